@@ -0,0 +1,47 @@
+/**
+ * Build time converter of SVG files to binary scene cache.
+ *
+ * Usage: svgscene-compile <input.svg> <output>
+ *
+ * @see svgscene/scenecache.h
+ */
+#include "svgscene/scenecache.h"
+#include "svgscene/svghandler.h"
+
+#include <QApplication>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QSaveFile>
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+    // Graphics items need a GUI application, but there is no display at build
+    // time.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    const QStringList args = QApplication::arguments();
+    if (args.size() != 3) {
+        fprintf(stderr, "Usage: svgscene-compile <input.svg> <output>\n");
+        return 2;
+    }
+
+    QFile input(args.at(1));
+    if (!input.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "Cannot open %s\n", qPrintable(args.at(1)));
+        return 1;
+    }
+    QGraphicsScene scene;
+    svgscene::SvgDocument document = svgscene::parseFromFile(&scene, &input);
+
+    QSaveFile output(args.at(2));
+    if (!output.open(QIODevice::WriteOnly)
+        || !svgscene::writeSceneCache(document.getRoot().getElement(), &output)
+        || !output.commit()) {
+        fprintf(stderr, "Cannot write scene cache %s\n", qPrintable(args.at(2)));
+        return 1;
+    }
+    return 0;
+}
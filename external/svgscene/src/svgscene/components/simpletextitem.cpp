@@ -19,10 +19,17 @@ void SimpleTextItem::setText(const QString& text) {
     if (!m_origTransformLoaded) {
         m_origTransformLoaded = true;
         m_origTransform = transform();
+    } else if (text == this->text()) {
+        return;
     }
     Super::setText(text);
     if (m_alignment != Qt::AlignLeft) {
         qreal w = boundingRect().width();
+        // Same width keeps the position, avoid invalidating the item again.
+        if (w == m_alignedWidth) {
+            return;
+        }
+        m_alignedWidth = w;
         QTransform t = m_origTransform;
         if (m_alignment == Qt::AlignHCenter)
             t.translate(-w / 2, 0);
@@ -32,6 +39,10 @@ void SimpleTextItem::setText(const QString& text) {
     }
 }
 
+QTransform SimpleTextItem::baseTransform() const {
+    return m_origTransformLoaded ? m_origTransform : transform();
+}
+
 void SimpleTextItem::paint(
     QPainter *painter,
     const QStyleOptionGraphicsItem *option,
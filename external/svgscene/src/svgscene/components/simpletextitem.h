@@ -13,6 +13,8 @@ public:
     explicit SimpleTextItem(const CssAttributes &css, QGraphicsItem *parent = nullptr);
 
     void setText(const QString& text);
+    /** Transform without the offset applied for text alignment. */
+    QTransform baseTransform() const;
     void paint(
         QPainter *painter,
         const QStyleOptionGraphicsItem *option,
@@ -22,6 +24,7 @@ private:
     int m_alignment = Qt::AlignLeft;
     QTransform m_origTransform;
     bool m_origTransformLoaded = false;
+    qreal m_alignedWidth = -1;
 };
 
 } // namespace svgscene
\ No newline at end of file
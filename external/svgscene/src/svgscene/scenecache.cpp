@@ -0,0 +1,290 @@
+#include "scenecache.h"
+
+#include "components/groupitem.h"
+#include "components/hyperlinkitem.h"
+#include "components/simpletextitem.h"
+#include "svghandler.h"
+#include "svgmetadata.h"
+#include "utils/logging.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QFontMetricsF>
+#include <QGraphicsScene>
+#include <QPainterPath>
+#include <QPen>
+#include <typeinfo>
+
+LOG_CATEGORY("svgscene.cache");
+
+namespace svgscene {
+
+static constexpr quint32 CACHE_MAGIC = 0x53564753; // "SVGS"
+static constexpr quint32 CACHE_VERSION = 1;
+
+enum class ItemKind : quint8 {
+    Rect = 1,
+    Group,
+    Hyperlink,
+    Ellipse,
+    Path,
+    SimpleText,
+    Text,
+};
+
+static void prepareStream(QDataStream &stream) {
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+/**
+ * Position of text item without baseline shift (font ascent) applied by
+ * SvgHandler. The shift is recomputed with the font available at load time.
+ */
+static QTransform textBaselineTransform(const SimpleTextItem *item) {
+    QFontMetricsF fm(item->font());
+    QTransform t;
+    t.translate(0, fm.ascent());
+    return t * item->baseTransform();
+}
+
+static bool writeItem(QDataStream &out, const QGraphicsItem *item) {
+    ItemKind kind;
+    // Most derived types first.
+    if (dynamic_cast<const HyperlinkItem *>(item)) {
+        kind = ItemKind::Hyperlink;
+    } else if (dynamic_cast<const GroupItem *>(item)) {
+        kind = ItemKind::Group;
+    } else if (dynamic_cast<const QGraphicsRectItem *>(item)) {
+        kind = ItemKind::Rect;
+    } else if (dynamic_cast<const QGraphicsEllipseItem *>(item)) {
+        kind = ItemKind::Ellipse;
+    } else if (dynamic_cast<const QGraphicsPathItem *>(item)) {
+        kind = ItemKind::Path;
+    } else if (dynamic_cast<const SimpleTextItem *>(item)) {
+        kind = ItemKind::SimpleText;
+    } else if (dynamic_cast<const QGraphicsTextItem *>(item)) {
+        kind = ItemKind::Text;
+    } else {
+        WARN() << "Unsupported item type:" << typeid(*item).name();
+        return false;
+    }
+    out << static_cast<quint8>(kind);
+
+    QVariant xml = item->data(static_cast<int>(MetadataType::XmlAttributes));
+    bool has_attributes = xml.isValid();
+    out << has_attributes;
+    if (has_attributes) {
+        out << getXmlAttributes(item) << getCssAttributes(item);
+    }
+
+    switch (kind) {
+    case ItemKind::Rect:
+    case ItemKind::Group:
+    case ItemKind::Hyperlink: {
+        auto *rect = dynamic_cast<const QGraphicsRectItem *>(item);
+        out << item->transform() << rect->rect() << rect->pen()
+            << rect->brush();
+        break;
+    }
+    case ItemKind::Ellipse: {
+        auto *ellipse = dynamic_cast<const QGraphicsEllipseItem *>(item);
+        out << item->transform() << ellipse->rect() << ellipse->pen()
+            << ellipse->brush();
+        break;
+    }
+    case ItemKind::Path: {
+        auto *path = dynamic_cast<const QGraphicsPathItem *>(item);
+        out << item->transform() << path->path() << path->pen()
+            << path->brush();
+        break;
+    }
+    case ItemKind::SimpleText: {
+        auto *text = dynamic_cast<const SimpleTextItem *>(item);
+        if (!has_attributes) {
+            return false;
+        }
+        out << textBaselineTransform(text) << text->pen() << text->brush()
+            << text->text();
+        break;
+    }
+    case ItemKind::Text: {
+        auto *text = dynamic_cast<const QGraphicsTextItem *>(item);
+        if (!has_attributes) {
+            return false;
+        }
+        out << item->transform() << text->textWidth() << text->toPlainText();
+        break;
+    }
+    }
+
+    const QList<QGraphicsItem *> children = item->childItems();
+    out << static_cast<quint32>(children.size());
+    for (const QGraphicsItem *child : children) {
+        if (!writeItem(out, child)) {
+            return false;
+        }
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+template<typename T>
+static T *readShape(QDataStream &in, T *item) {
+    QTransform transform;
+    QRectF rect;
+    QPen pen;
+    QBrush brush;
+    in >> transform >> rect >> pen >> brush;
+    item->setTransform(transform);
+    item->setRect(rect);
+    item->setPen(pen);
+    item->setBrush(brush);
+    return item;
+}
+
+static QGraphicsItem *readItem(QDataStream &in, QGraphicsItem *parent) {
+    quint8 raw_kind = 0;
+    bool has_attributes = false;
+    XmlAttributes xml;
+    CssAttributes css;
+    in >> raw_kind >> has_attributes;
+    if (has_attributes) {
+        in >> xml >> css;
+    }
+    if (in.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+
+    QGraphicsItem *item = nullptr;
+    switch (static_cast<ItemKind>(raw_kind)) {
+    case ItemKind::Rect: item = readShape(in, new QGraphicsRectItem()); break;
+    case ItemKind::Group: item = readShape(in, new GroupItem()); break;
+    case ItemKind::Hyperlink: item = readShape(in, new HyperlinkItem()); break;
+    case ItemKind::Ellipse:
+        item = readShape(in, new QGraphicsEllipseItem());
+        break;
+    case ItemKind::Path: {
+        auto *path = new QGraphicsPathItem();
+        QTransform transform;
+        QPainterPath painter_path;
+        QPen pen;
+        QBrush brush;
+        in >> transform >> painter_path >> pen >> brush;
+        path->setTransform(transform);
+        path->setPath(painter_path);
+        path->setPen(pen);
+        path->setBrush(brush);
+        item = path;
+        break;
+    }
+    case ItemKind::SimpleText: {
+        auto *text = new SimpleTextItem(css);
+        QTransform transform;
+        QPen pen;
+        QBrush brush;
+        QString str;
+        in >> transform >> pen >> brush >> str;
+        text->setPen(pen);
+        text->setBrush(brush);
+        SvgHandler::setTextStyle(text, css);
+        text->setTransform(transform);
+        QFontMetricsF fm(text->font());
+        QTransform t;
+        t.translate(0, -fm.ascent());
+        text->setTransform(t, true);
+        if (!str.isEmpty()) {
+            text->setText(str);
+        }
+        item = text;
+        break;
+    }
+    case ItemKind::Text: {
+        auto *text = new QGraphicsTextItem();
+        QTransform transform;
+        qreal text_width = -1;
+        QString str;
+        in >> transform >> text_width >> str;
+        SvgHandler::setTextStyle(text, css);
+        text->setTransform(transform);
+        text->setTextWidth(text_width);
+        text->setPlainText(str);
+        item = text;
+        break;
+    }
+    default:
+        WARN() << "Unknown item kind:" << raw_kind;
+        in.setStatus(QDataStream::ReadCorruptData);
+        return nullptr;
+    }
+
+    if (has_attributes) {
+        item->setData(
+            static_cast<int>(MetadataType::XmlAttributes),
+            QVariant::fromValue(xml));
+        item->setData(
+            static_cast<int>(MetadataType::CssAttributes),
+            QVariant::fromValue(css));
+    }
+    if (parent != nullptr) {
+        item->setParentItem(parent);
+    }
+
+    quint32 child_count = 0;
+    in >> child_count;
+    for (quint32 i = 0; i < child_count && in.status() == QDataStream::Ok;
+         i++) {
+        if (readItem(in, item) == nullptr) {
+            break;
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        if (parent == nullptr) {
+            delete item;
+        }
+        return nullptr;
+    }
+    return item;
+}
+
+bool writeSceneCache(const QGraphicsItem *root, QIODevice *out) {
+    QDataStream stream(out);
+    prepareStream(stream);
+    stream << CACHE_MAGIC << CACHE_VERSION;
+    return writeItem(stream, root) && stream.status() == QDataStream::Ok;
+}
+
+QGraphicsItem *readSceneCache(QGraphicsScene *scene, QIODevice *in) {
+    QDataStream stream(in);
+    prepareStream(stream);
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        WARN() << "Scene cache has unsupported format.";
+        return nullptr;
+    }
+    QGraphicsItem *root = readItem(stream, nullptr);
+    if (root == nullptr) {
+        WARN() << "Scene cache is corrupted.";
+        return nullptr;
+    }
+    scene->addItem(root);
+    return root;
+}
+
+SvgDocument parseFromCacheOrFileName(
+    QGraphicsScene *scene,
+    const QString &cache_filename,
+    const QString &svg_filename) {
+    QFile file(cache_filename);
+    if (file.open(QIODevice::ReadOnly)) {
+        QGraphicsItem *root = readSceneCache(scene, &file);
+        if (root != nullptr) {
+            return SvgDocument(root);
+        }
+    } else {
+        DEBUG() << "Scene cache" << cache_filename << "not available.";
+    }
+    return parseFromFileName(scene, svg_filename);
+}
+
+} // namespace svgscene
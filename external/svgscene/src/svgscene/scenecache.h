@@ -0,0 +1,50 @@
+#pragma once
+
+#include "svgdocument.h"
+
+#include <QIODevice>
+
+class QGraphicsScene;
+
+namespace svgscene {
+
+/**
+ * Binary scene description (scene cache).
+ *
+ * Parsing SVG (XML, CSS and path data) is slow, especially in WebAssembly.
+ * The scene cache stores the graphics items already created by `SvgHandler`
+ * (geometry, styles and xml/css attributes used for component lookup) in
+ * a compact binary form, that is read directly into `QGraphicsScene`.
+ *
+ * Fonts depend on the running platform, therefore text items store only
+ * their CSS attributes and baseline position and fonts are resolved when
+ * the cache is loaded.
+ *
+ * The cache is produced at build time by `svgscene-compile`.
+ */
+
+/**
+ * Serialize item tree produced by SvgHandler.
+ *
+ * @return  false when the tree contains an unsupported item or write failed
+ */
+bool writeSceneCache(const QGraphicsItem *root, QIODevice *out);
+
+/**
+ * Build items from scene cache and add them to the scene.
+ *
+ * @return  root item or nullptr when the cache is invalid (nothing is added
+ *          to the scene in that case)
+ */
+QGraphicsItem *readSceneCache(QGraphicsScene *scene, QIODevice *in);
+
+/**
+ * Load scene from cache file when available and valid, parse the SVG file
+ * otherwise.
+ */
+SvgDocument parseFromCacheOrFileName(
+    QGraphicsScene *scene,
+    const QString &cache_filename,
+    const QString &svg_filename);
+
+} // namespace svgscene
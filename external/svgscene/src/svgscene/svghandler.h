@@ -49,6 +49,13 @@ public:
 
     SvgDocument getDocument() const;
 
+    static void setTextStyle(QFont &font, const CssAttributes &attributes);
+    static void setTextStyle(
+        QGraphicsSimpleTextItem *text,
+        const CssAttributes &attributes);
+    static void
+    setTextStyle(QGraphicsTextItem *text, const CssAttributes &attributes);
+
 protected:
     virtual QGraphicsItem *createGroupItem(const SvgElement &el);
     QGraphicsItem *createHyperlinkItem(const SvgElement &el);
@@ -70,12 +77,6 @@ private:
     static void setTransform(QGraphicsItem *it, const QString &str_val);
     static void
     setStyle(QAbstractGraphicsShapeItem *it, const CssAttributes &attributes);
-    static void setTextStyle(QFont &font, const CssAttributes &attributes);
-    static void setTextStyle(
-        QGraphicsSimpleTextItem *text,
-        const CssAttributes &attributes);
-    static void
-    setTextStyle(QGraphicsTextItem *text, const CssAttributes &attributes);
 
     bool startElement();
     void addItem(QGraphicsItem *it);
@@ -1,5 +1,7 @@
 #include "fixmatheval.h"
 
+#include <QVarLengthArray>
+#include <algorithm>
 #include <climits>
 #include <utility>
 
@@ -59,6 +61,12 @@ QString FmeNodeConstant::dump() {
     return QString::number(value);
 }
 
+bool FmeNodeConstant::compile(FmeProgram &program, FmeSymbolSlots &slots) {
+    (void)slots;
+    program.emit_constant(value);
+    return true;
+}
+
 FmeNodeSymbol::FmeNodeSymbol(QString &name) : FmeNode(INT_MAX) {
     this->name = name;
 }
@@ -81,6 +89,11 @@ QString FmeNodeSymbol::dump() {
     return name;
 }
 
+bool FmeNodeSymbol::compile(FmeProgram &program, FmeSymbolSlots &slots) {
+    program.emit_symbol(slots.slot(name));
+    return true;
+}
+
 FmeNodeUnaryOp::FmeNodeUnaryOp(
     int priority,
     FmeValue (*op)(FmeValue &a),
@@ -124,6 +137,14 @@ QString FmeNodeUnaryOp::dump() {
            + ")";
 }
 
+bool FmeNodeUnaryOp::compile(FmeProgram &program, FmeSymbolSlots &slots) {
+    if (!operand_a || !operand_a->compile(program, slots)) {
+        return false;
+    }
+    program.emit_unary(op);
+    return true;
+}
+
 FmeNodeBinaryOp::FmeNodeBinaryOp(
     int priority,
     FmeValue (*op)(FmeValue &a, FmeValue &b),
@@ -169,6 +190,15 @@ QString FmeNodeBinaryOp::dump() {
            + " " + (operand_b ? operand_b->dump() : "nullptr") + ")";
 }
 
+bool FmeNodeBinaryOp::compile(FmeProgram &program, FmeSymbolSlots &slots) {
+    if (!operand_a || !operand_b || !operand_a->compile(program, slots)
+        || !operand_b->compile(program, slots)) {
+        return false;
+    }
+    program.emit_binary(op);
+    return true;
+}
+
 FmeExpression::FmeExpression() : FmeNode(0) {
     root = nullptr;
 }
@@ -342,3 +372,109 @@ FmeNode *FmeExpression::child() {
 QString FmeExpression::dump() {
     return "(" + (root ? root->dump() : "nullptr") + ")";
 }
+
+bool FmeExpression::compile(FmeProgram &program, FmeSymbolSlots &slots) {
+    if (!root) {
+        return false;
+    }
+    return root->compile(program, slots);
+}
+
+int FmeSymbolSlots::slot(const QString &name) {
+    auto it = index.constFind(name);
+    if (it != index.constEnd()) {
+        return it.value();
+    }
+    int slot = names.size();
+    index.insert(name, slot);
+    names.append(name);
+    return slot;
+}
+
+void FmeSymbolSlots::resolve(FmeSymbolDb *symdb) {
+    values.resize(names.size());
+    found.resize(names.size());
+    for (int i = 0; i < names.size(); i++) {
+        values[i] = 0;
+        found[i] = symdb != nullptr && symdb->getValue(values[i], names.at(i));
+    }
+}
+
+void FmeSymbolSlots::clear() {
+    index.clear();
+    names.clear();
+    values.clear();
+    found.clear();
+}
+
+bool FmeProgram::compile(const QString &expression, FmeSymbolSlots &slots) {
+    code.clear();
+    depth = 0;
+    max_depth = 0;
+    error.clear();
+    FmeExpression tree;
+    valid = tree.parse(expression, error);
+    if (valid) {
+        valid = tree.compile(*this, slots);
+        if (!valid) {
+            error = QString("incomplete expression");
+        }
+    }
+    return valid;
+}
+
+void FmeProgram::push(const Instruction &instruction, int stack_change) {
+    code.append(instruction);
+    depth += stack_change;
+    max_depth = std::max(max_depth, depth);
+}
+
+void FmeProgram::emit_constant(FmeValue value) {
+    push({ Instruction::CONSTANT, 0, value, nullptr, nullptr }, 1);
+}
+
+void FmeProgram::emit_symbol(int slot) {
+    push({ Instruction::SYMBOL, slot, 0, nullptr, nullptr }, 1);
+}
+
+void FmeProgram::emit_unary(FmeValue (*op)(FmeValue &a)) {
+    push({ Instruction::UNARY, 0, 0, op, nullptr }, 0);
+}
+
+void FmeProgram::emit_binary(FmeValue (*op)(FmeValue &a, FmeValue &b)) {
+    push({ Instruction::BINARY, 0, 0, nullptr, op }, -1);
+}
+
+bool FmeProgram::eval(
+    FmeValue &value,
+    const FmeSymbolSlots &slots,
+    QString &error) const {
+    if (!valid) {
+        error = this->error;
+        return false;
+    }
+    QVarLengthArray<FmeValue, 16> stack(max_depth);
+    int top = 0;
+    for (const Instruction &in : code) {
+        switch (in.kind) {
+        case Instruction::CONSTANT: stack[top++] = in.constant; break;
+        case Instruction::SYMBOL:
+            if (!slots.defined(in.slot)) {
+                error = QString("value for symbol \"%1\" not found")
+                            .arg(slots.name(in.slot));
+                return false;
+            }
+            stack[top++] = slots.value(in.slot);
+            break;
+        case Instruction::UNARY:
+            stack[top - 1] = in.unary(stack[top - 1]);
+            break;
+        case Instruction::BINARY:
+            top--;
+            stack[top - 1] = in.binary(stack[top - 1], stack[top]);
+            break;
+        }
+    }
+    value = stack[0];
+    return true;
+}
@@ -1,12 +1,17 @@
 #ifndef FIXMATHEVAL_H
 #define FIXMATHEVAL_H
 
+#include <QHash>
 #include <QString>
+#include <QVector>
 
 namespace fixmatheval {
 
 typedef int64_t FmeValue;
 
+class FmeProgram;
+class FmeSymbolSlots;
+
 class FmeSymbolDb {
 public:
     virtual ~FmeSymbolDb();
@@ -21,6 +26,8 @@ public:
     virtual bool insert(FmeNode *node);
     virtual FmeNode *child();
     virtual QString dump() = 0;
+    /** Append postfix code of the subtree to the program. */
+    virtual bool compile(FmeProgram &program, FmeSymbolSlots &slots) = 0;
     FmeNode *find_last_child();
     int priority() const;
 
@@ -34,6 +41,7 @@ public:
     ~FmeNodeConstant() override;
     bool eval(FmeValue &value, FmeSymbolDb *symdb, QString &error) override;
     QString dump() override;
+    bool compile(FmeProgram &program, FmeSymbolSlots &slots) override;
 
 private:
     FmeValue value;
@@ -45,6 +53,7 @@ public:
     ~FmeNodeSymbol() override;
     bool eval(FmeValue &value, FmeSymbolDb *symdb, QString &error) override;
     QString dump() override;
+    bool compile(FmeProgram &program, FmeSymbolSlots &slots) override;
 
 private:
     QString name;
@@ -61,6 +70,7 @@ public:
     bool insert(FmeNode *node) override;
     FmeNode *child() override;
     QString dump() override;
+    bool compile(FmeProgram &program, FmeSymbolSlots &slots) override;
 
 private:
     FmeValue (*op)(FmeValue &a);
@@ -80,6 +90,7 @@ public:
     bool insert(FmeNode *node) override;
     FmeNode *child() override;
     QString dump() override;
+    bool compile(FmeProgram &program, FmeSymbolSlots &slots) override;
 
 private:
     FmeValue (*op)(FmeValue &a, FmeValue &b);
@@ -97,11 +108,76 @@ public:
     bool insert(FmeNode *node) override;
     FmeNode *child() override;
     QString dump() override;
+    bool compile(FmeProgram &program, FmeSymbolSlots &slots) override;
 
 private:
     FmeNode *root;
 };
 
+/**
+ * Symbols referenced by compiled expressions.
+ *
+ * Each distinct name gets a slot. Values are looked up once for all
+ * expressions by `resolve`.
+ */
+class FmeSymbolSlots {
+public:
+    int slot(const QString &name);
+    /** Look up values of all slots, missing symbols are remembered. */
+    void resolve(FmeSymbolDb *symdb);
+    void clear();
+
+    const QString &name(int slot) const { return names.at(slot); }
+    bool defined(int slot) const { return found.at(slot); }
+    FmeValue value(int slot) const { return values.at(slot); }
+
+private:
+    QHash<QString, int> index;
+    QVector<QString> names;
+    QVector<FmeValue> values;
+    QVector<bool> found;
+};
+
+/**
+ * Expression compiled to postfix code.
+ *
+ * Parsing and symbol lookup are done once, evaluation is a single loop
+ * over the code with values kept on a small stack.
+ */
+class FmeProgram {
+public:
+    struct Instruction {
+        enum Kind : uint8_t { CONSTANT, SYMBOL, UNARY, BINARY };
+        Kind kind;
+        int slot;
+        FmeValue constant;
+        FmeValue (*unary)(FmeValue &a);
+        FmeValue (*binary)(FmeValue &a, FmeValue &b);
+    };
+
+    bool compile(const QString &expression, FmeSymbolSlots &slots);
+    bool eval(FmeValue &value, const FmeSymbolSlots &slots, QString &error)
+        const;
+
+    bool is_valid() const { return valid; }
+    /** Error reported by the parser when compilation failed. */
+    const QString &parse_error() const { return error; }
+
+    void emit_constant(FmeValue value);
+    void emit_symbol(int slot);
+    void emit_unary(FmeValue (*op)(FmeValue &a));
+    void emit_binary(FmeValue (*op)(FmeValue &a, FmeValue &b));
+
+private:
+    void push(const Instruction &instruction, int stack_change);
+
+    QVector<Instruction> code;
+    int depth = 0;
+    int max_depth = 0;
+    bool valid = false;
+    QString error;
+};
+
 } // namespace fixmatheval
 
 #endif /*FIXMATHEVAL*/
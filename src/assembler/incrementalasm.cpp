@@ -0,0 +1,187 @@
+#include "incrementalasm.h"
+
+#include "machine/memory/backend/memory.h"
+#include "machine/memory/memory_bus.h"
+#include "machine/symboltable.h"
+
+#include <utility>
+
+using machine::Address;
+
+namespace {
+
+/**
+ * Assembler of a block of lines to scratch memory.
+ *
+ * Included files and pragmas are not processed, their use is only recorded.
+ */
+class ScratchAsm : public SimpleAsm {
+public:
+    bool preprocessor_used = false;
+
+    bool process_file(const QString &filename, QString *error_ptr) override {
+        (void)filename;
+        (void)error_ptr;
+        preprocessor_used = true;
+        return true;
+    }
+
+protected:
+    bool process_pragma(
+        QStringList &operands,
+        const QString &filename,
+        int line_number,
+        QString *error_ptr) override {
+        (void)operands;
+        (void)filename;
+        (void)line_number;
+        (void)error_ptr;
+        preprocessor_used = true;
+        return true;
+    }
+};
+
+/** Symbols of the block first, then symbols of the whole program. */
+class OverlaySymbolDb : public SymbolTableDb {
+public:
+    OverlaySymbolDb(machine::SymbolTable *symbol_table, SymbolTableDb *base)
+        : SymbolTableDb(symbol_table)
+        , base(base) {}
+
+    bool getValue(fixmatheval::FmeValue &value, QString name) override {
+        return SymbolTableDb::getValue(value, name)
+               || base->getValue(value, std::move(name));
+    }
+
+private:
+    SymbolTableDb *base;
+};
+
+} // namespace
+
+IncrementalAsm::IncrementalAsm(QObject *parent) : Super(parent) {}
+
+void IncrementalAsm::reset() {
+    lines.clear();
+    line_addresses.clear();
+}
+
+void IncrementalAsm::record_build(
+    const QStringList &lines,
+    const QVector<machine::Address> &line_addresses) {
+    Q_ASSERT(line_addresses.size() == lines.size() + 1);
+    this->lines = lines;
+    this->line_addresses = line_addresses;
+}
+
+IncrementalAsm::Result IncrementalAsm::update(
+    const QStringList &new_lines,
+    const QString &filename,
+    machine::FrontendMemory *mem,
+    SymbolTableDb *symtab) {
+    if (!has_build()) {
+        return FULL_BUILD_REQUIRED;
+    }
+
+    // Edited block is what remains after common beginning and end.
+    const int old_count = lines.size();
+    const int new_count = new_lines.size();
+    int first = 0;
+    while (first < old_count && first < new_count
+           && lines.at(first) == new_lines.at(first)) {
+        first++;
+    }
+    int tail = 0;
+    while (tail < old_count - first && tail < new_count - first
+           && lines.at(old_count - 1 - tail)
+                  == new_lines.at(new_count - 1 - tail)) {
+        tail++;
+    }
+    if (first == old_count && first == new_count) {
+        return UNCHANGED;
+    }
+    const int old_last = old_count - tail;
+    const int new_last = new_count - tail;
+    const Address start = line_addresses.at(first);
+
+    Layout new_layout = scratch_layout(
+        new_lines, first, new_last, start, filename, symtab,
+        mem->simulated_machine_endian, true);
+    if (!new_layout.ok) {
+        return FAILED;
+    }
+    if (!new_layout.local || new_layout.end != line_addresses.at(old_last)) {
+        return FULL_BUILD_REQUIRED;
+    }
+    Layout old_layout = scratch_layout(
+        lines, first, old_last, start, filename, symtab,
+        mem->simulated_machine_endian, false);
+    if (!old_layout.ok || !old_layout.local
+        || old_layout.end != new_layout.end
+        || old_layout.symbols != new_layout.symbols) {
+        return FULL_BUILD_REQUIRED;
+    }
+
+    // Layout is kept, the block can be assembled in place.
+    SimpleAsm sasm;
+    connect(
+        &sasm, &SimpleAsm::report_message, this,
+        &IncrementalAsm::report_message);
+    sasm.setup(mem, symtab, start);
+    bool ok = true;
+    for (int i = first; i < new_last; i++) {
+        if (!sasm.process_line(new_lines.at(i), filename, i + 1)) {
+            ok = false;
+        }
+    }
+    if (!sasm.finish()) {
+        ok = false;
+    }
+
+    lines = new_lines;
+    line_addresses = line_addresses.mid(0, first) + new_layout.line_addresses
+                     + line_addresses.mid(old_last);
+    return ok ? PATCHED : FAILED;
+}
+
+IncrementalAsm::Layout IncrementalAsm::scratch_layout(
+    const QStringList &source,
+    int first,
+    int last,
+    machine::Address start,
+    const QString &filename,
+    SymbolTableDb *symtab,
+    machine::Endian endian,
+    bool report) {
+    Layout layout;
+    machine::Memory memory(endian);
+    machine::MemoryDataBus bus(endian);
+    bus.insert_device_to_range(
+        &memory, Address::null(), Address(0xffffffff), false);
+    machine::SymbolTable symbols;
+    OverlaySymbolDb db(&symbols, symtab);
+
+    ScratchAsm sasm;
+    if (report) {
+        connect(
+            &sasm, &SimpleAsm::report_message, this,
+            &IncrementalAsm::report_message);
+    }
+    sasm.setup(&bus, &db, start);
+    layout.ok = true;
+    for (int i = first; i < last; i++) {
+        layout.line_addresses.append(sasm.current_address());
+        if (!sasm.process_line(source.at(i), filename, i + 1)) {
+            layout.ok = false;
+        }
+    }
+    layout.end = sasm.current_address();
+    layout.local = !sasm.preprocessor_used;
+    for (const QString &name : symbols.names()) {
+        SymbolValue value;
+        if (symbols.name_to_value(value, name)) {
+            layout.symbols.insert(name, value);
+        }
+    }
+    return layout;
+}
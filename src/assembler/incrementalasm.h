@@ -0,0 +1,102 @@
+#ifndef INCREMENTALASM_H
+#define INCREMENTALASM_H
+
+#include "machine/memory/address.h"
+#include "machine/memory/frontend_memory.h"
+#include "messagetype.h"
+#include "simpleasm.h"
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Reassembly of edited lines of already built source.
+ *
+ * Source lines and their addresses are remembered after a full build. When
+ * the source is edited, only the changed block of lines is assembled again.
+ * If it keeps the program layout (ends at the same address and defines the
+ * same symbols with the same values), the block is assembled directly into
+ * memory and nothing else has to be touched. Otherwise full build is needed.
+ */
+class IncrementalAsm : public QObject {
+    Q_OBJECT
+
+    using Super = QObject;
+
+signals:
+    void report_message(
+        messagetype::Type type,
+        QString file,
+        int line,
+        int column,
+        QString text,
+        QString hint);
+
+public:
+    enum Result {
+        UNCHANGED,          // Source matches the last build.
+        PATCHED,            // Edited lines were written to memory.
+        FAILED,             // Edited lines contain errors.
+        FULL_BUILD_REQUIRED // Edit changes layout or there is no build.
+    };
+
+    explicit IncrementalAsm(QObject *parent = nullptr);
+
+    /** Forget the last build, full build is required. */
+    void reset();
+    /**
+     * Remember source of successful full build.
+     *
+     * @param lines           source lines
+     * @param line_addresses  address of each line and the address after the
+     *                        last line (one more item than lines)
+     */
+    void record_build(
+        const QStringList &lines,
+        const QVector<machine::Address> &line_addresses);
+    bool has_build() const { return !line_addresses.isEmpty(); }
+
+    /**
+     * Bring memory up to date with edited source.
+     *
+     * Errors of the edited lines are reported. Memory and symbols are
+     * modified only for PATCHED and FAILED (relocation errors) results.
+     */
+    Result update(
+        const QStringList &new_lines,
+        const QString &filename,
+        machine::FrontendMemory *mem,
+        SymbolTableDb *symtab);
+
+private:
+    struct Layout {
+        bool ok = false;
+        /** Block does not include other files or use pragmas. */
+        bool local = true;
+        machine::Address end;
+        QMap<QString, SymbolValue> symbols;
+        QVector<machine::Address> line_addresses;
+    };
+
+    /**
+     * Assemble lines [first, last) to scratch memory to find out their size
+     * and symbols. Symbols defined elsewhere are taken from `symtab`.
+     */
+    Layout scratch_layout(
+        const QStringList &source,
+        int first,
+        int last,
+        machine::Address start,
+        const QString &filename,
+        SymbolTableDb *symtab,
+        machine::Endian endian,
+        bool report);
+
+    QStringList lines;
+    QVector<machine::Address> line_addresses;
+};
+
+#endif // INCREMENTALASM_H
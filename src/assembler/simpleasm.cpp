@@ -8,6 +8,7 @@
 #include <QFileInfo>
 #include <QObject>
 #include <QString>
+#include <algorithm>
 #include <utility>
 
 using namespace fixmatheval;
@@ -37,24 +38,89 @@ void SymbolTableDb::setSymbol(
     symbol_table->set_symbol(name, value, size, info, other);
 }
 
-uint64_t
-SimpleAsm::string_to_uint64(const QString &str, int base, int *chars_taken) {
-    int i;
-    int64_t val;
-    char *p, *r;
-    char cstr[str.count() + 1];
-    for (i = 0; i < str.count(); i++) {
+const QString &SymbolNamePool::intern(const QStringRef &name) {
+    auto it = index.constFind(name);
+    if (it != index.constEnd()) {
+        return *it.value();
+    }
+    names.push_back(name.toString());
+    const QString &stored = names.back();
+    index.insert(QStringRef(&stored), &stored);
+    return stored;
+}
+
+void SymbolNamePool::clear() {
+    index.clear();
+    names.clear();
+}
+
+uint64_t SimpleAsm::string_to_uint64(
+    const QStringRef &str,
+    int base,
+    int *chars_taken) {
+    // Numbers are short, longer operands are expressions and stop the
+    // conversion anyway.
+    char cstr[64];
+    int n = std::min(str.size(), (int)sizeof(cstr) - 1);
+    for (int i = 0; i < n; i++) {
         cstr[i] = str.at(i).toLatin1();
     }
-    cstr[i] = 0;
-    p = cstr;
-    val = std::strtoll(p, &r, base);
+    cstr[n] = 0;
+    char *r;
+    int64_t val = std::strtoll(cstr, &r, base);
     if (chars_taken != nullptr) {
-        *chars_taken = r - p;
+        *chars_taken = r - cstr;
     }
     return val;
 }
 
+namespace {
+
+enum class Directive {
+    NONE, // Instruction
+    PRAGMA,
+    INCLUDE,
+    IGNORED,
+    ORG,
+    SPACE,
+    EQU,
+    ASCII,
+    ASCIZ,
+    BYTE,
+    WORD,
+};
+
+struct DirectiveName {
+    const char *name;
+    Directive directive;
+};
+
+const DirectiveName directive_names[] = {
+    { "#pragma", Directive::PRAGMA }, { "#include", Directive::INCLUDE },
+    { ".data", Directive::IGNORED },  { ".text", Directive::IGNORED },
+    { ".globl", Directive::IGNORED }, { ".end", Directive::IGNORED },
+    { ".ent", Directive::IGNORED },   { ".org", Directive::ORG },
+    { ".space", Directive::SPACE },   { ".skip", Directive::SPACE },
+    { ".equ", Directive::EQU },       { ".set", Directive::EQU },
+    { ".ascii", Directive::ASCII },   { ".asciz", Directive::ASCIZ },
+    { ".byte", Directive::BYTE },     { ".word", Directive::WORD },
+};
+
+/** Recognize directive (case insensitive) without copying the operation. */
+Directive directive_from_op(const QStringRef &op) {
+    if (op.isEmpty() || (op.at(0) != '.' && op.at(0) != '#')) {
+        return Directive::NONE;
+    }
+    for (const DirectiveName &d : directive_names) {
+        if (op.compare(QLatin1String(d.name), Qt::CaseInsensitive) == 0) {
+            return d.directive;
+        }
+    }
+    return Directive::NONE;
+}
+
+} // namespace
+
 SimpleAsm::SimpleAsm(QObject *parent) : Super(parent) {
     clear();
 }
@@ -65,10 +131,13 @@ SimpleAsm::~SimpleAsm() {
 
 void SimpleAsm::clear() {
     symtab = nullptr;
+    symbol_names.clear();
     mem = nullptr;
     while (!reloc.isEmpty()) {
         delete reloc.takeFirst();
     }
+    reloc_programs.clear();
+    reloc_symbols.clear();
     error_occured = false;
     fatal_occured = false;
 }
@@ -87,10 +156,22 @@ bool SimpleAsm::process_line(
     const QString &filename,
     int line_number,
     QString *error_ptr) {
-    QString error;
-    QString label = "";
-    QString op = "";
-    QStringList operands;
+    return process_line(QStringRef(&line), filename, line_number, error_ptr);
+}
+
+bool SimpleAsm::is_directive(const QStringRef &op) {
+    return directive_from_op(op) != Directive::NONE;
+}
+
+bool SimpleAsm::tokenize_line(
+    const QStringRef &line,
+    SourceLineTokens &tokens,
+    QString &error,
+    int &error_pos) {
+    tokens.label.clear();
+    tokens.op.clear();
+    tokens.operands.clear();
+    tokens.comment_pos = -1;
     int pos;
     bool in_quotes = false;
     bool backslash = false;
@@ -116,25 +197,30 @@ bool SimpleAsm::process_line(
                     if ((line.count() > pos + 8)
                         && !line.at(pos + 8).isSpace()) {
                         final = true;
+                        tokens.comment_pos = pos;
                     }
                 } else if (line.mid(pos).startsWith("#pragma")) {
                     if ((line.count() > pos + 7)
                         && !line.at(pos + 7).isSpace()) {
                         final = true;
+                        tokens.comment_pos = pos;
                     } else {
                         space_separated = true;
                     }
                 } else {
                     final = true;
+                    tokens.comment_pos = pos;
                 }
             }
             if (ch == ';') {
                 final = true;
+                tokens.comment_pos = pos;
             }
             if (ch == '/') {
                 if (pos + 1 < line.count()) {
                     if (line.at(pos + 1) == '/') {
                         final = true;
+                        tokens.comment_pos = pos;
                     }
                 }
             }
@@ -147,16 +233,11 @@ bool SimpleAsm::process_line(
                 maybe_label = false;
                 if (token_beg == -1) {
                     error = "empty label";
-                    emit report_message(
-                        messagetype::MSG_ERROR, filename, line_number, pos,
-                        error, "");
-                    error_occured = true;
-                    if (error_ptr != nullptr) {
-                        *error_ptr = error;
-                    }
+                    error_pos = pos;
                     return false;
                 }
-                label = line.mid(token_beg, token_last - token_beg + 1);
+                tokens.label
+                    = line.mid(token_beg, token_last - token_beg + 1);
                 token_beg = -1;
             } else if (
                 ((!ch.isSpace() && (token_beg >= 0) && (token_last < pos - 1))
@@ -164,35 +245,23 @@ bool SimpleAsm::process_line(
                 && (operand_num == -1)) {
                 maybe_label = false;
                 if (token_beg != -1) {
-                    op = line.mid(token_beg, token_last - token_beg + 1)
-                             .toUpper();
+                    tokens.op
+                        = line.mid(token_beg, token_last - token_beg + 1);
                 }
                 token_beg = -1;
                 operand_num = 0;
                 if (ch == ',') {
                     error = "empty first operand";
-                    emit report_message(
-                        messagetype::MSG_ERROR, filename, line_number, pos,
-                        error, "");
-                    error_occured = true;
-                    if (error_ptr != nullptr) {
-                        *error_ptr = error;
-                    }
+                    error_pos = pos;
                     return false;
                 }
             } else if (separator || final) {
                 if (token_beg == -1) {
                     error = "empty operand";
-                    emit report_message(
-                        messagetype::MSG_ERROR, filename, line_number, pos,
-                        error, "");
-                    error_occured = true;
-                    if (error_ptr != nullptr) {
-                        *error_ptr = error;
-                    }
+                    error_pos = pos;
                     return false;
                 }
-                operands.append(
+                tokens.operands.append(
                     line.mid(token_beg, token_last - token_beg + 1));
                 token_beg = -1;
                 operand_num++;
@@ -210,13 +279,7 @@ bool SimpleAsm::process_line(
             if (ch == '"') {
                 if (operand_num == -1) {
                     error = "unexpected quoted text";
-                    emit report_message(
-                        messagetype::MSG_ERROR, filename, line_number, pos,
-                        error, "");
-                    error_occured = true;
-                    if (error_ptr != nullptr) {
-                        *error_ptr = error;
-                    }
+                    error_pos = pos;
                     return false;
                 }
                 in_quotes = true;
@@ -225,13 +288,7 @@ bool SimpleAsm::process_line(
             token_last = pos;
             if (final) {
                 error = "unterminated quoted text";
-                emit report_message(
-                    messagetype::MSG_ERROR, filename, line_number, pos, error,
-                    "");
-                error_occured = true;
-                if (error_ptr != nullptr) {
-                    *error_ptr = error;
-                }
+                error_pos = pos;
                 return false;
             }
             if ((ch == '"') && !backslash) {
@@ -245,8 +302,35 @@ bool SimpleAsm::process_line(
         }
     }
 
+    return true;
+}
+
+bool SimpleAsm::process_line(
+    const QStringRef &line,
+    const QString &filename,
+    int line_number,
+    QString *error_ptr) {
+    QString error;
+    int error_pos = 0;
+    // Tokens reference the line, the vector is reused to avoid allocation.
+    // Nested #include clobbers it, operands are not used after that.
+    SourceLineTokens &tokens = line_tokens;
+    if (!tokenize_line(line, tokens, error, error_pos)) {
+        emit report_message(
+            messagetype::MSG_ERROR, filename, line_number, error_pos, error,
+            "");
+        error_occured = true;
+        if (error_ptr != nullptr) {
+            *error_ptr = error;
+        }
+        return false;
+    }
+    const QStringRef label = tokens.label;
+    const QStringRef op = tokens.op;
+    QVector<QStringRef> &operands = tokens.operands;
+
     if (!label.isEmpty()) {
-        symtab->setSymbol(label, address.get_raw(), 4);
+        symtab->setSymbol(symbol_names.intern(label), address.get_raw(), 4);
     }
 
     if (op.isEmpty()) {
@@ -263,10 +347,17 @@ bool SimpleAsm::process_line(
         return true;
     }
 
-    if (op == "#PRAGMA") {
-        return process_pragma(operands, filename, line_number, error_ptr);
+    const Directive directive = directive_from_op(op);
+
+    if (directive == Directive::PRAGMA) {
+        QStringList pragma_operands;
+        for (const QStringRef &operand : operands) {
+            pragma_operands.append(operand.toString());
+        }
+        return process_pragma(
+            pragma_operands, filename, line_number, error_ptr);
     }
-    if (op == "#INCLUDE") {
+    if (directive == Directive::INCLUDE) {
         bool res = true;
         QString incname;
         if ((operands.count() != 1) || operands.at(0).isEmpty()) {
@@ -279,7 +370,7 @@ bool SimpleAsm::process_line(
             }
             return false;
         }
-        incname = operands.at(0);
+        incname = operands.at(0).toString();
         if (incname.at(0) == '"') {
             incname = incname.mid(1, incname.count() - 2);
         }
@@ -308,11 +399,10 @@ bool SimpleAsm::process_line(
         include_stack.removeLast();
         return res;
     }
-    if ((op == ".DATA") || (op == ".TEXT") || (op == ".GLOBL") || (op == ".END")
-        || (op == ".ENT")) {
+    if (directive == Directive::IGNORED) {
         return true;
     }
-    if (op == ".ORG") {
+    if (directive == Directive::ORG) {
         bool ok;
         fixmatheval::FmeExpression expression;
         fixmatheval::FmeValue value;
@@ -326,10 +416,10 @@ bool SimpleAsm::process_line(
             }
             return false;
         }
-        ok = expression.parse(operands.at(0), error);
+        ok = expression.parse(operands.at(0).toString(), error);
         if (!ok) {
             fatal_occured = true;
-            error = tr(".orig %1 parse error.").arg(line);
+            error = tr(".orig %1 parse error.").arg(line.toString());
             emit report_message(
                 messagetype::MSG_ERROR, filename, line_number, 0, error, "");
             error_occured = true;
@@ -341,7 +431,7 @@ bool SimpleAsm::process_line(
         ok = expression.eval(value, symtab, error);
         if (!ok) {
             fatal_occured = true;
-            error = tr(".orig %1 evaluation error.").arg(line);
+            error = tr(".orig %1 evaluation error.").arg(line.toString());
             emit report_message(
                 messagetype::MSG_ERROR, filename, line_number, 0, error, "");
             error_occured = true;
@@ -353,7 +443,7 @@ bool SimpleAsm::process_line(
         address = machine::Address(value);
         return true;
     }
-    if ((op == ".SPACE") || (op == ".SKIP")) {
+    if (directive == Directive::SPACE) {
         bool ok;
         fixmatheval::FmeExpression expression;
         fixmatheval::FmeValue value;
@@ -369,10 +459,10 @@ bool SimpleAsm::process_line(
             return false;
         }
         if (operands.count() > 1) {
-            ok = expression.parse(operands.at(1), error);
+            ok = expression.parse(operands.at(1).toString(), error);
             if (!ok) {
                 fatal_occured = true;
-                error = tr(".space/.skip %1 parse error.").arg(line);
+                error = tr(".space/.skip %1 parse error.").arg(line.toString());
                 emit report_message(
                     messagetype::MSG_ERROR, filename, line_number, 0, error,
                     "");
@@ -385,7 +475,8 @@ bool SimpleAsm::process_line(
             ok = expression.eval(fill, symtab, error);
             if (!ok) {
                 fatal_occured = true;
-                error = tr(".space/.skip %1 evaluation error.").arg(line);
+                error = tr(".space/.skip %1 evaluation error.")
+                            .arg(line.toString());
                 emit report_message(
                     messagetype::MSG_ERROR, filename, line_number, 0, error,
                     "");
@@ -396,10 +487,10 @@ bool SimpleAsm::process_line(
                 return false;
             }
         }
-        ok = expression.parse(operands.at(0), error);
+        ok = expression.parse(operands.at(0).toString(), error);
         if (!ok) {
             fatal_occured = true;
-            error = tr(".space/.skip %1 parse error.").arg(line);
+            error = tr(".space/.skip %1 parse error.").arg(line.toString());
             emit report_message(
                 messagetype::MSG_ERROR, filename, line_number, 0, error, "");
             error_occured = true;
@@ -411,7 +502,8 @@ bool SimpleAsm::process_line(
         ok = expression.eval(value, symtab, error);
         if (!ok) {
             fatal_occured = true;
-            error = tr(".space/.skip %1 evaluation error.").arg(line);
+            error = tr(".space/.skip %1 evaluation error.")
+                        .arg(line.toString());
             emit report_message(
                 messagetype::MSG_ERROR, filename, line_number, 0, error, "");
             error_occured = true;
@@ -428,7 +520,7 @@ bool SimpleAsm::process_line(
         }
         return true;
     }
-    if ((op == ".EQU") || (op == ".SET")) {
+    if (directive == Directive::EQU) {
         if ((operands.count() > 2) || (operands.count() < 1)) {
             error = tr(".set or .equ incorrect arguments number.");
             emit report_message(
@@ -439,7 +531,7 @@ bool SimpleAsm::process_line(
             }
             return false;
         }
-        QString name = operands.at(0).trimmed();
+        QStringRef name = operands.at(0).trimmed();
         if ((name == "noat") || (name == "noreored")) {
             return true;
         }
@@ -447,12 +539,13 @@ bool SimpleAsm::process_line(
         fixmatheval::FmeValue value = 1;
         if (operands.count() > 1) {
             fixmatheval::FmeExpression expression;
-            ok = expression.parse(operands.at(1), error);
+            ok = expression.parse(operands.at(1).toString(), error);
             if (ok) {
                 ok = expression.eval(value, symtab, error);
             }
             if (!ok) {
-                error = tr(".set or .equ %1 parse error.").arg(operands.at(1));
+                error = tr(".set or .equ %1 parse error.")
+                            .arg(operands.at(1).toString());
                 emit report_message(
                     messagetype::MSG_ERROR, filename, line_number, 0, error,
                     "");
@@ -463,12 +556,12 @@ bool SimpleAsm::process_line(
                 return false;
             }
         }
-        symtab->setSymbol(name, value, 0);
+        symtab->setSymbol(symbol_names.intern(name), value, 0);
         return true;
     }
-    if ((op == ".ASCII") || (op == ".ASCIZ")) {
-        bool append_zero = op == ".ASCIZ";
-        for (QString s : operands) {
+    if ((directive == Directive::ASCII) || (directive == Directive::ASCIZ)) {
+        bool append_zero = directive == Directive::ASCIZ;
+        for (QStringRef s : operands) {
             if (s.count() < 2) {
                 error = "ascii empty string";
                 emit report_message(
@@ -535,19 +628,19 @@ bool SimpleAsm::process_line(
         }
         return true;
     }
-    if (op == ".BYTE") {
+    if (directive == Directive::BYTE) {
         bool ok;
-        for (const QString &s : operands) {
+        for (const QStringRef &s : operands) {
             uint32_t val = 0;
             int chars_taken;
             val = string_to_uint64(s, 0, &chars_taken);
             if (chars_taken != s.size()) {
                 fixmatheval::FmeExpression expression;
                 fixmatheval::FmeValue value;
-                ok = expression.parse(s, error);
+                ok = expression.parse(s.toString(), error);
                 if (!ok) {
                     fatal_occured = true;
-                    error = tr(".byte %1 parse error.").arg(line);
+                    error = tr(".byte %1 parse error.").arg(line.toString());
                     emit report_message(
                         messagetype::MSG_ERROR, filename, line_number, 0, error,
                         "");
@@ -560,7 +653,8 @@ bool SimpleAsm::process_line(
                 ok = expression.eval(value, symtab, error);
                 if (!ok) {
                     fatal_occured = true;
-                    error = tr(".byte %1 evaluation error.").arg(line);
+                    error = tr(".byte %1 evaluation error.")
+                                .arg(line.toString());
                     emit report_message(
                         messagetype::MSG_ERROR, filename, line_number, 0, error,
                         "");
@@ -587,12 +681,12 @@ bool SimpleAsm::process_line(
         address += 1;
     }
 
-    if (op == ".WORD") {
-        for (QString s : operands) {
-            s = s.simplified();
+    if (directive == Directive::WORD) {
+        for (const QStringRef &operand : operands) {
+            QString s = operand.toString().simplified();
             uint32_t val = 0;
             int chars_taken;
-            val = string_to_uint64(s, 0, &chars_taken);
+            val = string_to_uint64(QStringRef(&s), 0, &chars_taken);
             if (chars_taken != s.size()) {
                 val = 0;
                 reloc.append(new machine::RelocExpression(
@@ -604,6 +698,7 @@ bool SimpleAsm::process_line(
             }
             address += 4;
         }
+        compile_relocations();
         return true;
     }
 
@@ -611,9 +706,11 @@ bool SimpleAsm::process_line(
     ssize_t size = machine::Instruction::code_from_string(
         inst, 8, op, operands, error, address, &reloc, filename, line_number,
         true);
+    compile_relocations();
 
     if (size < 0) {
-        error = tr("instruction %1 parse error - %2.").arg(line, error);
+        error = tr("instruction %1 parse error - %2.")
+                    .arg(line.toString(), error);
         emit report_message(
             messagetype::MSG_ERROR, filename, line_number, 0, error, "");
         error_occured = true;
@@ -645,28 +742,46 @@ bool SimpleAsm::process_file(const QString &filename, QString *error_ptr) {
         }
         return false;
     }
-    for (int ln = 1; !srcfile.atEnd(); ln++) {
-        QString line = srcfile.readLine();
-        if ((line.count() > 0) && (line.at(line.count() - 1) == '\n')) {
-            line.truncate(line.count() - 1);
+    // Whole source is decoded at once and lines are passed as references
+    // into it.
+    const QString text = QString::fromUtf8(srcfile.readAll());
+    srcfile.close();
+    int start = 0;
+    for (int ln = 1; start < text.size(); ln++) {
+        int end = text.indexOf('\n', start);
+        if (end < 0) {
+            end = text.size();
         }
-        if (!process_line(line, filename, ln, error_ptr)) {
+        if (!process_line(
+                text.midRef(start, end - start), filename, ln, error_ptr)) {
             res = false;
         }
+        start = end + 1;
     }
-    srcfile.close();
     return res;
 }
 
+void SimpleAsm::compile_relocations() {
+    for (int i = reloc_programs.size(); i < reloc.size(); i++) {
+        reloc_programs.append(fixmatheval::FmeProgram());
+        reloc_programs.last().compile(reloc.at(i)->expression, reloc_symbols);
+    }
+}
+
 bool SimpleAsm::finish(QString *error_ptr) {
     bool error_reported = false;
-    foreach (machine::RelocExpression *r, reloc) {
+    compile_relocations();
+    // Each symbol is looked up once, expressions then only read the slots.
+    reloc_symbols.resolve(symtab);
+    for (int i = 0; i < reloc.size(); i++) {
+        machine::RelocExpression *r = reloc.at(i);
+        const fixmatheval::FmeProgram &program = reloc_programs.at(i);
         QString error;
-        fixmatheval::FmeExpression expression;
-        if (!expression.parse(r->expression, error)) {
-            error
-                = tr("expression parse error %1 at line %2, expression %3.")
-                      .arg(error, QString::number(r->line), expression.dump());
+        if (!program.is_valid()) {
+            error = tr("expression parse error %1 at line %2, expression %3.")
+                        .arg(
+                            program.parse_error(), QString::number(r->line),
+                            r->expression);
             emit report_message(
                 messagetype::MSG_ERROR, r->filename, r->line, 0, error, "");
             if (error_ptr != nullptr && !error_reported) {
@@ -674,56 +789,45 @@ bool SimpleAsm::finish(QString *error_ptr) {
             }
             error_occured = true;
             error_reported = true;
-        } else {
-            fixmatheval::FmeValue value;
-            if (!expression.eval(value, symtab, error)) {
-                error = tr("expression evalution error %1 at line %2 , "
-                           "expression %3.")
-                            .arg(
-                                error, QString::number(r->line),
-                                expression.dump());
-                emit report_message(
-                    messagetype::MSG_ERROR, r->filename, r->line, 0, error, "");
-                if (error_ptr != nullptr && !error_reported) {
-                    *error_ptr = error;
-                }
-                error_occured = true;
-                error_reported = true;
-            } else {
-                if (false) {
-                    emit report_message(
-                        messagetype::MSG_INFO, r->filename, r->line, 0,
-                        expression.dump() + " -> " + QString::number(value),
-                        "");
-                }
-                machine::Instruction inst(
-                    mem->read_u32(r->location, ae::INTERNAL));
-                if (!inst.update(value, r)) {
-                    error = tr("instruction update error %1 at line %2, "
-                               "expression %3 -> value %4.")
-                                .arg(
-                                    error, QString::number(r->line),
-                                    expression.dump(), QString::number(value));
-                    emit report_message(
-                        messagetype::MSG_ERROR, r->filename, r->line, 0, error,
-                        "");
-                    if (error_ptr != nullptr && !error_reported) {
-                        *error_ptr = error;
-                    }
-                    error_occured = true;
-                    error_reported = true;
-                    // Remove address
-                }
-                if (!fatal_occured) {
-                    mem->write_u32(
-                        Address(r->location), inst.data(), ae::INTERNAL);
-                }
+            continue;
+        }
+        fixmatheval::FmeValue value;
+        if (!program.eval(value, reloc_symbols, error)) {
+            error = tr("expression evalution error %1 at line %2 , "
+                       "expression %3.")
+                        .arg(error, QString::number(r->line), r->expression);
+            emit report_message(
+                messagetype::MSG_ERROR, r->filename, r->line, 0, error, "");
+            if (error_ptr != nullptr && !error_reported) {
+                *error_ptr = error;
             }
+            error_occured = true;
+            error_reported = true;
+            continue;
+        }
+        machine::Instruction inst(mem->read_u32(r->location, ae::INTERNAL));
+        if (!inst.update(value, r)) {
+            error = tr("instruction update error %1 at line %2, "
+                       "expression %3 -> value %4.")
+                        .arg(
+                            error, QString::number(r->line), r->expression,
+                            QString::number(value));
+            emit report_message(
+                messagetype::MSG_ERROR, r->filename, r->line, 0, error, "");
+            if (error_ptr != nullptr && !error_reported) {
+                *error_ptr = error;
+            }
+            error_occured = true;
+            error_reported = true;
+        }
+        if (!fatal_occured) {
+            mem->write_u32(Address(r->location), inst.data(), ae::INTERNAL);
         }
     }
     while (!reloc.isEmpty()) {
         delete reloc.takeFirst();
     }
+    reloc_programs.clear();
 
     emit mem->external_change_notify(
         mem, Address::null(), Address(0xffffffff), ae::INTERNAL);
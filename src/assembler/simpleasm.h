@@ -6,8 +6,12 @@
 #include "machine/memory/frontend_memory.h"
 #include "messagetype.h"
 
+#include <QHash>
 #include <QString>
 #include <QStringList>
+#include <QStringRef>
+#include <QVector>
+#include <deque>
 
 using machine::SymbolInfo;
 using machine::SymbolOther;
@@ -29,6 +33,32 @@ private:
     machine::SymbolTable *symbol_table;
 };
 
+/**
+ * Unique copies of label and symbol names.
+ *
+ * Names are looked up by reference into the source line, so a name repeated
+ * in the source is allocated only once.
+ */
+class SymbolNamePool {
+public:
+    const QString &intern(const QStringRef &name);
+    void clear();
+
+private:
+    // Deque keeps stored strings in place, index keys reference them.
+    std::deque<QString> names;
+    QHash<QStringRef, const QString *> index;
+};
+
+/** Parts of a single source line, all of them reference the line text. */
+struct SourceLineTokens {
+    QStringRef label;
+    QStringRef op;
+    QVector<QStringRef> operands;
+    /** Start of the comment, -1 if the line has no comment. */
+    int comment_pos = -1;
+};
+
 class SimpleAsm : public QObject {
     Q_OBJECT
 
@@ -48,8 +78,27 @@ public:
     ~SimpleAsm() override;
 
 public:
-    static uint64_t
-    string_to_uint64(const QString &str, int base, int *chars_taken = nullptr);
+    static uint64_t string_to_uint64(
+        const QStringRef &str,
+        int base,
+        int *chars_taken = nullptr);
+    /**
+     * Split source line to label, operation and operands.
+     *
+     * The line is not assembled, so the function can be used by editor
+     * tools in any thread.
+     *
+     * @param error      description of malformed line
+     * @param error_pos  column of the error
+     * @return           false if the line is malformed
+     */
+    static bool tokenize_line(
+        const QStringRef &line,
+        SourceLineTokens &tokens,
+        QString &error,
+        int &error_pos);
+    /** Operation is a directive recognized by the assembler. */
+    static bool is_directive(const QStringRef &op);
     void clear();
     void setup(
         machine::FrontendMemory *mem,
@@ -60,9 +109,19 @@ public:
         const QString &filename = "",
         int line_number = 0,
         QString *error_ptr = nullptr);
+    /**
+     * Assemble line referenced in larger source text (no copy is made).
+     */
+    bool process_line(
+        const QStringRef &line,
+        const QString &filename = "",
+        int line_number = 0,
+        QString *error_ptr = nullptr);
     virtual bool
     process_file(const QString &filename, QString *error_ptr = nullptr);
     bool finish(QString *error_ptr = nullptr);
+    /** Address where the next line is placed. */
+    machine::Address current_address() const { return address; }
 
 protected:
     virtual bool process_pragma(
@@ -75,10 +134,18 @@ protected:
     SymbolTableDb *symtab {};
 
 private:
+    /** Compile expressions of relocations appended since the last call. */
+    void compile_relocations();
+
     QStringList include_stack;
     machine::FrontendMemory *mem {};
     machine::RelocExpressionList reloc;
+    /** Compiled `reloc` expressions (same indexes). */
+    QVector<fixmatheval::FmeProgram> reloc_programs;
+    fixmatheval::FmeSymbolSlots reloc_symbols;
     machine::Address address {};
+    SourceLineTokens line_tokens;
+    SymbolNamePool symbol_names;
 };
 
 #endif /*SIMPLEASM_H*/
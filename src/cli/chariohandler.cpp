@@ -1,5 +1,7 @@
 #include "chariohandler.h"
 
+#include <QFileDevice>
+
 CharIOHandler::CharIOHandler(QIODevice *iodev, QObject *parent)
     : QIODevice(parent)
     , fd_list() {
@@ -40,6 +42,15 @@ void CharIOHandler::writeByte(int fd, unsigned int data) {
         writeByte(data);
 }
 
+void CharIOHandler::writeBytes(const QByteArray &data) {
+    // Whole chunk is written at once and pushed out, so output of long
+    // running program shows up progressively.
+    write(data);
+    if (auto *file = qobject_cast<QFileDevice *>(iodev)) {
+        file->flush();
+    }
+}
+
 void CharIOHandler::readBytePoll(int fd, unsigned int &data, bool &available) {
     char ch;
     qint64 res;
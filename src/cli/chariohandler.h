@@ -17,6 +17,7 @@ public:
 public slots:
     void writeByte(unsigned int data);
     void writeByte(int fd, unsigned int data);
+    void writeBytes(const QByteArray &data);
     void readBytePoll(int fd, unsigned int &data, bool &available);
 
 public:
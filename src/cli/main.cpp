@@ -37,6 +37,51 @@ void create_parser(QCommandLineParser &p) {
     p.addOption({ "hazard-unit",
                   "Specify hazard unit imeplementation [none|stall|forward].",
                   "HUKIND" });
+    p.addOption({ "branch-predictor",
+                  "Branch predictor of pipelined core "
+                  "[not-taken|btfn|1bit|2bit|gshare].",
+                  "BPKIND" });
+    p.addOption({ "bp-table-bits",
+                  "Dynamic predictor table has 2^BITS counters (default 8).",
+                  "BITS" });
+    p.addOption({ "btb",
+                  "Number of branch target buffer entries (default 0, no "
+                  "taken prediction, out-of-order core mispredicts indirect "
+                  "jumps other than returns).",
+                  "N" });
+    p.addOption({ "ras", "Depth of return address stack (default 0).", "N" });
+    p.addOption({ "issue-width",
+                  "Simulate in-order core issuing up to N instructions per "
+                  "cycle.",
+                  "N" });
+    p.addOption({ "alu-ports",
+                  "ALU ports of multi-issue core (default one per slot).",
+                  "N" });
+    p.addOption({ "mul-ports",
+                  "Multiplier/FPU ports of multi-issue core (default 1).",
+                  "N" });
+    p.addOption(
+        { "mem-ports", "Memory ports of multi-issue core (default 1).", "N" });
+    p.addOption({ "ooo",
+                  "Simulate out-of-order core timing, execution ports are "
+                  "set by --alu-ports, --mul-ports and --mem-ports." });
+    p.addOption({ "ooo-width",
+                  "Dispatch, issue and commit width of out-of-order core "
+                  "(default 2,2,2). Implies --ooo.",
+                  "D,I,C" });
+    p.addOption({ "ooo-queues",
+                  "Entries of reorder buffer, issue queue and load/store "
+                  "queue (default 32,16,8). Implies --ooo.",
+                  "ROB,IQ,LSQ" });
+    p.addOption({ "ooo-latency",
+                  "Latency of ALU, multiplier, FPU and load in cycles "
+                  "(default 1,3,4,2). Implies --ooo.",
+                  "ALU,MUL,FPU,LOAD" });
+    p.addOption({ "mispredict-penalty",
+                  "Cycles from resolution of mispredicted branch to dispatch "
+                  "of its target in out-of-order core (default 2). Implies "
+                  "--ooo.",
+                  "N" });
     p.addOption(
         { { "trace-fetch", "tr-fetch" },
           "Trace fetched instruction (for both pipelined and not core)." });
@@ -58,6 +103,10 @@ void create_parser(QCommandLineParser &p) {
                   "Print general purpose register changes. You can use * for "
                   "all registers.",
                   "REG" });
+    p.addOption({ { "trace-fp", "tr-fp" },
+                  "Print floating-point register changes. You can use * for "
+                  "all registers.",
+                  "REG" });
     p.addOption({ { "trace-lo", "tr-lo" }, "Print LO register changes." });
     p.addOption({ { "trace-hi", "tr-hi" }, "Print HI register changes." });
     p.addOption({ { "dump-registers", "d-regs" },
@@ -97,6 +146,20 @@ void create_parser(QCommandLineParser &p) {
     p.addOption({ { "serial-out", "serout" },
                   "File connected to the serial port output.",
                   "FNAME" });
+    p.addOption({ "serial-char-time",
+                  "Serial port transmit time of one character (cycles).",
+                  "CTIME" });
+    p.addOption({ "serial-fifo",
+                  "Serial port TX and RX FIFO sizes in characters (default "
+                  "4096,64).",
+                  "TX,RX" });
+    p.addOption({ "harts",
+                  "Number of harts sharing memory, each with private caches.",
+                  "N" });
+    p.addOption({ "hart-quantum",
+                  "Run harts on separate host threads, synchronized every "
+                  "STEPS steps (default 0 is deterministic lockstep).",
+                  "STEPS" });
 }
 
 void configure_cache(
@@ -164,6 +227,65 @@ void configure_cache(
     }
 }
 
+/** Last value of the option as `count` comma separated numbers. */
+QList<unsigned> ooo_numbers(
+    const QStringList &values,
+    int count,
+    const char *which,
+    const char *correct) {
+    QList<unsigned> numbers;
+    for (const QString &piece : values.at(values.size() - 1).split(",")) {
+        bool ok = false;
+        numbers.append(piece.toUInt(&ok));
+        if (!ok) {
+            break;
+        }
+    }
+    if (numbers.size() != count) {
+        std::cerr << "Parameters for out-of-order " << which
+                  << " incorrect (correct " << correct << ")." << std::endl;
+        exit(1);
+    }
+    return numbers;
+}
+
+void configure_out_of_order(OutOfOrderConfig &ooo, QCommandLineParser &p) {
+    if (p.isSet("ooo")) {
+        ooo.set_enabled(true);
+    }
+    if (p.isSet("ooo-width")) {
+        QList<unsigned> n
+            = ooo_numbers(p.values("ooo-width"), 3, "width", "2,2,2");
+        ooo.set_enabled(true);
+        ooo.set_dispatch_width(n.at(0));
+        ooo.set_issue_width(n.at(1));
+        ooo.set_commit_width(n.at(2));
+    }
+    if (p.isSet("ooo-queues")) {
+        QList<unsigned> n
+            = ooo_numbers(p.values("ooo-queues"), 3, "queues", "32,16,8");
+        ooo.set_enabled(true);
+        ooo.set_rob_size(n.at(0));
+        ooo.set_iq_size(n.at(1));
+        ooo.set_lsq_size(n.at(2));
+    }
+    if (p.isSet("ooo-latency")) {
+        QList<unsigned> n
+            = ooo_numbers(p.values("ooo-latency"), 4, "latency", "1,3,4,2");
+        ooo.set_enabled(true);
+        ooo.set_alu_latency(n.at(0));
+        ooo.set_mul_latency(n.at(1));
+        ooo.set_fpu_latency(n.at(2));
+        ooo.set_load_latency(n.at(3));
+    }
+    int siz = p.values("mispredict-penalty").size();
+    if (siz >= 1) {
+        ooo.set_enabled(true);
+        ooo.set_mispredict_penalty(
+            p.values("mispredict-penalty").at(siz - 1).toLong());
+    }
+}
+
 void configure_machine(QCommandLineParser &p, MachineConfig &cc) {
     QStringList pa = p.positionalArguments();
     int siz;
@@ -185,6 +307,46 @@ void configure_machine(QCommandLineParser &p, MachineConfig &cc) {
         }
     }
 
+    BranchPredictorConfig *bpc = cc.access_branch_predictor();
+    siz = p.values("branch-predictor").size();
+    if (siz >= 1) {
+        QString bpkind = p.values("branch-predictor").at(siz - 1).toLower();
+        if (!bpc->set_predictor(bpkind)) {
+            std::cerr << "Unknown kind of branch predictor specified"
+                      << std::endl;
+            exit(1);
+        }
+    }
+    siz = p.values("bp-table-bits").size();
+    if (siz >= 1) {
+        bpc->set_table_bits(p.values("bp-table-bits").at(siz - 1).toLong());
+    }
+    siz = p.values("btb").size();
+    if (siz >= 1) {
+        bpc->set_btb_entries(p.values("btb").at(siz - 1).toLong());
+    }
+    siz = p.values("ras").size();
+    if (siz >= 1) {
+        bpc->set_ras_entries(p.values("ras").at(siz - 1).toLong());
+    }
+
+    siz = p.values("issue-width").size();
+    if (siz >= 1) {
+        cc.set_issue_width(p.values("issue-width").at(siz - 1).toLong());
+    }
+    siz = p.values("alu-ports").size();
+    if (siz >= 1) {
+        cc.set_issue_alu_ports(p.values("alu-ports").at(siz - 1).toLong());
+    }
+    siz = p.values("mul-ports").size();
+    if (siz >= 1) {
+        cc.set_issue_mul_ports(p.values("mul-ports").at(siz - 1).toLong());
+    }
+    siz = p.values("mem-ports").size();
+    if (siz >= 1) {
+        cc.set_issue_mem_ports(p.values("mem-ports").at(siz - 1).toLong());
+    }
+
     siz = p.values("read-time").size();
     if (siz >= 1) {
         cc.set_memory_access_time_read(
@@ -200,7 +362,33 @@ void configure_machine(QCommandLineParser &p, MachineConfig &cc) {
         cc.set_memory_access_time_burst(
             p.values("burst-time").at(siz - 1).toLong());
     }
+    siz = p.values("serial-char-time").size();
+    if (siz >= 1) {
+        cc.set_serial_cycles_per_char(
+            p.values("serial-char-time").at(siz - 1).toLong());
+    }
+    siz = p.values("serial-fifo").size();
+    if (siz >= 1) {
+        QStringList sizes = p.values("serial-fifo").at(siz - 1).split(",");
+        if (sizes.size() != 2) {
+            std::cerr << "Serial port FIFO sizes incorrect (correct 4096,64)."
+                      << std::endl;
+            exit(1);
+        }
+        cc.set_serial_tx_fifo_size(sizes.at(0).toLong());
+        cc.set_serial_rx_fifo_size(sizes.at(1).toLong());
+    }
+
+    siz = p.values("harts").size();
+    if (siz >= 1) {
+        cc.set_hart_count(p.values("harts").at(siz - 1).toLong());
+    }
+    siz = p.values("hart-quantum").size();
+    if (siz >= 1) {
+        cc.set_hart_quantum(p.values("hart-quantum").at(siz - 1).toLong());
+    }
 
+    configure_out_of_order(*cc.access_out_of_order(), p);
     configure_cache(*cc.access_cache_data(), p.values("d-cache"), "data");
     configure_cache(
         *cc.access_cache_program(), p.values("i-cache"), "instruction");
@@ -248,6 +436,25 @@ void configure_tracer(QCommandLineParser &p, Tracer &tr) {
         }
     }
 
+    QStringList fps = p.values("trace-fp");
+    for (int i = 0; i < fps.size(); i++) {
+        if (fps[i] == "*") {
+            for (int y = 0; y < 32; y++) {
+                tr.reg_fp(y);
+            }
+        } else {
+            bool res;
+            int num = fps[i].toInt(&res);
+            if (res && num >= 0 && num < 32) {
+                tr.reg_fp(num);
+            } else {
+                cout << "Unknown register number given for trace-fp: "
+                     << fps[i].toStdString() << endl;
+                exit(1);
+            }
+        }
+    }
+
     if (p.isSet("trace-lo")) {
         tr.reg_lo();
     }
@@ -388,8 +595,8 @@ void configure_serial_port(QCommandLineParser &p, SerialPort *ser_port) {
 
     if (ser_out) {
         QObject::connect(
-            ser_port, &SerialPort::tx_byte, ser_out,
-            QOverload<unsigned>::of(&CharIOHandler::writeByte));
+            ser_port, &SerialPort::tx_bytes, ser_out,
+            &CharIOHandler::writeBytes);
     }
 }
 
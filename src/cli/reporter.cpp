@@ -126,6 +126,111 @@ static void out_hex(ostream &out, uint64_t val, int digits) {
     out.flags(saveflg);
 }
 
+/** Hart 0 statistics keep their names, other harts are prefixed. */
+static string hart_prefix(unsigned hart) {
+    return hart == 0 ? string() : "hart" + to_string(hart) + ":";
+}
+
+static void report_cache(const string &name, const Cache *cache, bool data) {
+    cout << name << ":reads:" << cache->get_read_count() << endl;
+    if (data) {
+        cout << name << ":writes:" << cache->get_write_count() << endl;
+    }
+    cout << name << ":hit:" << cache->get_hit_count() << endl;
+    cout << name << ":miss:" << cache->get_miss_count() << endl;
+    cout << name << ":hit-rate:" << cache->get_hit_rate() << endl;
+    cout << name << ":stalled-cycles:" << cache->get_stall_count() << endl;
+    cout << name << ":improved-speed:" << cache->get_speed_improvement()
+         << endl;
+}
+
+// Code density, fetch buffer hits are i-cache reads saved.
+static void report_fetch(const string &prefix, const FetchStats &fetch) {
+    cout << prefix << "fetch:instructions:" << fetch.instructions << endl;
+    cout << prefix << "fetch:compressed:" << fetch.compressed << endl;
+    cout << prefix << "fetch:bytes:"
+         << fetch.instructions * 4 - fetch.compressed * 2 << endl;
+    cout << prefix << "fetch:bytes-saved:" << fetch.compressed * 2 << endl;
+    cout << prefix << "fetch:mem-reads:" << fetch.mem_reads << endl;
+    cout << prefix << "fetch:buffer-hits:" << fetch.buffer_hits << endl;
+}
+
+// Prediction accuracy over all resolved control transfers.
+static void report_branch(const string &prefix, const BranchStats &branch) {
+    const uint32_t transfers = branch.branches + branch.jumps;
+    const uint32_t mispredicted
+        = branch.branches_mispredicted + branch.jumps_mispredicted;
+    cout << prefix << "branch:branches:" << branch.branches << endl;
+    cout << prefix << "branch:branches-mispredicted:"
+         << branch.branches_mispredicted << endl;
+    cout << prefix << "branch:jumps:" << branch.jumps << endl;
+    cout << prefix << "branch:jumps-mispredicted:" << branch.jumps_mispredicted
+         << endl;
+    cout << prefix << "branch:accuracy:"
+         << (transfers ? 100.0 * (transfers - mispredicted) / transfers : 100.0)
+         << endl;
+    cout << prefix << "branch:penalty-cycles:" << branch.penalty_cycles
+         << endl;
+}
+
+// Use of issue slots of multi-issue core, empty slots by the reason.
+static void report_issue(const string &prefix, const IssueStats &issue) {
+    static const char *const limit_names[IL_COUNT] = {
+        "dependency", "output",  "alu-port", "mul-port",
+        "mem-port",   "load-use", "control",  "serialize"
+    };
+    for (size_t slot = 0; slot < issue.slot_issued.size(); slot++) {
+        cout << prefix << "issue:slot" << slot << ":" << issue.slot_issued[slot]
+             << endl;
+    }
+    for (int i = 0; i < IL_COUNT; i++) {
+        cout << prefix << "issue:empty:" << limit_names[i] << ":"
+             << issue.empty_slots[i] << endl;
+    }
+    for (int i = 0; i < IL_COUNT; i++) {
+        cout << prefix << "issue:bubbles:" << limit_names[i] << ":"
+             << issue.bubble_cycles[i] << endl;
+    }
+}
+
+// Occupancy histogram as average and cycles spent with each used entries.
+static void report_occupancy(
+    const string &name,
+    const vector<uint32_t> &occupancy) {
+    uint64_t cycles = 0, sum = 0;
+    for (size_t used = 0; used < occupancy.size(); used++) {
+        cycles += occupancy[used];
+        sum += used * occupancy[used];
+    }
+    cout << name << ":average:" << (cycles ? double(sum) / cycles : 0.0)
+         << endl;
+    for (size_t used = 0; used < occupancy.size(); used++) {
+        if (occupancy[used] != 0) {
+            cout << name << ":" << used << ":" << occupancy[used] << endl;
+        }
+    }
+}
+
+// Stall breakdown and queue occupancy of out-of-order core.
+static void report_ooo(const string &prefix, const OutOfOrderStats &ooo) {
+    static const char *const dispatch_names[DS_COUNT]
+        = { "rob-full", "iq-full", "lsq-full", "mispredict", "serialize" };
+    static const char *const commit_names[CS_COUNT]
+        = { "empty", "waiting", "executing" };
+    for (int i = 0; i < DS_COUNT; i++) {
+        cout << prefix << "ooo:dispatch-stall:" << dispatch_names[i] << ":"
+             << ooo.dispatch_stalls[i] << endl;
+    }
+    for (int i = 0; i < CS_COUNT; i++) {
+        cout << prefix << "ooo:commit-stall:" << commit_names[i] << ":"
+             << ooo.commit_stalls[i] << endl;
+    }
+    cout << prefix << "ooo:mispredictions:" << ooo.mispredictions << endl;
+    report_occupancy(prefix + "ooo:rob", ooo.rob_occupancy);
+    report_occupancy(prefix + "ooo:iq", ooo.iq_occupancy);
+    report_occupancy(prefix + "ooo:lsq", ooo.lsq_occupancy);
+}
+
 void Reporter::report() {
     cout << dec;
     if (e_regs) {
@@ -135,13 +240,25 @@ void Reporter::report() {
         cout << endl;
         for (int i = 0; i < 32; i++) {
             cout << "R" << i << ":0x";
-            out_hex(cout, machine->registers()->read_gp(i).as_u64(), 8);
+            out_hex(cout, machine->registers()->peek_gp(i).as_u64(), 8);
             if (i != 31) {
                 cout << " ";
             } else {
                 cout << endl;
             }
         }
+        for (int i = 0; i < 32; i++) {
+            cout << "F" << i << ":0x";
+            out_hex(cout, machine->registers()->peek_fp(i).as_u64(), 16);
+            if (i != 31) {
+                cout << " ";
+            } else {
+                cout << endl;
+            }
+        }
+        cout << "FCSR:0x";
+        out_hex(cout, machine->registers()->read_fcsr(), 2);
+        cout << endl;
         cout << "HI:0x";
         out_hex(cout, machine->registers()->read_hi_lo(true).as_u64(), 8);
         cout << " LO:0x";
@@ -165,32 +282,24 @@ void Reporter::report() {
     }
     if (e_cache_stats) {
         cout << "Cache statistics report:" << endl;
-        cout << "i-cache:reads:" << machine->cache_program()->get_read_count()
-             << endl;
-        cout << "i-cache:hit:" << machine->cache_program()->get_hit_count()
-             << endl;
-        cout << "i-cache:miss:" << machine->cache_program()->get_miss_count()
-             << endl;
-        cout << "i-cache:hit-rate:" << machine->cache_program()->get_hit_rate()
-             << endl;
-        cout << "i-cache:stalled-cycles:"
-             << machine->cache_program()->get_stall_count() << endl;
-        cout << "i-cache:improved-speed:"
-             << machine->cache_program()->get_speed_improvement() << endl;
-        cout << "d-cache:reads:" << machine->cache_data()->get_read_count()
-             << endl;
-        cout << "d-cache:writes:" << machine->cache_data()->get_write_count()
-             << endl;
-        cout << "d-cache:hit:" << machine->cache_data()->get_hit_count()
-             << endl;
-        cout << "d-cache:miss:" << machine->cache_data()->get_miss_count()
-             << endl;
-        cout << "d-cache:hit-rate:" << machine->cache_data()->get_hit_rate()
-             << endl;
-        cout << "d-cache:stalled-cycles:"
-             << machine->cache_data()->get_stall_count() << endl;
-        cout << "d-cache:improved-speed:"
-             << machine->cache_data()->get_speed_improvement() << endl;
+        for (unsigned hart = 0; hart < machine->hart_count(); hart++) {
+            const string prefix = hart_prefix(hart);
+            report_cache(
+                prefix + "i-cache", machine->hart_cache_program(hart), false);
+            report_cache(
+                prefix + "d-cache", machine->hart_cache_data(hart), true);
+            report_fetch(prefix, machine->hart_core(hart)->get_fetch_stats());
+        }
+        if (machine->coherence_bus() != nullptr) {
+            const CoherenceStats &coh = machine->coherence_bus()->get_stats();
+            cout << "coherence:bus-reads:" << coh.bus_reads << endl;
+            cout << "coherence:bus-read-exclusives:" << coh.bus_read_exclusives
+                 << endl;
+            cout << "coherence:upgrades:" << coh.upgrades << endl;
+            cout << "coherence:bus-writes:" << coh.bus_writes << endl;
+            cout << "coherence:invalidations:" << coh.invalidations << endl;
+            cout << "coherence:interventions:" << coh.interventions << endl;
+        }
     }
     if (e_cycles) {
         cout << "d-cache:stalled-cycles:"
@@ -199,8 +308,31 @@ void Reporter::report() {
              << machine->cache_data()->get_speed_improvement() << endl;
     }
     if (e_cycles) {
-        cout << "cycles:" << machine->core()->get_cycle_count() << endl;
-        cout << "stalls:" << machine->core()->get_stall_count() << endl;
+        for (unsigned hart = 0; hart < machine->hart_count(); hart++) {
+            const string prefix = hart_prefix(hart);
+            const Core *core = machine->hart_core(hart);
+            cout << prefix << "cycles:" << core->get_cycle_count() << endl;
+            cout << prefix << "stalls:" << core->get_stall_count() << endl;
+            cout << prefix << "instructions:" << core->get_instruction_count()
+                 << endl;
+            cout << prefix << "ipc:"
+                 << (core->get_cycle_count()
+                         ? double(core->get_instruction_count())
+                               / core->get_cycle_count()
+                         : 0.0)
+                 << endl;
+            if (dynamic_cast<const CorePipelined *>(core) != nullptr) {
+                report_branch(prefix, core->get_branch_stats());
+            }
+            auto *superscalar = dynamic_cast<const CoreSuperscalar *>(core);
+            if (superscalar != nullptr) {
+                report_issue(prefix, superscalar->get_issue_stats());
+            }
+            auto *out_of_order = dynamic_cast<const CoreOutOfOrder *>(core);
+            if (out_of_order != nullptr) {
+                report_ooo(prefix, out_of_order->get_ooo_stats());
+            }
+        }
     }
     foreach (DumpRange range, dump_ranges) {
         ofstream out;
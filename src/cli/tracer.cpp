@@ -8,6 +8,7 @@ using namespace machine;
 
 Tracer::Tracer(Machine *machine) {
     this->machine = machine;
+    xlen_64 = machine->config().get_simulated_xlen() == Xlen::_64;
     for (bool &gp_reg : gp_regs) {
         gp_reg = false;
     }
@@ -58,11 +59,17 @@ void Tracer::reg_pc() {
 }
 
 void Tracer::reg_gp(RegisterId i) {
-    CON(con_regs_gp, machine->registers(), &Registers::gp_update,
-        &Tracer::regs_gp_update);
+    CON(con_regs_gp, machine->registers(), &Registers::step_changes,
+        &Tracer::regs_gp_changes);
     gp_regs[i.data] = true;
 }
 
+void Tracer::reg_fp(RegisterId i) {
+    CON(con_regs_fp, machine->registers(), &Registers::step_changes,
+        &Tracer::regs_fp_changes);
+    fp_regs[i.data] = true;
+}
+
 void Tracer::reg_lo() {
     CON(con_regs_hi_lo, machine->registers(), &Registers::hi_lo_update,
         &Tracer::regs_hi_lo_update);
@@ -124,17 +131,32 @@ void Tracer::regs_pc_update(Address val) {
     cout << "PC:" << hex << val.get_raw() << endl;
 }
 
-void Tracer::regs_gp_update(RegisterId i, RegisterValue val) {
-    if (gp_regs[i.data]) {
-        cout << "GP" << dec << (unsigned)i.data << ":" << hex << val.as_u32()
-             << endl;
+void Tracer::regs_gp_changes(const RegisterJournal &changes) {
+    for (const RegisterChange &change : changes.writes) {
+        if (gp_regs[change.reg.data]) {
+            cout << "GP" << dec << (unsigned)change.reg.data << ":" << hex
+                 << xlen_value(change.new_value) << endl;
+        }
     }
 }
 
+void Tracer::regs_fp_changes(const RegisterJournal &changes) {
+    for (const RegisterChange &change : changes.fp_writes) {
+        if (fp_regs[change.reg.data]) {
+            cout << "FP" << dec << (unsigned)change.reg.data << ":" << hex
+                 << change.new_value.as_u64() << endl;
+        }
+    }
+}
+
+uint64_t Tracer::xlen_value(RegisterValue val) const {
+    return xlen_64 ? val.as_u64() : val.as_u32();
+}
+
 void Tracer::regs_hi_lo_update(bool hi, RegisterValue val) const {
     if (hi && r_hi) {
-        cout << "HI:" << hex << val.as_u32() << endl;
+        cout << "HI:" << hex << xlen_value(val) << endl;
     } else if (!hi && r_lo) {
-        cout << "LO:" << hex << val.as_u32() << endl;
+        cout << "LO:" << hex << xlen_value(val) << endl;
     }
 }
@@ -21,6 +21,7 @@ public:
     // Trace registers
     void reg_pc();
     void reg_gp(machine::RegisterId i);
+    void reg_fp(machine::RegisterId i);
     void reg_lo();
     void reg_hi();
 
@@ -52,17 +53,24 @@ private slots:
         bool valid);
 
     void regs_pc_update(machine::Address val);
-    void regs_gp_update(machine::RegisterId i, machine::RegisterValue val);
+    void regs_gp_changes(const machine::RegisterJournal &changes);
+    void regs_fp_changes(const machine::RegisterJournal &changes);
     void regs_hi_lo_update(bool hi, machine::RegisterValue val) const;
 
 private:
+    /** Register value of the simulated XLEN width. */
+    uint64_t xlen_value(machine::RegisterValue val) const;
+
     machine::Machine *machine;
+    bool xlen_64;
 
     bool gp_regs[32] {};
+    bool fp_regs[32] {};
     bool r_hi, r_lo;
 
     bool con_fetch {}, con_decode {}, con_execute {}, con_memory {},
-        con_writeback {}, con_regs_pc, con_regs_gp, con_regs_hi_lo;
+        con_writeback {}, con_regs_pc, con_regs_gp, con_regs_fp {},
+        con_regs_hi_lo;
 };
 
 #endif // TRACER_H
@@ -0,0 +1,83 @@
+/**
+ * Lock-free single producer / single consumer triple buffer.
+ *
+ * Producer always has a private buffer to fill, consumer always has a private
+ * buffer to read and the third one is handed over between them by an atomic
+ * exchange. Neither side ever waits for the other one. When the producer is
+ * faster, intermediate values are silently replaced (only the latest published
+ * value is ever seen by the consumer).
+ *
+ * Example:
+ * ```
+ *  // producer thread           // consumer thread
+ *  buf.write_buffer() = value;   if (buf.update()) {
+ *  buf.publish();                    use(buf.read_buffer());
+ *                                }
+ * ```
+ *
+ * @file
+ */
+#ifndef QTRVSIM_TRIPLE_BUFFER_H
+#define QTRVSIM_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+template<typename T>
+class TripleBuffer {
+public:
+    /** Buffer owned by the producer. Content is stale, overwrite it. */
+    T &write_buffer() { return buffers[back]; }
+
+    /** Hand the write buffer over to the consumer. */
+    void publish() {
+        uint8_t prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = prev & INDEX_MASK;
+    }
+
+    /**
+     * Producer side check whether the last published value was already taken
+     * by the consumer. When it was not, next publish will replace it.
+     */
+    bool consumed() const {
+        return (middle.load(std::memory_order_acquire) & FRESH) == 0;
+    }
+
+    /**
+     * Take the latest published value (if any) as the read buffer.
+     *
+     * @return  true when read buffer changed
+     */
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX_MASK;
+        return true;
+    }
+
+    /** Buffer owned by the consumer. Valid after first successful update. */
+    const T &read_buffer() const { return buffers[front]; }
+
+    /**
+     * Drop any published value. Must not race with producer nor consumer.
+     */
+    void reset() {
+        back = 0;
+        middle.store(1, std::memory_order_relaxed);
+        front = 2;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> buffers {};
+    uint8_t back = 0;
+    std::atomic<uint8_t> middle { 1 };
+    uint8_t front = 2;
+};
+
+#endif // QTRVSIM_TRIPLE_BUFFER_H
@@ -0,0 +1,117 @@
+#include "asmlexer.h"
+
+#include "assembler/simpleasm.h"
+#include "machine/instruction.h"
+
+#include <QStringList>
+#include <QtAlgorithms>
+
+AsmLexer::AsmLexer() {
+    QStringList reg_list;
+    machine::Instruction::append_recognized_registers(reg_list);
+    for (const QString &name : reg_list) {
+        registers.insert(name);
+    }
+    reg_list.clear();
+    machine::Instruction::append_recognized_fp_registers(reg_list);
+    for (const QString &name : reg_list) {
+        fp_registers.insert(name);
+    }
+}
+
+bool AsmLexer::is_register(const QStringRef &word) const {
+    if ((word.size() >= 2) && (word.at(0) == 'f')) {
+        bool ok;
+        uint number = word.mid(1).toUInt(&ok, 10);
+        if (ok) {
+            return number < 32;
+        }
+        return fp_registers.contains(word.toString());
+    }
+    if ((word.size() < 2) || ((word.at(0) != 'x') && (word.at(0) != '$'))) {
+        return false;
+    }
+    const QStringRef name = word.mid(1);
+    bool ok;
+    uint number = name.toUInt(&ok, 10);
+    if (ok) {
+        return number < 32;
+    }
+    return registers.contains(name.toString());
+}
+
+AsmLineInfo AsmLexer::lex(const QString &line) const {
+    AsmLineInfo info;
+    SourceLineTokens tokens;
+    QString error;
+    int error_pos = 0;
+
+    if (!SimpleAsm::tokenize_line(
+            QStringRef(&line), tokens, error, error_pos)) {
+        int start = qMax(0, qMin(error_pos, line.size() - 1));
+        info.spans.append({ start, line.size() - start, AsmSpan::ERROR });
+        info.error = error;
+        return info;
+    }
+    if (tokens.comment_pos >= 0) {
+        info.spans.append({ tokens.comment_pos,
+                            line.size() - tokens.comment_pos,
+                            AsmSpan::COMMENT });
+    }
+    if (tokens.op.isEmpty()) {
+        return info;
+    }
+
+    const QStringRef &op = tokens.op;
+    if (!SimpleAsm::is_directive(op)) {
+        uint32_t code[2];
+        machine::RelocExpressionList reloc;
+        ssize_t size = machine::Instruction::code_from_string(
+            code, sizeof(code), op, tokens.operands, error,
+            machine::Address::null(), &reloc, "", 0, true, true);
+        qDeleteAll(reloc);
+        if (size < 0) {
+            const QStringRef last = tokens.operands.isEmpty()
+                                        ? op
+                                        : tokens.operands.last();
+            int end = last.position() + last.size();
+            info.spans.append(
+                { op.position(), end - op.position(), AsmSpan::ERROR });
+            info.error = error;
+        }
+    }
+    info.spans.append({ op.position(), op.size(), AsmSpan::KEYWORD });
+
+    for (const QStringRef &operand : tokens.operands) {
+        if (operand.startsWith('"')) {
+            info.spans.append(
+                { operand.position(), operand.size(), AsmSpan::STRING });
+            continue;
+        }
+        // Registers are found also inside of expressions like 4(x2).
+        int word_beg = -1;
+        for (int i = 0; i <= operand.size(); i++) {
+            bool word_char = (i < operand.size())
+                             && (operand.at(i).isLetterOrNumber()
+                                 || (operand.at(i) == '_')
+                                 || (operand.at(i) == '$'));
+            if (word_char && (word_beg < 0)) {
+                word_beg = i;
+            } else if (!word_char && (word_beg >= 0)) {
+                if (is_register(operand.mid(word_beg, i - word_beg))) {
+                    info.spans.append({ operand.position() + word_beg,
+                                        i - word_beg, AsmSpan::REGISTER });
+                }
+                word_beg = -1;
+            }
+        }
+    }
+    return info;
+}
+
+void AsmLexerWorker::lex_line(
+    int block_number,
+    int revision,
+    const QString &text) {
+    emit line_lexed(block_number, revision, text, lexer.lex(text));
+}
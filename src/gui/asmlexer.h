@@ -0,0 +1,72 @@
+#ifndef ASMLEXER_H
+#define ASMLEXER_H
+
+#include <QMetaType>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/** Highlighted part of a source line. */
+struct AsmSpan {
+    enum Kind { KEYWORD, REGISTER, STRING, COMMENT, ERROR };
+
+    int start;
+    int length;
+    Kind kind;
+};
+
+/** Lexer result for a single source line. */
+struct AsmLineInfo {
+    QVector<AsmSpan> spans;
+    /** Assembler diagnostic, empty if the line is correct. */
+    QString error;
+};
+
+Q_DECLARE_METATYPE(AsmLineInfo)
+
+/**
+ * Lexer of assembler source lines.
+ *
+ * Lines are split by the assembler tokenizer and instructions are checked
+ * by the instruction parser, so the editor reports the same errors as the
+ * compilation. Lexer does not touch any document and can be used from any
+ * thread.
+ */
+class AsmLexer {
+public:
+    AsmLexer();
+    AsmLineInfo lex(const QString &line) const;
+
+private:
+    bool is_register(const QStringRef &word) const;
+
+    QSet<QString> registers;
+    QSet<QString> fp_registers;
+};
+
+/**
+ * Lexer running in a worker thread.
+ *
+ * Requests are processed in order, results are sent back with the block
+ * identification, so the receiver can drop results of already edited
+ * lines.
+ */
+class AsmLexerWorker : public QObject {
+    Q_OBJECT
+
+public slots:
+    void lex_line(int block_number, int revision, const QString &text);
+
+signals:
+    void line_lexed(
+        int block_number,
+        int revision,
+        const QString &text,
+        const AsmLineInfo &info);
+
+private:
+    AsmLexer lexer;
+};
+
+#endif // ASMLEXER_H
@@ -46,6 +46,7 @@ Cop0Dock::~Cop0Dock() {
 }
 
 void Cop0Dock::setup(machine::Machine *machine) {
+    this->machine = machine;
     if (machine == nullptr) {
         // Reset data
         for (int i = 1; i < machine::Cop0State::COP0REGS_CNT; i++) {
@@ -70,6 +71,12 @@ void Cop0Dock::setup(machine::Machine *machine) {
         &Cop0Dock::cop0reg_read);
     connect(
         machine, &machine::Machine::tick, this, &Cop0Dock::clear_highlights);
+    // Count changes every cycle without notification.
+    connect(
+        machine, &machine::Machine::post_tick, this, &Cop0Dock::count_update);
+    connect(
+        machine, &machine::Machine::snapshot_update, this,
+        &Cop0Dock::snapshot_update);
 }
 
 void Cop0Dock::cop0reg_changed(
@@ -113,7 +120,42 @@ void Cop0Dock::clear_highlights() {
     cop0reg_highlighted_any = false;
 }
 
+void Cop0Dock::count_update() {
+    // Live state is owned by simulation thread, snapshot is used instead.
+    if (machine == nullptr || machine->background_running()) {
+        return;
+    }
+    enum machine::Cop0State::Cop0Registers reg = machine::Cop0State::Count;
+    if (labelValChanged(
+            cop0reg[reg], machine->cop0state()->peek_cop0reg(reg))) {
+        cop0reg[reg]->setPalette(pal_updated);
+        cop0reg_highlighted[reg] = true;
+        cop0reg_highlighted_any = true;
+    }
+}
+
+void Cop0Dock::snapshot_update(const machine::MachineSnapshot &snapshot) {
+    // Cop0 signals are blocked during background run, highlight registers
+    // changed since the previous snapshot instead.
+    for (int i = 1; i < machine::Cop0State::COP0REGS_CNT; i++) {
+        if (labelValChanged(cop0reg[i], snapshot.cop0[i])) {
+            cop0reg[i]->setPalette(pal_updated);
+            cop0reg_highlighted[i] = true;
+            cop0reg_highlighted_any = true;
+        }
+    }
+}
+
 void Cop0Dock::labelVal(QLabel *label, uint32_t value) {
     QString t = QString("0x") + QString::number(value, 16);
     label->setText(t);
 }
+
+bool Cop0Dock::labelValChanged(QLabel *label, uint32_t value) {
+    QString t = QString("0x") + QString::number(value, 16);
+    if (label->text() == t) {
+        return false;
+    }
+    label->setText(t);
+    return true;
+}
@@ -24,8 +24,11 @@ private slots:
     cop0reg_changed(enum machine::Cop0State::Cop0Registers reg, uint32_t val);
     void cop0reg_read(enum machine::Cop0State::Cop0Registers reg, uint32_t val);
     void clear_highlights();
+    void count_update();
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 private:
+    machine::Machine *machine {};
     StaticTable *widg;
     QScrollArea *scrollarea;
 
@@ -38,6 +41,7 @@ private:
     QPalette pal_read;
 
     void labelVal(QLabel *label, uint32_t val);
+    bool labelValChanged(QLabel *label, uint32_t val);
 };
 
 #endif // COP0DOCK_H
@@ -7,6 +7,9 @@ BoolValue::BoolValue(SimpleTextItem *const element, const bool &data)
     , data(data) {}
 
 void BoolValue::update() {
+    if (!rendered.changed(data)) {
+        return;
+    }
     element->setText(data ? "1" : "0");
 }
 
@@ -17,13 +20,17 @@ PCValue::PCValue(SimpleTextItem *element, const machine::Address &data)
 PCValue::PCValue(const PCValue &other)
     : QObject(other.parent())
     , element(other.element)
-    , data(other.data) {}
+    , data(other.data)
+    , rendered(other.rendered) {}
 
 void PCValue::clicked() {
     emit jump_to_pc(data);
 }
 
 void PCValue::update() {
+    if (!rendered.changed(data)) {
+        return;
+    }
     element->setText(
         QString("0x%1").arg(data.get_raw(), 8, 16, QChar('0')).toUpper());
 }
@@ -33,6 +40,9 @@ RegValue::RegValue(SimpleTextItem *element, const machine::RegisterValue &data)
     , data(data) {}
 
 void RegValue::update() {
+    if (!rendered.changed(data.as_u32())) {
+        return;
+    }
     element->setText(
         QString("%1").arg(data.as_u32(), 8, 16, QChar('0')).toUpper());
 }
@@ -42,6 +52,9 @@ RegIdValue::RegIdValue(svgscene::SimpleTextItem *element, const uint8_t &data)
     , data(data) {}
 
 void RegIdValue::update() {
+    if (!rendered.changed(data)) {
+        return;
+    }
     element->setText(QString("%1").arg(data, 2, 10, QChar('0')));
 }
 
@@ -50,14 +63,21 @@ DebugValue::DebugValue(SimpleTextItem *element, const unsigned int &data)
     , data(data) {}
 
 void DebugValue::update() {
+    if (!rendered.changed(data)) {
+        return;
+    }
     element->setText(QString("%1").arg(data, 0, 10, QChar(' ')));
 }
+
 MultiTextValue::MultiTextValue(SimpleTextItem *const element, Data data)
     : element(element)
     , current_text_index(data.first)
     , text_table(data.second) {}
 
 void MultiTextValue::update() {
+    if (!rendered.changed(current_text_index)) {
+        return;
+    }
     element->setText(text_table.at(current_text_index));
 }
 
@@ -67,5 +87,8 @@ InstructionValue::InstructionValue(SimpleTextItem *const element, Data data)
     , address_data(data.second) {}
 
 void InstructionValue::update() {
+    if (!rendered.changed({ instruction_data.data(), address_data })) {
+        return;
+    }
     element->setText(instruction_data.to_str(address_data));
 }
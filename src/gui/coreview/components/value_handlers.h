@@ -15,6 +15,31 @@
 #include <machine/registers.h>
 #include <svgscene/components/simpletextitem.h>
 #include <svgscene/utils/memory_ownership.h>
+#include <utility>
+
+/**
+ * Last value rendered into a text element.
+ *
+ * Formatting and setting text is the main cost of core view refresh, while
+ * most of the values do not change between refreshes.
+ */
+template<typename T>
+class RenderedValue {
+public:
+    /** Remember value and tell whether it differs from the previous one. */
+    bool changed(const T &value) {
+        if (valid && value == last) {
+            return false;
+        }
+        valid = true;
+        last = value;
+        return true;
+    }
+
+private:
+    bool valid = false;
+    T last {};
+};
 
 class BoolValue {
 public:
@@ -25,6 +50,7 @@ public:
 private:
     BORROWED svgscene::SimpleTextItem *const element;
     const bool &data;
+    RenderedValue<bool> rendered;
 };
 
 class PCValue : public QObject {
@@ -44,6 +70,7 @@ public:
 private:
     BORROWED svgscene::SimpleTextItem *const element;
     const machine::Address &data;
+    RenderedValue<machine::Address> rendered;
 };
 
 class RegValue {
@@ -57,6 +84,7 @@ public:
 private:
     BORROWED svgscene::SimpleTextItem *const element;
     const machine::RegisterValue &data;
+    RenderedValue<uint32_t> rendered;
 };
 
 class RegIdValue {
@@ -68,6 +96,7 @@ public:
 private:
     BORROWED svgscene::SimpleTextItem *const element;
     const uint8_t &data;
+    RenderedValue<uint8_t> rendered;
 };
 
 class DebugValue {
@@ -79,6 +108,7 @@ public:
 private:
     BORROWED svgscene::SimpleTextItem *const element;
     const unsigned &data;
+    RenderedValue<unsigned> rendered;
 };
 
 class MultiTextValue {
@@ -93,6 +123,7 @@ private:
     BORROWED svgscene::SimpleTextItem *const element;
     const unsigned &current_text_index;
     const std::vector<QString> &text_table;
+    RenderedValue<unsigned> rendered;
 };
 
 class InstructionValue {
@@ -108,6 +139,7 @@ private:
     BORROWED svgscene::SimpleTextItem *const element;
     const machine::Instruction &instruction_data;
     const machine::Address &address_data;
+    RenderedValue<std::pair<uint32_t, machine::Address>> rendered;
 };
 
 #endif // QTRVSIM_VALUE_HANDLERS_H
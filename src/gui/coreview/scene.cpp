@@ -7,6 +7,7 @@
 #include <svgscene/components/groupitem.h>
 #include <svgscene/components/hyperlinkitem.h>
 #include <svgscene/components/simpletextitem.h>
+#include <svgscene/scenecache.h>
 #include <svgscene/svghandler.h>
 #include <unordered_map>
 #include <vector>
@@ -32,16 +33,24 @@ void CoreViewScene::install_values_from_document<PCValue>(
 CoreViewScene::CoreViewScene(
     machine::Machine *machine,
     const QString &core_svg_scheme_name)
-    : SvgGraphicsScene() {
-    Q_UNUSED(machine)
-
-    // Update coreview each core step.
+    : SvgGraphicsScene()
+    , machine(machine) {
+    // Update coreview after core steps, limited to display frame rate.
+    update_timer.setSingleShot(true);
+    connect(
+        &update_timer, &QTimer::timeout, this, &CoreViewScene::update_values);
     connect(
         machine->core(), &machine::Core::step_done, this,
-        &CoreViewScene::update_values);
+        &CoreViewScene::schedule_update);
+    // Core does not signal steps while running in background.
+    connect(
+        machine, &machine::Machine::status_change, this,
+        &CoreViewScene::schedule_update);
 
-    SvgDocument document = svgscene::parseFromFileName(
-        this, QString(":/core/%1.svg").arg(core_svg_scheme_name));
+    // Scene cache is generated from the SVG at build time, when available.
+    SvgDocument document = svgscene::parseFromCacheOrFileName(
+        this, QString(":/core/%1.svgscene").arg(core_svg_scheme_name),
+        QString(":/core/%1.svg").arg(core_svg_scheme_name));
 
     for (auto hyperlink_tree : document.getRoot().findAll<HyperlinkItem>()) {
         this->install_hyperlink(hyperlink_tree.getElement());
@@ -110,6 +119,7 @@ CoreViewScene::CoreViewScene(
         document, values.instruction_values, VALUE_SOURCE_NAME_MAPS.INSTRUCTION,
         core_state);
 
+    since_update.start();
     update_values();
 }
 
@@ -213,6 +223,13 @@ void CoreViewScene::update_value_list(std::vector<T> &value_list) {
 }
 
 void CoreViewScene::update_values() {
+    update_timer.stop();
+    if (machine->background_running()) {
+        // Core state is owned by the simulation thread, the view is
+        // refreshed by the status change when the run ends.
+        return;
+    }
+    since_update.restart();
     update_value_list(values.bool_values);
     update_value_list(values.debug_values);
     update_value_list(values.reg_values);
@@ -222,6 +239,20 @@ void CoreViewScene::update_values() {
     update_value_list(values.instruction_values);
 }
 
+void CoreViewScene::schedule_update() {
+    if (update_timer.isActive()) {
+        return;
+    }
+    qint64 elapsed = since_update.elapsed();
+    if (elapsed >= FRAME_INTERVAL_MS) {
+        // First change after idle period (e.g., single step) is shown
+        // immediately.
+        update_values();
+    } else {
+        update_timer.start(FRAME_INTERVAL_MS - (int)elapsed);
+    }
+}
+
 CoreViewSceneSimple::CoreViewSceneSimple(machine::Machine *machine)
     : CoreViewScene(machine, "simple") {}
 
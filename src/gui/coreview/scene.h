@@ -8,7 +8,9 @@
 
 #include <QGraphicsScene>
 #include <QGraphicsView>
+#include <QElapsedTimer>
 #include <QSignalMapper>
+#include <QTimer>
 #include <machine/machine.h>
 #include <svgscene/components/hyperlinkitem.h>
 #include <svgscene/components/simpletextitem.h>
@@ -43,6 +45,12 @@ public slots:
      */
     void update_values();
 
+    /**
+     * Request update of dynamic values. Requests are coalesced, values are
+     * updated at most once per display frame.
+     */
+    void schedule_update();
+
 protected:
     /**
      * Lookup link target and connect element one of `request_` slots.
@@ -117,6 +125,11 @@ protected:
 
     Box<Cache> program_cache;
     Box<Cache> data_cache;
+
+    static constexpr int FRAME_INTERVAL_MS = 16;
+    const machine::Machine *machine;
+    QTimer update_timer;
+    QElapsedTimer since_update;
 };
 
 class CoreViewSceneSimple : public CoreViewScene {
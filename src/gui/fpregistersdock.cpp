@@ -0,0 +1,179 @@
+#include "fpregistersdock.h"
+
+#include <cstring>
+
+static const QString labels[]
+    = { "ft0", "ft1", "ft2",  "ft3",  "ft4", "ft5", "ft6",  "ft7",
+        "fs0", "fs1", "fa0",  "fa1",  "fa2", "fa3", "fa4",  "fa5",
+        "fa6", "fa7", "fs2",  "fs3",  "fs4", "fs5", "fs6",  "fs7",
+        "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11" };
+
+FpRegistersDock::FpRegistersDock(QWidget *parent) : QDockWidget(parent) {
+    static const QColor defaultTextColor(0, 0, 0);
+
+    scrollarea = new QScrollArea(this);
+    scrollarea->setWidgetResizable(true);
+    widg = new StaticTable(scrollarea);
+    fp_highlighted = 0;
+    fcsr_highlighted = false;
+
+    pal_normal = palette();
+    pal_normal.setColor(QPalette::WindowText, defaultTextColor);
+
+#define INIT(X, LABEL)                                                         \
+    do {                                                                       \
+        (X) = new QLabel(                                                      \
+            "0x0000000000000000 (-0.000000000000000e-000)", widg);           \
+        (X)->setFixedSize((X)->sizeHint());                                    \
+        (X)->setText("");                                                      \
+        (X)->setPalette(pal_normal);                                           \
+        (X)->setTextInteractionFlags(Qt::TextSelectableByMouse);               \
+        QLabel *l = new QLabel(LABEL, widg);                                   \
+        l->setPalette(pal_normal);                                             \
+        widg->addRow({ l, X });                                                \
+    } while (false)
+
+    for (int i = 0; i < 32; i++) {
+        INIT(fp[i], QString("f") + QString::number(i) + "/" + labels[i]);
+    }
+    INIT(fcsr, "fcsr");
+#undef INIT
+    scrollarea->setWidget(widg);
+
+    setWidget(scrollarea);
+    setObjectName("FpRegisters");
+    setWindowTitle("FP Registers");
+
+    pal_updated = pal_normal;
+    pal_read = pal_normal;
+    pal_updated.setColor(QPalette::WindowText, QColor(240, 0, 0));
+    pal_read.setColor(QPalette::WindowText, QColor(0, 0, 240));
+}
+
+FpRegistersDock::~FpRegistersDock() {
+    for (auto &i : fp) {
+        delete i;
+    }
+    delete fcsr;
+    delete widg;
+    delete scrollarea;
+}
+
+void FpRegistersDock::setup(machine::Machine *machine) {
+    if (machine == nullptr) {
+        // Reset data
+        for (auto &i : fp) {
+            i->setText("");
+        }
+        fcsr->setText("");
+        return;
+    }
+
+    const machine::Registers *regs = machine->registers();
+
+    // Load values
+    for (int i = 0; i < 32; i++) {
+        fp[i]->setText(fp_text(regs->peek_fp(i)));
+    }
+    fcsr->setText(fcsr_text(regs->read_fcsr()));
+
+    connect(
+        regs, &machine::Registers::step_changes, this,
+        &FpRegistersDock::fp_changes);
+    connect(
+        machine, &machine::Machine::tick, this,
+        &FpRegistersDock::clear_highlights);
+    connect(
+        machine, &machine::Machine::snapshot_update, this,
+        &FpRegistersDock::snapshot_update);
+}
+
+void FpRegistersDock::fp_changes(const machine::RegisterJournal &changes) {
+    for (const machine::RegisterChange &change : changes.fp_writes) {
+        fp[change.reg.data]->setText(fp_text(change.new_value));
+        fp[change.reg.data]->setPalette(pal_updated);
+        fp_highlighted |= 1u << change.reg.data;
+    }
+    uint32_t read = changes.fp_read_mask & ~fp_highlighted;
+    for (int i = 0; i < 32; i++) {
+        if (read & (1u << i)) {
+            fp[i]->setPalette(pal_read);
+        }
+    }
+    fp_highlighted |= read;
+    if (changes.fcsr_written) {
+        fcsr->setText(fcsr_text(changes.new_fcsr));
+        fcsr->setPalette(pal_updated);
+        fcsr_highlighted = true;
+    }
+}
+
+void FpRegistersDock::snapshot_update(
+    const machine::MachineSnapshot &snapshot) {
+    // Register signals are blocked during background run, highlight registers
+    // changed since the previous snapshot instead.
+    for (int i = 0; i < 32; i++) {
+        if (labelTextChanged(fp[i], fp_text(snapshot.fp[i]))) {
+            fp[i]->setPalette(pal_updated);
+            fp_highlighted |= 1u << i;
+        }
+    }
+    if (labelTextChanged(fcsr, fcsr_text(snapshot.fcsr))) {
+        fcsr->setPalette(pal_updated);
+        fcsr_highlighted = true;
+    }
+}
+
+void FpRegistersDock::clear_highlights() {
+    if (fp_highlighted != 0) {
+        for (int i = 0; i < 32; i++) {
+            if (fp_highlighted & (1u << i)) {
+                fp[i]->setPalette(pal_normal);
+            }
+        }
+    }
+    if (fcsr_highlighted) {
+        fcsr->setPalette(pal_normal);
+    }
+    fp_highlighted = 0;
+    fcsr_highlighted = false;
+}
+
+QString FpRegistersDock::fp_text(machine::RegisterValue value) {
+    const uint64_t bits = value.as_u64();
+    double number;
+    if ((bits >> 32) == 0xffffffff) {
+        // NaN-boxed single-precision value
+        float f;
+        const uint32_t low = uint32_t(bits);
+        std::memcpy(&f, &low, sizeof(f));
+        number = f;
+    } else {
+        std::memcpy(&number, &bits, sizeof(number));
+    }
+    return QString("0x%1 (%2)")
+        .arg(bits, 16, 16, QChar('0'))
+        .arg(number, 0, 'g', 17);
+}
+
+QString FpRegistersDock::fcsr_text(uint32_t value) {
+    static const char *const frm_names[8]
+        = { "rne", "rtz", "rdn", "rup", "rmm", "?", "?", "dyn" };
+    static const char flag_names[] = "NZOUX"; // NV DZ OF UF NX
+    QString flags;
+    for (int i = 4; i >= 0; i--) {
+        flags += (value & (1u << i)) ? QChar(flag_names[4 - i]) : QChar('-');
+    }
+    return QString("0x%1 frm=%2 %3")
+        .arg(value, 2, 16, QChar('0'))
+        .arg(frm_names[(value >> 5) & 0x7])
+        .arg(flags);
+}
+
+bool FpRegistersDock::labelTextChanged(QLabel *label, const QString &text) {
+    if (label->text() == text) {
+        return false;
+    }
+    label->setText(text);
+    return true;
+}
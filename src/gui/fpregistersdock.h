@@ -0,0 +1,50 @@
+#ifndef FPREGISTERSDOCK_H
+#define FPREGISTERSDOCK_H
+
+#include "machine/machine.h"
+#include "statictable.h"
+
+#include <QDockWidget>
+#include <QLabel>
+#include <QPalette>
+#include <QScrollArea>
+
+/**
+ * Floating-point registers (F and D extensions) and fcsr.
+ *
+ * Registers are shown as raw 64-bit values followed by their value as
+ * single (when NaN-boxed) or double-precision number.
+ */
+class FpRegistersDock : public QDockWidget {
+    Q_OBJECT
+public:
+    FpRegistersDock(QWidget *parent);
+    ~FpRegistersDock() override;
+
+    void setup(machine::Machine *machine);
+
+private slots:
+    void fp_changes(const machine::RegisterJournal &changes);
+    void clear_highlights();
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
+
+private:
+    StaticTable *widg;
+    QScrollArea *scrollarea;
+
+    QLabel *fp[32] {};
+    QLabel *fcsr {};
+
+    uint32_t fp_highlighted;
+    bool fcsr_highlighted;
+
+    QPalette pal_normal;
+    QPalette pal_updated;
+    QPalette pal_read;
+
+    static QString fp_text(machine::RegisterValue value);
+    static QString fcsr_text(uint32_t value);
+    static bool labelTextChanged(QLabel *label, const QString &text);
+};
+
+#endif // FPREGISTERSDOCK_H
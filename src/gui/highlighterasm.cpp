@@ -2,117 +2,146 @@
 
 #include "highlighterasm.h"
 
-#include "QStringList"
-#include "machine/instruction.h"
+#include <QTextDocument>
+#include <utility>
+
+namespace {
+
+/** Lexer result stored in the document block. */
+class AsmBlockData : public QTextBlockUserData {
+public:
+    AsmBlockData(int revision, AsmLineInfo info)
+        : revision(revision)
+        , info(std::move(info)) {}
+
+    int revision;
+    AsmLineInfo info;
+};
+
+} // namespace
 
 HighlighterAsm::HighlighterAsm(QTextDocument *parent)
     : QSyntaxHighlighter(parent) {
-    HighlightingRule rule;
+    qRegisterMetaType<AsmLineInfo>();
 
     keywordFormat.setForeground(Qt::darkBlue);
     keywordFormat.setFontWeight(QFont::Bold);
-    const QString keywordPatterns[]
-        = { QStringLiteral("\\.org\\b"),   QStringLiteral("\\.word\\b"),
-            QStringLiteral("\\.text\\b"),  QStringLiteral("\\.data\\b"),
-            QStringLiteral("\\.globl\\b"), QStringLiteral("\\.set\\b"),
-            QStringLiteral("\\.equ\\b"),   QStringLiteral("\\.end\\b"),
-            QStringLiteral("\\.ent\\b"),   QStringLiteral("\\.ascii\\b"),
-            QStringLiteral("\\.asciz\\b"), QStringLiteral("\\.byte\\b"),
-            QStringLiteral("\\.skip\\b"),  QStringLiteral("\\.space\\b") };
-
-    for (const QString &pattern : keywordPatterns) {
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = keywordFormat;
-        highlightingRules.append(rule);
-    }
+    registerFormat.setFontWeight(QFont::Bold);
+    registerFormat.setForeground(Qt::darkMagenta);
+    singleLineCommentFormat.setForeground(Qt::red);
+    quotationFormat.setForeground(Qt::darkGreen);
+    errorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+    errorFormat.setUnderlineColor(Qt::red);
+
+    auto *worker = new AsmLexerWorker();
+    worker->moveToThread(&worker_thread);
+    connect(
+        &worker_thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(
+        this, &HighlighterAsm::lex_line, worker, &AsmLexerWorker::lex_line);
+    connect(
+        worker, &AsmLexerWorker::line_lexed, this,
+        &HighlighterAsm::line_lexed);
+    worker_thread.start();
+}
 
-    QStringList inst_list;
-    machine::Instruction::append_recognized_instructions(inst_list);
-    foreach (const QString &str, inst_list) {
-        rule.pattern = QRegularExpression("\\b" + str + "\\b");
-        rule.format = keywordFormat;
-        highlightingRules.append(rule);
-        rule.pattern = QRegularExpression("\\b" + str.toLower() + "\\b");
-        rule.format = keywordFormat;
-        highlightingRules.append(rule);
+HighlighterAsm::~HighlighterAsm() {
+    worker_thread.quit();
+    worker_thread.wait();
+}
+
+void HighlighterAsm::set_visible_blocks(int first, int last) {
+    first_visible = first;
+    last_visible = last;
+    if (document() == nullptr) {
+        return;
+    }
+    for (QTextBlock block = document()->findBlockByNumber(first);
+         block.isValid() && block.blockNumber() <= last;
+         block = block.next()) {
+        auto *data = static_cast<AsmBlockData *>(block.userData());
+        if ((data == nullptr) || (data->revision != block.revision())) {
+            request(block, block.text());
+        }
     }
+}
 
-    registerFormat.setFontWeight(QFont::Bold);
-    registerFormat.setForeground(Qt::darkMagenta);
-    QStringList reg_list;
-    machine::Instruction::append_recognized_registers(reg_list);
-    foreach (const QString &str, reg_list) {
-        rule.pattern = QRegularExpression("\\$" + str + "\\b");
-        rule.format = registerFormat;
-        highlightingRules.append(rule);
+QString HighlighterAsm::block_error(const QTextBlock &block) {
+    auto *data = dynamic_cast<AsmBlockData *>(block.userData());
+    if ((data == nullptr) || (data->revision != block.revision())) {
+        return QString();
     }
-    rule.pattern = QRegularExpression("\\$[0-9]+\\b");
-    rule.format = registerFormat;
-    highlightingRules.append(rule);
+    return data->info.error;
+}
 
-    singleLineCommentFormat.setForeground(Qt::red);
-    rule.pattern = QRegularExpression(QStringLiteral(";[^\n]*"));
-    rule.format = singleLineCommentFormat;
-    highlightingRules.append(rule);
-    rule.pattern = QRegularExpression(QStringLiteral("#[^\n]*"));
-    rule.format = singleLineCommentFormat;
-    highlightingRules.append(rule);
-    rule.pattern = QRegularExpression(QStringLiteral("//[^\n]*"));
-    rule.format = singleLineCommentFormat;
-    highlightingRules.append(rule);
-
-    multiLineCommentFormat.setForeground(Qt::red);
+void HighlighterAsm::request(const QTextBlock &block, const QString &text) {
+    const int number = block.blockNumber();
+    auto it = requested.constFind(number);
+    if ((it != requested.constEnd()) && (it.value() == block.revision())) {
+        return;
+    }
+    requested.insert(number, block.revision());
+    emit lex_line(number, block.revision(), text);
+}
 
-    quotationFormat.setForeground(Qt::darkGreen);
-    rule.pattern = QRegularExpression(QStringLiteral("\".*\""));
-    rule.format = quotationFormat;
-    highlightingRules.append(rule);
-
-    // functionFormat.setFontItalic(true);
-    // functionFormat.setForeground(Qt::blue);
-    // rule.pattern =
-    // QRegularExpression(QStringLiteral("\\b[A-Za-z0-9_]+(?=\\()"));
-    // rule.format = functionFormat; highlightingRules.append(rule);
-
-    // commentStartExpression = QRegularExpression(QStringLiteral("/\\*"));
-    // commentEndExpression = QRegularExpression(QStringLiteral("\\*/"));
+void HighlighterAsm::line_lexed(
+    int block_number,
+    int revision,
+    const QString &text,
+    const AsmLineInfo &info) {
+    auto it = requested.find(block_number);
+    if ((it != requested.end()) && (it.value() == revision)) {
+        requested.erase(it);
+    }
+    QTextBlock block = document()->findBlockByNumber(block_number);
+    // Block was edited or moved meanwhile, its new content is requested by
+    // highlightBlock.
+    if (!block.isValid() || (block.revision() != revision)
+        || (block.text() != text)) {
+        return;
+    }
+    block.setUserData(new AsmBlockData(revision, info));
+    rehighlightBlock(block);
 }
 
 void HighlighterAsm::highlightBlock(const QString &text) {
-#if QT_VERSION < QT_VERSION_CHECK(5, 7, 0)
-    foreach (const HighlightingRule &rule, highlightingRules)
-#else
-    for (const HighlightingRule &rule : qAsConst(highlightingRules))
-#endif
-    {
-        QRegularExpressionMatchIterator matchIterator
-            = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(
-                match.capturedStart(), match.capturedLength(), rule.format);
+    setCurrentBlockState(0);
+    const QTextBlock block = currentBlock();
+    auto *data = static_cast<AsmBlockData *>(currentBlockUserData());
+    if ((data == nullptr) || (data->revision != block.revision())) {
+        if ((block.blockNumber() >= first_visible)
+            && (block.blockNumber() <= last_visible)) {
+            request(block, text);
         }
+        return;
     }
-    setCurrentBlockState(0);
 
-#if 0
-    int startIndex = 0;
-    if (previousBlockState() != 1)
-        startIndex = text.indexOf(commentStartExpression);
-
-    while (startIndex >= 0) {
-        QRegularExpressionMatch match = commentEndExpression.match(text, startIndex);
-        int endIndex = match.capturedStart();
-        int commentLength = 0;
-        if (endIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
-        } else {
-            commentLength = endIndex - startIndex
-                            + match.capturedLength();
+    for (const AsmSpan &span : data->info.spans) {
+        switch (span.kind) {
+        case AsmSpan::KEYWORD:
+            setFormat(span.start, span.length, keywordFormat);
+            break;
+        case AsmSpan::REGISTER:
+            setFormat(span.start, span.length, registerFormat);
+            break;
+        case AsmSpan::STRING:
+            setFormat(span.start, span.length, quotationFormat);
+            break;
+        case AsmSpan::COMMENT:
+            setFormat(span.start, span.length, singleLineCommentFormat);
+            break;
+        case AsmSpan::ERROR: break;
+        }
+    }
+    // Errors are drawn over other formats.
+    for (const AsmSpan &span : data->info.spans) {
+        if (span.kind != AsmSpan::ERROR) {
+            continue;
+        }
+        for (int i = span.start; i < span.start + span.length; i++) {
+            QTextCharFormat f = format(i);
+            f.merge(errorFormat);
+            setFormat(i, 1, f);
         }
-        setFormat(startIndex, commentLength, multiLineCommentFormat);
-        startIndex = text.indexOf(commentStartExpression, startIndex + commentLength);
     }
-#endif
 }
@@ -3,41 +3,66 @@
 #ifndef HIGHLIGHTERASM_H
 #define HIGHLIGHTERASM_H
 
-#include <QRegularExpression>
+#include "asmlexer.h"
+
+#include <QHash>
 #include <QSyntaxHighlighter>
+#include <QTextBlock>
 #include <QTextCharFormat>
+#include <QThread>
 
 QT_BEGIN_NAMESPACE
 class QTextDocument;
 QT_END_NAMESPACE
 
-//! [0]
+/**
+ * Assembler highlighter with lexing in a worker thread.
+ *
+ * Result of lexing is stored in each block together with the block revision
+ * and `highlightBlock` only applies it. Blocks without up to date result are
+ * sent to the worker when they are visible, so large sources are processed
+ * only as far as the user scrolls.
+ */
 class HighlighterAsm : public QSyntaxHighlighter {
     Q_OBJECT
 
 public:
     HighlighterAsm(QTextDocument *parent = nullptr);
+    ~HighlighterAsm() override;
+
+    /** Set range of shown blocks, the range is lexed if needed. */
+    void set_visible_blocks(int first, int last);
+    /** Assembler diagnostic of the block, empty if none or not known yet. */
+    static QString block_error(const QTextBlock &block);
+
+signals:
+    void lex_line(int block_number, int revision, const QString &text);
 
 protected:
     void highlightBlock(const QString &text) override;
 
+private slots:
+    void line_lexed(
+        int block_number,
+        int revision,
+        const QString &text,
+        const AsmLineInfo &info);
+
 private:
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlightingRules;
+    /** Send block to worker unless it is already waiting there. */
+    void request(const QTextBlock &block, const QString &text);
 
-    QRegularExpression commentStartExpression;
-    QRegularExpression commentEndExpression;
+    QThread worker_thread;
+    /** Revisions of blocks waiting for worker. */
+    QHash<int, int> requested;
+    int first_visible = 0;
+    int last_visible = 100;
 
     QTextCharFormat keywordFormat;
     QTextCharFormat registerFormat;
     QTextCharFormat singleLineCommentFormat;
-    QTextCharFormat multiLineCommentFormat;
     QTextCharFormat quotationFormat;
-    QTextCharFormat functionFormat;
+    QTextCharFormat errorFormat;
 };
-//! [0]
 
 #endif // HIGHLIGHTERASM_H
@@ -27,8 +27,8 @@ LcdDisplayDock::~LcdDisplayDock() {
     delete lcd_display_widget;
 }
 
-void LcdDisplayDock::setup(machine::LcdDisplay *lcd_display) {
-    lcd_display_widget->setup(lcd_display);
+void LcdDisplayDock::setup(machine::Machine *machine) {
+    lcd_display_widget->setup(machine);
     update_layout(width(), height());
 }
 
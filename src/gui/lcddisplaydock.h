@@ -17,7 +17,7 @@ public:
     ~LcdDisplayDock() override;
     void resizeEvent(QResizeEvent *event) override;
 
-    void setup(machine::LcdDisplay *lcd_display);
+    void setup(machine::Machine *machine);
 
     // public slots:
 
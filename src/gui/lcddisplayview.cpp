@@ -1,71 +1,125 @@
 #include "lcddisplayview.h"
 
+#include "pixelconvert.h"
+
 #include <QPaintEvent>
 #include <QPainter>
 #include <QStyle>
+#include <algorithm>
 
 LcdDisplayView::LcdDisplayView(QWidget *parent) : Super(parent) {
     setMinimumSize(100, 100);
     fb_pixels = nullptr;
-    scale_x = 1.0;
-    scale_y = 1.0;
 }
 
 LcdDisplayView::~LcdDisplayView() {
     { delete fb_pixels; }
+    { delete scaled_pixels; }
 }
 
-void LcdDisplayView::setup(machine::LcdDisplay *lcd_display) {
+void LcdDisplayView::setup(machine::Machine *machine) {
+    lcd_display = machine->peripheral_lcd_display();
     if (lcd_display == nullptr) {
         return;
     }
     connect(
-        lcd_display, &machine::LcdDisplay::pixel_update, this,
-        &LcdDisplayView::pixel_update);
+        lcd_display, &machine::LcdDisplay::region_update, this,
+        &LcdDisplayView::region_update);
+    connect(
+        machine, &machine::Machine::snapshot_update, this,
+        &LcdDisplayView::snapshot_update);
     { delete fb_pixels; }
     fb_pixels = nullptr;
     fb_pixels = new QImage(
         lcd_display->get_width(), lcd_display->get_height(),
         QImage::Format_RGB32);
-    fb_pixels->fill(qRgb(0, 0, 0));
     update_scale();
-    update();
+    region_update(0, 0, lcd_display->get_width(), lcd_display->get_height());
+}
+
+void LcdDisplayView::region_update(
+    size_t x,
+    size_t y,
+    size_t width,
+    size_t height) {
+    if (lcd_display == nullptr) {
+        return;
+    }
+    const size_t line_size = lcd_display->get_fb_line_size();
+    update_region(
+        lcd_display->get_fb_data() + y * line_size + 2 * x, line_size, x, y,
+        width, height);
+}
+
+void LcdDisplayView::snapshot_update(
+    const machine::MachineSnapshot &snapshot) {
+    const machine::LcdRegion &region = snapshot.lcd_region;
+    if (!region.valid) {
+        return;
+    }
+    update_region(
+        region.pixels.data(), 2 * region.width, region.x, region.y,
+        region.width, region.height);
 }
 
-void LcdDisplayView::pixel_update(size_t x, size_t y, uint r, uint g, uint b) {
-    int x1, y1, x2, y2;
-    if (fb_pixels != nullptr) {
-        fb_pixels->setPixel(x, y, qRgb(r, g, b));
-        x1 = x * scale_x - 2;
-        if (x1 < 0) {
-            x1 = 0;
-        }
-        x2 = x * scale_x + 2;
-        if (x2 > width()) {
-            x2 = width();
-        }
-        y1 = y * scale_y - 2;
-        if (y1 < 0) {
-            y1 = 0;
-        }
-        y2 = y * scale_y + 2;
-        if (y2 > height()) {
-            y2 = height();
-        }
-        update(x1, y1, x2 - x1, y2 - y1);
+void LcdDisplayView::update_region(
+    const byte *data,
+    size_t line_size,
+    size_t x,
+    size_t y,
+    size_t width,
+    size_t height) {
+    if (fb_pixels == nullptr) {
+        return;
+    }
+    for (size_t row = 0; row < height; row++) {
+        convert_rgb565be_to_argb32(
+            data + row * line_size,
+            reinterpret_cast<uint32_t *>(fb_pixels->scanLine(y + row)) + x,
+            width);
+    }
+    if (scaled_pixels == nullptr) {
+        return;
+    }
+
+    // Destination pixels sampling the region (maps are monotonic).
+    int x1 = std::lower_bound(scale_map_x.begin(), scale_map_x.end(), (int)x)
+             - scale_map_x.begin();
+    int x2 = std::lower_bound(
+                 scale_map_x.begin(), scale_map_x.end(), (int)(x + width))
+             - scale_map_x.begin();
+    int y1 = std::lower_bound(scale_map_y.begin(), scale_map_y.end(), (int)y)
+             - scale_map_y.begin();
+    int y2 = std::lower_bound(
+                 scale_map_y.begin(), scale_map_y.end(), (int)(y + height))
+             - scale_map_y.begin();
+    scale_rows(x1, x2, y1, y2);
+    update(x1, y1, x2 - x1, y2 - y1);
+}
+
+void LcdDisplayView::scale_rows(int x1, int x2, int y1, int y2) {
+    for (int row = y1; row < y2; row++) {
+        scale_line_nearest(
+            reinterpret_cast<const uint32_t *>(
+                fb_pixels->constScanLine(scale_map_y[row])),
+            reinterpret_cast<uint32_t *>(scaled_pixels->scanLine(row)),
+            scale_map_x, x1, x2);
     }
 }
 
 void LcdDisplayView::update_scale() {
-    if (fb_pixels != nullptr) {
-        if ((fb_pixels->width() != 0) && (fb_pixels->height() != 0)) {
-            scale_x = (float)width() / fb_pixels->width();
-            scale_y = (float)height() / fb_pixels->height();
-            return;
-        }
+    { delete scaled_pixels; }
+    scaled_pixels = nullptr;
+    if (fb_pixels == nullptr || fb_pixels->width() == 0
+        || fb_pixels->height() == 0 || width() <= 0 || height() <= 0) {
+        return;
     }
-    scale_x = 1.0;
-    scale_y = 1.0;
+    // Scale once per resize/update instead of on every paint.
+    scaled_pixels = new QImage(width(), height(), QImage::Format_RGB32);
+    scale_map_x = nearest_neighbour_map(fb_pixels->width(), width());
+    scale_map_y = nearest_neighbour_map(fb_pixels->height(), height());
+    scale_rows(0, width(), 0, height());
+    update();
 }
 
 void LcdDisplayView::paintEvent(QPaintEvent *event) {
@@ -77,7 +131,11 @@ void LcdDisplayView::paintEvent(QPaintEvent *event) {
     }
 
     QPainter painter(this);
-    painter.drawImage(rect(), *fb_pixels);
+    if (scaled_pixels != nullptr) {
+        painter.drawImage(event->rect(), *scaled_pixels, event->rect());
+    } else {
+        painter.drawImage(rect(), *fb_pixels);
+    }
 #if 0
     painter.setPen(QPen(QColor(255, 255, 0)));
     painter.drawLine(event->rect().topLeft(),event->rect().topRight());
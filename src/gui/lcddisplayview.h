@@ -1,10 +1,12 @@
 #ifndef LCDDISPLAYVIEW_H
 #define LCDDISPLAYVIEW_H
 
+#include "machine/machine.h"
 #include "machine/memory/backend/lcddisplay.h"
 
 #include <QImage>
 #include <QWidget>
+#include <vector>
 
 class LcdDisplayView : public QWidget {
     Q_OBJECT
@@ -15,22 +17,42 @@ public:
     explicit LcdDisplayView(QWidget *parent = nullptr);
     ~LcdDisplayView() override;
 
-    void setup(machine::LcdDisplay *lcd_display);
+    void setup(machine::Machine *machine);
     uint fb_width();
     uint fb_height();
 
 public slots:
-    void pixel_update(size_t x, size_t y, uint r, uint g, uint b);
+    void region_update(size_t x, size_t y, size_t width, size_t height);
+    /** Background run passes modified pixels in the snapshot. */
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
 
 private:
+    /**
+     * Convert framebuffer rectangle into `fb_pixels` and repaint it.
+     *
+     * @param data          RGB565 pixel at [x, y]
+     * @param line_size     bytes between the rows of `data`
+     */
+    void update_region(
+        const byte *data,
+        size_t line_size,
+        size_t x,
+        size_t y,
+        size_t width,
+        size_t height);
     void update_scale();
-    float scale_x;
-    float scale_y;
+    /** Fill destination rectangle of the scaled image from `fb_pixels`. */
+    void scale_rows(int x1, int x2, int y1, int y2);
     QImage *fb_pixels;
+    /** `fb_pixels` scaled to widget size by nearest neighbour. */
+    QImage *scaled_pixels = nullptr;
+    std::vector<int> scale_map_x;
+    std::vector<int> scale_map_y;
+    const machine::LcdDisplay *lcd_display = nullptr;
 };
 
 #endif // LCDDISPLAYVIEW_H
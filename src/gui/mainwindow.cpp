@@ -50,6 +50,8 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     ndialog = new NewDialog(this, settings);
     registers = new RegistersDock(this);
     registers->hide();
+    fp_registers = new FpRegistersDock(this);
+    fp_registers->hide();
     program = new ProgramDock(this, settings);
     addDockWidget(Qt::LeftDockWidgetArea, program);
     program->show();
@@ -70,6 +72,16 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     messages = new MessagesDock(this, settings);
     messages->hide();
 
+    incremental_timer = new QTimer(this);
+    incremental_timer->setSingleShot(true);
+    incremental_timer->setInterval(300);
+    connect(
+        incremental_timer, &QTimer::timeout, this,
+        &MainWindow::incremental_compile);
+    connect(
+        &incremental_asm, &IncrementalAsm::report_message, this,
+        &MainWindow::report_message);
+
     // Execution speed actions
     speed_group = new QActionGroup(this);
     speed_group->addAction(ui->ips1);
@@ -116,6 +128,9 @@ MainWindow::MainWindow(QSettings *settings, QWidget *parent)
     connect(
         ui->actionRegisters, &QAction::triggered, this,
         &MainWindow::show_registers);
+    connect(
+        ui->actionFpRegisters, &QAction::triggered, this,
+        &MainWindow::show_fp_registers);
     connect(
         ui->actionProgram_memory, &QAction::triggered, this,
         &MainWindow::show_program);
@@ -208,6 +223,7 @@ MainWindow::~MainWindow() {
     delete central_window;
     delete ndialog;
     delete registers;
+    delete fp_registers;
     delete program;
     delete memory;
     delete cache_program;
@@ -243,7 +259,9 @@ void MainWindow::show_hide_coreview(bool show) {
         return;
     }
 
-    if (machine->config().pipelined()) {
+    // Multi-issue core passes instructions through the stages one by one,
+    // the simple view fits it.
+    if (machine->core_pipelined() != nullptr) {
         corescene = new CoreViewScenePipelined(machine);
     } else {
         corescene = new CoreViewSceneSimple(machine);
@@ -290,6 +308,8 @@ void MainWindow::create_core(
     // Remove old machine
     delete machine;
     machine = new_machine;
+    incremental_asm.reset();
+    incremental_editor = nullptr;
 
     // Create machine view
     delete corescene;
@@ -309,7 +329,7 @@ void MainWindow::create_core(
             terminal, QOverload<int, unsigned int>::of(&TerminalDock::tx_byte));
         connect(
             osemu_handler, &osemu::OsSyscallExceptionHandler::rx_byte_pool,
-            terminal, &TerminalDock::rx_byte_pool);
+            terminal, &TerminalDock::rx_byte_pool, Qt::DirectConnection);
         machine->set_step_over_exception(machine::EXCAUSE_SYSCALL, true);
         machine->set_stop_on_exception(machine::EXCAUSE_SYSCALL, false);
     } else {
@@ -345,13 +365,14 @@ void MainWindow::create_core(
 
     // Setup docks
     registers->setup(machine);
+    fp_registers->setup(machine);
     program->setup(machine);
     memory->setup(machine);
     cache_program->setup(machine->cache_program());
     cache_data->setup(machine->cache_data());
     terminal->setup(machine->serial_port());
     peripherals->setup(machine->peripheral_spi_led());
-    lcd_display->setup(machine->peripheral_lcd_display());
+    lcd_display->setup(machine);
     cop0dock->setup(machine);
 
     // Connect signals for instruction address followup
@@ -469,6 +490,7 @@ void MainWindow::print_action() {
     }
 
 SHOW_HANDLER(registers, Qt::TopDockWidgetArea)
+SHOW_HANDLER(fp_registers, Qt::TopDockWidgetArea)
 SHOW_HANDLER(program, Qt::LeftDockWidgetArea)
 SHOW_HANDLER(memory, Qt::RightDockWidgetArea)
 SHOW_HANDLER(cache_program, Qt::RightDockWidgetArea)
@@ -532,6 +554,9 @@ void MainWindow::set_speed() {
     } else {
         machine->set_speed(0);
     }
+    // Unlimited speed does not visualize individual steps, so the simulation
+    // is moved off the GUI thread.
+    machine->set_background_run(ui->ipsUnlimited->isChecked());
 }
 
 void MainWindow::view_mnemonics_registers(bool enable) {
@@ -695,6 +720,11 @@ void MainWindow::add_src_editor_to_tabs(SrcEditor *editor) {
     central_window->setCurrentWidget(editor);
     connect(
         editor, &QObject::destroyed, this, &MainWindow::tab_widget_destroyed);
+    connect(editor->document(), &QTextDocument::contentsChanged, this, [=] {
+        if (editor == incremental_editor) {
+            incremental_timer->start();
+        }
+    });
 }
 
 void MainWindow::update_open_file_list() {
@@ -1138,6 +1168,9 @@ void MainWindow::compile_source() {
     }
     QString filename = current_srceditor->filename();
 
+    // Memory cannot be modified under running simulation, the run continues
+    // with the new program.
+    bool resume = machine->suspend_background_run();
     machine->cache_sync();
     SrcEditor *editor = current_srceditor;
     QTextDocument *doc = editor->document();
@@ -1150,23 +1183,73 @@ void MainWindow::compile_source() {
 
     sasm.setup(mem, &symtab, machine::Address(0x80020000));
 
+    QStringList lines;
+    QVector<machine::Address> line_addresses;
     int ln = 1;
     for (QTextBlock block = doc->begin(); block.isValid();
          block = block.next(), ln++) {
         QString line = block.text();
+        lines.append(line);
+        line_addresses.append(sasm.current_address());
         if (!sasm.process_line(line, filename, ln)) {
             error_occured = true;
         }
     }
+    line_addresses.append(sasm.current_address());
     if (!sasm.finish()) {
         error_occured = true;
     }
+    if (resume) {
+        machine->resume_background_run();
+    }
+
+    incremental_timer->stop();
+    if (error_occured) {
+        incremental_asm.reset();
+        incremental_editor = nullptr;
+    } else {
+        incremental_asm.record_build(lines, line_addresses);
+        incremental_editor = editor;
+    }
 
     if (error_occured) {
         show_messages();
     }
 }
 
+void MainWindow::incremental_compile() {
+    if ((incremental_editor == nullptr) || (machine == nullptr)) {
+        return;
+    }
+    // Memory cannot be modified under running simulation, the edit is
+    // applied together with the next one.
+    if ((machine->status() == machine::Machine::ST_RUNNING)
+        || (machine->status() == machine::Machine::ST_BUSY)) {
+        return;
+    }
+    machine::FrontendMemory *mem = machine->memory_data_bus_rw();
+    if (mem == nullptr) {
+        return;
+    }
+    QStringList lines;
+    QTextDocument *doc = incremental_editor->document();
+    for (QTextBlock block = doc->begin(); block.isValid();
+         block = block.next()) {
+        lines.append(block.text());
+    }
+    SymbolTableDb symtab(machine->symbol_table_rw(true));
+
+    machine->cache_sync();
+    emit clear_messages();
+    IncrementalAsm::Result result = incremental_asm.update(
+        lines, incremental_editor->filename(), mem, &symtab);
+    if (result == IncrementalAsm::FULL_BUILD_REQUIRED) {
+        ui->statusBar->showMessage(
+            tr("Program layout changed, compile source to update memory."),
+            5000);
+    }
+}
+
 void MainWindow::build_execute() {
     QStringList list;
     if (modified_file_list(list)) {
@@ -1,10 +1,12 @@
 ﻿#ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "assembler/incrementalasm.h"
 #include "assembler/simpleasm.h"
 #include "cachedock.h"
 #include "cop0dock.h"
 #include "extprocess.h"
+#include "fpregistersdock.h"
 #include "gui/srceditor.h"
 #include "lcddisplaydock.h"
 #include "machine/machine.h"
@@ -23,6 +25,7 @@
 #include <QPointer>
 #include <QSettings>
 #include <QTabWidget>
+#include <QTimer>
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -67,10 +70,12 @@ public slots:
     void close_source_decided(int result);
     void example_source(const QString &source_file);
     void compile_source();
+    void incremental_compile();
     void build_execute();
     void build_execute_no_check();
     void build_execute_with_save(bool cancel, QStringList tosavelist);
     void show_registers();
+    void show_fp_registers();
     void show_program();
     void show_memory();
     void show_cache_data();
@@ -121,6 +126,7 @@ private:
     CoreViewScene *corescene;
 
     RegistersDock *registers {};
+    FpRegistersDock *fp_registers {};
     ProgramDock *program {};
     MemoryDock *memory {};
     CacheDock *cache_program {}, *cache_data {};
@@ -147,6 +153,10 @@ private:
     SrcEditor *source_editor_for_file(const QString &filename, bool open);
     QPointer<ExtProcess> build_process;
     bool ignore_unsaved;
+    // Edits of the last compiled source are reassembled in background.
+    IncrementalAsm incremental_asm;
+    QPointer<SrcEditor> incremental_editor;
+    QTimer *incremental_timer {};
 };
 
 class SimpleAsmWithEditorCheck : public SimpleAsm {
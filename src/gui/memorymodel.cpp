@@ -13,9 +13,8 @@ MemoryModel::MemoryModel(QObject *parent)
     index0_offset = machine::Address::null();
     data_font.setStyleHint(QFont::TypeWriter);
     machine = nullptr;
-    memory_change_counter = 0;
-    cache_data_change_counter = 0;
     access_through_cache = 0;
+    rows.resize(rowCount());
 }
 
 const machine::FrontendMemory *MemoryModel::mem_access() const {
@@ -71,12 +70,66 @@ QVariant MemoryModel::headerData(
     return Super::headerData(section, orientation, role);
 }
 
+const MemoryModel::RowCache &MemoryModel::row_cache(int row) const {
+    RowCache &rc = rows[row];
+    if (rc.valid) {
+        return rc;
+    }
+    rc.data.assign(cells_per_row, 0);
+    rc.loc_stat.assign(cells_per_row, machine::LOCSTAT_NONE);
+    rc.valid = true;
+
+    machine::Address address;
+    const machine::FrontendMemory *mem = mem_access();
+    if (mem == nullptr || !get_row_address(address, row)) {
+        return rc;
+    }
+    if (machine->background_running()) {
+        // Memory is owned by the simulation thread, use its last copy.
+        const machine::SnapshotWindowRequest &request
+            = snapshot_window.request;
+        const bool usable = request.cell_bytes == cellSizeBytes()
+                            && request.through_cache
+                                   == (access_through_cache > 0);
+        for (unsigned int col = 0; col < cells_per_row; col++) {
+            if (!usable
+                || !snapshot_window.cell(
+                    address, rc.data[col], rc.loc_stat[col])) {
+                rc.valid = false; // Filled by a later snapshot.
+            }
+            address += cellSizeBytes();
+        }
+        return rc;
+    }
+    if ((access_through_cache > 0) && (machine->cache_data() != nullptr)) {
+        mem = machine->cache_data();
+    }
+    for (unsigned int col = 0; col < cells_per_row; col++) {
+        switch (cell_size) {
+        case CELLSIZE_BYTE:
+            rc.data[col] = mem->read_u8(address, ae::INTERNAL);
+            break;
+        case CELLSIZE_HWORD:
+            rc.data[col] = mem->read_u16(address, ae::INTERNAL);
+            break;
+        default:
+        case CELLSIZE_WORD:
+            rc.data[col] = mem->read_u32(address, ae::INTERNAL);
+            break;
+        }
+        if (machine->cache_data() != nullptr) {
+            rc.loc_stat[col] = machine->cache_data()->location_status(address);
+        }
+        address += cellSizeBytes();
+    }
+    return rc;
+}
+
 QVariant MemoryModel::data(const QModelIndex &index, int role) const {
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         QString s, t;
         machine::Address address;
         uint32_t data;
-        const machine::FrontendMemory *mem;
         if (!get_row_address(address, index.row())) {
             return QString("");
         }
@@ -85,26 +138,14 @@ QVariant MemoryModel::data(const QModelIndex &index, int role) const {
             s.fill('0', 8 - t.count());
             return "0x" + s + t.toUpper();
         }
-        if (machine == nullptr) {
-            return QString("");
-        }
-        mem = mem_access();
-        if (mem == nullptr) {
+        if (machine == nullptr || mem_access() == nullptr) {
             return QString("");
         }
-        if ((access_through_cache > 0) && (machine->cache_data() != nullptr)) {
-            mem = machine->cache_data();
-        }
         address += cellSizeBytes() * (index.column() - 1);
         if (address < index0_offset) {
             return QString("");
         }
-        switch (cell_size) {
-        case CELLSIZE_BYTE: data = mem->read_u8(address,ae::INTERNAL); break;
-        case CELLSIZE_HWORD: data = mem->read_u16(address,ae::INTERNAL); break;
-        default:
-        case CELLSIZE_WORD: data = mem->read_u32(address,ae::INTERNAL); break;
-        }
+        data = row_cache(index.row()).data.at(index.column() - 1);
 
         t = QString::number(data, 16);
         s.fill('0', cellSizeBytes() * 2 - t.count());
@@ -127,10 +168,9 @@ QVariant MemoryModel::data(const QModelIndex &index, int role) const {
             || index.column() == 0) {
             return QVariant();
         }
-        address += cellSizeBytes() * (index.column() - 1);
         if (machine->cache_data() != nullptr) {
-            machine::LocationStatus loc_stat;
-            loc_stat = machine->cache_data()->location_status(address);
+            machine::LocationStatus loc_stat
+                = row_cache(index.row()).loc_stat.at(index.column() - 1);
             if (loc_stat & machine::LOCSTAT_DIRTY) {
                 QBrush bgd(Qt::yellow);
                 return bgd;
@@ -153,12 +193,29 @@ void MemoryModel::setup(machine::Machine *machine) {
         connect(
             machine, &machine::Machine::post_tick, this,
             &MemoryModel::check_for_updates);
+        connect(
+            machine, &machine::Machine::snapshot_update, this,
+            &MemoryModel::snapshot_update);
+        if (machine->cache_data() != nullptr) {
+            connect(
+                machine->cache_data(),
+                &machine::FrontendMemory::changed_range_notify, this,
+                &MemoryModel::range_changed);
+        }
     }
     if (mem_access() != nullptr) {
+        connect(
+            mem_access(), &machine::FrontendMemory::changed_range_notify, this,
+            &MemoryModel::range_changed);
+        // External changes (e.g. assembler) arrive outside of machine tick.
+        connect(
+            mem_access(), &machine::FrontendMemory::external_change_notify,
+            this, &MemoryModel::range_changed);
         connect(
             mem_access(), &machine::FrontendMemory::external_change_notify,
             this, &MemoryModel::check_for_updates);
     }
+    update_snapshot_window();
     emit update_all();
     emit setup_done();
 }
@@ -166,6 +223,8 @@ void MemoryModel::setup(machine::Machine *machine) {
 void MemoryModel::setCellsPerRow(unsigned int cells) {
     beginResetModel();
     cells_per_row = cells;
+    invalidate_all_rows();
+    update_snapshot_window();
     endResetModel();
 }
 
@@ -173,44 +232,116 @@ void MemoryModel::set_cell_size(int index) {
     beginResetModel();
     cell_size = (enum MemoryCellSize)index;
     index0_offset -= index0_offset.get_raw() % cellSizeBytes();
+    invalidate_all_rows();
+    update_snapshot_window();
     endResetModel();
     emit cell_size_changed();
 }
 
-void MemoryModel::update_all() {
-    const machine::FrontendMemory *mem;
-    mem = mem_access();
-    if (mem != nullptr) {
-        memory_change_counter = mem->get_change_counter();
-        if (machine->cache_data() != nullptr) {
-            cache_data_change_counter
-                = machine->cache_data()->get_change_counter();
-        }
+void MemoryModel::set_visible_rows(int first, int last) {
+    visible_first = std::max(first, 0);
+    visible_last = (last < 0) ? rowCount() - 1 : last;
+    update_snapshot_window();
+}
+
+void MemoryModel::update_snapshot_window() {
+    if (machine == nullptr) {
+        return;
     }
-    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+    int last = (visible_last < 0) ? rowCount() - 1 : visible_last;
+    machine::SnapshotWindowRequest request;
+    get_row_address(request.start, visible_first);
+    request.cell_bytes = cellSizeBytes();
+    request.cells = (last - visible_first + 1) * cells_per_row;
+    request.through_cache = access_through_cache > 0;
+    machine->set_snapshot_window(machine::SW_DATA, request);
 }
 
-void MemoryModel::check_for_updates() {
-    bool need_update = false;
-    const machine::FrontendMemory *mem;
-    mem = mem_access();
-    if (mem == nullptr) {
+void MemoryModel::snapshot_update(const machine::MachineSnapshot &snapshot) {
+    const machine::SnapshotWindow &window = snapshot.windows[machine::SW_DATA];
+    const bool moved = window.request != snapshot_window.request;
+    snapshot_window = window;
+    if (!moved) {
         return;
     }
+    // Rows scrolled into view during the run are shown from this snapshot.
+    int last = (visible_last < 0) ? rowCount() - 1 : visible_last;
+    invalidate_rows(visible_first, last);
+    dirty_first = (dirty_first < 0) ? visible_first
+                                    : std::min(dirty_first, visible_first);
+    dirty_last = std::max(dirty_last, last);
+}
 
-    if (memory_change_counter != mem->get_change_counter()) {
-        need_update = true;
+void MemoryModel::update_all() {
+    invalidate_all_rows();
+    dirty_first = dirty_last = -1;
+    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+}
+
+void MemoryModel::invalidate_rows(int first, int last) {
+    for (int row = first; row <= last; row++) {
+        rows[row].valid = false;
     }
-    if (machine->cache_data() != nullptr) {
-        if (cache_data_change_counter
-            != machine->cache_data()->get_change_counter()) {
-            need_update = true;
-        }
+}
+
+void MemoryModel::invalidate_all_rows() {
+    invalidate_rows(0, rowCount() - 1);
+}
+
+bool MemoryModel::get_rows_for_range(
+    int &first,
+    int &last,
+    machine::Address start_addr,
+    machine::Address last_addr) const {
+    const uint64_t row_bytes = cells_per_row * cellSizeBytes();
+    const machine::Address window_last
+        = index0_offset + (row_bytes * rowCount() - 1);
+    if (last_addr < index0_offset || start_addr > window_last) {
+        return false;
+    }
+    first = (start_addr <= index0_offset)
+                ? 0
+                : (int)((start_addr - index0_offset) / row_bytes);
+    last = (last_addr >= window_last)
+               ? rowCount() - 1
+               : (int)((last_addr - index0_offset) / row_bytes);
+    return true;
+}
+
+void MemoryModel::range_changed(
+    const machine::FrontendMemory *issuing_memory,
+    machine::Address start_addr,
+    machine::Address last_addr) {
+    (void)issuing_memory;
+    int first, last;
+    if (!get_rows_for_range(first, last, start_addr, last_addr)) {
+        return;
     }
-    if (!need_update) {
+    invalidate_rows(first, last);
+    // Rows out of view are only invalidated, they will be read when shown.
+    int visible_last_row = (visible_last < 0) ? rowCount() - 1 : visible_last;
+    first = std::max(first, visible_first);
+    last = std::min(last, visible_last_row);
+    if (first > last) {
         return;
     }
-    update_all();
+    if (dirty_first < 0) {
+        dirty_first = first;
+        dirty_last = last;
+    } else {
+        dirty_first = std::min(dirty_first, first);
+        dirty_last = std::max(dirty_last, last);
+    }
+}
+
+void MemoryModel::check_for_updates() {
+    if (dirty_first < 0) {
+        return;
+    }
+    int first = dirty_first;
+    int last = dirty_last;
+    dirty_first = dirty_last = -1;
+    emit dataChanged(index(first, 0), index(last, columnCount() - 1));
 }
 
 bool MemoryModel::adjustRowAndOffset(int &row, machine::Address address) {
@@ -228,11 +359,14 @@ bool MemoryModel::adjustRowAndOffset(int &row, machine::Address address) {
     } else {
         index0_offset = address - diff;
     }
+    invalidate_all_rows();
+    update_snapshot_window();
     return get_row_for_address(row, address);
 }
 
 void MemoryModel::cached_access(int cached) {
     access_through_cache = cached;
+    update_snapshot_window();
     update_all();
 }
 
@@ -262,6 +396,9 @@ bool MemoryModel::setData(
         if (index.column() == 0 || machine == nullptr) {
             return false;
         }
+        if (machine->background_running()) {
+            return false; // Memory is owned by the simulation thread.
+        }
         mem = mem_access_rw();
         if (mem == nullptr) {
             return false;
@@ -277,6 +414,9 @@ bool MemoryModel::setData(
         default:
         case CELLSIZE_WORD: mem->write_u32(address, data,ae::INTERNAL); break;
         }
+        // Edit does not happen during machine tick, publish it right away.
+        mem->flush_changed_range();
+        check_for_updates();
     }
     return true;
 }
@@ -5,6 +5,7 @@
 
 #include <QAbstractTableModel>
 #include <QFont>
+#include <vector>
 
 class MemoryModel : public QAbstractTableModel {
     Q_OBJECT
@@ -70,27 +71,62 @@ public:
         return true;
     }
 
+    /**
+     * Rows currently shown by the view. Changes outside of this window only
+     * invalidate the row cache, no repaint is requested for them.
+     */
+    void set_visible_rows(int first, int last);
+
 public slots:
     void setup(machine::Machine *machine);
     void set_cell_size(int index);
     void check_for_updates();
+    void range_changed(
+        const machine::FrontendMemory *issuing_memory,
+        machine::Address start_addr,
+        machine::Address last_addr);
     void cached_access(int cached);
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 signals:
     void cell_size_changed();
     void setup_done();
 
 private:
+    /**
+     * Cells of one row as last read from memory. Filled on first paint after
+     * invalidation, so repaint does not touch simulated memory at all.
+     */
+    struct RowCache {
+        bool valid = false;
+        std::vector<uint32_t> data;
+        std::vector<machine::LocationStatus> loc_stat;
+    };
+
     const machine::FrontendMemory *mem_access() const;
     machine::FrontendMemory *mem_access_rw() const;
+    const RowCache &row_cache(int row) const;
+    void invalidate_rows(int first, int last);
+    void invalidate_all_rows();
+    /** Ask for the visible cells in snapshots of background run. */
+    void update_snapshot_window();
+    bool get_rows_for_range(
+        int &first,
+        int &last,
+        machine::Address start_addr,
+        machine::Address last_addr) const;
+    mutable std::vector<RowCache> rows;
+    int visible_first = 0;
+    int visible_last = -1;
+    int dirty_first = -1;
+    int dirty_last = -1;
     enum MemoryCellSize cell_size;
     unsigned int cells_per_row;
     machine::Address index0_offset;
     QFont data_font;
     machine::Machine *machine;
-    uint32_t memory_change_counter;
-    uint32_t cache_data_change_counter;
     int access_through_cache;
+    machine::SnapshotWindow snapshot_window; // Cells of the last snapshot
 };
 
 #endif // MEMORYMODEL_H
@@ -156,6 +156,15 @@ void MemoryTableView::adjust_scroll_pos_process() {
     m->get_row_address(address, rowAt(0));
     addr0_save_change(address);
     emit address_changed(address);
+    update_visible_rows();
+}
+
+void MemoryTableView::update_visible_rows() {
+    MemoryModel *m = dynamic_cast<MemoryModel *>(model());
+    if (m == nullptr) {
+        return;
+    }
+    m->set_visible_rows(rowAt(0), rowAt(viewport()->height() - 1));
 }
 
 void MemoryTableView::resizeEvent(QResizeEvent *event) {
@@ -176,6 +185,7 @@ void MemoryTableView::resizeEvent(QResizeEvent *event) {
         initial_address = machine::Address::null();
         go_to_address(address);
     }
+    update_visible_rows();
 }
 
 void MemoryTableView::go_to_address(machine::Address address) {
@@ -0,0 +1,127 @@
+#include "pixelconvert.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define PIXELCONVERT_SSE2 1
+    #include <emmintrin.h>
+#endif
+#if defined(PIXELCONVERT_SSE2) && defined(__GNUC__)
+    // GCC and clang can compile AVX2 function without -mavx2 for the whole
+    // unit, it is only used after a runtime check.
+    #define PIXELCONVERT_AVX2 1
+    #include <immintrin.h>
+#endif
+
+static void convert_scalar(const uint8_t *src, uint32_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t pixel = ((uint32_t)src[2 * i] << 8u) | src[2 * i + 1];
+        uint32_t r = ((pixel >> 11u) & 0x1fu) << 3u;
+        uint32_t g = ((pixel >> 5u) & 0x3fu) << 2u;
+        uint32_t b = (pixel & 0x1fu) << 3u;
+        dst[i] = 0xff000000u | (r << 16u) | (g << 8u) | b;
+    }
+}
+
+#ifdef PIXELCONVERT_SSE2
+/**
+ * 8 pixels per iteration. Within 16-bit lanes (after byte swap):
+ *  r = (p >> 8) & 0xf8, g = (p >> 3) & 0xfc, b = (p << 3) & 0xf8
+ * Low half of the output pixel is g:b, high half is 0xff:r, interleaving
+ * both halves gives the final 32-bit pixels.
+ */
+static void convert_sse2(const uint8_t *src, uint32_t *dst, size_t count) {
+    const __m128i mask_r = _mm_set1_epi16(0x00f8);
+    const __m128i mask_g = _mm_set1_epi16(0x00fc);
+    const __m128i mask_b = _mm_set1_epi16(0x00f8);
+    const __m128i alpha = _mm_set1_epi16((short)0xff00);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i be = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        __m128i p = _mm_or_si128(_mm_slli_epi16(be, 8), _mm_srli_epi16(be, 8));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(p, 8), mask_r);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(p, 3), mask_g);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(p, 3), mask_b);
+        __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+        __m128i ar = _mm_or_si128(alpha, r);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(gb, ar));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(gb, ar));
+    }
+    convert_scalar(src + 2 * i, dst + i, count - i);
+}
+#endif
+
+#ifdef PIXELCONVERT_AVX2
+/**
+ * Same as SSE2 version with 16 pixels per iteration. Unpack works within
+ * 128-bit lanes, so the halves are reordered before store.
+ */
+__attribute__((target("avx2"))) static void
+convert_avx2(const uint8_t *src, uint32_t *dst, size_t count) {
+    const __m256i mask_r = _mm256_set1_epi16(0x00f8);
+    const __m256i mask_g = _mm256_set1_epi16(0x00fc);
+    const __m256i mask_b = _mm256_set1_epi16(0x00f8);
+    const __m256i alpha = _mm256_set1_epi16((short)0xff00);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i be = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        __m256i p = _mm256_or_si256(
+            _mm256_slli_epi16(be, 8), _mm256_srli_epi16(be, 8));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi16(p, 8), mask_r);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(p, 3), mask_g);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi16(p, 3), mask_b);
+        __m256i gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+        __m256i ar = _mm256_or_si256(alpha, r);
+        __m256i lo = _mm256_unpacklo_epi16(gb, ar); // pixels 0-3, 8-11
+        __m256i hi = _mm256_unpackhi_epi16(gb, ar); // pixels 4-7, 12-15
+        _mm256_storeu_si256(
+            (__m256i *)(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(
+            (__m256i *)(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    convert_sse2(src + 2 * i, dst + i, count - i);
+}
+#endif
+
+using ConvertFn = void (*)(const uint8_t *, uint32_t *, size_t);
+
+static ConvertFn select_convert() {
+#ifdef PIXELCONVERT_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return convert_avx2;
+    }
+#endif
+#ifdef PIXELCONVERT_SSE2
+    return convert_sse2;
+#else
+    return convert_scalar;
+#endif
+}
+
+void convert_rgb565be_to_argb32(
+    const uint8_t *src,
+    uint32_t *dst,
+    size_t pixel_count) {
+    static const ConvertFn convert = select_convert();
+    convert(src, dst, pixel_count);
+}
+
+std::vector<int> nearest_neighbour_map(int src_size, int dst_size) {
+    std::vector<int> map(dst_size > 0 ? dst_size : 0);
+    for (int i = 0; i < dst_size; i++) {
+        // Sample at pixel centre, integer only to avoid rounding drift.
+        int64_t src = ((int64_t)(2 * i + 1) * src_size) / (2 * dst_size);
+        map[i] = src < src_size ? (int)src : src_size - 1;
+    }
+    return map;
+}
+
+void scale_line_nearest(
+    const uint32_t *src,
+    uint32_t *dst,
+    const std::vector<int> &map,
+    int dst_begin,
+    int dst_end) {
+    for (int i = dst_begin; i < dst_end; i++) {
+        dst[i] = src[map[i]];
+    }
+}
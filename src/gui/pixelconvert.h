@@ -0,0 +1,39 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Convert a run of big endian RGB565 pixels (LCD framebuffer layout) to
+ * 0xffRRGGBB (QImage::Format_RGB32/ARGB32).
+ *
+ * Uses AVX2 or SSE2 when available on the host CPU, scalar code otherwise.
+ * Channels are expanded by shift only (low bits are zero), matching the
+ * original per pixel conversion.
+ */
+void convert_rgb565be_to_argb32(
+    const uint8_t *src,
+    uint32_t *dst,
+    size_t pixel_count);
+
+/**
+ * Nearest-neighbour index map from `dst_size` destination pixels to
+ * `src_size` source pixels.
+ */
+std::vector<int> nearest_neighbour_map(int src_size, int dst_size);
+
+/**
+ * Scale one line using a map produced by `nearest_neighbour_map`.
+ *
+ * Only destination pixels in [dst_begin, dst_end) are written.
+ */
+void scale_line_nearest(
+    const uint32_t *src,
+    uint32_t *dst,
+    const std::vector<int> &map,
+    int dst_begin,
+    int dst_end);
+
+#endif // PIXELCONVERT_H
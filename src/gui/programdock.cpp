@@ -101,6 +101,9 @@ void ProgramDock::setup(machine::Machine *machine) {
         address = pc;
     }
     update_follow_position();
+    connect(
+        machine, &machine::Machine::snapshot_update, this,
+        &ProgramDock::snapshot_update);
 }
 
 void ProgramDock::set_follow_inst(int follow) {
@@ -159,6 +162,14 @@ void ProgramDock::writeback_inst_addr(machine::Address addr) {
     }
 }
 
+void ProgramDock::snapshot_update(const machine::MachineSnapshot &snapshot) {
+    fetch_inst_addr(snapshot.fetch_addr);
+    decode_inst_addr(snapshot.decode_addr);
+    execute_inst_addr(snapshot.execute_addr);
+    memory_inst_addr(snapshot.memory_addr);
+    writeback_inst_addr(snapshot.writeback_addr);
+}
+
 void ProgramDock::update_follow_position() {
     if (follow_source != FOLLOWSRC_NONE) {
         emit focus_addr(follow_addr[follow_source]);
@@ -32,6 +32,7 @@ public slots:
     void execute_inst_addr(machine::Address addr);
     void memory_inst_addr(machine::Address addr);
     void writeback_inst_addr(machine::Address addr);
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
     void report_error(const QString &error);
 
 private:
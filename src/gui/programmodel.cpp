@@ -12,12 +12,10 @@ ProgramModel::ProgramModel(QObject *parent)
     index0_offset = machine::Address::null();
     data_font.setStyleHint(QFont::TypeWriter);
     machine = nullptr;
-    memory_change_counter = 0;
-    cache_program_change_counter = 0;
     for (auto &i : stage_addr) {
         i = machine::STAGEADDR_NONE;
     }
-    stages_need_update = false;
+    rows.resize(rowCount());
 }
 
 const machine::FrontendMemory *ProgramModel::mem_access() const {
@@ -67,9 +65,39 @@ QVariant ProgramModel::headerData(
     return Super::headerData(section, orientation, role);
 }
 
-QVariant ProgramModel::data(const QModelIndex &index, int role) const {
-    const machine::FrontendMemory *mem;
+const ProgramModel::RowCache &ProgramModel::row_cache(int row) const {
+    RowCache &rc = rows[row];
+    if (rc.valid) {
+        return rc;
+    }
+    rc = RowCache();
+    rc.valid = true;
+
+    machine::Address address;
+    const machine::FrontendMemory *mem = mem_access();
+    if (mem == nullptr || !get_row_address(address, row)) {
+        return rc;
+    }
+    uint32_t code;
+    if (machine->background_running()) {
+        // Memory is owned by the simulation thread, use its last copy.
+        if (!snapshot_window.cell(address, code, rc.loc_stat)) {
+            rc.valid = false; // Filled by a later snapshot.
+            return rc;
+        }
+    } else {
+        code = mem->read_u32(address, ae::INTERNAL);
+        if (machine->cache_program() != nullptr) {
+            rc.loc_stat = machine->cache_program()->location_status(address);
+        }
+    }
+    machine::Instruction inst(code);
+    rc.code = inst.data();
+    rc.text = inst.to_str(address);
+    return rc;
+}
 
+QVariant ProgramModel::data(const QModelIndex &index, int role) const {
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         QString s, t;
         machine::Address address;
@@ -83,13 +111,10 @@ QVariant ProgramModel::data(const QModelIndex &index, int role) const {
             return "0x" + s + t.toUpper();
         }
 
-        mem = mem_access();
-        if (mem == nullptr) {
+        if (mem_access() == nullptr) {
             return QString(" ");
         }
 
-        machine::Instruction inst(mem->read_u32(address));
-
         switch (index.column()) {
         case 0:
             if (machine->is_hwbreak(address)) {
@@ -98,10 +123,10 @@ QVariant ProgramModel::data(const QModelIndex &index, int role) const {
                 return QString(" ");
             }
         case 2:
-            t = QString::number(inst.data(), 16);
+            t = QString::number(row_cache(index.row()).code, 16);
             s.fill('0', 8 - t.count());
             return s + t.toUpper();
-        case 3: return inst.to_str(address);
+        case 3: return row_cache(index.row()).text;
         default: return tr("");
         }
     }
@@ -111,9 +136,7 @@ QVariant ProgramModel::data(const QModelIndex &index, int role) const {
             return QVariant();
         }
         if (index.column() == 2 && machine->cache_program() != nullptr) {
-            machine::LocationStatus loc_stat;
-            loc_stat = machine->cache_program()->location_status(address);
-            if (loc_stat & machine::LOCSTAT_CACHED) {
+            if (row_cache(index.row()).loc_stat & machine::LOCSTAT_CACHED) {
                 QBrush bgd(Qt::lightGray);
                 return bgd;
             }
@@ -155,50 +178,145 @@ void ProgramModel::setup(machine::Machine *machine) {
         connect(
             machine, &machine::Machine::post_tick, this,
             &ProgramModel::check_for_updates);
+        connect(
+            machine, &machine::Machine::snapshot_update, this,
+            &ProgramModel::snapshot_update);
+        if (machine->cache_program() != nullptr) {
+            connect(
+                machine->cache_program(),
+                &machine::FrontendMemory::changed_range_notify, this,
+                &ProgramModel::range_changed);
+        }
     }
     if (mem_access() != nullptr) {
+        connect(
+            mem_access(), &machine::FrontendMemory::changed_range_notify, this,
+            &ProgramModel::range_changed);
+        // External changes (e.g. assembler) arrive outside of machine tick.
+        connect(
+            mem_access(), &machine::FrontendMemory::external_change_notify,
+            this, &ProgramModel::range_changed);
         connect(
             mem_access(), &machine::FrontendMemory::external_change_notify,
             this, &ProgramModel::check_for_updates);
     }
+    update_snapshot_window();
     emit update_all();
 }
 
-void ProgramModel::update_all() {
-    const machine::FrontendMemory *mem;
-    mem = mem_access();
-    if (mem != nullptr) {
-        memory_change_counter = mem->get_change_counter();
-        if (machine->cache_program() != nullptr) {
-            cache_program_change_counter
-                = machine->cache_program()->get_change_counter();
-        }
+void ProgramModel::set_visible_rows(int first, int last) {
+    visible_first = std::max(first, 0);
+    visible_last = (last < 0) ? rowCount() - 1 : last;
+    update_snapshot_window();
+}
+
+void ProgramModel::update_snapshot_window() {
+    if (machine == nullptr) {
+        return;
     }
-    stages_need_update = false;
+    int last = (visible_last < 0) ? rowCount() - 1 : visible_last;
+    machine::SnapshotWindowRequest request;
+    get_row_address(request.start, visible_first);
+    request.cell_bytes = cellSizeBytes();
+    request.cells = last - visible_first + 1;
+    machine->set_snapshot_window(machine::SW_PROGRAM, request);
+}
+
+void ProgramModel::snapshot_update(const machine::MachineSnapshot &snapshot) {
+    const machine::SnapshotWindow &window
+        = snapshot.windows[machine::SW_PROGRAM];
+    const bool moved = window.request != snapshot_window.request;
+    snapshot_window = window;
+    if (moved) {
+        // Rows scrolled into view during the run are shown from this one.
+        int last = (visible_last < 0) ? rowCount() - 1 : visible_last;
+        invalidate_rows(visible_first, last);
+        mark_rows_dirty(visible_first, last);
+    }
+}
+
+void ProgramModel::update_all() {
+    invalidate_all_rows();
+    dirty_first = dirty_last = -1;
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
 }
 
-void ProgramModel::check_for_updates() {
-    bool need_update = stages_need_update;
-    const machine::FrontendMemory *mem;
-    mem = mem_access();
-    if (mem == nullptr) {
+void ProgramModel::invalidate_rows(int first, int last) {
+    for (int row = first; row <= last; row++) {
+        rows[row].valid = false;
+    }
+}
+
+void ProgramModel::invalidate_all_rows() {
+    invalidate_rows(0, rowCount() - 1);
+}
+
+void ProgramModel::mark_rows_dirty(int first, int last) {
+    // Rows out of view are not repainted, they will be read when shown.
+    int visible_last_row = (visible_last < 0) ? rowCount() - 1 : visible_last;
+    first = std::max(first, visible_first);
+    last = std::min(last, visible_last_row);
+    if (first > last) {
         return;
     }
+    if (dirty_first < 0) {
+        dirty_first = first;
+        dirty_last = last;
+    } else {
+        dirty_first = std::min(dirty_first, first);
+        dirty_last = std::max(dirty_last, last);
+    }
+}
 
-    if (memory_change_counter != mem->get_change_counter()) {
-        need_update = true;
+void ProgramModel::mark_address_dirty(machine::Address address) {
+    int row;
+    if (address == machine::STAGEADDR_NONE
+        || !get_row_for_address(row, address) || row >= rowCount()) {
+        return;
     }
-    if (machine->cache_data() != nullptr) {
-        if (cache_program_change_counter
-            != machine->cache_program()->get_change_counter()) {
-            need_update = true;
-        }
+    mark_rows_dirty(row, row);
+}
+
+bool ProgramModel::get_rows_for_range(
+    int &first,
+    int &last,
+    machine::Address start_addr,
+    machine::Address last_addr) const {
+    const machine::Address window_last
+        = index0_offset + (cellSizeBytes() * rowCount() - 1);
+    if (last_addr < index0_offset || start_addr > window_last) {
+        return false;
     }
-    if (!need_update) {
+    first = (start_addr <= index0_offset)
+                ? 0
+                : (int)((start_addr - index0_offset) / cellSizeBytes());
+    last = (last_addr >= window_last)
+               ? rowCount() - 1
+               : (int)((last_addr - index0_offset) / cellSizeBytes());
+    return true;
+}
+
+void ProgramModel::range_changed(
+    const machine::FrontendMemory *issuing_memory,
+    machine::Address start_addr,
+    machine::Address last_addr) {
+    (void)issuing_memory;
+    int first, last;
+    if (!get_rows_for_range(first, last, start_addr, last_addr)) {
+        return;
+    }
+    invalidate_rows(first, last);
+    mark_rows_dirty(first, last);
+}
+
+void ProgramModel::check_for_updates() {
+    if (dirty_first < 0) {
         return;
     }
-    update_all();
+    int first = dirty_first;
+    int last = dirty_last;
+    dirty_first = dirty_last = -1;
+    emit dataChanged(index(first, 0), index(last, columnCount() - 1));
 }
 
 bool ProgramModel::adjustRowAndOffset(int &row, machine::Address address) {
@@ -216,6 +334,8 @@ bool ProgramModel::adjustRowAndOffset(int &row, machine::Address address) {
     } else {
         index0_offset = address - diff;
     }
+    invalidate_all_rows();
+    update_snapshot_window();
     return get_row_for_address(row, address);
 }
 
@@ -234,7 +354,8 @@ void ProgramModel::toggle_hw_break(const QModelIndex &index) {
     } else {
         machine->insert_hwbreak(address);
     }
-    update_all();
+    mark_rows_dirty(index.row(), index.row());
+    check_for_updates();
 }
 
 Qt::ItemFlags ProgramModel::flags(const QModelIndex &index) const {
@@ -286,6 +407,9 @@ bool ProgramModel::setData(
             break;
         default: return false;
         }
+        // Edit does not happen during machine tick, publish it right away.
+        mem->flush_changed_range();
+        check_for_updates();
     }
     return true;
 }
@@ -293,8 +417,10 @@ bool ProgramModel::setData(
 void ProgramModel::update_stage_addr(uint stage, machine::Address addr) {
     if (stage < STAGEADDR_COUNT) {
         if (stage_addr[stage] != addr) {
+            // Only stage highlight changes, row content stays cached.
+            mark_address_dirty(stage_addr[stage]);
             stage_addr[stage] = addr;
-            stages_need_update = true;
+            mark_address_dirty(addr);
         }
     }
 }
@@ -5,6 +5,7 @@
 
 #include <QAbstractTableModel>
 #include <QFont>
+#include <vector>
 
 class ProgramModel : public QAbstractTableModel {
     Q_OBJECT
@@ -52,6 +53,12 @@ public:
         return true;
     }
 
+    /**
+     * Rows currently shown by the view. Changes outside of this window only
+     * invalidate the row cache, no repaint is requested for them.
+     */
+    void set_visible_rows(int first, int last);
+
     enum StageAddress {
         STAGEADDR_FETCH,
         STAGEADDR_DECODE,
@@ -66,20 +73,51 @@ signals:
 public slots:
     void setup(machine::Machine *machine);
     void check_for_updates();
+    void range_changed(
+        const machine::FrontendMemory *issuing_memory,
+        machine::Address start_addr,
+        machine::Address last_addr);
     void toggle_hw_break(const QModelIndex &index);
     void update_stage_addr(uint stage, machine::Address addr);
     void update_all();
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 private:
+    /**
+     * Instruction of one row as last read and disassembled. Filled on first
+     * paint after invalidation, so repaint does not touch simulated memory.
+     */
+    struct RowCache {
+        bool valid = false;
+        uint32_t code = 0;
+        QString text;
+        machine::LocationStatus loc_stat = machine::LOCSTAT_NONE;
+    };
+
     const machine::FrontendMemory *mem_access() const;
     machine::FrontendMemory *mem_access_rw() const;
+    const RowCache &row_cache(int row) const;
+    void invalidate_rows(int first, int last);
+    void invalidate_all_rows();
+    void mark_rows_dirty(int first, int last);
+    void mark_address_dirty(machine::Address address);
+    /** Ask for the visible instructions in snapshots of background run. */
+    void update_snapshot_window();
+    bool get_rows_for_range(
+        int &first,
+        int &last,
+        machine::Address start_addr,
+        machine::Address last_addr) const;
     machine::Address index0_offset;
     QFont data_font;
     machine::Machine *machine;
-    uint32_t memory_change_counter;
-    uint32_t cache_program_change_counter;
     machine::Address stage_addr[STAGEADDR_COUNT] {};
-    bool stages_need_update;
+    mutable std::vector<RowCache> rows;
+    int visible_first = 0;
+    int visible_last = -1;
+    int dirty_first = -1;
+    int dirty_last = -1;
+    machine::SnapshotWindow snapshot_window; // Code of the last snapshot
 };
 
 #endif // PROGRAMMODEL_H
@@ -134,6 +134,15 @@ void ProgramTableView::adjust_scroll_pos_process() {
         addr0_save_change(address);
     }
     emit address_changed(address.get_raw());
+    update_visible_rows();
+}
+
+void ProgramTableView::update_visible_rows() {
+    ProgramModel *m = dynamic_cast<ProgramModel *>(model());
+    if (m == nullptr) {
+        return;
+    }
+    m->set_visible_rows(rowAt(0), rowAt(viewport()->height() - 1));
 }
 
 void ProgramTableView::resizeEvent(QResizeEvent *event) {
@@ -154,6 +163,7 @@ void ProgramTableView::resizeEvent(QResizeEvent *event) {
         initial_address = machine::Address::null();
         go_to_address(address);
     }
+    update_visible_rows();
 }
 
 void ProgramTableView::go_to_address_priv(machine::Address address) {
@@ -35,6 +35,7 @@ private:
     void go_to_address_priv(machine::Address address);
     void addr0_save_change(machine::Address val);
     void adjustColumnCount();
+    void update_visible_rows();
     QSettings *settings;
 
     machine::Address initial_address;
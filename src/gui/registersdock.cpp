@@ -75,66 +75,61 @@ void RegistersDock::setup(machine::Machine *machine) {
     }
 
     const machine::Registers *regs = machine->registers();
+    set_xlen(machine->config().get_simulated_xlen());
 
     // Load values
     labelVal(pc, regs->read_pc().get_raw());
-    labelVal(hi, regs->read_hi_lo(true).as_u32());
-    labelVal(lo, regs->read_hi_lo(false).as_u32());
+    labelVal(hi, regVal(regs->read_hi_lo(true)));
+    labelVal(lo, regVal(regs->read_hi_lo(false)));
     for (int i = 0; i < 32; i++) {
-        labelVal(gp[i], regs->read_gp(i).as_u32());
+        labelVal(gp[i], regVal(regs->peek_gp(i)));
     }
 
     connect(
         regs, &machine::Registers::pc_update, this, &RegistersDock::pc_changed);
     connect(
-        regs, &machine::Registers::gp_update, this, &RegistersDock::gp_changed);
+        regs, &machine::Registers::step_changes, this,
+        &RegistersDock::gp_changes);
     connect(
         regs, &machine::Registers::hi_lo_update, this,
         &RegistersDock::hi_lo_changed);
-    connect(regs, &machine::Registers::gp_read, this, &RegistersDock::gp_read);
     connect(
         regs, &machine::Registers::hi_lo_read, this,
         &RegistersDock::hi_lo_read);
     connect(
         machine, &machine::Machine::tick, this,
         &RegistersDock::clear_highlights);
+    connect(
+        machine, &machine::Machine::snapshot_update, this,
+        &RegistersDock::snapshot_update);
 }
 
 void RegistersDock::pc_changed(machine::Address val) {
     labelVal(pc, val.get_raw());
 }
 
-void RegistersDock::gp_changed(
-    machine::RegisterId i,
-    machine::RegisterValue val) {
-    SANITY_ASSERT(
-        i.data < 32,
-        QString("RegistersDock received signal with invalid gp register: ")
-            + QString::number(i.data));
-    labelVal(gp[i.data], val.as_u32());
-    gp[i.data]->setPalette(pal_updated);
-    gp_highlighted |= 1 << i.data;
-}
-
-void RegistersDock::gp_read(machine::RegisterId i, machine::RegisterValue val) {
-    (void)val;
-    SANITY_ASSERT(
-        i.data < 32,
-        QString("RegistersDock received signal with invalid gp register: ")
-            + QString::number(i.data));
-    if (!(gp_highlighted & (1 << i.data))) {
-        gp[i.data]->setPalette(pal_read);
-        gp_highlighted |= 1 << i.data;
+void RegistersDock::gp_changes(const machine::RegisterJournal &changes) {
+    for (const machine::RegisterChange &change : changes.writes) {
+        labelVal(gp[change.reg.data], regVal(change.new_value));
+        gp[change.reg.data]->setPalette(pal_updated);
+        gp_highlighted |= 1 << change.reg.data;
+    }
+    uint32_t read = changes.read_mask & ~gp_highlighted;
+    for (int i = 0; i < 32; i++) {
+        if (read & (1u << i)) {
+            gp[i]->setPalette(pal_read);
+        }
     }
+    gp_highlighted |= read;
 }
 
 void RegistersDock::hi_lo_changed(bool hi, machine::RegisterValue val) {
     if (hi) {
-        labelVal(this->hi, val.as_u32());
+        labelVal(this->hi, regVal(val));
         this->hi->setPalette(pal_updated);
         hi_highlighted = true;
     } else {
-        labelVal(lo, val.as_u32());
+        labelVal(lo, regVal(val));
         this->lo->setPalette(pal_updated);
         lo_highlighted = true;
     }
@@ -155,6 +150,27 @@ void RegistersDock::hi_lo_read(bool hi, machine::RegisterValue val) {
     }
 }
 
+void RegistersDock::snapshot_update(
+    const machine::MachineSnapshot &snapshot) {
+    // Register signals are blocked during background run, highlight registers
+    // changed since the previous snapshot instead.
+    labelVal(pc, snapshot.pc.get_raw());
+    for (int i = 1; i < 32; i++) {
+        if (labelValChanged(gp[i], regVal(snapshot.gp[i]))) {
+            gp[i]->setPalette(pal_updated);
+            gp_highlighted |= 1 << i;
+        }
+    }
+    if (labelValChanged(hi, regVal(snapshot.hi))) {
+        hi->setPalette(pal_updated);
+        hi_highlighted = true;
+    }
+    if (labelValChanged(lo, regVal(snapshot.lo))) {
+        lo->setPalette(pal_updated);
+        lo_highlighted = true;
+    }
+}
+
 void RegistersDock::clear_highlights() {
     if (hi_highlighted) {
         this->hi->setPalette(pal_normal);
@@ -174,7 +190,37 @@ void RegistersDock::clear_highlights() {
     lo_highlighted = false;
 }
 
-void RegistersDock::labelVal(QLabel *label, uint32_t value) {
+void RegistersDock::set_xlen(machine::Xlen xlen) {
+    unsigned digits = xlen == machine::Xlen::_64 ? 16 : 8;
+    if (digits == xlen_digits) {
+        return;
+    }
+    xlen_digits = digits;
+    QString widest = QString("0x") + QString(digits, '0');
+    for (QLabel *label : { pc, hi, lo }) {
+        label->setText(widest);
+        label->setFixedSize(label->sizeHint());
+    }
+    for (QLabel *label : gp) {
+        label->setText(widest);
+        label->setFixedSize(label->sizeHint());
+    }
+}
+
+uint64_t RegistersDock::regVal(machine::RegisterValue val) const {
+    return xlen_digits == 16 ? val.as_u64() : regVal(val);
+}
+
+void RegistersDock::labelVal(QLabel *label, uint64_t value) {
     QString t = QString("0x") + QString::number(value, 16);
     label->setText(t);
 }
+
+bool RegistersDock::labelValChanged(QLabel *label, uint64_t value) {
+    QString t = QString("0x") + QString::number(value, 16);
+    if (label->text() == t) {
+        return false;
+    }
+    label->setText(t);
+    return true;
+}
@@ -21,11 +21,11 @@ public:
 
 private slots:
     void pc_changed(machine::Address val);
-    void gp_changed(machine::RegisterId i, machine::RegisterValue val);
     void hi_lo_changed(bool hi, machine::RegisterValue val);
-    void gp_read(machine::RegisterId i, machine::RegisterValue val);
+    void gp_changes(const machine::RegisterJournal &changes);
     void hi_lo_read(bool hi, machine::RegisterValue val);
     void clear_highlights();
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 private:
     StaticTable *widg;
@@ -44,7 +44,14 @@ private:
     QPalette pal_updated;
     QPalette pal_read;
 
-    void labelVal(QLabel *label, uint32_t val);
+    unsigned xlen_digits = 8; // Hexadecimal digits of register value
+
+    /** Fit labels to register values of the simulated XLEN. */
+    void set_xlen(machine::Xlen xlen);
+    /** Register value of the simulated XLEN width. */
+    uint64_t regVal(machine::RegisterValue val) const;
+    void labelVal(QLabel *label, uint64_t val);
+    bool labelValChanged(QLabel *label, uint64_t val);
 };
 
 #endif // REGISTERSDOCK_H
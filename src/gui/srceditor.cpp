@@ -5,9 +5,12 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QHelpEvent>
 #include <QPalette>
+#include <QScrollBar>
 #include <QTextCursor>
 #include <QTextDocumentWriter>
+#include <QToolTip>
 
 void SrcEditor::setup_common() {
     QFont font;
@@ -26,6 +29,10 @@ void SrcEditor::setup_common() {
     setPalette(p);
 
     setTextColor(Qt::black);
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
+        update_visible_blocks();
+    });
 }
 
 SrcEditor::SrcEditor(QWidget *parent) : Super(parent) {
@@ -62,6 +69,7 @@ void SrcEditor::setFileName(const QString &filename) {
         highlighter = new HighlighterC(document());
     } else {
         highlighter = new HighlighterAsm(document());
+        update_visible_blocks();
     }
 }
 
@@ -123,3 +131,35 @@ void SrcEditor::setSaveAsRequired(bool val) {
 bool SrcEditor::saveAsRequired() const {
     return saveAsRequiredFl;
 }
+
+void SrcEditor::update_visible_blocks() {
+    auto *asm_highlighter = qobject_cast<HighlighterAsm *>(highlighter);
+    if (asm_highlighter == nullptr) {
+        return;
+    }
+    int first = cursorForPosition(QPoint(0, 0)).blockNumber();
+    int last = cursorForPosition(QPoint(0, viewport()->height() - 1))
+                   .blockNumber();
+    asm_highlighter->set_visible_blocks(first, last);
+}
+
+void SrcEditor::resizeEvent(QResizeEvent *event) {
+    Super::resizeEvent(event);
+    update_visible_blocks();
+}
+
+bool SrcEditor::viewportEvent(QEvent *event) {
+    if ((event->type() == QEvent::ToolTip)
+        && (qobject_cast<HighlighterAsm *>(highlighter) != nullptr)) {
+        auto *help_event = static_cast<QHelpEvent *>(event);
+        QString error = HighlighterAsm::block_error(
+            cursorForPosition(help_event->pos()).block());
+        if (error.isEmpty()) {
+            QToolTip::hideText();
+        } else {
+            QToolTip::showText(help_event->globalPos(), error, this);
+        }
+        return true;
+    }
+    return Super::viewportEvent(event);
+}
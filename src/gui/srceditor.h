@@ -27,9 +27,15 @@ public:
     void setSaveAsRequired(bool val);
     bool saveAsRequired() const;
 
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
+
 private:
     QSyntaxHighlighter *highlighter {};
     void setup_common();
+    /** Tell highlighter which blocks are shown. */
+    void update_visible_blocks();
     QString fname;
     QString tname;
     bool saveAsRequiredFl {};
@@ -5,6 +5,7 @@
 #include <QString>
 #include <QTextBlock>
 #include <QTextCursor>
+#include <QThread>
 
 TerminalDock::TerminalDock(QWidget *parent, QSettings *settings)
     : QDockWidget(parent) {
@@ -36,11 +37,11 @@ void TerminalDock::setup(machine::SerialPort *ser_port) {
         return;
     }
     connect(
-        ser_port, &machine::SerialPort::tx_byte, this,
-        QOverload<unsigned int>::of(&TerminalDock::tx_byte));
+        ser_port, &machine::SerialPort::tx_bytes, this,
+        &TerminalDock::tx_bytes);
     connect(
         ser_port, &machine::SerialPort::rx_byte_pool, this,
-        &TerminalDock::rx_byte_pool);
+        &TerminalDock::rx_byte_pool, Qt::DirectConnection);
     connect(
         input_edit, &QLineEdit::textChanged, ser_port,
         &machine::SerialPort::rx_queue_check);
@@ -60,6 +61,17 @@ void TerminalDock::tx_byte(unsigned int data) {
     }
 }
 
+void TerminalDock::tx_bytes(const QByteArray &data) {
+    bool at_end = terminal_text->textCursor().atEnd();
+    // Newlines are inserted as block separators by the cursor.
+    append_cursor->insertText(QString::fromLatin1(data));
+    if (at_end) {
+        QTextCursor cursor = QTextCursor(terminal_text->document());
+        cursor.movePosition(QTextCursor::End);
+        terminal_text->setTextCursor(cursor);
+    }
+}
+
 void TerminalDock::tx_byte(int fd, unsigned int data) {
     (void)fd;
     tx_byte(data);
@@ -67,6 +79,16 @@ void TerminalDock::tx_byte(int fd, unsigned int data) {
 
 void TerminalDock::rx_byte_pool(int fd, unsigned int &data, bool &available) {
     (void)fd;
+    if (QThread::currentThread() != thread()) {
+        // Called from the simulation thread (background run), the input
+        // widget has to be accessed from GUI thread. Reference arguments
+        // cannot be queued, result is passed through members instead.
+        QMetaObject::invokeMethod(
+            this, "rx_byte_pool_gui", Qt::BlockingQueuedConnection);
+        data = rx_data;
+        available = rx_available;
+        return;
+    }
     QString str = input_edit->text();
     available = false;
     if (str.count() > 0) {
@@ -75,3 +97,7 @@ void TerminalDock::rx_byte_pool(int fd, unsigned int &data, bool &available) {
         available = true;
     }
 }
+
+void TerminalDock::rx_byte_pool_gui() {
+    rx_byte_pool(0, rx_data, rx_available);
+}
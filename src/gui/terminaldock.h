@@ -20,9 +20,13 @@ public:
 
 public slots:
     void tx_byte(unsigned int data);
+    void tx_bytes(const QByteArray &data);
     void tx_byte(int fd, unsigned int data);
     void rx_byte_pool(int fd, unsigned int &data, bool &available);
 
+private slots:
+    void rx_byte_pool_gui();
+
 private:
     QVBoxLayout *layout_box;
     QHBoxLayout *layout_bottom_box;
@@ -31,6 +35,8 @@ private:
     QTextEdit *terminal_text;
     QTextCursor *append_cursor;
     QLineEdit *input_edit;
+    unsigned int rx_data = 0;
+    bool rx_available = false;
 };
 
 #endif // TERMINALDOCK_H
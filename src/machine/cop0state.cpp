@@ -59,7 +59,7 @@ const Cop0State::cop0reg_desc_t Cop0State::cop0reg_desc[Cop0State::COP0REGS_CNT]
                                     &Cop0State::read_cop0reg_default,
                                     &Cop0State::write_cop0reg_default },
           [Cop0State::Count]
-          = { "Count", 0xffffffff, 0x00000000, &Cop0State::read_cop0reg_default,
+          = { "Count", 0xffffffff, 0x00000000, &Cop0State::read_cop0reg_count,
               &Cop0State::write_cop0reg_count_compare },
           [Cop0State::Compare] = { "Compare", 0xffffffff, 0x00000000,
                                    &Cop0State::read_cop0reg_default,
@@ -89,12 +89,17 @@ Cop0State::Cop0State(Core *core) : QObject() {
 Cop0State::Cop0State(const Cop0State &orig) : QObject() {
     this->core = orig.core;
     for (int i = 0; i < COP0REGS_CNT; i++) {
-        this->cop0reg[i] = orig.read_cop0reg((enum Cop0Registers)i);
+        this->cop0reg[i] = orig.cop0reg[i];
     }
+    count_base_cycles = orig.count_base_cycles;
+    timer_armed_count = orig.timer_armed_count;
+    timer_deadline = orig.timer_deadline;
+    next_event_cycle = orig.next_event_cycle;
 }
 
 void Cop0State::setup_core(Core *core) {
     this->core = core;
+    rebase_count(get_core_cycles());
 }
 
 uint32_t Cop0State::read_cop0reg(uint8_t rd, uint8_t sel) const {
@@ -139,6 +144,13 @@ void Cop0State::write_cop0reg(enum Cop0Registers reg, RegisterValue value) {
     (this->*cop0reg_desc[reg].reg_write)(reg, value.as_u32());
 }
 
+uint32_t Cop0State::peek_cop0reg(enum Cop0Registers reg) const {
+    if (reg == Count) {
+        return count_at(get_core_cycles());
+    }
+    return cop0reg[(int)reg];
+}
+
 QString Cop0State::cop0reg_name(enum Cop0Registers reg) {
     return QString(cop0reg_desc[(int)reg].name);
 }
@@ -150,10 +162,17 @@ uint32_t Cop0State::read_cop0reg_default(enum Cop0Registers reg) const {
     return val;
 }
 
+uint32_t Cop0State::read_cop0reg_count(enum Cop0Registers reg) const {
+    uint32_t val = count_at(get_core_cycles());
+    emit cop0reg_read(reg, val);
+    return val;
+}
+
 void Cop0State::write_cop0reg_default(enum Cop0Registers reg, uint32_t value) {
     uint32_t mask = cop0reg_desc[(int)reg].write_mask;
     cop0reg[(int)reg] = (value & mask) | (cop0reg[(int)reg] & ~mask);
     emit cop0reg_update(reg, cop0reg[(int)reg]);
+    events_due_now();
 }
 
 bool Cop0State::operator==(const Cop0State &c) const {
@@ -175,7 +194,8 @@ void Cop0State::reset() {
         this->cop0reg[i] = cop0reg_desc[i].init_value;
         emit cop0reg_update((enum Cop0Registers)i, cop0reg[i]);
     }
-    last_core_cycles = 0;
+    count_base_cycles = get_core_cycles();
+    arm_timer(count_base_cycles);
 }
 
 void Cop0State::update_execption_cause(
@@ -191,6 +211,7 @@ void Cop0State::update_execption_cause(
         cop0reg[(int)Cause] |= (int)excause << 2;
     }
     emit cop0reg_update(Cause, cop0reg[(int)Cause]);
+    events_due_now();
 }
 
 void Cop0State::set_interrupt_signal(uint irq_num, bool active) {
@@ -205,20 +226,29 @@ void Cop0State::set_interrupt_signal(uint irq_num, bool active) {
         cop0reg[(int)Cause] &= ~mask;
     }
     emit cop0reg_update(Cause, cop0reg[(int)Cause]);
+    events_due_now();
 }
 
 bool Cop0State::core_interrupt_request() {
     uint32_t irqs;
+    uint32_t core_cycles = get_core_cycles();
+
+    if ((int32_t)(core_cycles - next_event_cycle) < 0) {
+        return false;
+    }
 
-    update_count_and_compare_irq();
+    update_count_and_compare_irq(core_cycles);
 
     irqs = cop0reg[(int)Status];
     irqs &= cop0reg[(int)Cause];
     irqs &= Status_IntMask;
 
-    return irqs && cop0reg[(int)Status] & Status_IntMask
-           && !(cop0reg[(int)Status] & Status_EXL)
-           && !(cop0reg[(int)Status] & Status_ERL);
+    bool request = irqs && cop0reg[(int)Status] & Status_IntMask
+                   && !(cop0reg[(int)Status] & Status_EXL)
+                   && !(cop0reg[(int)Status] & Status_ERL);
+    // Pending request is checked again each cycle until it is accepted.
+    next_event_cycle = request ? core_cycles : timer_deadline;
+    return request;
 }
 
 void Cop0State::set_status_exl(bool value) {
@@ -228,6 +258,7 @@ void Cop0State::set_status_exl(bool value) {
         cop0reg[(int)Status] &= ~Status_EXL;
     }
     emit cop0reg_update(Status, cop0reg[(int)Status]);
+    events_due_now();
 }
 
 Address Cop0State::exception_pc_address() {
@@ -237,26 +268,55 @@ Address Cop0State::exception_pc_address() {
 void Cop0State::write_cop0reg_count_compare(
     enum Cop0Registers reg,
     uint32_t value) {
+    uint32_t core_cycles = get_core_cycles();
     set_interrupt_signal(COUNTER_IRQ_LEVEL, false);
+    if (reg == Count) {
+        count_base_cycles = core_cycles;
+    }
     write_cop0reg_default(reg, value);
+    arm_timer(core_cycles);
 }
 
-void Cop0State::update_count_and_compare_irq() {
-    uint32_t core_cycles;
-    uint32_t count_orig;
-    if (core == nullptr) {
+void Cop0State::update_count_and_compare_irq(uint32_t core_cycles) {
+    if ((int32_t)(core_cycles - timer_deadline) < 0) {
         return;
     }
-    count_orig = cop0reg[(int)Count];
-    core_cycles = core->get_cycle_count();
-    cop0reg[(int)Count] += core_cycles - last_core_cycles;
-    last_core_cycles = core_cycles;
-    emit cop0reg_update(Count, cop0reg[(int)Count]);
-
-    if ((int32_t)(cop0reg[(int)Compare] - count_orig) > 0
-        && (int32_t)(cop0reg[(int)Compare] - cop0reg[(int)Count]) <= 0) {
+    uint32_t count = count_at(core_cycles);
+    if ((int32_t)(cop0reg[(int)Compare] - timer_armed_count) > 0
+        && (int32_t)(cop0reg[(int)Compare] - count) <= 0) {
         set_interrupt_signal(COUNTER_IRQ_LEVEL, true);
     }
+    arm_timer(core_cycles);
+}
+
+void Cop0State::rebase_count(uint32_t core_cycles) {
+    cop0reg[(int)Count] = count_at(get_core_cycles());
+    count_base_cycles = core_cycles;
+    arm_timer(core_cycles);
+}
+
+uint32_t Cop0State::get_core_cycles() const {
+    return core != nullptr ? core->get_cycle_count() : 0;
+}
+
+uint32_t Cop0State::count_at(uint32_t core_cycles) const {
+    return cop0reg[(int)Count] + (core_cycles - count_base_cycles);
+}
+
+void Cop0State::arm_timer(uint32_t core_cycles) {
+    timer_armed_count = count_at(core_cycles);
+    uint32_t remaining = cop0reg[(int)Compare] - timer_armed_count;
+    if ((int32_t)remaining <= 0) {
+        // Compare is behind Count, the match is more than half of counter
+        // range away. Recheck in between to keep wrapping comparison valid.
+        remaining = 0x40000000;
+    }
+    timer_deadline = core_cycles + remaining;
+    next_event_cycle = core_cycles;
+}
+
+void Cop0State::events_due_now() {
+    next_event_cycle = get_core_cycles();
 }
 
 void Cop0State::write_cop0reg_user_local(enum Cop0Registers reg, uint32_t value) {
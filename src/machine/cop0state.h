@@ -45,6 +45,10 @@ public:
     Cop0State(const Cop0State &);
 
     uint32_t read_cop0reg(enum Cop0Registers reg) const;
+    /**
+     * Read register without notifying visualization (no `cop0reg_read`).
+     */
+    uint32_t peek_cop0reg(enum Cop0Registers reg) const;
     uint32_t read_cop0reg(uint8_t rd, uint8_t sel) const; // Read coprocessor 0
                                                           // register
     void write_cop0reg(enum Cop0Registers reg, RegisterValue value);
@@ -59,6 +63,10 @@ public:
 
     void reset(); // Reset all values to zero
 
+    /**
+     * Check for interrupt request. Cheap unless some event (timer deadline or
+     * change of Status or Cause) is due.
+     */
     bool core_interrupt_request();
     Address exception_pc_address();
 
@@ -73,7 +81,8 @@ public slots:
 protected:
     void setup_core(Core *core);
     void update_execption_cause(enum ExceptionCause excause, bool in_delay_slot);
-    void update_count_and_compare_irq();
+    void update_count_and_compare_irq(uint32_t core_cycles);
+    void rebase_count(uint32_t core_cycles);
 
 private:
     typedef uint32_t (Cop0State::*reg_read_t)(enum Cop0Registers reg) const;
@@ -92,12 +101,25 @@ private:
     static const cop0reg_desc_t cop0reg_desc[COP0REGS_CNT];
 
     uint32_t read_cop0reg_default(enum Cop0Registers reg) const;
+    uint32_t read_cop0reg_count(enum Cop0Registers reg) const;
     void write_cop0reg_default(enum Cop0Registers reg, uint32_t value);
     void write_cop0reg_count_compare(enum Cop0Registers reg, uint32_t value);
     void write_cop0reg_user_local(enum Cop0Registers reg, uint32_t value);
+    uint32_t get_core_cycles() const;
+    uint32_t count_at(uint32_t core_cycles) const;
+    void arm_timer(uint32_t core_cycles);
+    void events_due_now();
+
     Core *core;
     uint32_t cop0reg[COP0REGS_CNT] {}; // coprocessor 0 registers
-    uint32_t last_core_cycles {};
+    // Count is not incremented each cycle, `cop0reg[Count]` holds its value
+    // at core cycle `count_base_cycles`.
+    uint32_t count_base_cycles {};
+    // Compare match is checked only once core reaches the deadline cycle.
+    uint32_t timer_armed_count {};
+    uint32_t timer_deadline {};
+    // Cycle when interrupt request has to be evaluated again.
+    uint32_t next_event_cycle {};
 };
 
 } // namespace machine
@@ -3,6 +3,9 @@
 #include "programloader.h"
 #include "utils.h"
 #include "execute/alu.h"
+#include "execute/fpu.h"
+
+#include <algorithm>
 
 using namespace machine;
 
@@ -13,8 +16,10 @@ Core::Core(
     FrontendMemory *mem_program,
     FrontendMemory *mem_data,
     unsigned int min_cache_row_size,
-    Cop0State *cop0state)
-    : ex_handlers() {
+    Cop0State *cop0state,
+    Xlen xlen)
+    : ex_handlers()
+    , xlen(xlen) {
     this->regs = regs;
     this->cop0state = cop0state;
     this->mem_program = mem_program;
@@ -40,12 +45,24 @@ void Core::step(bool skip_break) {
     state.cycle_count++;
     emit cycle_c_value(state.cycle_count);
     do_step(skip_break);
+    regs->flush_changes();
     emit step_done();
 }
 
 void Core::reset() {
+    if (cop0state != nullptr) {
+        // Count is derived from cycle count, keep its value.
+        cop0state->rebase_count(0);
+    }
     state.cycle_count = 0;
     state.stall_count = 0;
+    state.instruction_count = 0;
+    state.fetch_stats = {};
+    state.branch_stats = {};
+    state.exception_stop_pending = false;
+    fetch_buffer.valid = false;
+    fetch_held = false;
+    completed_addr = Address::null();
     do_reset();
 }
 
@@ -57,6 +74,22 @@ unsigned Core::get_stall_count() const {
     return state.stall_count;
 }
 
+unsigned Core::get_instruction_count() const {
+    return state.instruction_count;
+}
+
+const FetchStats &Core::get_fetch_stats() const {
+    return state.fetch_stats;
+}
+
+const BranchStats &Core::get_branch_stats() const {
+    return state.branch_stats;
+}
+
+bool Core::busy() const {
+    return false;
+}
+
 Registers *Core::get_regs() {
     return regs;
 }
@@ -73,6 +106,18 @@ FrontendMemory *Core::get_mem_program() {
     return mem_program;
 }
 
+Xlen Core::get_xlen() const {
+    return xlen;
+}
+
+void Core::set_hart_id(unsigned id) {
+    hart_id = id;
+}
+
+unsigned Core::get_hart_id() const {
+    return hart_id;
+}
+
 void Core::insert_hwbreak(Address address) {
     state.hw_breaks.insert(address, new hwBreak(address));
 }
@@ -159,6 +204,7 @@ bool Core::handle_exception(
             in_delay_slot, mem_ref_addr);
     }
     if (get_stop_on_exception(excause)) {
+        state.exception_stop_pending = true;
         emit core->stop_on_exception_reached();
     }
 
@@ -174,16 +220,99 @@ void Core::set_c0_userlocal(uint32_t address) {
     }
 }
 
+/** Operations of AMO instructions, values match the funct5 field. */
+enum class AmoOp : uint8_t {
+    ADD = 0b00000,
+    SWAP = 0b00001,
+    XOR = 0b00100,
+    OR = 0b01000,
+    AND = 0b01100,
+    MIN = 0b10000,
+    MAX = 0b10100,
+    MINU = 0b11000,
+    MAXU = 0b11100,
+};
+
+/**
+ * Value stored to memory by AMO instruction.
+ *
+ * Word operations compare sign or zero extended 32-bit values, the store
+ * truncates the result.
+ */
+static RegisterValue
+amo_operate(AmoOp op, bool dword, RegisterValue mem_val, RegisterValue src) {
+    const int64_t s_mem = dword ? mem_val.as_i64() : mem_val.as_i32();
+    const int64_t s_src = dword ? src.as_i64() : src.as_i32();
+    const uint64_t u_mem = dword ? mem_val.as_u64() : mem_val.as_u32();
+    const uint64_t u_src = dword ? src.as_u64() : src.as_u32();
+
+    switch (op) {
+    case AmoOp::ADD: return u_mem + u_src;
+    case AmoOp::SWAP: return src;
+    case AmoOp::XOR: return u_mem ^ u_src;
+    case AmoOp::OR: return u_mem | u_src;
+    case AmoOp::AND: return u_mem & u_src;
+    case AmoOp::MIN: return s_mem < s_src ? mem_val : src;
+    case AmoOp::MAX: return s_mem > s_src ? mem_val : src;
+    case AmoOp::MINU: return u_mem < u_src ? mem_val : src;
+    case AmoOp::MAXU: return u_mem > u_src ? mem_val : src;
+    }
+    throw SIMULATOR_EXCEPTION(
+        UnsupportedInstruction, "Unsupported atomic memory operation",
+        QString::number(static_cast<unsigned>(op), 2));
+}
+
+enum ExceptionCause Core::memory_atomic(
+    enum AccessControl memctl,
+    const Instruction &inst,
+    RegisterValue &towrite_val,
+    RegisterValue rt_value,
+    Address mem_addr) {
+    const bool dword = (inst.funct() & 0x7) == 0x3;
+    const enum AccessControl ctl = dword ? AC_I64 : AC_I32;
+
+    // Atomic accesses have to be naturally aligned.
+    if (mem_addr.get_raw() % (dword ? 8 : 4)) {
+        return memctl == AC_LOAD_LINKED ? EXCAUSE_ADDRL : EXCAUSE_ADDRS;
+    }
+
+    // Harts on other threads must not access the memory in between.
+    mem_data->atomic_access([&]() {
+        switch (memctl) {
+        case AC_LOAD_LINKED:
+            towrite_val = mem_data->read_ctl(ctl, mem_addr);
+            mem_data->reserve(hart_id, mem_addr);
+            break;
+        case AC_STORE_CONDITIONAL:
+            // Reservation is consumed whether the store succeeds or not.
+            if (mem_data->take_reservation(hart_id, mem_addr)) {
+                mem_data->write_ctl(ctl, mem_addr, rt_value);
+                towrite_val = 0;
+            } else {
+                towrite_val = 1;
+            }
+            break;
+        default: {
+            const RegisterValue mem_val = mem_data->read_ctl(ctl, mem_addr);
+            const auto op = static_cast<AmoOp>(inst.funct() >> 5);
+            mem_data->write_ctl(
+                ctl, mem_addr, amo_operate(op, dword, mem_val, rt_value));
+            towrite_val = mem_val;
+            break;
+        }
+        }
+    });
+    return EXCAUSE_NONE;
+}
+
 enum ExceptionCause Core::memory_special(
     enum AccessControl memctl,
-    int mode,
+    const Instruction &inst,
     bool memread,
     bool memwrite,
     RegisterValue &towrite_val,
     RegisterValue rt_value,
     Address mem_addr) {
-    UNUSED(mode)
-
     uint32_t mask;
     uint32_t shift;
     uint32_t temp;
@@ -193,19 +322,10 @@ enum ExceptionCause Core::memory_special(
         mem_data->sync();
         mem_program->sync();
         break;
-    case AC_STORE_CONDITIONAL:
-        if (!memwrite) {
-            break;
-        }
-        mem_data->write_u32(mem_addr, rt_value.as_u32());
-        towrite_val = 1;
-        break;
     case AC_LOAD_LINKED:
-        if (!memread) {
-            break;
-        }
-        towrite_val = mem_data->read_u32(mem_addr);
-        break;
+    case AC_STORE_CONDITIONAL:
+    case AC_AMO:
+        return memory_atomic(memctl, inst, towrite_val, rt_value, mem_addr);
     case AC_WORD_RIGHT:
         if (memwrite) {
             shift = (3u - (mem_addr.get_raw() & 3u)) << 3;
@@ -242,10 +362,53 @@ enum ExceptionCause Core::memory_special(
     return EXCAUSE_NONE;
 }
 
-FetchState Core::fetch(bool skip_break) {
+uint32_t Core::fetch_word(Address address, bool accepted) {
+    // Any write to program memory invalidates the buffer.
+    const uint32_t change_counter = mem_program->get_change_counter();
+    if (fetch_buffer.valid && fetch_buffer.address == address
+        && fetch_buffer.change_counter == change_counter) {
+        if (accepted) {
+            state.fetch_stats.buffer_hits++;
+        }
+        return fetch_buffer.data;
+    }
+    if (!accepted) {
+        return mem_program->read_u32(address);
+    }
+    fetch_buffer.data = mem_program->read_u32(address);
+    fetch_buffer.address = address;
+    fetch_buffer.change_counter = mem_program->get_change_counter();
+    fetch_buffer.valid = true;
+    state.fetch_stats.mem_reads++;
+    return fetch_buffer.data;
+}
+
+uint32_t Core::fetch_code(Address inst_addr, bool accepted) {
+    const Address word_addr = inst_addr & ~(uint64_t)3;
+    uint32_t code = fetch_word(word_addr, accepted);
+    if (inst_addr != word_addr) {
+        code >>= 16;
+        if ((code & 0x3) == 0x3) {
+            // 32-bit instruction straddling two words (and possibly two
+            // cache lines).
+            code |= fetch_word(word_addr + 4, accepted) << 16;
+        }
+    } else if ((code & 0x3) != 0x3) {
+        code &= 0xffff;
+    }
+    return code;
+}
+
+FetchState Core::fetch(bool skip_break, bool accepted) {
     enum ExceptionCause excause = EXCAUSE_NONE;
     Address inst_addr = Address(regs->read_pc());
-    Instruction inst(mem_program->read_u32(inst_addr));
+    Instruction inst(fetch_code(inst_addr, accepted));
+    if (accepted) {
+        state.fetch_stats.instructions++;
+        if (inst.size() == 2) {
+            state.fetch_stats.compressed++;
+        }
+    }
 
     if (!skip_break) {
         hwBreak *brk = state.hw_breaks.value(inst_addr);
@@ -277,22 +440,45 @@ DecodeState Core::decode(const FetchInterstage &dt) {
     enum AluOp alu_op;
     enum AccessControl mem_ctl;
     enum ExceptionCause excause = dt.excause;
+    // Compressed instructions continue down the pipeline in expanded form.
+    const Instruction inst = dt.inst.expanded(xlen);
 
-    dt.inst.flags_alu_op_mem_ctl(flags, alu_op, mem_ctl);
+    inst.flags_alu_op_mem_ctl(flags, alu_op, mem_ctl);
 
     if (!(flags & IMF_SUPPORTED)) {
         throw SIMULATOR_EXCEPTION(
             UnsupportedInstruction,
             "Instruction with following encoding is not supported",
-            QString::number(dt.inst.data(), 16));
+            QString::number(inst.data(), 16));
+    }
+    if ((flags & IMF_RV64) && (xlen == Xlen::_32)) {
+        throw SIMULATOR_EXCEPTION(
+            UnsupportedInstruction,
+            "Instruction with following encoding is available in RV64 only",
+            QString::number(inst.data(), 16));
     }
 
-    uint8_t num_rs = dt.inst.rs();
-    uint8_t num_rt = dt.inst.rt();
-    uint8_t num_rd = dt.inst.rd();
-    RegisterValue val_rs = regs->read_gp(num_rs);
-    RegisterValue val_rt = regs->read_gp(num_rt);
-    uint32_t immediate_val;
+    uint8_t num_rs = inst.rs();
+    uint8_t num_rt = inst.rt();
+    uint8_t num_rd = inst.rd();
+    uint8_t num_rs3 = inst.rs3();
+    // Register fields of U and J types hold immediate bits, unused sources
+    // are not read.
+    RegisterValue val_rs = 0;
+    if (flags & (IMF_ALU_REQ_RS | IMF_BJR_REQ_RS)) {
+        val_rs = (flags & IMF_FP_RS) ? regs->read_fp(num_rs)
+                                     : regs->read_gp(num_rs);
+    } else if (flags & IMF_CSR) {
+        val_rs = num_rs; // Immediate operand of CSRRxI
+    }
+    RegisterValue val_rt = 0;
+    if (flags & (IMF_ALU_REQ_RT | IMF_BJR_REQ_RT)) {
+        val_rt = (flags & IMF_FP_RT) ? regs->read_fp(num_rt)
+                                     : regs->read_gp(num_rt);
+    }
+    RegisterValue val_rs3
+        = (flags & IMF_FP_REQ_RS3) ? regs->read_fp(num_rs3) : 0;
+    RegisterValue immediate_val;
     bool regwrite = flags & IMF_REGWRITE;
     // bool regd = flags & IMF_REGD;
     bool regd = true; // Rv always writes to rd
@@ -311,17 +497,20 @@ DecodeState Core::decode(const FetchInterstage &dt) {
     // } else {
     //     immediate_val = sign_extend(dt.inst.immediate());
     // }
-    immediate_val = dt.inst.immediate();
+    immediate_val = (int32_t)inst.immediate();
+    if (flags & IMF_PC_TO_ALU) {
+        val_rs = dt.inst_addr.get_raw();
+    }
 
     if ((flags & IMF_EXCEPTION) && (excause == EXCAUSE_NONE)) {
-        excause = dt.inst.encoded_exception();
+        excause = inst.encoded_exception();
     }
 
     emit decode_inst_addr_value(dt.inst_addr);
-    emit instruction_decoded(dt.inst, dt.inst_addr, excause, dt.is_valid);
-    emit decode_instruction_value(dt.inst.data());
-    emit decode_reg1_value(val_rs.as_u32());
-    emit decode_reg2_value(val_rt.as_u32());
+    emit instruction_decoded(inst, dt.inst_addr, excause, dt.is_valid);
+    emit decode_instruction_value(inst.data());
+    emit decode_reg1_value(val_rs);
+    emit decode_reg2_value(val_rt);
     emit decode_immediate_value(immediate_val);
     emit decode_regw_value(regwrite);
     emit decode_memtoreg_value((bool)(flags & IMF_MEMREAD));
@@ -335,16 +524,23 @@ DecodeState Core::decode(const FetchInterstage &dt) {
     emit decode_regd31_value(regd31);
 
     if (regd31) {
-        val_rt = (dt.inst_addr + 8).get_raw();
+        // Return address is passed to writeback instead of ALU result.
+        val_rt = (dt.inst_addr + inst.size()).get_raw();
     }
 
-    rwrite = regd31 ? 31 : regd ? num_rd : num_rt;
+    rwrite = regd ? num_rd : num_rt;
+    uint8_t num_rs1 = num_rs + ((flags & IMF_FP_RS) ? FP_REG_BASE : 0);
+    uint8_t num_rs2 = num_rt + ((flags & IMF_FP_RT) ? FP_REG_BASE : 0);
+    if (flags & IMF_FP_RD) {
+        num_rd += FP_REG_BASE;
+        rwrite += FP_REG_BASE;
+    }
 
     return { DecodeInternalState {
                  .alu_op_num = static_cast<unsigned>(alu_op),
              },
              DecodeInterstage {
-                 .inst = dt.inst,
+                 .inst = inst,
                  .memread = !!(flags & IMF_MEMREAD),
                  .memwrite = !!(flags & IMF_MEMWRITE),
                  .alusrc = !!(flags & IMF_ALUSRC),
@@ -363,8 +559,8 @@ DecodeState Core::decode(const FetchInterstage &dt) {
                  .forward_m_d_rt = false,
                  .aluop = alu_op,
                  .memctl = mem_ctl,
-                 .num_rs1 = num_rs,
-                 .num_rs2 = num_rt,
+                 .num_rs1 = num_rs1,
+                 .num_rs2 = num_rs2,
                  .num_rd = num_rd,
                  .wb_num_rd = rwrite,
                  .val_rs = val_rs,
@@ -381,6 +577,18 @@ DecodeState Core::decode(const FetchInterstage &dt) {
                  .stop_if = !!(flags & IMF_STOP_IF),
                  .is_valid = dt.is_valid,
                  .alu_mod = bool(flags & IMF_ALU_MOD),
+                 .alu_mul = bool(flags & IMF_MUL),
+                 .alu_word = bool(flags & IMF_ALU_WORD),
+                 .alu_fn = decode_alu_function(flags, alu_op),
+                 .fpu = bool(flags & IMF_FPU),
+                 .fp_double = bool(flags & IMF_FP_DOUBLE),
+                 .fp_req_rs3 = bool(flags & IMF_FP_REQ_RS3),
+                 .csr = bool(flags & IMF_CSR),
+                 .fp_rm = (flags & IMF_FP_RM)
+                              ? static_cast<FpRounding>(inst.rm())
+                              : FpRounding::RNE,
+                 .num_rs3 = uint8_t(num_rs3 + FP_REG_BASE),
+                 .val_rs3 = val_rs3,
              } };
 }
 
@@ -399,8 +607,17 @@ ExecuteState Core::execute(const DecodeInterstage &dt) {
     }
 
     if (excause == EXCAUSE_NONE) {
-        alu_val = alu_combined_operate({.alu_op = dt.aluop}, AluComponent::ALU, true, dt.alu_mod, dt.val_rs, alu_sec);
-        if (dt.branch) alu_val = dt.bj_not ^ (alu_val == 0);
+        if (dt.jump) {
+            alu_val = dt.val_rt; // Return address
+        } else if (dt.branch) {
+            alu_val = branch_taken(dt);
+        } else if (dt.fpu) {
+            alu_val = fpu_execute(dt);
+        } else if (dt.csr) {
+            alu_val = csr_operate(dt);
+        } else {
+            alu_val = dt.alu_fn(dt.val_rs, alu_sec);
+        }
         discard = dt.num_rd == 0;
         if (discard) {
             regwrite = false;
@@ -470,9 +687,9 @@ ExecuteState Core::execute(const DecodeInterstage &dt) {
 
     emit execute_inst_addr_value(dt.inst_addr);
     emit instruction_executed(dt.inst, dt.inst_addr, excause, dt.is_valid);
-    emit execute_alu_value(alu_val.as_u32());
-    emit execute_reg1_value(dt.val_rs.as_u32());
-    emit execute_reg2_value(dt.val_rt.as_u32());
+    emit execute_alu_value(alu_val);
+    emit execute_reg1_value(dt.val_rs);
+    emit execute_reg2_value(dt.val_rt);
     emit execute_reg1_ff_value(dt.ff_rs1);
     emit execute_reg2_ff_value(dt.ff_rs2);
     //    emit execute_immediate_value(dt.immediate_val);
@@ -527,12 +744,15 @@ ExecuteState Core::execute(const DecodeInterstage &dt) {
                  .in_delay_slot = dt.in_delay_slot,
                  .stop_if = dt.stop_if,
                  .is_valid = dt.is_valid,
+                 // FLW is the only single-precision load to FP register.
+                 .fp_box = dt.memread && dt.num_rd >= FP_REG_BASE
+                           && !dt.fp_double,
              } };
 }
 
 MemoryState Core::memory(const ExecuteInterstage &dt) {
     RegisterValue towrite_val = dt.alu_val;
-    Address mem_addr = Address(dt.alu_val.as_u32());
+    Address mem_addr = to_address(dt.alu_val);
     bool memread = dt.memread;
     bool memwrite = dt.memwrite;
     bool regwrite = dt.regwrite;
@@ -541,14 +761,17 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
     if (excause == EXCAUSE_NONE) {
         if (is_special_access(dt.memctl)) {
             excause = memory_special(
-                dt.memctl, dt.inst.rt(), memread, memwrite, towrite_val,
-                dt.val_rt, mem_addr);
+                dt.memctl, dt.inst, memread, memwrite, towrite_val, dt.val_rt,
+                mem_addr);
         } else if (is_regular_access(dt.memctl)) {
             if (memwrite) {
                 mem_data->write_ctl(dt.memctl, mem_addr, dt.val_rt);
             }
             if (memread) {
                 towrite_val = mem_data->read_ctl(dt.memctl, mem_addr);
+                if (dt.fp_box) {
+                    towrite_val = fp_box32(towrite_val.as_u32());
+                }
             }
         } else {
             Q_ASSERT(dt.memctl == AC_NONE);
@@ -556,17 +779,17 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
         }
     }
 
-    if (dt.excause != EXCAUSE_NONE) {
+    if (excause != EXCAUSE_NONE) {
         memread = false;
         memwrite = false;
         regwrite = false;
     }
 
     emit memory_inst_addr_value(dt.inst_addr);
-    emit instruction_memory(dt.inst, dt.inst_addr, dt.excause, dt.is_valid);
-    emit memory_alu_value(dt.alu_val.as_u32());
-    emit memory_rt_value(dt.val_rt.as_u32());
-    emit memory_mem_value(memread ? towrite_val.as_u32() : 0);
+    emit instruction_memory(dt.inst, dt.inst_addr, excause, dt.is_valid);
+    emit memory_alu_value(dt.alu_val);
+    emit memory_rt_value(dt.val_rt);
+    emit memory_mem_value(memread ? towrite_val : 0);
     emit memory_regw_value(regwrite);
     emit memory_memtoreg_value(dt.memread);
     emit memory_memread_value(dt.memread);
@@ -577,7 +800,7 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
     return { MemoryInternalState {
                  .memwrite = dt.memwrite,
                  .memread = dt.memread,
-                 .mem_read_val = memread ? towrite_val.as_u32() : 0,
+                 .mem_read_val = memread ? towrite_val : 0,
                  .mem_write_val = dt.val_rt,
              },
              MemoryInterstage {
@@ -588,7 +811,7 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
                  .towrite_val = towrite_val,
                  .mem_addr = mem_addr,
                  .inst_addr = dt.inst_addr,
-                 .excause = dt.excause,
+                 .excause = excause,
                  .in_delay_slot = dt.in_delay_slot,
                  .stop_if = dt.stop_if,
                  .is_valid = dt.is_valid,
@@ -598,12 +821,19 @@ MemoryState Core::memory(const ExecuteInterstage &dt) {
 WritebackState Core::writeback(const MemoryInterstage &dt) {
     emit writeback_inst_addr_value(dt.inst_addr);
     emit instruction_writeback(dt.inst, dt.inst_addr, dt.excause, dt.is_valid);
-    emit writeback_value(dt.towrite_val.as_u32());
+    emit writeback_value(dt.towrite_val);
     emit writeback_memtoreg_value(dt.memtoreg);
     emit writeback_regw_value(dt.regwrite);
     emit writeback_regw_num_value(dt.num_rd);
+    if (dt.is_valid) {
+        state.instruction_count++;
+    }
     if (dt.regwrite) {
-        regs->write_gp(dt.num_rd, dt.towrite_val);
+        if (dt.num_rd >= FP_REG_BASE) {
+            regs->write_fp(dt.num_rd - FP_REG_BASE, dt.towrite_val);
+        } else {
+            regs->write_gp(dt.num_rd, dt.towrite_val);
+        }
     }
 
     return { WritebackInternalState {
@@ -614,52 +844,171 @@ WritebackState Core::writeback(const MemoryInterstage &dt) {
 }
 
 bool Core::handle_pc(const DecodeInterstage &dt) {
-    bool branch = false;
+    bool taken = false;
+    const Address next_addr = resolve_pc(dt, taken);
+    if (taken) {
+        regs->pc_abs_jmp(next_addr);
+    } else {
+        // Program counter points to the last fetched instruction.
+        regs->pc_inc(state.pipeline.fetch.final.inst.size());
+    }
+    return taken;
+}
+
+const DecodeInterstage &Core::decode_next(bool skip_break) {
+    // Held instruction fetched with break is fetched again to skip it.
+    const FetchInterstage &held = state.pipeline.fetch.final;
+    if (!fetch_held || held.inst_addr != regs->read_pc()
+        || (skip_break && held.excause != EXCAUSE_NONE)) {
+        state.pipeline.fetch = fetch(skip_break);
+        fetch_held = true;
+    }
+    state.pipeline.decode = decode(state.pipeline.fetch.final);
+    return state.pipeline.decode.final;
+}
+
+enum ExceptionCause Core::complete_next(bool &taken) {
+    fetch_held = false;
+    state.pipeline.execute = execute(state.pipeline.decode.final);
+    state.pipeline.memory = memory(state.pipeline.execute.final);
+    state.pipeline.writeback = writeback(state.pipeline.memory.final);
+    taken = handle_pc(state.pipeline.decode.final);
+
+    const MemoryInterstage &mt = state.pipeline.memory.final;
+    if (mt.excause != EXCAUSE_NONE) {
+        handle_exception(
+            this, regs, mt.excause, mt.inst_addr, regs->read_pc(),
+            completed_addr, mt.in_delay_slot, mt.mem_addr);
+        return mt.excause;
+    }
+    completed_addr = mt.inst_addr;
+    return EXCAUSE_NONE;
+}
+
+Address Core::resolve_pc(const DecodeInterstage &dt, bool &taken) {
     emit instruction_program_counter(
         dt.inst, dt.inst_addr, EXCAUSE_NONE, dt.is_valid);
 
+    taken = false;
     if (dt.jump) {
+        taken = true;
+        emit fetch_jump_value(!dt.bjr_req_rs);
+        emit fetch_jump_reg_value(dt.bjr_req_rs);
+        emit fetch_branch_value(false);
         if (!dt.bjr_req_rs) {
-            regs->pc_abs_jmp_28(dt.inst.address() << 2);
-            emit fetch_jump_value(true);
-            emit fetch_jump_reg_value(false);
-        } else {
-            regs->pc_abs_jmp(Address(dt.val_rs.as_u32()));
-            emit fetch_jump_value(false);
-            emit fetch_jump_reg_value(true);
+            return to_address(
+                dt.inst_addr.get_raw() + dt.immediate_val.as_u64());
         }
-        emit fetch_branch_value(false);
-        return true;
+        // JALR clears the lowest bit of the target.
+        return to_address(dt.val_rs.as_u64() + dt.immediate_val.as_u64())
+               & ~(uint64_t)1;
     }
 
     if (dt.branch) {
-        if (dt.bjr_req_rt) {
-            branch = dt.val_rs.as_u32() == dt.val_rt.as_u32();
-        } else if (!dt.bgt_blez) {
-            branch = dt.val_rs.as_i32() < 0;
-        } else {
-            branch = dt.val_rs.as_i32() <= 0;
-        }
-
-        if (dt.bj_not) {
-            branch = !branch;
-        }
+        taken = branch_taken(dt);
     }
 
     emit fetch_jump_value(false);
     emit fetch_jump_reg_value(false);
-    emit fetch_branch_value(branch);
+    emit fetch_branch_value(taken);
+
+    if (taken) {
+        return to_address(dt.inst_addr.get_raw() + dt.immediate_val.as_u64());
+    }
+    return dt.inst_addr + dt.inst.size();
+}
+
+Address Core::to_address(RegisterValue value) const {
+    return Address(xlen == Xlen::_64 ? value.as_u64() : value.as_u32());
+}
+
+AluFunction
+Core::decode_alu_function(enum InstructionFlags flags, AluOp alu_op) const {
+    // RV32 operates on whole registers as on words.
+    const bool w_operation = (xlen == Xlen::_32) || (flags & IMF_ALU_WORD);
+    if (flags & IMF_FPU) {
+        // ALU field holds FpuOp, the ALU is not used.
+        alu_op = AluOp::ADD;
+    } else if (flags & IMF_MUL) {
+        return alu_select(
+            { .mul_op = static_cast<MulOp>(alu_op) }, AluComponent::MUL,
+            w_operation, false);
+    }
+    return alu_select(
+        { .alu_op = alu_op }, AluComponent::ALU, w_operation,
+        flags & IMF_ALU_MOD);
+}
 
-    if (branch) {
-        int32_t rel_offset = dt.inst.immediate() << 2;
-        if (rel_offset & (1 << 17)) {
-            rel_offset -= 1 << 18;
+bool Core::branch_taken(const DecodeInterstage &dt) const {
+    RegisterValue result = dt.alu_fn(dt.val_rs, dt.val_rt);
+    // BEQ and BNE subtract operands, other branches compare them by SLT(U).
+    bool condition = dt.alu_mod ? (result == 0) : (result != 0);
+    return condition != dt.bj_not;
+}
+
+RegisterValue Core::fpu_execute(const DecodeInterstage &dt) {
+    FpRounding rm = dt.fp_rm;
+    if (rm == FpRounding::DYN) {
+        rm = static_cast<FpRounding>(
+            (regs->read_fcsr() & FCSR_FRM_MASK) >> FCSR_FRM_SHIFT);
+    }
+    if (!fp_rounding_valid(rm)) {
+        throw SIMULATOR_EXCEPTION(
+            UnsupportedInstruction, "Invalid floating-point rounding mode",
+            QString::number(dt.inst.data(), 16));
+    }
+    uint32_t fflags = 0;
+    RegisterValue result = fpu_operate(
+        static_cast<FpuOp>(dt.aluop), dt.fp_double, rm, dt.val_rs, dt.val_rt,
+        dt.val_rs3, fflags);
+    regs->accrue_fflags(fflags);
+    return result;
+}
+
+RegisterValue Core::csr_operate(const DecodeInterstage &dt) {
+    const uint32_t csr = dt.immediate_val.as_u32() & 0xfff;
+    if (csr == 0xf14) { // mhartid, read-only
+        if ((dt.inst.rm() & 0x3) != 1 && dt.inst.rs() == 0) {
+            return hart_id;
         }
-        regs->pc_abs_jmp(dt.inst_addr + rel_offset + 4);
-    } else {
-        regs->pc_inc();
+        throw SIMULATOR_EXCEPTION(
+            UnsupportedInstruction, "Write to read-only CSR mhartid",
+            QString::number(csr, 16));
     }
-    return branch;
+    const uint32_t fcsr = regs->read_fcsr();
+    uint32_t shift, mask;
+    switch (csr) {
+    case 0x001: // fflags
+        shift = 0;
+        mask = FCSR_FFLAGS_MASK;
+        break;
+    case 0x002: // frm
+        shift = FCSR_FRM_SHIFT;
+        mask = FCSR_FRM_MASK;
+        break;
+    case 0x003: // fcsr
+        shift = 0;
+        mask = FCSR_MASK;
+        break;
+    default:
+        throw SIMULATOR_EXCEPTION(
+            UnsupportedInstruction, "Unsupported control and status register",
+            QString::number(csr, 16));
+    }
+    const uint32_t old_value = (fcsr & mask) >> shift;
+    const uint32_t operand = dt.val_rs.as_u32();
+    uint32_t value;
+    // funct3: 1 - write, 2 - set bits, 3 - clear bits, +4 immediate operand
+    switch (dt.inst.rm() & 0x3) {
+    case 1: value = operand; break;
+    case 2: value = old_value | operand; break;
+    default: value = old_value & ~operand; break;
+    }
+    // Set and clear with zero operand do not write the register.
+    if (value != old_value || (dt.inst.rm() & 0x3) == 1) {
+        regs->write_fcsr((fcsr & ~mask) | ((value << shift) & mask));
+    }
+    return old_value;
 }
 
 void Core::dtFetchInit(FetchInterstage &dt) {
@@ -683,10 +1032,21 @@ void Core::dtDecodeInit(DecodeInterstage &dt) {
     dt.bj_not = false;
     dt.bgt_blez = false;
     dt.nb_skip_ds = false;
+    dt.alu_mul = false;
+    dt.alu_word = false;
+    dt.fpu = false;
+    dt.fp_double = false;
+    dt.fp_req_rs3 = false;
+    dt.csr = false;
+    dt.fp_rm = FpRounding::RNE;
+    dt.num_rs3 = 0;
+    dt.val_rs3 = 0;
     dt.forward_m_d_rs = false;
     dt.forward_m_d_rt = false;
     // dt.aluop = ALU_OP_SLL;
     dt.aluop = AluOp::ADD;
+    dt.alu_fn = alu_select(
+        { .alu_op = AluOp::ADD }, AluComponent::ALU, true, false);
     dt.memctl = AC_NONE;
     dt.num_rs1 = 0;
     dt.num_rs2 = 0;
@@ -717,6 +1077,7 @@ void Core::dtExecuteInit(ExecuteInterstage &dt) {
     dt.in_delay_slot = false;
     dt.stop_if = false;
     dt.is_valid = false;
+    dt.fp_box = false;
 }
 
 void Core::dtMemoryInit(MemoryInterstage &dt) {
@@ -737,8 +1098,14 @@ CoreSingle::CoreSingle(
     FrontendMemory *mem_program,
     FrontendMemory *mem_data,
     unsigned int min_cache_row_size,
-    Cop0State *cop0state)
-    : Core(regs, mem_program, mem_data, min_cache_row_size, cop0state) {
+    Cop0State *cop0state,
+    Xlen xlen)
+    : Core(regs,
+           mem_program,
+           mem_data,
+           min_cache_row_size,
+           cop0state,
+           xlen) {
     reset();
 }
 
@@ -751,9 +1118,7 @@ void CoreSingle::do_step(bool skip_break) {
 
     // Handle PC before instruction following jump leaves decode internal
 
-    {
-        bool branch_taken = handle_pc(state.pipeline.decode.final);
-    }
+    handle_pc(state.pipeline.decode.final);
 
     if (state.pipeline.memory.final.excause != EXCAUSE_NONE) {
         handle_exception(
@@ -776,13 +1141,35 @@ CorePipelined::CorePipelined(
     FrontendMemory *mem_data,
     enum MachineConfig::HazardUnit hazard_unit,
     unsigned int min_cache_row_size,
-    Cop0State *cop0state)
-    : Core(regs, mem_program, mem_data, min_cache_row_size, cop0state) {
+    Cop0State *cop0state,
+    Xlen xlen,
+    const BranchPredictorConfig &bp_config)
+    : Core(regs,
+           mem_program,
+           mem_data,
+           min_cache_row_size,
+           cop0state,
+           xlen)
+    , predictor(BranchPredictor::get_predictor_instance(bp_config))
+    , btb(bp_config.btb_entries())
+    , ras(bp_config.ras_entries()) {
     this->hazard_unit = hazard_unit;
 
     reset();
 }
 
+const BranchPredictor *CorePipelined::get_branch_predictor() const {
+    return predictor.get();
+}
+
+const BranchTargetBuffer &CorePipelined::get_btb() const {
+    return btb;
+}
+
+const ReturnAddressStack &CorePipelined::get_ras() const {
+    return ras;
+}
+
 void CorePipelined::do_step(bool skip_break) {
     bool stall = false;
     bool branch_stall = false;
@@ -912,6 +1299,16 @@ void CorePipelined::do_step(bool skip_break) {
             }
         }
 #undef HAZARD
+        // Third operand of fused operations is not forwarded.
+        if (state.pipeline.decode.final.fp_req_rs3
+            && ((state.pipeline.execute.final.regwrite
+                 && state.pipeline.execute.final.num_rd
+                        == state.pipeline.decode.final.num_rs3)
+                || (state.pipeline.memory.final.regwrite
+                    && state.pipeline.memory.final.num_rd
+                           == state.pipeline.decode.final.num_rs3))) {
+            stall = true;
+        }
         if (state.pipeline.execute.final.num_rd != 0
             && state.pipeline.execute.final.regwrite
             && ((state.pipeline.decode.final.bjr_req_rs
@@ -990,22 +1387,20 @@ void CorePipelined::do_step(bool skip_break) {
     if (!stall && !state.pipeline.decode.final.stop_if) {
         state.pipeline.decode.final.stall = false;
         state.pipeline.fetch = fetch(skip_break);
-        if (handle_pc(state.pipeline.decode.final)) {
-            state.pipeline.fetch.final.in_delay_slot = true;
-        } else {
-            if (state.pipeline.decode.final.nb_skip_ds) {
-                dtFetchInit(state.pipeline.fetch.final);
-                emit instruction_fetched(
-                    state.pipeline.fetch.final.inst,
-                    state.pipeline.fetch.final.inst_addr,
-                    state.pipeline.fetch.final.excause,
-                    state.pipeline.fetch.final.is_valid);
-                emit fetch_inst_addr_value(STAGEADDR_NONE);
-            }
+        if (handle_pc_predicted(state.pipeline.decode.final)) {
+            // RISC-V has no delay slot, instruction fetched after mispredicted
+            // jump or branch is flushed.
+            dtFetchInit(state.pipeline.fetch.final);
+            emit instruction_fetched(
+                state.pipeline.fetch.final.inst,
+                state.pipeline.fetch.final.inst_addr,
+                state.pipeline.fetch.final.excause,
+                state.pipeline.fetch.final.is_valid);
+            emit fetch_inst_addr_value(STAGEADDR_NONE);
         }
     } else {
-        // Run fetch internal on empty
-        fetch(skip_break);
+        // Run fetch internal on empty, the result is dropped
+        fetch(skip_break, false);
         // clear decode latch (insert nope to execute internal)
         if (!state.pipeline.decode.final.stop_if) {
             dtDecodeInit(state.pipeline.decode.final);
@@ -1023,7 +1418,100 @@ void CorePipelined::do_step(bool skip_break) {
     }
 }
 
+bool CorePipelined::handle_pc_predicted(const DecodeInterstage &dt) {
+    bool taken = false;
+    const Address next_addr = resolve_pc(dt, taken);
+    const FetchInterstage &fetched = state.pipeline.fetch.final;
+    BranchStats &stats = state.branch_stats;
+
+    // Bubble carries no prediction, the fetched instruction follows a flush.
+    if (dt.is_valid) {
+        // Fetched instruction is the predicted successor of the decoded one.
+        const bool mispredicted = next_addr != fetched.inst_addr;
+        if (dt.branch) {
+            stats.branches++;
+            stats.branches_mispredicted += mispredicted;
+        } else if (dt.jump) {
+            stats.jumps++;
+            stats.jumps_mispredicted += mispredicted;
+        }
+        if (dt.branch || dt.jump || mispredicted) {
+            emit branch_resolved(dt.inst_addr, next_addr, taken, mispredicted);
+        }
+        train_predictor(dt, taken, next_addr);
+        if (mispredicted) {
+            regs->pc_abs_jmp(next_addr);
+            stats.penalty_cycles++;
+            emit mispredict_c_value(stats.penalty_cycles);
+            return true;
+        }
+    }
+
+    Address target;
+    if (predict_taken(fetched, target)) {
+        regs->pc_abs_jmp(target);
+    } else {
+        // Program counter points to the last fetched instruction.
+        regs->pc_inc(fetched.inst.size());
+    }
+    return false;
+}
+
+bool CorePipelined::predict_taken(
+    const FetchInterstage &fetched,
+    Address &target) const {
+    const BranchTargetBuffer::Entry *entry = btb.lookup(fetched.inst_addr);
+    if (!fetched.is_valid || entry == nullptr) {
+        return false;
+    }
+    target = entry->target;
+    switch (entry->kind) {
+    case BranchKind::BRANCH:
+        return predictor->predict(fetched.inst_addr, entry->target);
+    case BranchKind::RETURN:
+        // Last seen target is used when the stack is empty.
+        ras.top(target);
+        return true;
+    case BranchKind::JUMP:
+    case BranchKind::CALL: return true;
+    }
+    return false;
+}
+
+void CorePipelined::train_predictor(
+    const DecodeInterstage &dt,
+    bool taken,
+    Address target) {
+    if (!dt.branch && !dt.jump) {
+        // Stale entry (code was rewritten), do not predict it again.
+        btb.remove(dt.inst_addr);
+        return;
+    }
+    if (dt.branch) {
+        predictor->update(dt.inst_addr, taken);
+        if (taken) {
+            btb.insert(dt.inst_addr, target, BranchKind::BRANCH);
+        }
+        return;
+    }
+    // Link register usage hints of the RISC-V specification
+    auto is_link = [](uint8_t num) { return num == 1 || num == 5; };
+    BranchKind kind = BranchKind::JUMP;
+    if (is_link(dt.num_rd)) {
+        kind = BranchKind::CALL;
+        ras.push(dt.inst_addr + dt.inst.size());
+    } else if (dt.bjr_req_rs && is_link(dt.num_rs1)) {
+        kind = BranchKind::RETURN;
+        Address return_addr;
+        ras.pop(return_addr);
+    }
+    btb.insert(dt.inst_addr, target, kind);
+}
+
 void CorePipelined::do_reset() {
+    predictor->reset();
+    btb.reset();
+    ras.reset();
     dtFetchInit(state.pipeline.fetch.final);
     dtFetchInit(state.pipeline.fetch.result);
     state.pipeline.fetch.final.inst_addr = 0x0_addr;
@@ -1042,6 +1530,447 @@ void CorePipelined::do_reset() {
     state.pipeline.memory.final.inst_addr = 0x0_addr;
 }
 
+CoreSuperscalar::CoreSuperscalar(
+    Registers *regs,
+    FrontendMemory *mem_program,
+    FrontendMemory *mem_data,
+    unsigned issue_width,
+    unsigned alu_ports,
+    unsigned mul_ports,
+    unsigned mem_ports,
+    unsigned int min_cache_row_size,
+    Cop0State *cop0state,
+    Xlen xlen)
+    : Core(regs,
+           mem_program,
+           mem_data,
+           min_cache_row_size,
+           cop0state,
+           xlen)
+    , issue_width(issue_width > 0 ? issue_width : 1)
+    , ports { alu_ports > 0 ? alu_ports : this->issue_width,
+              mul_ports > 0 ? mul_ports : 1, mem_ports > 0 ? mem_ports : 1 } {
+    reset();
+}
+
+unsigned CoreSuperscalar::get_issue_width() const {
+    return issue_width;
+}
+
+const IssueStats &CoreSuperscalar::get_issue_stats() const {
+    return issue_stats;
+}
+
+void CoreSuperscalar::set_program_end(Address address) {
+    program_end = address;
+}
+
+void CoreSuperscalar::do_step(bool skip_break) {
+    if (control_bubble) {
+        // Target of the taken jump or branch is fetched in this cycle.
+        control_bubble = false;
+        bubble(IL_CONTROL);
+        return;
+    }
+
+    uint64_t written = 0;
+    uint64_t loaded = 0;
+    Ports used;
+    enum IssueLimit limit = IL_COUNT;
+    unsigned slot = 0;
+    while (slot < issue_width && (slot == 0 || regs->read_pc() < program_end)) {
+        // Only the first instruction steps over a breakpoint.
+        const DecodeInterstage &dt = decode_next(skip_break && slot == 0);
+        limit = issue_limit(dt, slot, written, used);
+        if (limit != IL_COUNT) {
+            break;
+        }
+        if (dt.memread || dt.memwrite) {
+            used.mem++;
+        } else if (dt.alu_mul || dt.fpu) {
+            used.mul++;
+        } else {
+            used.alu++;
+        }
+        written |= dest_mask(dt);
+        if (dt.memread) {
+            loaded |= dest_mask(dt);
+        }
+        issue_stats.slot_issued.at(slot)++;
+        slot++;
+
+        bool taken = false;
+        if (complete_next(taken) != EXCAUSE_NONE) {
+            limit = IL_SERIALIZE;
+            break;
+        }
+        if (taken) {
+            control_bubble = true;
+            limit = IL_CONTROL;
+            break;
+        }
+        if (dt.stop_if || dt.csr) {
+            limit = IL_SERIALIZE;
+            break;
+        }
+    }
+    loaded_prev = loaded;
+
+    if (slot == 0) {
+        // Only a load still in flight blocks the first slot.
+        bubble(limit);
+    } else if (slot < issue_width && limit != IL_COUNT) {
+        issue_stats.empty_slots.at(limit) += issue_width - slot;
+    }
+}
+
+void CoreSuperscalar::do_reset() {
+    issue_stats = {};
+    issue_stats.slot_issued.resize(issue_width);
+    control_bubble = false;
+    loaded_prev = 0;
+}
+
+enum IssueLimit CoreSuperscalar::issue_limit(
+    const DecodeInterstage &dt,
+    unsigned slot,
+    uint64_t written,
+    const Ports &used) const {
+    const bool serialize
+        = dt.stop_if || dt.csr || dt.excause != EXCAUSE_NONE;
+    if (serialize && slot > 0) {
+        return IL_SERIALIZE;
+    }
+    const uint64_t sources = source_mask(dt);
+    if (sources & loaded_prev) {
+        return IL_LOAD_USE;
+    }
+    if (sources & written) {
+        return IL_DEPENDENCY;
+    }
+    if (dest_mask(dt) & written) {
+        return IL_OUTPUT;
+    }
+    if (dt.memread || dt.memwrite) {
+        return used.mem < ports.mem ? IL_COUNT : IL_MEM_PORT;
+    }
+    if (dt.alu_mul || dt.fpu) {
+        return used.mul < ports.mul ? IL_COUNT : IL_MUL_PORT;
+    }
+    return used.alu < ports.alu ? IL_COUNT : IL_ALU_PORT;
+}
+
+uint64_t CoreSuperscalar::source_mask(const DecodeInterstage &dt) {
+    uint64_t mask = 0;
+    if (dt.alu_req_rs || dt.bjr_req_rs) {
+        mask |= (uint64_t)1 << dt.num_rs1;
+    }
+    if (dt.alu_req_rt || dt.bjr_req_rt) {
+        mask |= (uint64_t)1 << dt.num_rs2;
+    }
+    if (dt.fp_req_rs3) {
+        mask |= (uint64_t)1 << dt.num_rs3;
+    }
+    // Register x0 is never written.
+    return mask & ~(uint64_t)1;
+}
+
+uint64_t CoreSuperscalar::dest_mask(const DecodeInterstage &dt) {
+    if (!dt.regwrite || dt.num_rd == 0) {
+        return 0;
+    }
+    return (uint64_t)1 << dt.num_rd;
+}
+
+void CoreSuperscalar::bubble(enum IssueLimit reason) {
+    issue_stats.bubble_cycles.at(reason)++;
+    issue_stats.empty_slots.at(reason) += issue_width;
+    state.stall_count++;
+    emit stall_c_value(state.stall_count);
+}
+
+CoreOutOfOrder::CoreOutOfOrder(
+    Registers *regs,
+    FrontendMemory *mem_program,
+    FrontendMemory *mem_data,
+    const OutOfOrderConfig &config,
+    unsigned alu_ports,
+    unsigned mul_ports,
+    unsigned mem_ports,
+    const BranchPredictorConfig &bp_config,
+    unsigned int min_cache_row_size,
+    Cop0State *cop0state,
+    Xlen xlen)
+    : Core(regs,
+           mem_program,
+           mem_data,
+           min_cache_row_size,
+           cop0state,
+           xlen)
+    , config(config)
+    , alu_ports(alu_ports > 0 ? alu_ports : config.issue_width())
+    , mul_ports(mul_ports > 0 ? mul_ports : 1)
+    , mem_ports(mem_ports > 0 ? mem_ports : 1)
+    , predictor(BranchPredictor::get_predictor_instance(bp_config))
+    , btb(bp_config.btb_entries())
+    , ras(bp_config.ras_entries()) {
+    reset();
+}
+
+const OutOfOrderConfig &CoreOutOfOrder::get_config() const {
+    return config;
+}
+
+const OutOfOrderStats &CoreOutOfOrder::get_ooo_stats() const {
+    return ooo_stats;
+}
+
+void CoreOutOfOrder::set_program_end(Address address) {
+    program_end = address;
+}
+
+bool CoreOutOfOrder::busy() const {
+    return !rob.empty();
+}
+
+void CoreOutOfOrder::do_step(bool skip_break) {
+    // Instruction dispatched in this cycle issues in the next one at the
+    // earliest, so dispatch goes last.
+    commit();
+    issue();
+    const enum DispatchStall stall = dispatch(skip_break);
+    if (stall != DS_COUNT) {
+        ooo_stats.dispatch_stalls.at(stall)++;
+    }
+    sample_occupancy();
+}
+
+void CoreOutOfOrder::do_reset() {
+    predictor->reset();
+    btb.reset();
+    ras.reset();
+    ooo_stats = {};
+    ooo_stats.rob_occupancy.resize(config.rob_size() + 1);
+    ooo_stats.iq_occupancy.resize(config.iq_size() + 1);
+    ooo_stats.lsq_occupancy.resize(config.lsq_size() + 1);
+    rob.clear();
+    rename.fill(0);
+    next_seq = 1;
+    iq_used = 0;
+    lsq_used = 0;
+    redirect_seq = 0;
+    redirect_cycle = 0;
+    serialize_pending = false;
+}
+
+void CoreOutOfOrder::commit() {
+    unsigned committed = 0;
+    while (committed < config.commit_width() && !rob.empty()
+           && completed(rob.front().seq)) {
+        const RobEntry &entry = rob.front();
+        if (entry.dest != 0 && rename.at(entry.dest) == entry.seq) {
+            rename.at(entry.dest) = 0;
+        }
+        if (entry.load || entry.store) {
+            lsq_used--;
+        }
+        rob.pop_front();
+        committed++;
+    }
+    if (committed > 0) {
+        return;
+    }
+
+    enum CommitStall reason = CS_EMPTY;
+    if (!rob.empty()) {
+        reason = rob.front().issued ? CS_EXECUTING : CS_WAITING;
+    }
+    ooo_stats.commit_stalls.at(reason)++;
+    state.stall_count++;
+    emit stall_c_value(state.stall_count);
+}
+
+void CoreOutOfOrder::issue() {
+    const std::array<unsigned, 3> ports = { alu_ports, mul_ports, mem_ports };
+    std::array<unsigned, 3> used {};
+    unsigned issued = 0;
+    for (size_t i = 0; i < rob.size() && issued < config.issue_width(); i++) {
+        RobEntry &entry = rob.at(i);
+        if (entry.issued || used.at(entry.unit) >= ports.at(entry.unit)) {
+            continue;
+        }
+        bool ready = std::all_of(
+            entry.sources.begin(), entry.sources.end(),
+            [this](uint64_t seq) { return completed(seq); });
+        // Store data are forwarded to the load once the store executes.
+        for (size_t j = 0; ready && entry.load && j < i; j++) {
+            const RobEntry &older = rob.at(j);
+            ready = !older.store || completed(older.seq)
+                    || (older.mem_addr & ~(uint64_t)7)
+                           != (entry.mem_addr & ~(uint64_t)7);
+        }
+        if (!ready) {
+            continue;
+        }
+        entry.issued = true;
+        entry.done_cycle = state.cycle_count + entry.latency;
+        used.at(entry.unit)++;
+        issued++;
+        iq_used--;
+        if (entry.seq == redirect_seq) {
+            redirect_cycle = entry.done_cycle + config.mispredict_penalty();
+            redirect_seq = 0;
+        }
+    }
+}
+
+enum DispatchStall CoreOutOfOrder::dispatch(bool skip_break) {
+    for (unsigned n = 0; n < config.dispatch_width(); n++) {
+        if (regs->read_pc() >= program_end) {
+            return DS_COUNT;
+        }
+        if (redirect_seq != 0 || state.cycle_count < redirect_cycle) {
+            return DS_MISPREDICT;
+        }
+        if (serialize_pending) {
+            if (!rob.empty()) {
+                return DS_SERIALIZE;
+            }
+            serialize_pending = false;
+        }
+
+        // Only the first instruction steps over a breakpoint.
+        const DecodeInterstage &dt = decode_next(skip_break && n == 0);
+        const bool serialize
+            = dt.stop_if || dt.csr || dt.excause != EXCAUSE_NONE;
+        const bool mem = dt.memread || dt.memwrite;
+        if (serialize && !rob.empty()) {
+            return DS_SERIALIZE;
+        }
+        if (rob.size() >= config.rob_size()) {
+            return DS_ROB_FULL;
+        }
+        if (iq_used >= config.iq_size()) {
+            return DS_IQ_FULL;
+        }
+        if (mem && lsq_used >= config.lsq_size()) {
+            return DS_LSQ_FULL;
+        }
+
+        RobEntry entry;
+        entry.seq = next_seq++;
+        const std::array<std::pair<bool, uint8_t>, 3> sources = { {
+            { dt.alu_req_rs || dt.bjr_req_rs, dt.num_rs1 },
+            { dt.alu_req_rt || dt.bjr_req_rt, dt.num_rs2 },
+            { dt.fp_req_rs3, dt.num_rs3 },
+        } };
+        for (size_t i = 0; i < sources.size(); i++) {
+            // Register x0 is never written.
+            if (sources[i].first && sources[i].second != 0) {
+                entry.sources[i] = rename.at(sources[i].second);
+            }
+        }
+        if (mem) {
+            entry.unit = UNIT_MEM;
+            entry.latency = dt.memread ? config.load_latency() : 1;
+            entry.load = dt.memread;
+            entry.store = dt.memwrite;
+        } else if (dt.alu_mul) {
+            entry.unit = UNIT_MUL;
+            entry.latency = config.mul_latency();
+        } else if (dt.fpu) {
+            entry.unit = UNIT_MUL;
+            entry.latency = config.fpu_latency();
+        } else {
+            entry.latency = config.alu_latency();
+        }
+        if (dt.regwrite && dt.num_rd != 0) {
+            entry.dest = dt.num_rd;
+        }
+
+        bool taken = false;
+        const enum ExceptionCause excause = complete_next(taken);
+        entry.mem_addr = state.pipeline.memory.final.mem_addr;
+        if (entry.dest != 0) {
+            rename.at(entry.dest) = entry.seq;
+        }
+        rob.push_back(entry);
+        iq_used++;
+        if (mem) {
+            lsq_used++;
+        }
+
+        if (serialize || excause != EXCAUSE_NONE) {
+            serialize_pending = true;
+        } else if (mispredicted(dt, taken)) {
+            ooo_stats.mispredictions++;
+            redirect_seq = entry.seq;
+        }
+    }
+    return DS_COUNT;
+}
+
+void CoreOutOfOrder::sample_occupancy() {
+    ooo_stats.rob_occupancy.at(rob.size())++;
+    ooo_stats.iq_occupancy.at(iq_used)++;
+    ooo_stats.lsq_occupancy.at(lsq_used)++;
+}
+
+const CoreOutOfOrder::RobEntry *CoreOutOfOrder::in_flight(uint64_t seq) const {
+    if (rob.empty() || seq < rob.front().seq) {
+        return nullptr;
+    }
+    const uint64_t index = seq - rob.front().seq;
+    return index < rob.size() ? &rob.at(index) : nullptr;
+}
+
+bool CoreOutOfOrder::completed(uint64_t seq) const {
+    const RobEntry *entry = in_flight(seq);
+    return entry == nullptr
+           || (entry->issued && entry->done_cycle <= state.cycle_count);
+}
+
+bool CoreOutOfOrder::mispredicted(const DecodeInterstage &dt, bool taken) {
+    if (dt.branch) {
+        const Address target
+            = to_address(dt.inst_addr.get_raw() + dt.immediate_val.as_u64());
+        const bool predicted = predictor->predict(dt.inst_addr, target);
+        predictor->update(dt.inst_addr, taken);
+        return predicted != taken;
+    }
+    if (!dt.jump) {
+        return false;
+    }
+    // Link register usage hints of the RISC-V specification
+    auto is_link = [](uint8_t num) { return num == 1 || num == 5; };
+    const bool is_return
+        = dt.bjr_req_rs && is_link(dt.num_rs1) && !is_link(dt.num_rd);
+    Address target;
+    bool predicted = is_return && ras.pop(target);
+    if (is_link(dt.num_rd)) {
+        ras.push(dt.inst_addr + dt.inst.size());
+    }
+    // Target of direct jump is known as soon as it is predecoded.
+    if (!dt.bjr_req_rs) {
+        return false;
+    }
+    // Other indirect jumps and returns missing in the stack go to the
+    // target seen last time.
+    const BranchTargetBuffer::Entry *entry = btb.lookup(dt.inst_addr);
+    if (!predicted && entry != nullptr) {
+        predicted = true;
+        target = entry->target;
+    }
+    BranchKind kind = BranchKind::JUMP;
+    if (is_return) {
+        kind = BranchKind::RETURN;
+    } else if (is_link(dt.num_rd)) {
+        kind = BranchKind::CALL;
+    }
+    btb.insert(dt.inst_addr, regs->read_pc(), kind);
+    return !predicted || target != regs->read_pc();
+}
+
 bool StopExceptionHandler::handle_exception(
     Core *core,
     Registers *regs,
@@ -2,6 +2,7 @@
 #define CORE_H
 
 #include "cop0state.h"
+#include "core/branch_predictor.h"
 #include "core/core_state.h"
 #include "instruction.h"
 #include "machineconfig.h"
@@ -13,6 +14,7 @@
 #include "simulator_exception.h"
 
 #include <QObject>
+#include <deque>
 
 namespace machine {
 
@@ -55,7 +57,8 @@ public:
         FrontendMemory *mem_program,
         FrontendMemory *mem_data,
         unsigned int min_cache_row_size = 1,
-        Cop0State *cop0state = nullptr);
+        Cop0State *cop0state = nullptr,
+        Xlen xlen = Xlen::_32);
     ~Core() override;
 
     void step(bool skip_break = false); // Do single step
@@ -65,11 +68,23 @@ public:
     unsigned get_cycle_count() const; // Returns number of executed
                                       // get_cycle_count
     unsigned get_stall_count() const; // Returns number of stall get_cycle_count
+    unsigned get_instruction_count() const; // Retired instructions
+    const FetchStats &get_fetch_stats() const;
+    const BranchStats &get_branch_stats() const;
+    /**
+     * Instructions are still in flight after the fetch reached the end of
+     * program, the core has to be stepped until they finish.
+     */
+    virtual bool busy() const;
 
     Registers *get_regs();
     Cop0State *get_cop0state();
     FrontendMemory *get_mem_data();
     FrontendMemory *get_mem_program();
+    Xlen get_xlen() const;
+    /** Hart index in multi-hart machine, readable by `mhartid` CSR. */
+    void set_hart_id(unsigned id);
+    unsigned get_hart_id() const;
     void register_exception_handler(
         ExceptionCause excause,
         ExceptionHandler *exhandler);
@@ -124,9 +139,9 @@ signals:
     void fetch_branch_value(uint32_t);
     void decode_inst_addr_value(machine::Address);
     void decode_instruction_value(uint32_t);
-    void decode_reg1_value(uint32_t);
-    void decode_reg2_value(uint32_t);
-    void decode_immediate_value(uint32_t);
+    void decode_reg1_value(machine::RegisterValue);
+    void decode_reg2_value(machine::RegisterValue);
+    void decode_immediate_value(machine::RegisterValue);
     void decode_regw_value(uint32_t);
     void decode_memtoreg_value(uint32_t);
     void decode_memwrite_value(uint32_t);
@@ -140,12 +155,12 @@ signals:
     void forward_m_d_rs_value(uint32_t);
     void forward_m_d_rt_value(uint32_t);
     void execute_inst_addr_value(machine::Address);
-    void execute_alu_value(uint32_t);
-    void execute_reg1_value(uint32_t);
-    void execute_reg2_value(uint32_t);
+    void execute_alu_value(machine::RegisterValue);
+    void execute_reg1_value(machine::RegisterValue);
+    void execute_reg2_value(machine::RegisterValue);
     void execute_reg1_ff_value(uint32_t);
     void execute_reg2_ff_value(uint32_t);
-    void execute_immediate_value(uint32_t);
+    void execute_immediate_value(machine::RegisterValue);
     void execute_regw_value(uint32_t);
     void execute_memtoreg_value(uint32_t);
     void execute_memwrite_value(uint32_t);
@@ -158,9 +173,9 @@ signals:
     void execute_rt_num_value(uint32_t);
     void execute_rd_num_value(uint32_t);
     void memory_inst_addr_value(machine::Address);
-    void memory_alu_value(uint32_t);
-    void memory_rt_value(uint32_t);
-    void memory_mem_value(uint32_t);
+    void memory_alu_value(machine::RegisterValue);
+    void memory_rt_value(machine::RegisterValue);
+    void memory_mem_value(machine::RegisterValue);
     void memory_regw_value(uint32_t);
     void memory_memtoreg_value(uint32_t);
     void memory_memwrite_value(uint32_t);
@@ -168,7 +183,7 @@ signals:
     void memory_regw_num_value(uint32_t);
     void memory_excause_value(uint32_t);
     void writeback_inst_addr_value(machine::Address);
-    void writeback_value(uint32_t);
+    void writeback_value(machine::RegisterValue);
     void writeback_memtoreg_value(uint32_t);
     void writeback_regw_value(uint32_t);
     void writeback_regw_num_value(uint32_t);
@@ -178,6 +193,16 @@ signals:
 
     void cycle_c_value(uint32_t);
     void stall_c_value(uint32_t);
+    void mispredict_c_value(uint32_t);
+    /**
+     * Control transfer (or falsely predicted instruction) was resolved by
+     * pipelined core, `next_addr` is the correct successor.
+     */
+    void branch_resolved(
+        machine::Address inst_addr,
+        machine::Address next_addr,
+        bool taken,
+        bool mispredicted);
 
     void stop_on_exception_reached();
 
@@ -202,22 +227,85 @@ protected:
     FrontendMemory *mem_data, *mem_program;
     QMap<ExceptionCause, ExceptionHandler *> ex_handlers;
     ExceptionHandler *ex_default_handler;
-
-    FetchState fetch(bool skip_break = false);
+    const Xlen xlen;
+    unsigned hart_id = 0; // Also owner of LR reservations in memory system
+
+    /**
+     * Fetch buffer holds the last aligned word read from program memory.
+     * Compressed instructions sharing a word are fetched by a single access,
+     * instruction straddling two words needs both of them.
+     */
+    struct {
+        Address address;
+        uint32_t data = 0;
+        uint32_t change_counter = 0;
+        bool valid = false;
+    } fetch_buffer;
+    bool fetch_held = false;  // Fetched by `decode_next`, not completed yet
+    Address completed_addr {}; // Last instruction passed to `complete_next`
+
+    /**
+     * Aligned word of program memory, from the fetch buffer when held.
+     *
+     * @param accepted  result enters the pipeline, fetch of a stalled one
+     *                  does not update the buffer nor fetch statistics
+     */
+    uint32_t fetch_word(Address address, bool accepted);
+    /** Code of the instruction at address, only low half for RVC. */
+    uint32_t fetch_code(Address inst_addr, bool accepted);
+    FetchState fetch(bool skip_break = false, bool accepted = true);
     DecodeState decode(const FetchInterstage &);
     ExecuteState execute(const DecodeInterstage &);
     MemoryState memory(const ExecuteInterstage &);
     WritebackState writeback(const MemoryInterstage &);
     bool handle_pc(const DecodeInterstage &);
+    /**
+     * Fetch and decode of the instruction at PC for cores which issue
+     * fetched instructions later. Instruction fetched but not issued is kept
+     * and decoded again (with current register values) by the next call.
+     */
+    const DecodeInterstage &decode_next(bool skip_break);
+    /**
+     * Passes instruction decoded by `decode_next` through the remaining
+     * stages and updates PC. Exception is passed to its handler.
+     *
+     * @param taken     set for taken jump or branch
+     * @return          exception cause of the instruction
+     */
+    enum ExceptionCause complete_next(bool &taken);
+    /**
+     * Address of the instruction following the decoded one. Set `taken` for
+     * taken branches and jumps.
+     */
+    Address resolve_pc(const DecodeInterstage &, bool &taken);
+
+    /** Address in the simulated address space (truncated to XLEN). */
+    Address to_address(RegisterValue value) const;
+    /** Specialized ALU or multiplier operation of the instruction. */
+    AluFunction
+    decode_alu_function(enum InstructionFlags flags, AluOp alu_op) const;
+    /** Condition of the decoded branch instruction evaluated on rs and rt. */
+    bool branch_taken(const DecodeInterstage &) const;
+    /** Floating-point operation, exception flags are accrued to fcsr. */
+    RegisterValue fpu_execute(const DecodeInterstage &);
+    /** CSR instruction, returns old value of the register. */
+    RegisterValue csr_operate(const DecodeInterstage &);
 
     enum ExceptionCause memory_special(
         enum AccessControl memctl,
-        int mode,
+        const Instruction &inst,
         bool memread,
         bool memwrite,
         RegisterValue &towrite_val,
         RegisterValue rt_value,
         Address mem_addr);
+    /** LR, SC and AMO instructions (RISC-V "A" extension). */
+    enum ExceptionCause memory_atomic(
+        enum AccessControl memctl,
+        const Instruction &inst,
+        RegisterValue &towrite_val,
+        RegisterValue rt_value,
+        Address mem_addr);
 
     // Initialize structures to NOPE instruction
     static void dtFetchInit(FetchInterstage &dt);
@@ -233,7 +321,8 @@ public:
         FrontendMemory *mem_program,
         FrontendMemory *mem_data,
         unsigned int min_cache_row_size = 1,
-        Cop0State *cop0state = nullptr);
+        Cop0State *cop0state = nullptr,
+        Xlen xlen = Xlen::_32);
 
 protected:
     void do_step(bool skip_break = false) override;
@@ -252,14 +341,201 @@ public:
         enum MachineConfig::HazardUnit hazard_unit
         = MachineConfig::HU_STALL_FORWARD,
         unsigned int min_cache_row_size = 1,
-        Cop0State *cop0state = nullptr);
+        Cop0State *cop0state = nullptr,
+        Xlen xlen = Xlen::_32,
+        const BranchPredictorConfig &bp_config = BranchPredictorConfig());
+
+    const BranchPredictor *get_branch_predictor() const;
+    const BranchTargetBuffer &get_btb() const;
+    const ReturnAddressStack &get_ras() const;
+
+protected:
+    void do_step(bool skip_break = false) override;
+    void do_reset() override;
+
+private:
+    /**
+     * Verify prediction made for the decoded instruction against its resolved
+     * successor and predict the successor of the newly fetched one.
+     *
+     * @return  true when the fetched instruction has to be flushed
+     */
+    bool handle_pc_predicted(const DecodeInterstage &);
+    /** Predicted successor of the fetched instruction, if taken. */
+    bool predict_taken(const FetchInterstage &, Address &target) const;
+    void train_predictor(const DecodeInterstage &, bool taken, Address target);
+
+    MachineConfig::HazardUnit hazard_unit;
+    std::unique_ptr<BranchPredictor> predictor;
+    BranchTargetBuffer btb;
+    ReturnAddressStack ras;
+};
+
+/**
+ * In-order multi-issue core.
+ *
+ * Instructions go through the stage functions one by one in program order,
+ * as in single cycle core, so architectural results are the same. A step is
+ * one cycle of N-wide in-order pipeline with full forwarding and branches
+ * resolved in decode: it issues the longest prefix of the instruction stream
+ * fitting into the issue slots. Instruction fetched but not issued waits for
+ * the next cycle.
+ *
+ * Pairing rules: an instruction cannot issue with an older instruction of
+ * the same cycle producing its operand or writing the same register, ALU,
+ * multiplier (also used by FPU) and memory ports are limited, serializing
+ * instructions (CSR access, environment calls, exceptions) issue alone and
+ * a taken jump or branch ends the bundle and costs one bubble cycle. Loaded
+ * value is available one cycle after the load.
+ */
+class CoreSuperscalar : public Core {
+public:
+    CoreSuperscalar(
+        Registers *regs,
+        FrontendMemory *mem_program,
+        FrontendMemory *mem_data,
+        unsigned issue_width = 2,
+        unsigned alu_ports = 0,
+        unsigned mul_ports = 1,
+        unsigned mem_ports = 1,
+        unsigned int min_cache_row_size = 1,
+        Cop0State *cop0state = nullptr,
+        Xlen xlen = Xlen::_32);
+
+    unsigned get_issue_width() const;
+    const IssueStats &get_issue_stats() const;
+    /** Machine stops at the end of the program, bundles do too. */
+    void set_program_end(Address address);
+
+protected:
+    void do_step(bool skip_break = false) override;
+    void do_reset() override;
+
+private:
+    /** Functional units the instructions of the bundle occupy. */
+    struct Ports {
+        unsigned alu = 0, mul = 0, mem = 0;
+    };
+
+    /**
+     * Checks whether decoded instruction can issue in the slot after older
+     * instructions of the bundle writing `written` registers.
+     *
+     * @return  reason preventing the issue or IL_COUNT when it can issue
+     */
+    enum IssueLimit issue_limit(
+        const DecodeInterstage &dt,
+        unsigned slot,
+        uint64_t written,
+        const Ports &used) const;
+    /** Registers of the decoded instruction as a mask. */
+    static uint64_t source_mask(const DecodeInterstage &dt);
+    static uint64_t dest_mask(const DecodeInterstage &dt);
+    void bubble(enum IssueLimit reason);
+
+    const unsigned issue_width;
+    const Ports ports;
+    IssueStats issue_stats;
+    bool control_bubble = false;
+    uint64_t loaded_prev = 0; // Registers loaded by the previous cycle
+    Address program_end = 0xffff0000_addr;
+};
+
+/**
+ * Timing model of out-of-order core.
+ *
+ * Instructions are executed at dispatch, in program order by the stages of
+ * single cycle core, so architectural state is the same as of the other
+ * cores. The model only decides when the instructions would issue, complete
+ * and commit. Dispatch renames source registers to in-flight producers and
+ * allocates entries of reorder buffer, issue queue and (for memory accesses)
+ * load/store queue. Issue selects the oldest ready instructions up to issue
+ * width and free execution ports. Commit retires completed instructions in
+ * program order. Addresses of memory accesses are known, so a load waits
+ * only for older store to the same doubleword.
+ *
+ * Conditional branches are predicted by the configured predictor and
+ * returns by return address stack, other indirect jumps are mispredicted.
+ * Dispatch of the correct path waits until the mispredicted instruction
+ * completes and the penalty elapses. Serializing instructions (CSR access,
+ * exceptions) are dispatched to empty reorder buffer and block dispatch
+ * until committed.
+ *
+ * One step is one cycle. The step dispatching the last instruction of the
+ * program runs the remaining cycles until the reorder buffer drains.
+ */
+class CoreOutOfOrder : public Core {
+public:
+    CoreOutOfOrder(
+        Registers *regs,
+        FrontendMemory *mem_program,
+        FrontendMemory *mem_data,
+        const OutOfOrderConfig &config = OutOfOrderConfig(),
+        unsigned alu_ports = 0,
+        unsigned mul_ports = 1,
+        unsigned mem_ports = 1,
+        const BranchPredictorConfig &bp_config = BranchPredictorConfig(),
+        unsigned int min_cache_row_size = 1,
+        Cop0State *cop0state = nullptr,
+        Xlen xlen = Xlen::_32);
+
+    const OutOfOrderConfig &get_config() const;
+    const OutOfOrderStats &get_ooo_stats() const;
+    /** Machine stops at the end of the program, dispatch does too. */
+    void set_program_end(Address address);
+    /** Reorder buffer is not empty. */
+    bool busy() const override;
 
 protected:
     void do_step(bool skip_break = false) override;
     void do_reset() override;
 
 private:
-        MachineConfig::HazardUnit hazard_unit;
+    enum Unit { UNIT_ALU, UNIT_MUL, UNIT_MEM };
+
+    struct RobEntry {
+        uint64_t seq = 0;
+        std::array<uint64_t, 3> sources {}; // Producer sequence, 0 if none
+        uint8_t dest = 0;                   // Renamed register, 0 if none
+        enum Unit unit = UNIT_ALU;
+        unsigned latency = 1;
+        bool load = false;
+        bool store = false;
+        Address mem_addr;
+        bool issued = false;
+        uint32_t done_cycle = 0; // Result available, valid once issued
+    };
+
+    void commit();
+    void issue();
+    /** @return reason which ended dispatch early or DS_COUNT */
+    enum DispatchStall dispatch(bool skip_break);
+    void sample_occupancy();
+    /** Entry of in-flight instruction, nullptr when it was committed. */
+    const RobEntry *in_flight(uint64_t seq) const;
+    bool completed(uint64_t seq) const;
+    /**
+     * Trains predictors, @return true when fetch would go astray. Target of
+     * indirect jump is taken from return address stack or branch target
+     * buffer.
+     */
+    bool mispredicted(const DecodeInterstage &dt, bool taken);
+
+    const OutOfOrderConfig config;
+    const unsigned alu_ports, mul_ports, mem_ports;
+    std::unique_ptr<BranchPredictor> predictor;
+    BranchTargetBuffer btb; // Targets of indirect jumps only
+    ReturnAddressStack ras;
+    OutOfOrderStats ooo_stats;
+    std::deque<RobEntry> rob;
+    std::array<uint64_t, 64> rename {}; // Youngest in-flight producer
+    uint64_t next_seq = 1;
+    unsigned iq_used = 0;
+    unsigned lsq_used = 0;
+    uint64_t redirect_seq = 0;      // Mispredicted transfer to wait for
+    uint32_t redirect_cycle = 0;    // Its target can be dispatched since
+    bool serialize_pending = false; // Serializing instruction in flight
+    Address program_end = 0xffff0000_addr;
 };
 
 } // namespace machine
@@ -0,0 +1,676 @@
+#include "core.h"
+
+#include "core.test.h"
+#include "memory/backend/memory.h"
+#include "memory/memory_bus.h"
+#include "simulator_exception.h"
+
+using namespace machine;
+
+/** Store code fragment to memory, return address following its end. */
+static Address
+load_code(Memory &mem, Address addr, const QVector<uint32_t> &code) {
+    for (uint32_t word : code) {
+        memory_write_u32(&mem, addr.get_raw(), word);
+        addr += 4;
+    }
+    return addr;
+}
+
+/**
+ * Step core until program counter reaches the end address and no instruction
+ * is in flight.
+ */
+static void run_until(Core &core, Registers &regs, Address end) {
+    for (int k = 1000; k > 0 && (regs.read_pc() != end || core.busy()); k--) {
+        core.step();
+    }
+    QCOMPARE(regs.read_pc(), end);
+    QVERIFY(!core.busy());
+}
+
+/**
+ * Loop of ten iterations calling a function, results are stored to memory.
+ * Code ends with nops, so the last instruction before them leaves the pipeline
+ * by the time the fetch reaches the end.
+ */
+static const QVector<uint32_t> call_loop_code {
+    0x00a00513, // addi a0, zero, 10
+    0x00000593, // addi a1, zero, 0
+    0x00a585b3, // loop: add a1, a1, a0
+    0x018000ef, // jal  ra, func
+    0xfff50513, // addi a0, a0, -1
+    0xfe051ae3, // bnez a0, loop
+    0x10b02023, // sw   a1, 256(zero)
+    0x10c02223, // sw   a2, 260(zero)
+    0x00c0006f, // j    done
+    0x00160613, // func: addi a2, a2, 1
+    0x00008067, // ret
+    0x00000013, // done: nop
+    0x00000013, // nop
+    0x00000013, // nop
+    0x00000013, // nop
+};
+
+/**
+ * Store and sum of an array with load-use dependency in the loop followed by
+ * independent multiplications.
+ */
+static const QVector<uint32_t> array_sum_code {
+    0x10000293, // addi t0, zero, 0x100
+    0x00500313, // addi t1, zero, 5
+    0x00000393, // addi t2, zero, 0
+    0x0062a023, // store: sw t1, 0(t0)
+    0x00428293, // addi t0, t0, 4
+    0xfff30313, // addi t1, t1, -1
+    0xfe031ae3, // bnez t1, store
+    0x10000293, // addi t0, zero, 0x100
+    0x00500e13, // addi t3, zero, 5
+    0x0002ae83, // load: lw t4, 0(t0)
+    0x01d383b3, // add  t2, t2, t4
+    0x00428293, // addi t0, t0, 4
+    0xfffe0e13, // addi t3, t3, -1
+    0xfe0e18e3, // bnez t3, load
+    0x20702023, // sw   t2, 512(zero)
+    0x00300513, // addi a0, zero, 3
+    0x00400593, // addi a1, zero, 4
+    0x02b50633, // mul  a2, a0, a1
+    0x02a506b3, // mul  a3, a0, a0
+    0x00d60733, // add  a4, a2, a3
+    0x20e02223, // sw   a4, 516(zero)
+    0x00000013, // nop
+    0x00000013, // nop
+    0x00000013, // nop
+    0x00000013, // nop
+};
+
+/**
+ * Chain of multiplications blocking commit, independent instructions
+ * executing under it and stores forwarded to loads.
+ */
+static const QVector<uint32_t> mul_chain_code {
+    0x00300513, // addi a0, zero, 3
+    0x02a505b3, // mul  a1, a0, a0
+    0x02a585b3, // mul  a1, a1, a0
+    0x02a585b3, // mul  a1, a1, a0
+    0x00100613, // addi a2, zero, 1
+    0x00200693, // addi a3, zero, 2
+    0x00300713, // addi a4, zero, 3
+    0x00400793, // addi a5, zero, 4
+    0x10c02023, // sw   a2, 256(zero)
+    0x10d02223, // sw   a3, 260(zero)
+    0x10e02423, // sw   a4, 264(zero)
+    0x10f02623, // sw   a5, 268(zero)
+    0x10002303, // lw   t1, 256(zero)
+    0x10802383, // lw   t2, 264(zero)
+    0x00730e33, // add  t3, t1, t2
+    0x10b02823, // sw   a1, 272(zero)
+    0x11c02a23, // sw   t3, 276(zero)
+    0x00000013, // nop
+    0x00000013, // nop
+    0x00000013, // nop
+    0x00000013, // nop
+};
+
+/** Run code fragment on single cycle core to get the reference state. */
+static void run_reference(
+    const QVector<uint32_t> &code,
+    Registers &regs,
+    Memory &mem) {
+    TrivialBus bus(&mem);
+    const Address end = load_code(mem, regs.read_pc(), code);
+    CoreSingle core(&regs, &bus, &bus, 1);
+    run_until(core, regs, end);
+}
+
+/**
+ * Run code fragment on another core until its fetch reaches the end, then
+ * compare the state with the single cycle core. Program counter is not
+ * compared.
+ */
+static void compare_with_reference(
+    Core &core,
+    Registers &regs,
+    Memory &mem,
+    const QVector<uint32_t> &code) {
+    Registers regs_ref;
+    Memory mem_ref(LITTLE);
+    run_reference(code, regs_ref, mem_ref);
+
+    const Address end = load_code(mem, regs.read_pc(), code);
+    run_until(core, regs, end);
+    regs.pc_abs_jmp(regs_ref.read_pc());
+    QCOMPARE(regs, regs_ref);
+    QCOMPARE(mem, mem_ref);
+}
+
+void TestCore::test_rv64_decode_data() {
+    QTest::addColumn<uint32_t>("code");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("ADDIW") << (uint32_t)0x0005059b << "addiw x11, x10, 0";
+    QTest::newRow("SLLIW") << (uint32_t)0x01f6171b << "slliw x14, x12, 0x1F";
+    QTest::newRow("ADDW") << (uint32_t)0x00c606bb << "addw x13, x12, x12";
+    QTest::newRow("MULW") << (uint32_t)0x02c60a3b << "mulw x20, x12, x12";
+    QTest::newRow("LD") << (uint32_t)0x1002b783 << "ld x15, 256(x5)";
+    QTest::newRow("LWU") << (uint32_t)0x1002e883 << "lwu x17, 256(x5)";
+    QTest::newRow("SD") << (uint32_t)0x10c2b023 << "sd x12, 256(x5)";
+}
+
+void TestCore::test_rv64_decode() {
+    QFETCH(uint32_t, code);
+    QFETCH(QString, text);
+
+    QCOMPARE(Instruction(code).to_str(), text);
+}
+
+void TestCore::test_rvc_expand_data() {
+    QTest::addColumn<uint32_t>("code");
+    QTest::addColumn<bool>("rv64");
+    QTest::addColumn<uint32_t>("expanded");
+
+    // Quadrant 0
+    QTest::newRow("C.ADDI4SPN") << (uint32_t)0x0808 << false
+                                << (uint32_t)0x01010513; // addi a0, sp, 16
+    QTest::newRow("C.LW") << (uint32_t)0x414c << false
+                          << (uint32_t)0x00452583; // lw a1, 4(a0)
+    QTest::newRow("C.SW") << (uint32_t)0xc50c << false
+                          << (uint32_t)0x00b52423; // sw a1, 8(a0)
+    QTest::newRow("C.FLW") << (uint32_t)0x6148 << false
+                           << (uint32_t)0x00452507; // flw fa0, 4(a0)
+    QTest::newRow("C.FSD") << (uint32_t)0xa50c << false
+                           << (uint32_t)0x00b53427; // fsd fa1, 8(a0)
+    QTest::newRow("C.LD") << (uint32_t)0x650c << true
+                          << (uint32_t)0x00853583; // ld a1, 8(a0)
+    QTest::newRow("C.SD") << (uint32_t)0xe50c << true
+                          << (uint32_t)0x00b53423; // sd a1, 8(a0)
+    // Quadrant 1
+    QTest::newRow("C.NOP") << (uint32_t)0x0001 << false
+                           << (uint32_t)0x00000013; // addi zero, zero, 0
+    QTest::newRow("C.ADDI") << (uint32_t)0x157d << false
+                            << (uint32_t)0xfff50513; // addi a0, a0, -1
+    QTest::newRow("C.JAL") << (uint32_t)0x2021 << false
+                           << (uint32_t)0x008000ef; // jal ra, 8
+    QTest::newRow("C.ADDIW") << (uint32_t)0x2505 << true
+                             << (uint32_t)0x0015051b; // addiw a0, a0, 1
+    QTest::newRow("C.LI") << (uint32_t)0x4515 << false
+                          << (uint32_t)0x00500513; // addi a0, zero, 5
+    QTest::newRow("C.ADDI16SP") << (uint32_t)0x6105 << false
+                                << (uint32_t)0x02010113; // addi sp, sp, 32
+    QTest::newRow("C.LUI") << (uint32_t)0x6505 << false
+                           << (uint32_t)0x00001537; // lui a0, 1
+    QTest::newRow("C.SRLI") << (uint32_t)0x8105 << false
+                            << (uint32_t)0x00155513; // srli a0, a0, 1
+    QTest::newRow("C.SRAI") << (uint32_t)0x8505 << false
+                            << (uint32_t)0x40155513; // srai a0, a0, 1
+    QTest::newRow("C.ANDI") << (uint32_t)0x890d << false
+                            << (uint32_t)0x00357513; // andi a0, a0, 3
+    QTest::newRow("C.SUB") << (uint32_t)0x8d0d << false
+                           << (uint32_t)0x40b50533; // sub a0, a0, a1
+    QTest::newRow("C.XOR") << (uint32_t)0x8d2d << false
+                           << (uint32_t)0x00b54533; // xor a0, a0, a1
+    QTest::newRow("C.OR") << (uint32_t)0x8d4d << false
+                          << (uint32_t)0x00b56533; // or a0, a0, a1
+    QTest::newRow("C.AND") << (uint32_t)0x8d6d << false
+                           << (uint32_t)0x00b57533; // and a0, a0, a1
+    QTest::newRow("C.SUBW") << (uint32_t)0x9d0d << true
+                            << (uint32_t)0x40b5053b; // subw a0, a0, a1
+    QTest::newRow("C.ADDW") << (uint32_t)0x9d2d << true
+                            << (uint32_t)0x00b5053b; // addw a0, a0, a1
+    QTest::newRow("C.J") << (uint32_t)0xa801 << false
+                         << (uint32_t)0x0100006f; // jal zero, 16
+    QTest::newRow("C.BEQZ") << (uint32_t)0xc501 << false
+                            << (uint32_t)0x00050463; // beq a0, zero, 8
+    QTest::newRow("C.BNEZ") << (uint32_t)0xfd65 << false
+                            << (uint32_t)0xfe051ce3; // bne a0, zero, -8
+    // Quadrant 2
+    QTest::newRow("C.SLLI") << (uint32_t)0x050a << false
+                            << (uint32_t)0x00251513; // slli a0, a0, 2
+    QTest::newRow("C.SLLI, RV64") << (uint32_t)0x1522 << true
+                                  << (uint32_t)0x02851513; // slli a0, a0, 40
+    QTest::newRow("C.LWSP") << (uint32_t)0x4512 << false
+                            << (uint32_t)0x00412503; // lw a0, 4(sp)
+    QTest::newRow("C.LDSP") << (uint32_t)0x6522 << true
+                            << (uint32_t)0x00813503; // ld a0, 8(sp)
+    QTest::newRow("C.JR") << (uint32_t)0x8082 << false
+                          << (uint32_t)0x00008067; // jalr zero, 0(ra)
+    QTest::newRow("C.MV") << (uint32_t)0x852e << false
+                          << (uint32_t)0x00b00533; // add a0, zero, a1
+    QTest::newRow("C.EBREAK") << (uint32_t)0x9002 << false
+                              << (uint32_t)0x00100073; // ebreak
+    QTest::newRow("C.JALR") << (uint32_t)0x9502 << false
+                            << (uint32_t)0x000500e7; // jalr ra, 0(a0)
+    QTest::newRow("C.ADD") << (uint32_t)0x952e << false
+                           << (uint32_t)0x00b50533; // add a0, a0, a1
+    QTest::newRow("C.SWSP") << (uint32_t)0xc42a << false
+                            << (uint32_t)0x00a12423; // sw a0, 8(sp)
+    QTest::newRow("C.SDSP") << (uint32_t)0xe82a << true
+                            << (uint32_t)0x00a13823; // sd a0, 16(sp)
+    // Reserved encodings expand to illegal zero.
+    QTest::newRow("zero") << (uint32_t)0x0000 << false << (uint32_t)0;
+    QTest::newRow("C.ADDI4SPN, zero immediate")
+        << (uint32_t)0x0008 << false << (uint32_t)0;
+    QTest::newRow("C.LUI, zero immediate")
+        << (uint32_t)0x6501 << false << (uint32_t)0;
+    QTest::newRow("C.SLLI, RV32 shamt[5]")
+        << (uint32_t)0x1502 << false << (uint32_t)0;
+    QTest::newRow("C.SUBW, RV32") << (uint32_t)0x9d0d << false << (uint32_t)0;
+}
+
+void TestCore::test_rvc_expand() {
+    QFETCH(uint32_t, code);
+    QFETCH(bool, rv64);
+    QFETCH(uint32_t, expanded);
+
+    const Instruction inst(code);
+    QCOMPARE(inst.size(), (uint8_t)2);
+    QCOMPARE(inst.expanded(rv64 ? Xlen::_64 : Xlen::_32).data(), expanded);
+}
+
+void TestCore::test_rv64_execute() {
+    const Address high = 0x100000000_addr; // Above 4 GiB
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    const Address end = load_code(
+        mem, regs.read_pc(),
+        {
+            0xfff00513, // addi  x10, x0, -1
+            0x0005059b, // addiw x11, x10, 0
+            0x02055613, // srli  x12, x10, 32
+            0x00c606bb, // addw  x13, x12, x12
+            0x01f6171b, // slliw x14, x12, 31
+            0x40c009bb, // subw  x19, x0, x12
+            0x02c60a3b, // mulw  x20, x12, x12
+            0x40475a9b, // sraiw x21, x14, 4
+            0x00100293, // addi  x5, x0, 1
+            0x02029293, // slli  x5, x5, 32
+            0x000280e7, // jalr  x1, 0(x5)
+        });
+    load_code(
+        mem, high,
+        {
+            0x00000317, // auipc x6, 0
+            0x10c2b023, // sd    x12, 256(x5)
+            0x1002b783, // ld    x15, 256(x5)
+            0x1002a803, // lw    x16, 256(x5)
+            0x1002e883, // lwu   x17, 256(x5)
+            0x10003903, // ld    x18, 256(x0)
+            0x00008067, // jalr  x0, 0(x1)
+        });
+
+    CoreSingle core(&regs, &bus, &bus, 1, nullptr, Xlen::_64);
+    run_until(core, regs, end);
+
+    QCOMPARE(regs.read_gp(10).as_u64(), (uint64_t)0xffffffffffffffff);
+    QCOMPARE(regs.read_gp(11).as_u64(), (uint64_t)0xffffffffffffffff);
+    QCOMPARE(regs.read_gp(12).as_u64(), (uint64_t)0x00000000ffffffff);
+    QCOMPARE(regs.read_gp(13).as_u64(), (uint64_t)0xfffffffffffffffe);
+    QCOMPARE(regs.read_gp(14).as_u64(), (uint64_t)0xffffffff80000000);
+    QCOMPARE(regs.read_gp(19).as_u64(), (uint64_t)1);
+    QCOMPARE(regs.read_gp(20).as_u64(), (uint64_t)1);
+    QCOMPARE(regs.read_gp(21).as_u64(), (uint64_t)0xfffffffff8000000);
+    // Program counter and return address are 64-bit.
+    QCOMPARE(regs.read_gp(1).as_u64(), end.get_raw());
+    QCOMPARE(regs.read_gp(6).as_u64(), high.get_raw());
+    // Doubleword and zero-extended word loads.
+    QCOMPARE(regs.read_gp(15).as_u64(), (uint64_t)0x00000000ffffffff);
+    QCOMPARE(regs.read_gp(16).as_u64(), (uint64_t)0xffffffffffffffff);
+    QCOMPARE(regs.read_gp(17).as_u64(), (uint64_t)0x00000000ffffffff);
+    // Memory above 4 GiB does not alias low memory.
+    QCOMPARE(regs.read_gp(18).as_u64(), (uint64_t)0);
+    QCOMPARE(
+        memory_read_u64(&mem, (high + 0x100).get_raw()), (uint64_t)0xffffffff);
+    QCOMPARE(memory_read_u64(&mem, (uint64_t)0x100), (uint64_t)0);
+}
+
+void TestCore::test_rv64_only_in_rv64() {
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    load_code(mem, regs.read_pc(), { 0x0005059b }); // addiw x11, x10, 0
+
+    CoreSingle core(&regs, &bus, &bus, 1, nullptr, Xlen::_32);
+    bool thrown = false;
+    try {
+        core.step();
+    } catch (SimulatorExceptionUnsupportedInstruction &) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+}
+
+void TestCore::test_compressed_fetch() {
+    // Halfwords are listed from the low one, 32-bit instructions at 0xa and
+    // 0x1a straddle two fetched words.
+    const QVector<uint32_t> code {
+        0x458d4515, // c.li a0, 5; c.li a1, 3
+        0x10a02023, // sw   a0, 256(zero)
+        0x2603952e, // c.add a0, a1; lw a2, 256(zero) (low half)
+        0x962a1000, // (lw high half); c.add a2, a0
+        0x10c02223, // sw   a2, 260(zero)
+        0x86b20606, // c.slli a2, 1; c.mv a3, a2
+        0x87130001, // c.nop; addi a4, a3, 1 (low half)
+        0x00010016, // (addi high half); c.nop
+        0x00000013, // nop
+        0x00000013, // nop
+        0x00000013, // nop
+        0x00000013, // nop
+    };
+    Registers regs_single;
+    Memory mem_single(LITTLE);
+    TrivialBus bus_single(&mem_single);
+    const Address end = load_code(mem_single, regs_single.read_pc(), code);
+    CoreSingle single(&regs_single, &bus_single, &bus_single, 1);
+    run_until(single, regs_single, end);
+    QCOMPARE(regs_single.read_gp(10).as_u32(), (uint32_t)8);
+    QCOMPARE(regs_single.read_gp(12).as_u32(), (uint32_t)26);
+    QCOMPARE(regs_single.read_gp(13).as_u32(), (uint32_t)26);
+    QCOMPARE(regs_single.read_gp(14).as_u32(), (uint32_t)27);
+    QCOMPARE(memory_read_u32(&mem_single, 0x100), (uint32_t)5);
+    QCOMPARE(memory_read_u32(&mem_single, 0x104), (uint32_t)13);
+
+    const FetchStats &stats_single = single.get_fetch_stats();
+    QCOMPARE(stats_single.instructions, (uint32_t)16);
+    QCOMPARE(stats_single.compressed, (uint32_t)8);
+
+    // Load-use stall of the pipeline does not count the stalled fetch.
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    CorePipelined core(&regs, &bus, &bus);
+    compare_with_reference(core, regs, mem, code);
+    QCOMPARE(core.get_stall_count(), 1u);
+
+    const FetchStats &stats = core.get_fetch_stats();
+    QCOMPARE(stats.instructions, stats_single.instructions);
+    QCOMPARE(stats.compressed, stats_single.compressed);
+    // Stores invalidate the fetch buffer at different time.
+    QCOMPARE(
+        stats.mem_reads + stats.buffer_hits,
+        stats_single.mem_reads + stats_single.buffer_hits);
+}
+
+void TestCore::test_branch_predictor() {
+    const Address branch = 0x200_addr, loop = 0x100_addr;
+    // Loop of ten iterations, 2-bit counter misses only the first and the
+    // last one.
+    BranchPredictorBimodal bimodal(4, 2);
+    unsigned missed = 0;
+    for (int i = 0; i < 10; i++) {
+        const bool taken = i != 9;
+        missed += bimodal.predict(branch, loop) != taken;
+        bimodal.update(branch, taken);
+    }
+    QCOMPARE(missed, 2u);
+
+    // Alternating outcome is learned by global history.
+    BranchPredictorGshare gshare(6);
+    missed = 0;
+    for (int i = 0; i < 100; i++) {
+        const bool taken = i & 1;
+        missed += i >= 20 && gshare.predict(branch, loop) != taken;
+        gshare.update(branch, taken);
+    }
+    QCOMPARE(missed, 0u);
+
+    BranchPredictorBTFN btfn;
+    QVERIFY(btfn.predict(branch, loop));
+    QVERIFY(!btfn.predict(loop, branch));
+
+    BranchTargetBuffer btb(4);
+    btb.insert(branch, loop, BranchKind::BRANCH);
+    QVERIFY(btb.lookup(branch) != nullptr);
+    QCOMPARE(btb.lookup(branch)->target, loop);
+    QVERIFY(btb.lookup(branch + 8) == nullptr); // Same index, other tag
+    btb.remove(branch);
+    QVERIFY(btb.lookup(branch) == nullptr);
+
+    // Full stack overwrites the oldest return address.
+    ReturnAddressStack ras(2);
+    ras.push(0x4_addr);
+    ras.push(0x8_addr);
+    ras.push(0xc_addr);
+    Address ret;
+    QVERIFY(ras.pop(ret));
+    QCOMPARE(ret, 0xc_addr);
+    QVERIFY(ras.pop(ret));
+    QCOMPARE(ret, 0x8_addr);
+    QVERIFY(!ras.pop(ret));
+}
+
+void TestCore::test_branch_prediction_data() {
+    QTest::addColumn<int>("predictor");
+    QTest::addColumn<unsigned>("btb_entries");
+    QTest::addColumn<unsigned>("ras_entries");
+    QTest::addColumn<unsigned>("penalty_cycles");
+
+    // Without BTB every taken branch and jump is found in decode: 10 calls,
+    // 10 returns, 9 taken loop branches and the final jump.
+    QTest::newRow("no BTB") << (int)BranchPredictorConfig::BP_BIMODAL2 << 0u
+                            << 0u << 30u;
+    // Jumps hit BTB from the second iteration on, the loop branch is always
+    // predicted not taken.
+    QTest::newRow("not taken")
+        << (int)BranchPredictorConfig::BP_NOT_TAKEN << 16u << 0u << 12u;
+    // First and last iteration of the loop branch are mispredicted.
+    QTest::newRow("BTFN") << (int)BranchPredictorConfig::BP_BTFN << 16u << 0u
+                          << 5u;
+    QTest::newRow("bimodal1")
+        << (int)BranchPredictorConfig::BP_BIMODAL1 << 16u << 0u << 5u;
+    QTest::newRow("bimodal2")
+        << (int)BranchPredictorConfig::BP_BIMODAL2 << 16u << 0u << 5u;
+    QTest::newRow("bimodal2 RAS")
+        << (int)BranchPredictorConfig::BP_BIMODAL2 << 16u << 4u << 5u;
+    // Global history needs four more iterations to fill up.
+    QTest::newRow("gshare") << (int)BranchPredictorConfig::BP_GSHARE << 16u
+                            << 4u << 9u;
+}
+
+void TestCore::test_branch_prediction() {
+    QFETCH(int, predictor);
+    QFETCH(unsigned, btb_entries);
+    QFETCH(unsigned, ras_entries);
+    QFETCH(unsigned, penalty_cycles);
+
+    BranchPredictorConfig bp_config;
+    bp_config.set_predictor((BranchPredictorConfig::Predictor)predictor);
+    bp_config.set_table_bits(4);
+    bp_config.set_btb_entries(btb_entries);
+    bp_config.set_ras_entries(ras_entries);
+
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    CorePipelined core(
+        &regs, &bus, &bus, MachineConfig::HU_STALL_FORWARD, 1, nullptr,
+        Xlen::_32, bp_config);
+    // Prediction changes only timing.
+    compare_with_reference(core, regs, mem, call_loop_code);
+    QCOMPARE(memory_read_u32(&mem, 0x100), (uint32_t)55);
+    QCOMPARE(memory_read_u32(&mem, 0x104), (uint32_t)10);
+
+    const BranchStats &stats = core.get_branch_stats();
+    QCOMPARE(stats.branches, 10u);
+    QCOMPARE(stats.jumps, 21u);
+    QCOMPARE(stats.penalty_cycles, penalty_cycles);
+    QCOMPARE(
+        stats.branches_mispredicted + stats.jumps_mispredicted,
+        penalty_cycles);
+}
+
+void TestCore::test_superscalar_issue() {
+    QVector<uint32_t> code {
+        0x00100093, // addi x1,x0,1
+        0x00200113, // addi x2,x0,2
+        0x002081b3, // add  x3,x1,x2
+        0x00108233, // add  x4,x1,x1
+        0x02418333, // mul  x6,x3,x4
+        0x022083b3, // mul  x7,x1,x2
+    };
+    Registers regs;
+    Memory mem(BIG);
+    TrivialBus mem_frontend(&mem);
+    const Address end = load_code(mem, regs.read_pc(), code);
+
+    CoreSuperscalar core(&regs, &mem_frontend, &mem_frontend, 2);
+    core.set_program_end(end);
+    run_until(core, regs, end);
+    QCOMPARE(regs.read_gp(3).as_u32(), (uint32_t)3);
+    QCOMPARE(regs.read_gp(4).as_u32(), (uint32_t)2);
+    QCOMPARE(regs.read_gp(6).as_u32(), (uint32_t)6);
+    QCOMPARE(regs.read_gp(7).as_u32(), (uint32_t)2);
+
+    // Two pairs, multiplications share the single multiplier port.
+    const IssueStats &stats = core.get_issue_stats();
+    QCOMPARE(core.get_cycle_count(), 4u);
+    QCOMPARE(core.get_instruction_count(), 6u);
+    QCOMPARE(stats.slot_issued.at(0), (uint32_t)4);
+    QCOMPARE(stats.slot_issued.at(1), (uint32_t)2);
+    QCOMPARE(stats.empty_slots.at(IL_MUL_PORT), (uint32_t)1);
+}
+
+void TestCore::test_superscalar_data() {
+    QTest::addColumn<QVector<uint32_t>>("code");
+    QTest::addColumn<unsigned>("issue_width");
+    QTest::addColumn<unsigned>("instructions");
+    QTest::addColumn<unsigned>("cycles");
+
+    // Single issue takes a cycle per instruction and a bubble per taken
+    // jump or branch (30 of them) or load-use dependency.
+    QTest::newRow("call loop, 1") << call_loop_code << 1u << 69u << 99u;
+    QTest::newRow("call loop, 2") << call_loop_code << 2u << 69u << 74u;
+    QTest::newRow("call loop, 4") << call_loop_code << 4u << 69u << 73u;
+    QTest::newRow("array sum, 1") << array_sum_code << 1u << 61u << 74u;
+    QTest::newRow("array sum, 2") << array_sum_code << 2u << 61u << 56u;
+    QTest::newRow("array sum, 4") << array_sum_code << 4u << 61u << 44u;
+}
+
+void TestCore::test_superscalar() {
+    QFETCH(QVector<uint32_t>, code);
+    QFETCH(unsigned, issue_width);
+    QFETCH(unsigned, instructions);
+    QFETCH(unsigned, cycles);
+
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    CoreSuperscalar core(&regs, &bus, &bus, issue_width);
+    core.set_program_end(regs.read_pc() + 4 * code.size());
+    compare_with_reference(core, regs, mem, code);
+    QCOMPARE(core.get_instruction_count(), instructions);
+    QCOMPARE(core.get_cycle_count(), cycles);
+
+    // Every instruction is accounted to a slot, every cycle either issues
+    // the first slot or is a bubble.
+    const IssueStats &stats = core.get_issue_stats();
+    unsigned issued = 0, bubbles = 0;
+    for (uint32_t count : stats.slot_issued) {
+        issued += count;
+    }
+    for (uint32_t count : stats.bubble_cycles) {
+        bubbles += count;
+    }
+    QCOMPARE(issued, instructions);
+    QCOMPARE(stats.slot_issued.at(0) + bubbles, cycles);
+}
+
+void TestCore::test_out_of_order_timing() {
+    QVector<uint32_t> code {
+        0x022081b3, // mul  x3,x1,x2
+        0x00100213, // addi x4,x0,1
+        0x00200293, // addi x5,x0,2
+        0x00418333, // add  x6,x3,x4
+    };
+    Registers regs;
+    regs.write_gp(1, 3);
+    regs.write_gp(2, 4);
+    Memory mem(BIG);
+    TrivialBus mem_frontend(&mem);
+    const Address end = load_code(mem, regs.read_pc(), code);
+
+    CoreOutOfOrder core(&regs, &mem_frontend, &mem_frontend);
+    core.set_program_end(end);
+    run_until(core, regs, end);
+    QCOMPARE(regs.read_gp(3).as_u32(), (uint32_t)12);
+    QCOMPARE(regs.read_gp(5).as_u32(), (uint32_t)2);
+    QCOMPARE(regs.read_gp(6).as_u32(), (uint32_t)13);
+
+    // Independent additions complete under the multiplication, the dependent
+    // one issues when its result is available. Commit stays in order.
+    const OutOfOrderStats &stats = core.get_ooo_stats();
+    QCOMPARE(core.get_cycle_count(), 6u);
+    QCOMPARE(core.get_instruction_count(), 4u);
+    QCOMPARE(core.get_stall_count(), 4u);
+    QCOMPARE(stats.commit_stalls.at(CS_EMPTY), (uint32_t)1);
+    QCOMPARE(stats.commit_stalls.at(CS_WAITING), (uint32_t)1);
+    QCOMPARE(stats.commit_stalls.at(CS_EXECUTING), (uint32_t)2);
+    QCOMPARE(stats.rob_occupancy.at(4), (uint32_t)3);
+}
+
+void TestCore::test_out_of_order_data() {
+    QTest::addColumn<QVector<uint32_t>>("code");
+    QTest::addColumn<unsigned>("rob_size");
+    QTest::addColumn<unsigned>("lsq_size");
+    QTest::addColumn<unsigned>("cycles");
+    QTest::addColumn<unsigned>("rob_full");
+    QTest::addColumn<unsigned>("lsq_full");
+    QTest::addColumn<unsigned>("btb_entries");
+    QTest::addColumn<unsigned>("mispredictions");
+
+    // Default predictor does not take branches, every return mispredicts
+    // without return address stack or branch target buffer.
+    QTest::newRow("call loop")
+        << call_loop_code << 32u << 8u << 103u << 0u << 0u << 0u << 19u;
+    // Returns are predicted by branch target buffer since the second call.
+    QTest::newRow("call loop, BTB")
+        << call_loop_code << 32u << 8u << 76u << 0u << 0u << 16u << 10u;
+    QTest::newRow("array sum")
+        << array_sum_code << 32u << 8u << 66u << 0u << 0u << 0u << 8u;
+    // Commit waits for the multiplications, dispatch goes on until the queues
+    // are full.
+    QTest::newRow("mul chain")
+        << mul_chain_code << 32u << 8u << 20u << 0u << 0u << 0u << 0u;
+    QTest::newRow("mul chain, ROB 4")
+        << mul_chain_code << 4u << 8u << 24u << 15u << 0u << 0u << 0u;
+    QTest::newRow("mul chain, LSQ 2")
+        << mul_chain_code << 32u << 2u << 24u << 0u << 13u << 0u << 0u;
+}
+
+void TestCore::test_out_of_order() {
+    QFETCH(QVector<uint32_t>, code);
+    QFETCH(unsigned, rob_size);
+    QFETCH(unsigned, lsq_size);
+    QFETCH(unsigned, cycles);
+    QFETCH(unsigned, rob_full);
+    QFETCH(unsigned, lsq_full);
+    QFETCH(unsigned, btb_entries);
+    QFETCH(unsigned, mispredictions);
+
+    OutOfOrderConfig config;
+    config.set_rob_size(rob_size);
+    config.set_lsq_size(lsq_size);
+    BranchPredictorConfig bp_config;
+    bp_config.set_btb_entries(btb_entries);
+    Registers regs;
+    Memory mem(LITTLE);
+    TrivialBus bus(&mem);
+    CoreOutOfOrder core(
+        &regs, &bus, &bus, config, 0, 1, 1, bp_config);
+    core.set_program_end(regs.read_pc() + 4 * code.size());
+    compare_with_reference(core, regs, mem, code);
+
+    const OutOfOrderStats &stats = core.get_ooo_stats();
+    QCOMPARE(core.get_cycle_count(), cycles);
+    QCOMPARE(stats.mispredictions, (uint32_t)mispredictions);
+    QCOMPARE(stats.dispatch_stalls.at(DS_ROB_FULL), (uint32_t)rob_full);
+    QCOMPARE(stats.dispatch_stalls.at(DS_LSQ_FULL), (uint32_t)lsq_full);
+    // Every cycle with no commit is a stall of a single reason.
+    unsigned stalls = 0;
+    for (uint32_t count : stats.commit_stalls) {
+        stalls += count;
+    }
+    QCOMPARE(stalls, core.get_stall_count());
+}
+
+QTEST_APPLESS_MAIN(TestCore)
@@ -0,0 +1,27 @@
+#ifndef CORE_TEST_H
+#define CORE_TEST_H
+
+#include <QtTest>
+
+class TestCore : public QObject {
+    Q_OBJECT
+private slots:
+    static void test_rv64_decode_data();
+    static void test_rv64_decode();
+    static void test_rvc_expand_data();
+    static void test_rvc_expand();
+    static void test_rv64_execute();
+    static void test_rv64_only_in_rv64();
+    static void test_compressed_fetch();
+    static void test_branch_predictor();
+    static void test_branch_prediction_data();
+    static void test_branch_prediction();
+    static void test_superscalar_issue();
+    static void test_superscalar_data();
+    static void test_superscalar();
+    static void test_out_of_order_timing();
+    static void test_out_of_order_data();
+    static void test_out_of_order();
+};
+
+#endif // CORE_TEST_H
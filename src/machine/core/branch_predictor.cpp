@@ -0,0 +1,209 @@
+#include "core/branch_predictor.h"
+
+#include "utils.h"
+
+namespace machine {
+
+std::unique_ptr<BranchPredictor>
+BranchPredictor::get_predictor_instance(const BranchPredictorConfig &config) {
+    switch (config.predictor()) {
+    case BranchPredictorConfig::BP_NOT_TAKEN:
+        return std::make_unique<BranchPredictorNotTaken>();
+    case BranchPredictorConfig::BP_BTFN:
+        return std::make_unique<BranchPredictorBTFN>();
+    case BranchPredictorConfig::BP_BIMODAL1:
+        return std::make_unique<BranchPredictorBimodal>(config.table_bits(), 1);
+    case BranchPredictorConfig::BP_BIMODAL2:
+        return std::make_unique<BranchPredictorBimodal>(config.table_bits(), 2);
+    case BranchPredictorConfig::BP_GSHARE:
+        return std::make_unique<BranchPredictorGshare>(config.table_bits());
+    }
+
+    Q_UNREACHABLE();
+}
+
+size_t BranchPredictor::table_size() const {
+    return 0;
+}
+
+uint8_t BranchPredictor::table_counter(size_t index) const {
+    UNUSED(index);
+    return 0;
+}
+
+bool BranchPredictorNotTaken::predict(Address inst_addr, Address target)
+    const {
+    UNUSED(inst_addr);
+    UNUSED(target);
+    return false;
+}
+
+void BranchPredictorNotTaken::update(Address inst_addr, bool taken) {
+    UNUSED(inst_addr);
+    UNUSED(taken);
+}
+
+void BranchPredictorNotTaken::reset() {}
+
+bool BranchPredictorBTFN::predict(Address inst_addr, Address target) const {
+    return target <= inst_addr;
+}
+
+void BranchPredictorBTFN::update(Address inst_addr, bool taken) {
+    UNUSED(inst_addr);
+    UNUSED(taken);
+}
+
+void BranchPredictorBTFN::reset() {}
+
+BranchPredictorBimodal::BranchPredictorBimodal(
+    unsigned index_bits,
+    unsigned counter_bits)
+    : index_mask((size_t(1) << index_bits) - 1)
+    , counters(size_t(1) << index_bits)
+    , counter_max(counter_bits > 1 ? 3 : 1) {
+    reset();
+}
+
+bool BranchPredictorBimodal::predict(Address inst_addr, Address target)
+    const {
+    UNUSED(target);
+    // Upper half of the counter range predicts taken.
+    return counters.at(index(inst_addr)) > counter_max / 2;
+}
+
+void BranchPredictorBimodal::update(Address inst_addr, bool taken) {
+    uint8_t &counter = counters.at(index(inst_addr));
+    if (taken && counter < counter_max) {
+        counter++;
+    } else if (!taken && counter > 0) {
+        counter--;
+    }
+}
+
+void BranchPredictorBimodal::reset() {
+    // Two bit counters start weakly not taken.
+    std::fill(counters.begin(), counters.end(), counter_max / 2);
+}
+
+size_t BranchPredictorBimodal::table_size() const {
+    return counters.size();
+}
+
+uint8_t BranchPredictorBimodal::table_counter(size_t index) const {
+    return counters.at(index);
+}
+
+size_t BranchPredictorBimodal::index(Address inst_addr) const {
+    // Instructions are at least 2-byte aligned.
+    return (inst_addr.get_raw() >> 1) & index_mask;
+}
+
+BranchPredictorGshare::BranchPredictorGshare(unsigned index_bits)
+    : BranchPredictorBimodal(index_bits, 2) {}
+
+void BranchPredictorGshare::update(Address inst_addr, bool taken) {
+    // Counter has to be selected with the history used for the prediction.
+    BranchPredictorBimodal::update(inst_addr, taken);
+    history = ((history << 1) | (taken ? 1 : 0)) & index_mask;
+}
+
+void BranchPredictorGshare::reset() {
+    BranchPredictorBimodal::reset();
+    history = 0;
+}
+
+size_t BranchPredictorGshare::index(Address inst_addr) const {
+    return BranchPredictorBimodal::index(inst_addr) ^ history;
+}
+
+BranchTargetBuffer::BranchTargetBuffer(unsigned entries) : entries(entries) {}
+
+const BranchTargetBuffer::Entry *
+BranchTargetBuffer::lookup(Address inst_addr) const {
+    if (entries.empty()) {
+        return nullptr;
+    }
+    const Entry &e = entries.at(index(inst_addr));
+    if (!e.valid || e.inst_addr != inst_addr) {
+        return nullptr;
+    }
+    return &e;
+}
+
+void BranchTargetBuffer::insert(
+    Address inst_addr,
+    Address target,
+    BranchKind kind) {
+    if (entries.empty()) {
+        return;
+    }
+    entries.at(index(inst_addr)) = { true, inst_addr, target, kind };
+}
+
+void BranchTargetBuffer::remove(Address inst_addr) {
+    if (lookup(inst_addr) != nullptr) {
+        entries.at(index(inst_addr)).valid = false;
+    }
+}
+
+void BranchTargetBuffer::reset() {
+    std::fill(entries.begin(), entries.end(), Entry());
+}
+
+size_t BranchTargetBuffer::size() const {
+    return entries.size();
+}
+
+const BranchTargetBuffer::Entry &BranchTargetBuffer::entry(size_t index) const {
+    return entries.at(index);
+}
+
+size_t BranchTargetBuffer::index(Address inst_addr) const {
+    return (inst_addr.get_raw() >> 1) % entries.size();
+}
+
+ReturnAddressStack::ReturnAddressStack(unsigned depth) : stack(depth) {}
+
+void ReturnAddressStack::push(Address return_addr) {
+    if (stack.empty()) {
+        return;
+    }
+    stack.at(top_index) = return_addr;
+    top_index = (top_index + 1) % stack.size();
+    if (used < stack.size()) {
+        used++;
+    }
+}
+
+bool ReturnAddressStack::pop(Address &return_addr) {
+    if (!top(return_addr)) {
+        return false;
+    }
+    top_index = (top_index + stack.size() - 1) % stack.size();
+    used--;
+    return true;
+}
+
+bool ReturnAddressStack::top(Address &return_addr) const {
+    if (used == 0) {
+        return false;
+    }
+    return_addr = stack.at((top_index + stack.size() - 1) % stack.size());
+    return true;
+}
+
+void ReturnAddressStack::reset() {
+    top_index = 0;
+    used = 0;
+}
+
+size_t ReturnAddressStack::depth() const {
+    return stack.size();
+}
+
+size_t ReturnAddressStack::count() const {
+    return used;
+}
+
+} // namespace machine
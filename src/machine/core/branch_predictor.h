@@ -0,0 +1,183 @@
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include "machineconfig.h"
+#include "memory/address.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using std::size_t;
+
+namespace machine {
+
+/**
+ * Direction predictor of conditional branches interface.
+ *
+ * Pipelined core asks for prediction when a branch found in branch target
+ * buffer is fetched and trains the predictor when the branch is resolved in
+ * decode. No other branch can be resolved in between, so there is no need to
+ * repair speculatively updated history.
+ */
+class BranchPredictor {
+public:
+    /**
+     * @param inst_addr     address of the branch instruction
+     * @param target        target address remembered by branch target buffer
+     * @return              true when the branch is predicted taken
+     */
+    virtual bool predict(Address inst_addr, Address target) const = 0;
+
+    /** To be called with outcome of every resolved conditional branch. */
+    virtual void update(Address inst_addr, bool taken) = 0;
+
+    virtual void reset() = 0;
+
+    /** Number of counters in the table (zero for static predictors). */
+    virtual size_t table_size() const;
+    /** Value of table counter, for visualization. */
+    virtual uint8_t table_counter(size_t index) const;
+
+    virtual ~BranchPredictor() = default;
+
+    static std::unique_ptr<BranchPredictor>
+    get_predictor_instance(const BranchPredictorConfig &config);
+};
+
+/** Static prediction, conditional branches are never taken. */
+class BranchPredictorNotTaken final : public BranchPredictor {
+public:
+    bool predict(Address inst_addr, Address target) const final;
+    void update(Address inst_addr, bool taken) final;
+    void reset() final;
+};
+
+/**
+ * Static prediction, backward branches (loops) are taken, forward are not.
+ */
+class BranchPredictorBTFN final : public BranchPredictor {
+public:
+    bool predict(Address inst_addr, Address target) const final;
+    void update(Address inst_addr, bool taken) final;
+    void reset() final;
+};
+
+/**
+ * Table of saturating counters indexed by branch address.
+ *
+ * Single bit counter just repeats the last outcome of the branch (or of
+ * another branch aliasing to the same entry), two bit counter needs two
+ * mispredictions in a row to change its prediction.
+ */
+class BranchPredictorBimodal : public BranchPredictor {
+public:
+    /**
+     * @param index_bits    table has 2^index_bits counters
+     * @param counter_bits  width of counters, 1 or 2
+     */
+    BranchPredictorBimodal(unsigned index_bits, unsigned counter_bits);
+
+    bool predict(Address inst_addr, Address target) const override;
+    void update(Address inst_addr, bool taken) override;
+    void reset() override;
+
+    size_t table_size() const final;
+    uint8_t table_counter(size_t index) const final;
+
+protected:
+    virtual size_t index(Address inst_addr) const;
+
+    const size_t index_mask;
+
+private:
+    std::vector<uint8_t> counters;
+    const uint8_t counter_max;
+};
+
+/**
+ * Two bit counters indexed by branch address xor-ed with global history of
+ * branch outcomes, so correlated branches use different counters.
+ */
+class BranchPredictorGshare final : public BranchPredictorBimodal {
+public:
+    explicit BranchPredictorGshare(unsigned index_bits);
+
+    void update(Address inst_addr, bool taken) final;
+    void reset() final;
+
+protected:
+    size_t index(Address inst_addr) const final;
+
+private:
+    size_t history = 0;
+};
+
+/** Kind of control transfer remembered by branch target buffer. */
+enum class BranchKind : uint8_t {
+    BRANCH, // Conditional, direction is predicted
+    JUMP,   // Unconditional, always taken
+    CALL,   // Jump linking return address, pushes return address stack
+    RETURN, // Indirect jump through link register, pops the stack
+};
+
+/**
+ * Direct mapped branch target buffer.
+ *
+ * Holds control transfers seen taken, so fetch can redirect before the
+ * instruction is even decoded. Full address is kept as a tag.
+ */
+class BranchTargetBuffer {
+public:
+    struct Entry {
+        bool valid = false;
+        Address inst_addr;
+        Address target;
+        BranchKind kind = BranchKind::BRANCH;
+    };
+
+    explicit BranchTargetBuffer(unsigned entries);
+
+    /** @return entry for the address or nullptr on miss */
+    const Entry *lookup(Address inst_addr) const;
+    void insert(Address inst_addr, Address target, BranchKind kind);
+    void remove(Address inst_addr);
+    void reset();
+
+    size_t size() const;
+    const Entry &entry(size_t index) const;
+
+private:
+    size_t index(Address inst_addr) const;
+
+    std::vector<Entry> entries;
+};
+
+/**
+ * Return address stack. Oldest address is overwritten when the stack is full,
+ * pop of an empty stack gives no prediction.
+ */
+class ReturnAddressStack {
+public:
+    explicit ReturnAddressStack(unsigned depth);
+
+    void push(Address return_addr);
+    /** @return false when the stack is empty */
+    bool pop(Address &return_addr);
+    /** @return false when the stack is empty */
+    bool top(Address &return_addr) const;
+    void reset();
+
+    size_t depth() const;
+    size_t count() const;
+
+private:
+    std::vector<Address> stack;
+    size_t top_index = 0; // Slot for the next push
+    size_t used = 0;
+};
+
+} // namespace machine
+
+#endif // BRANCH_PREDICTOR_H
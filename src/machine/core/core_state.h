@@ -5,7 +5,9 @@
 #include "pipeline.h"
 
 #include <QMap>
+#include <array>
 #include <cstdint>
+#include <vector>
 #include <machineconfig.h>
 using std::uint32_t;
 
@@ -18,13 +20,91 @@ struct hwBreak {
     unsigned int count;
 };
 
+/** Instruction fetch and code density statistics. */
+struct FetchStats {
+    uint32_t instructions = 0; // Fetched instructions
+    uint32_t compressed = 0;   // Of them compressed (16-bit) instructions
+    uint32_t mem_reads = 0;    // Words read from program memory
+    uint32_t buffer_hits = 0;  // Words served by the fetch buffer
+};
+
+/**
+ * Branch prediction statistics of pipelined core. Every misprediction
+ * (including instruction falsely found in branch target buffer) costs one
+ * flushed fetch cycle.
+ */
+struct BranchStats {
+    uint32_t branches = 0;              // Resolved conditional branches
+    uint32_t branches_mispredicted = 0; // Of them mispredicted
+    uint32_t jumps = 0;                 // Resolved unconditional jumps
+    uint32_t jumps_mispredicted = 0;    // Of them with wrong target
+    uint32_t penalty_cycles = 0;        // Cycles lost by flushed fetch
+};
+
+/** Reason why an issue slot of multi-issue core stays empty. */
+enum IssueLimit {
+    IL_DEPENDENCY, // Operand produced by older instruction of the bundle
+    IL_OUTPUT,     // Destination written by older instruction of the bundle
+    IL_ALU_PORT,   // All ALU ports taken
+    IL_MUL_PORT,   // All multiplier (and FPU) ports taken
+    IL_MEM_PORT,   // All memory ports taken
+    IL_LOAD_USE,   // Operand loaded by previous cycle is not available yet
+    IL_CONTROL,    // Taken jump or branch, fetch of the target
+    IL_SERIALIZE,  // CSR access, exception or other serializing instruction
+    IL_COUNT
+};
+
+/** Issue statistics of multi-issue core. */
+struct IssueStats {
+    std::vector<uint32_t> slot_issued {};            // Issued by each slot
+    std::array<uint32_t, IL_COUNT> empty_slots {};   // By the reason
+    std::array<uint32_t, IL_COUNT> bubble_cycles {}; // Cycles with no issue
+};
+
+/** Reason why out-of-order core dispatched less instructions than it could. */
+enum DispatchStall {
+    DS_ROB_FULL,   // No free reorder buffer entry
+    DS_IQ_FULL,    // No free issue queue entry
+    DS_LSQ_FULL,   // No free load/store queue entry
+    DS_MISPREDICT, // Mispredicted control transfer, target not fetched yet
+    DS_SERIALIZE,  // CSR access, exception or other serializing instruction
+    DS_COUNT
+};
+
+/** Reason why out-of-order core committed no instruction in a cycle. */
+enum CommitStall {
+    CS_EMPTY,     // Reorder buffer is empty (frontend stall)
+    CS_WAITING,   // Oldest instruction waits for operands or execution port
+    CS_EXECUTING, // Oldest instruction is executing
+    CS_COUNT
+};
+
+/** Timing statistics of out-of-order core. */
+struct OutOfOrderStats {
+    std::array<uint32_t, DS_COUNT> dispatch_stalls {}; // Cycles by the reason
+    std::array<uint32_t, CS_COUNT> commit_stalls {};   // Cycles by the reason
+    // Cycles spent with given number of occupied entries
+    std::vector<uint32_t> rob_occupancy {};
+    std::vector<uint32_t> iq_occupancy {};
+    std::vector<uint32_t> lsq_occupancy {};
+    uint32_t mispredictions = 0; // Control transfers with wrong target
+};
+
 struct CoreState {
     Pipeline pipeline;
     uint32_t stall_count = 0;
     uint32_t cycle_count = 0;
+    uint32_t instruction_count = 0; // Retired (written back) instructions
+    FetchStats fetch_stats {};
+    BranchStats branch_stats {};
     std::array<bool, EXCAUSE_COUNT> stop_on_exception {};
     std::array<bool, EXCAUSE_COUNT> step_over_exception {};
     QMap<Address, hwBreak *> hw_breaks {};
+    /**
+     * Set together with `Core::stop_on_exception_reached`. Polled by
+     * background run, where core signals are blocked.
+     */
+    bool exception_stop_pending = false;
     uint32_t hwr_userlocal;
     uint32_t min_cache_row_size;
 };
@@ -0,0 +1,55 @@
+#include "event_queue.h"
+
+#include <algorithm>
+
+namespace machine {
+
+constexpr uint64_t EventQueue::NEVER;
+
+EventQueue::EventId EventQueue::schedule_at(uint64_t cycle, Callback callback) {
+    EventId id = next_id++;
+    callbacks.emplace(id, std::move(callback));
+    heap.push_back({ cycle, id });
+    std::push_heap(heap.begin(), heap.end());
+    deadline = std::min(deadline, heap.front().cycle);
+    return id;
+}
+
+void EventQueue::cancel(EventId id) {
+    if (callbacks.erase(id) != 0) {
+        update_deadline();
+    }
+}
+
+void EventQueue::reset() {
+    current = 0;
+    deadline = NEVER;
+    heap.clear();
+    callbacks.clear();
+}
+
+void EventQueue::run_due() {
+    while (!heap.empty() && heap.front().cycle <= current) {
+        EventId id = heap.front().id;
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+        auto it = callbacks.find(id);
+        if (it == callbacks.end()) {
+            continue; // Cancelled.
+        }
+        Callback callback = std::move(it->second);
+        callbacks.erase(it);
+        callback();
+    }
+    update_deadline();
+}
+
+void EventQueue::update_deadline() {
+    while (!heap.empty() && callbacks.count(heap.front().id) == 0) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+    }
+    deadline = heap.empty() ? NEVER : heap.front().cycle;
+}
+
+} // namespace machine
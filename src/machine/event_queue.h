@@ -0,0 +1,94 @@
+/**
+ * Simulated time for peripherals.
+ *
+ * Devices schedule callbacks at a future machine cycle (character sent by
+ * UART, transfer finished by DMA, ...) instead of being polled. Simulation
+ * loop only compares current cycle with the earliest deadline, so pending
+ * events cost nothing until they are due.
+ *
+ * Time is counted in machine cycles since machine creation (or `reset`) and
+ * never wraps. It is not the core cycle counter, which restarts with the
+ * core.
+ *
+ * @file
+ */
+#ifndef QTRVSIM_EVENT_QUEUE_H
+#define QTRVSIM_EVENT_QUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace machine {
+
+class EventQueue {
+public:
+    using Callback = std::function<void()>;
+    using EventId = uint64_t;
+
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+    /** Current machine cycle. */
+    uint64_t now() const { return current; }
+
+    /** Cycle of the earliest pending event, `NEVER` when none is pending. */
+    uint64_t next_deadline() const { return deadline; }
+
+    /**
+     * Run callback at given cycle. Events with the same cycle run in order
+     * of scheduling. Past cycle runs the event on next `tick`.
+     *
+     * Callback may schedule or cancel other events.
+     */
+    EventId schedule_at(uint64_t cycle, Callback callback);
+
+    /** Run callback `delay` cycles from now. */
+    EventId schedule_in(uint64_t delay, Callback callback) {
+        return schedule_at(current + delay, std::move(callback));
+    }
+
+    /** Cancel pending event, no-op when it already ran or was cancelled. */
+    void cancel(EventId id);
+
+    bool is_pending(EventId id) const { return callbacks.count(id) != 0; }
+
+    /**
+     * Advance time by one cycle and run events which became due.
+     */
+    void tick() {
+        if (++current >= deadline) {
+            run_due();
+        }
+    }
+
+    /** Drop all pending events and restart time from zero. */
+    void reset();
+
+private:
+    struct Event {
+        uint64_t cycle;
+        EventId id;
+
+        /** Heap comparator (std heap is max-heap). */
+        bool operator<(const Event &other) const {
+            return cycle != other.cycle ? cycle > other.cycle : id > other.id;
+        }
+    };
+
+    void run_due();
+    /** Drop cancelled events from the top and update deadline. */
+    void update_deadline();
+
+    uint64_t current = 0;
+    uint64_t deadline = NEVER;
+    EventId next_id = 1;
+    std::vector<Event> heap;
+    // Cancelled events stay in the heap and are dropped once they get on top.
+    std::unordered_map<EventId, Callback> callbacks;
+};
+
+} // namespace machine
+
+#endif // QTRVSIM_EVENT_QUEUE_H
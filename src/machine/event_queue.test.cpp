@@ -0,0 +1,105 @@
+#include "event_queue.h"
+
+#include "event_queue.test.h"
+
+#include <vector>
+
+using namespace machine;
+
+/** Advance the queue until (including) given cycle. */
+static void run_until(EventQueue &events, uint64_t cycle) {
+    while (events.now() < cycle) {
+        events.tick();
+    }
+}
+
+void TestEventQueue::test_event_queue_order() {
+    EventQueue events;
+    std::vector<int> fired;
+    QCOMPARE(events.next_deadline(), EventQueue::NEVER);
+    events.schedule_at(5, [&]() { fired.push_back(5); });
+    events.schedule_at(2, [&]() { fired.push_back(2); });
+    events.schedule_in(3, [&]() { fired.push_back(3); });
+    QCOMPARE(events.next_deadline(), uint64_t(2));
+
+    run_until(events, 1);
+    QVERIFY(fired.empty());
+    run_until(events, 2);
+    QCOMPARE(fired, std::vector<int>({ 2 }));
+    QCOMPARE(events.next_deadline(), uint64_t(3));
+    run_until(events, 10);
+    QCOMPARE(fired, std::vector<int>({ 2, 3, 5 }));
+    QCOMPARE(events.next_deadline(), EventQueue::NEVER);
+}
+
+void TestEventQueue::test_event_queue_same_cycle() {
+    EventQueue events;
+    std::vector<int> fired;
+    for (int i = 0; i < 4; i++) {
+        events.schedule_at(3, [&fired, i]() { fired.push_back(i); });
+    }
+    run_until(events, 2);
+    // Event scheduled into the past runs on the next tick, ahead of events
+    // due exactly then.
+    events.schedule_at(1, [&]() { fired.push_back(-1); });
+    run_until(events, 3);
+    QCOMPARE(fired, std::vector<int>({ -1, 0, 1, 2, 3 }));
+}
+
+void TestEventQueue::test_event_queue_cancel() {
+    EventQueue events;
+    std::vector<int> fired;
+    auto first = events.schedule_at(1, [&]() { fired.push_back(1); });
+    auto second = events.schedule_at(2, [&]() { fired.push_back(2); });
+    QVERIFY(events.is_pending(first));
+    events.cancel(first);
+    QVERIFY(!events.is_pending(first));
+    QCOMPARE(events.next_deadline(), uint64_t(2));
+    events.cancel(first); // No-op.
+
+    run_until(events, 2);
+    QCOMPARE(fired, std::vector<int>({ 2 }));
+    QVERIFY(!events.is_pending(second));
+    events.cancel(second); // Already ran.
+    QCOMPARE(events.next_deadline(), EventQueue::NEVER);
+}
+
+void TestEventQueue::test_event_queue_reschedule() {
+    EventQueue events;
+    std::vector<uint64_t> fired;
+    EventQueue::EventId victim = 0;
+    // Periodic event, which also cancels other event due the same cycle.
+    std::function<void()> periodic = [&]() {
+        fired.push_back(events.now());
+        events.cancel(victim);
+        if (fired.size() < 3) {
+            events.schedule_in(4, periodic);
+        }
+    };
+    events.schedule_at(4, periodic);
+    victim = events.schedule_at(4, [&]() { fired.push_back(0); });
+
+    run_until(events, 20);
+    QCOMPARE(fired, std::vector<uint64_t>({ 4, 8, 12 }));
+    QCOMPARE(events.next_deadline(), EventQueue::NEVER);
+}
+
+void TestEventQueue::test_event_queue_reset() {
+    EventQueue events;
+    std::vector<int> fired;
+    auto pending = events.schedule_at(5, [&]() { fired.push_back(5); });
+    run_until(events, 3);
+    events.reset();
+    QCOMPARE(events.now(), uint64_t(0));
+    QCOMPARE(events.next_deadline(), EventQueue::NEVER);
+    QVERIFY(!events.is_pending(pending));
+
+    // Identifiers are not reused, stale one does not cancel new event.
+    auto fresh = events.schedule_at(2, [&]() { fired.push_back(2); });
+    QVERIFY(fresh != pending);
+    events.cancel(pending);
+    run_until(events, 10);
+    QCOMPARE(fired, std::vector<int>({ 2 }));
+}
+
+QTEST_APPLESS_MAIN(TestEventQueue)
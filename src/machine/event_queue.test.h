@@ -0,0 +1,16 @@
+#ifndef EVENT_QUEUE_TEST_H
+#define EVENT_QUEUE_TEST_H
+
+#include <QtTest>
+
+class TestEventQueue : public QObject {
+    Q_OBJECT
+private slots:
+    static void test_event_queue_order();
+    static void test_event_queue_same_cycle();
+    static void test_event_queue_cancel();
+    static void test_event_queue_reschedule();
+    static void test_event_queue_reset();
+};
+
+#endif // EVENT_QUEUE_TEST_H
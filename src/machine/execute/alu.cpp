@@ -2,6 +2,9 @@
 
 #include "common/polyfills/mulh64.h"
 
+#include <array>
+#include <utility>
+
 namespace machine {
 
 RegisterValue alu_combined_operate(
@@ -25,11 +28,12 @@ RegisterValue alu_combined_operate(
 }
 
 /**
- * Shift operations are limited to shift by 31 bits.
+ * Shift operations are limited to shift by 31 bits (63 bits in RV64).
  * Other bits of the operand may be used as flags and need to be masked out
  * before any ALU operation is performed.
  */
-constexpr uint64_t SHIFT_MASK = 0b11111; // == 31
+constexpr uint64_t SHIFT_MASK32 = 0b11111;  // == 31
+constexpr uint64_t SHIFT_MASK64 = 0b111111; // == 63
 
 int64_t
 alu64_operate(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
@@ -38,14 +42,15 @@ alu64_operate(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
 
     switch (op) {
     case AluOp::ADD: return _a + ((modified) ? -_b : _b);
-    case AluOp::SLL: return _a << (_b & SHIFT_MASK);
+    case AluOp::SLL: return _a << (_b & SHIFT_MASK64);
     case AluOp::SLT: return a.as_i64() < b.as_i64();
     case AluOp::SLTU: return _a < _b;
     case AluOp::XOR:
         return _a ^ _b;
         // Most compilers should calculate SRA correctly, but it is UB.
     case AluOp::SR:
-        return (modified) ? (a.as_i64() >> _b) : (_a >> (_b & SHIFT_MASK));
+        return (modified) ? (a.as_i64() >> (_b & SHIFT_MASK64))
+                          : (_a >> (_b & SHIFT_MASK64));
     case AluOp::OR: return _a | _b;
     case AluOp::AND: return _a & _b;
     default:
@@ -61,15 +66,15 @@ alu32_operate(AluOp op, bool modified, RegisterValue a, RegisterValue b) {
 
     switch (op) {
     case AluOp::ADD: return _a + ((modified) ? -_b : _b);
-    case AluOp::SLL: return _a << (_b & SHIFT_MASK);
-    case AluOp::SLT: return a.as_i64() < b.as_i64();
+    case AluOp::SLL: return _a << (_b & SHIFT_MASK32);
+    case AluOp::SLT: return a.as_i32() < b.as_i32();
     case AluOp::SLTU: return _a < _b;
     case AluOp::XOR:
         return _a ^ _b;
         // Most compilers should calculate SRA correctly, but it is UB.
     case AluOp::SR:
-        return (modified) ? (a.as_i64() >> (_b & SHIFT_MASK))
-                          : (_a >> (_b & SHIFT_MASK));
+        return (modified) ? (a.as_i32() >> (_b & SHIFT_MASK32))
+                          : (_a >> (_b & SHIFT_MASK32));
     case AluOp::OR: return _a | _b;
     case AluOp::AND: return _a & _b;
     default:
@@ -151,4 +156,92 @@ int32_t mul32_operate(MulOp op, RegisterValue a, RegisterValue b) {
     }
 }
 
+namespace {
+
+/** Operations of both ALU and multiplier are encoded by funct3. */
+constexpr size_t OPERATION_COUNT = 8;
+
+/*
+ * Operations with all dispatch arguments known at compile time. Flattening
+ * inlines the generic implementation, so its switch is folded away.
+ */
+
+template<bool W_OPERATION, bool MODIFIED, AluOp OP>
+[[gnu::flatten]] RegisterValue
+alu_specialized(RegisterValue a, RegisterValue b) {
+    if (W_OPERATION) {
+        return alu32_operate(OP, MODIFIED, a, b);
+    }
+    return alu64_operate(OP, MODIFIED, a, b);
+}
+
+template<bool W_OPERATION, MulOp OP>
+[[gnu::flatten]] RegisterValue
+mul_specialized(RegisterValue a, RegisterValue b) {
+    if (W_OPERATION) {
+        return mul32_operate(OP, a, b);
+    }
+    return mul64_operate(OP, a, b);
+}
+
+RegisterValue alu_invalid(RegisterValue a, RegisterValue b) {
+    (void)a;
+    (void)b;
+    return 0;
+}
+
+using OperationTable = std::array<AluFunction, OPERATION_COUNT>;
+
+template<bool W_OPERATION, bool MODIFIED, size_t... OPS>
+constexpr OperationTable alu_table(std::index_sequence<OPS...>) {
+    return { { &alu_specialized<W_OPERATION, MODIFIED, AluOp(OPS)>... } };
+}
+
+template<bool W_OPERATION, size_t... OPS>
+constexpr OperationTable mul_table(std::index_sequence<OPS...>) {
+    return { { &mul_specialized<W_OPERATION, MulOp(OPS)>... } };
+}
+
+constexpr auto OPERATIONS = std::make_index_sequence<OPERATION_COUNT>();
+
+/** Indexed by w_operation, modified and operation. */
+constexpr OperationTable ALU_TABLE[2][2] = {
+    { alu_table<false, false>(OPERATIONS), alu_table<false, true>(OPERATIONS) },
+    { alu_table<true, false>(OPERATIONS), alu_table<true, true>(OPERATIONS) },
+};
+
+/** Indexed by w_operation and operation. */
+constexpr OperationTable MUL_TABLE[2] = {
+    mul_table<false>(OPERATIONS),
+    mul_table<true>(OPERATIONS),
+};
+
+} // namespace
+
+AluFunction alu_select(
+    AluCombinedOp op,
+    AluComponent component,
+    bool w_operation,
+    bool modified) {
+    switch (component) {
+    case AluComponent::ALU:
+        if (size_t(op.alu_op) < OPERATION_COUNT) {
+            return ALU_TABLE[w_operation][modified][size_t(op.alu_op)];
+        }
+        qDebug("ERROR, unknown alu operation: %hhx", uint8_t(op.alu_op));
+        return &alu_invalid;
+    case AluComponent::MUL:
+        if (size_t(op.mul_op) < OPERATION_COUNT) {
+            return MUL_TABLE[w_operation][size_t(op.mul_op)];
+        }
+        qDebug(
+            "ERROR, unknown multiplication operation: %hhx",
+            uint8_t(op.mul_op));
+        return &alu_invalid;
+    default:
+        qDebug("ERROR, unknown alu component: %hhx", uint8_t(component));
+        return &alu_invalid;
+    }
+}
+
 } // namespace machine
@@ -41,6 +41,25 @@ union AluCombinedOp {
     RegisterValue a,
     RegisterValue b);
 
+/** ALU operation with dispatch arguments already resolved. */
+using AluFunction = RegisterValue (*)(RegisterValue a, RegisterValue b);
+
+/**
+ * Select specialized operation for arguments of `alu_combined_operate`
+ *
+ * Selection is done once when the instruction is decoded, execution is then
+ * a single indirect call without switching on component, width and
+ * operation.
+ *
+ * @return  function computing the same result as `alu_combined_operate`
+ *          called with the same op, component, w_operation and modified
+ */
+AluFunction alu_select(
+    AluCombinedOp op,
+    AluComponent component,
+    bool w_operation,
+    bool modified);
+
 /**
  * RV64I for OP and OP-IMM instructions
  *
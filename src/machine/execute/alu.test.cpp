@@ -5,6 +5,7 @@
 
 #include <array>
 #include <tuple>
+#include <vector>
 
 using namespace machine;
 
@@ -48,6 +49,16 @@ void TestAlu::test_alu64_operate_data() {
     QTest::addRow("SRA") << AluOp::SR << true << int64_t(0xFFFFFFFF00000000ULL)
                          << int64_t(0xFFFFFFFF00000010ULL)
                          << int64_t(0xFFFFFFFFFFFF0000ULL);
+    QTest::addRow("SLL wide") << AluOp::SLL << false << int64_t(1)
+                              << int64_t(0xFFFFFFFF0000003FULL)
+                              << int64_t(0x8000000000000000ULL);
+    QTest::addRow("SRL wide") << AluOp::SR << false
+                              << int64_t(0x8000000000000000ULL) << int64_t(33)
+                              << int64_t(0x0000000040000000ULL);
+    QTest::addRow("SRA wide") << AluOp::SR << true
+                              << int64_t(0x8000000000000000ULL)
+                              << int64_t(0xFFFFFFFF0000003FULL)
+                              << int64_t(0xFFFFFFFFFFFFFFFFULL);
 }
 
 void TestAlu::test_alu64_operate() {
@@ -262,4 +273,92 @@ void TestAlu::test_mul32_operate() {
         RegisterValue(result));
 }
 
+/** All combinations accepted by alu_combined_operate. */
+struct AluDispatch {
+    AluCombinedOp op;
+    AluComponent component;
+    bool w_operation;
+    bool modified;
+};
+
+static std::vector<AluDispatch> all_alu_dispatches() {
+    std::vector<AluDispatch> dispatches;
+    for (bool w_operation : { false, true }) {
+        for (uint8_t op = 0; op < 8; op++) {
+            for (bool modified : { false, true }) {
+                dispatches.push_back({ { .alu_op = AluOp(op) },
+                                       AluComponent::ALU, w_operation,
+                                       modified });
+            }
+            dispatches.push_back({ { .mul_op = MulOp(op) }, AluComponent::MUL,
+                                   w_operation, false });
+        }
+    }
+    return dispatches;
+}
+
+static const std::array<std::pair<uint64_t, uint64_t>, 6> operands = { {
+    { 0, 0 },
+    { 123123, 123000 },
+    { 0xFFFFFFFFFFFFFFFFULL, 1 },
+    { 0x8000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL },
+    { 0x0000000080000000ULL, 0xFFFFFFFF0000003FULL },
+    { 0x123456789ABCDEF0ULL, 0x0FEDCBA987654321ULL },
+} };
+
+void TestAlu::test_alu_select() {
+    for (const AluDispatch &d : all_alu_dispatches()) {
+        AluFunction fn
+            = alu_select(d.op, d.component, d.w_operation, d.modified);
+        for (const auto &operand : operands) {
+            QCOMPARE(
+                fn(operand.first, operand.second),
+                alu_combined_operate(
+                    d.op, d.component, d.w_operation, d.modified,
+                    operand.first, operand.second));
+        }
+    }
+}
+
+/*
+ * Benchmarks compare dispatch of all operations on every execution with
+ * functions selected in advance, as done by decode.
+ */
+
+/** Results are stored here, so the compiler cannot drop the computation. */
+static volatile uint64_t benchmark_sink;
+
+void TestAlu::benchmark_alu_combined_operate() {
+    const std::vector<AluDispatch> dispatches = all_alu_dispatches();
+    uint64_t sum = 0;
+    QBENCHMARK {
+        for (const auto &operand : operands) {
+            for (const AluDispatch &d : dispatches) {
+                sum += alu_combined_operate(
+                           d.op, d.component, d.w_operation, d.modified,
+                           operand.first, operand.second)
+                           .as_u64();
+            }
+        }
+    }
+    benchmark_sink = sum;
+}
+
+void TestAlu::benchmark_alu_select() {
+    std::vector<AluFunction> functions;
+    for (const AluDispatch &d : all_alu_dispatches()) {
+        functions.push_back(
+            alu_select(d.op, d.component, d.w_operation, d.modified));
+    }
+    uint64_t sum = 0;
+    QBENCHMARK {
+        for (const auto &operand : operands) {
+            for (AluFunction fn : functions) {
+                sum += fn(operand.first, operand.second).as_u64();
+            }
+        }
+    }
+    benchmark_sink = sum;
+}
+
 QTEST_APPLESS_MAIN(TestAlu)
\ No newline at end of file
@@ -14,6 +14,9 @@ private slots:
     static void test_mul64_operate();
     static void test_mul32_operate_data();
     static void test_mul32_operate();
+    static void test_alu_select();
+    static void benchmark_alu_combined_operate();
+    static void benchmark_alu_select();
 };
 
 #endif // ALU_TEST_H
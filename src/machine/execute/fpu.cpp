@@ -0,0 +1,701 @@
+#include "fpu.h"
+
+#include "common/polyfills/mulh64.h"
+#include "simulator_exception.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cfenv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace machine {
+
+namespace {
+
+/** Bit level properties of the simulated formats. */
+template<typename T>
+struct FpFormat;
+
+template<>
+struct FpFormat<float> {
+    using Bits = uint32_t;
+    /** Format used to compute RMM results by round-to-odd. */
+    using Wide = double;
+    static constexpr Bits CANONICAL_NAN = 0x7fc00000;
+    static constexpr Bits QUIET_BIT = 0x00400000;
+    static constexpr Bits SIGN_BIT = 0x80000000;
+
+    /** Improperly NaN-boxed values are treated as canonical NaN. */
+    static Bits load_bits(RegisterValue value) {
+        return (value.as_u64() >> 32) == 0xffffffff ? value.as_u32()
+                                                    : CANONICAL_NAN;
+    }
+    static RegisterValue store_bits(Bits bits) { return fp_box32(bits); }
+    static RegisterValue move_to_integer(RegisterValue value) {
+        return value.as_i32();
+    }
+};
+
+template<>
+struct FpFormat<double> {
+    using Bits = uint64_t;
+    using Wide = long double;
+    static constexpr Bits CANONICAL_NAN = 0x7ff8000000000000ULL;
+    static constexpr Bits QUIET_BIT = 0x0008000000000000ULL;
+    static constexpr Bits SIGN_BIT = 0x8000000000000000ULL;
+
+    static Bits load_bits(RegisterValue value) { return value.as_u64(); }
+    static RegisterValue store_bits(Bits bits) { return bits; }
+    static RegisterValue move_to_integer(RegisterValue value) {
+        return value;
+    }
+};
+
+template<typename T>
+typename FpFormat<T>::Bits to_bits(T value) {
+    typename FpFormat<T>::Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+template<typename T>
+T from_bits(typename FpFormat<T>::Bits bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<typename T>
+T load(RegisterValue value) {
+    return from_bits<T>(FpFormat<T>::load_bits(value));
+}
+
+template<typename T>
+RegisterValue store(T value) {
+    return FpFormat<T>::store_bits(to_bits(value));
+}
+
+template<typename T>
+T canonical_nan() {
+    return from_bits<T>(FpFormat<T>::CANONICAL_NAN);
+}
+
+template<typename T>
+bool is_signaling(T value) {
+    return std::isnan(value) && !(to_bits(value) & FpFormat<T>::QUIET_BIT);
+}
+
+/** RISC-V does not propagate NaN payloads. */
+template<typename T>
+T canonicalize(T value) {
+    return std::isnan(value) ? canonical_nan<T>() : value;
+}
+
+int host_rounding(FpRounding rm) {
+    switch (rm) {
+    case FpRounding::RNE: return FE_TONEAREST;
+    case FpRounding::RTZ: return FE_TOWARDZERO;
+    case FpRounding::RDN: return FE_DOWNWARD;
+    case FpRounding::RUP: return FE_UPWARD;
+    default:
+        throw SIMULATOR_EXCEPTION(
+            UnsupportedAluOperation, "Rounding mode has no host equivalent",
+            QString::number(static_cast<unsigned>(rm)));
+    }
+}
+
+/**
+ * Host floating-point environment with given rounding mode for the lifetime
+ * of the object. Host exception flags are cleared when it is created.
+ */
+class HostFpEnv {
+public:
+    explicit HostFpEnv(int rounding) : saved(std::fegetround()) {
+        if (std::fesetround(rounding) != 0) {
+            throw SIMULATOR_EXCEPTION(
+                UnsupportedAluOperation,
+                "Host does not support required rounding mode",
+                QString::number(rounding));
+        }
+        std::feclearexcept(FE_ALL_EXCEPT);
+    }
+    ~HostFpEnv() { std::fesetround(saved); }
+
+    HostFpEnv(const HostFpEnv &) = delete;
+    HostFpEnv &operator=(const HostFpEnv &) = delete;
+
+    /** Host exception flags raised so far converted to fflags. */
+    static uint32_t flags() {
+        const int raised = std::fetestexcept(FE_ALL_EXCEPT);
+        uint32_t fflags = 0;
+        fflags |= (raised & FE_INEXACT) ? FPE_NX : 0;
+        fflags |= (raised & FE_UNDERFLOW) ? FPE_UF : 0;
+        fflags |= (raised & FE_OVERFLOW) ? FPE_OF : 0;
+        fflags |= (raised & FE_DIVBYZERO) ? FPE_DZ : 0;
+        fflags |= (raised & FE_INVALID) ? FPE_NV : 0;
+        return fflags;
+    }
+
+private:
+    const int saved;
+};
+
+/**
+ * Operation on the host FPU in the current host rounding mode.
+ *
+ * Operands and result go through volatile variables, so the compiler cannot
+ * move the computation out of the scope of the host environment.
+ */
+template<typename T>
+T compute(FpuOp op, T a, T b, T c) {
+    volatile T va = a, vb = b, vc = c;
+    volatile T result;
+    switch (op) {
+    case FpuOp::ADD: result = va + vb; break;
+    case FpuOp::SUB: result = va - vb; break;
+    case FpuOp::MUL: result = va * vb; break;
+    case FpuOp::DIV: result = va / vb; break;
+    case FpuOp::SQRT: result = std::sqrt(T(va)); break;
+    case FpuOp::MADD: result = std::fma(T(va), T(vb), T(vc)); break;
+    case FpuOp::MSUB: result = std::fma(T(va), T(vb), -T(vc)); break;
+    case FpuOp::NMSUB: result = std::fma(-T(va), T(vb), T(vc)); break;
+    case FpuOp::NMADD: result = std::fma(-T(va), T(vb), -T(vc)); break;
+    default: result = 0; break;
+    }
+    return result;
+}
+
+/** Wide format has to keep two more bits than the target for round-to-odd. */
+template<typename T, typename W>
+constexpr bool is_wide_enough() {
+    return std::numeric_limits<W>::digits
+           >= std::numeric_limits<T>::digits + 2;
+}
+
+/** Round-to-odd of a value already truncated towards zero. */
+template<typename W>
+W make_odd(W value) {
+    int exp;
+    const W mantissa = std::ldexp(
+        std::frexp(value, &exp), std::numeric_limits<W>::digits);
+    if (std::fmod(mantissa, W(2)) == 0) {
+        value = std::nextafter(
+            value,
+            std::copysign(std::numeric_limits<W>::infinity(), value));
+    }
+    return value;
+}
+
+/**
+ * Round value of a wider format to T with ties to max magnitude.
+ *
+ * The wide value has to be exact or rounded to odd, then ties are detected
+ * exactly in the wide format.
+ */
+template<typename T, typename W>
+T round_rmm(W value, uint32_t &fflags) {
+    if (std::isnan(value) || std::isinf(value) || value == 0) {
+        return static_cast<T>(value);
+    }
+    T truncated;
+    {
+        HostFpEnv env(FE_TOWARDZERO);
+        volatile W v = value;
+        truncated = static_cast<T>(v);
+    }
+    if (static_cast<W>(truncated) == value) {
+        return truncated;
+    }
+    const T inf = std::numeric_limits<T>::infinity();
+    const T away = std::nextafter(truncated, value < 0 ? -inf : inf);
+    // Largest finite value rounds to infinity above the same distance.
+    const W half_ulp
+        = std::isinf(away)
+              ? (static_cast<W>(truncated)
+                 - static_cast<W>(std::nextafter(truncated, T(0))))
+                    / 2
+              : (static_cast<W>(away) - static_cast<W>(truncated)) / 2;
+    const T result
+        = (std::fabs(value - static_cast<W>(truncated)) >= std::fabs(half_ulp))
+              ? away
+              : truncated;
+
+    fflags |= FPE_NX;
+    if (std::isinf(result)) {
+        fflags |= FPE_OF;
+    }
+    if (std::fabs(result) < std::numeric_limits<T>::min()) {
+        fflags |= FPE_UF;
+    }
+    return result;
+}
+
+/**
+ * Exact finite value `(-1)^negative * mantissa * 2^exponent` with 128-bit
+ * mantissa. It emulates RMM in software when the host has no wide enough
+ * format (e.g. `long double` of the same size as `double`).
+ */
+struct ExactValue {
+    bool negative = false;
+    uint64_t high = 0;
+    uint64_t low = 0;
+    int exponent = 0;
+};
+
+template<typename T>
+ExactValue decompose(T value) {
+    ExactValue result;
+    result.negative = std::signbit(value);
+    if (value != 0) {
+        int exp;
+        const T mantissa = std::frexp(std::fabs(value), &exp);
+        result.low = static_cast<uint64_t>(
+            std::ldexp(mantissa, std::numeric_limits<T>::digits));
+        result.exponent = exp - std::numeric_limits<T>::digits;
+    }
+    return result;
+}
+
+int bit_length(const ExactValue &value) {
+    uint64_t word = value.high ? value.high : value.low;
+    int length = value.high ? 64 : 0;
+    for (; word != 0; word >>= 1) {
+        length++;
+    }
+    return length;
+}
+
+/** Shift left without loss, the mantissa has to fit into 128 bits. */
+void shift_left(ExactValue &value, int bits) {
+    if (bits >= 64) {
+        value.high = value.low << (bits - 64);
+        value.low = 0;
+    } else if (bits > 0) {
+        value.high = (value.high << bits) | (value.low >> (64 - bits));
+        value.low <<= bits;
+    }
+    value.exponent -= bits;
+}
+
+/** @return whether nonzero bits were shifted out */
+bool shift_right(ExactValue &value, int bits) {
+    bool lost = false;
+    if (bits >= 128) {
+        lost = (value.high | value.low) != 0;
+        value.high = value.low = 0;
+    } else if (bits >= 64) {
+        lost = value.low != 0
+               || (bits > 64 && (value.high << (128 - bits)) != 0);
+        value.low = value.high >> (bits - 64);
+        value.high = 0;
+    } else if (bits > 0) {
+        lost = (value.low << (64 - bits)) != 0;
+        value.low = (value.low >> bits) | (value.high << (64 - bits));
+        value.high >>= bits;
+    }
+    value.exponent += bits;
+    return lost;
+}
+
+ExactValue multiply(const ExactValue &a, const ExactValue &b) {
+    ExactValue result;
+    result.negative = a.negative != b.negative;
+    result.high = mulhu64(a.low, b.low);
+    result.low = a.low * b.low;
+    result.exponent = a.exponent + b.exponent;
+    return result;
+}
+
+/**
+ * Both mantissas have to be normalized to the same number of bits. The
+ * remainder is jammed into the lowest bit of 63-bit quotient.
+ */
+ExactValue divide(const ExactValue &a, const ExactValue &b) {
+    constexpr int QUOTIENT_BITS = 62;
+    ExactValue result;
+    result.negative = a.negative != b.negative;
+    uint64_t quotient = a.low / b.low;
+    uint64_t remainder = a.low % b.low;
+    for (int i = 0; i < QUOTIENT_BITS; i++) {
+        remainder <<= 1;
+        quotient <<= 1;
+        if (remainder >= b.low) {
+            remainder -= b.low;
+            quotient |= 1;
+        }
+    }
+    result.low = quotient | (remainder != 0 ? 1 : 0);
+    result.exponent = a.exponent - b.exponent - QUOTIENT_BITS;
+    return result;
+}
+
+/**
+ * Sum of mantissas of at most 126 bits. Bits of the smaller operand shifted
+ * out during alignment are jammed into the lowest bit, which stays far below
+ * the rounding position.
+ */
+ExactValue add(ExactValue a, ExactValue b) {
+    if ((a.high | a.low) == 0) {
+        return b;
+    }
+    if ((b.high | b.low) == 0) {
+        return a;
+    }
+    shift_left(a, 126 - bit_length(a));
+    shift_left(b, 126 - bit_length(b));
+    if (a.exponent < b.exponent) {
+        std::swap(a, b);
+    }
+    if (shift_right(b, std::min(a.exponent - b.exponent, 128))) {
+        b.low |= 1;
+    }
+    ExactValue result = a;
+    if (a.negative == b.negative) {
+        result.low = a.low + b.low;
+        result.high = a.high + b.high + (result.low < a.low ? 1 : 0);
+        return result;
+    }
+    if (a.high < b.high || (a.high == b.high && a.low < b.low)) {
+        std::swap(a, b);
+        result.negative = a.negative;
+    }
+    result.low = a.low - b.low;
+    result.high = a.high - b.high - (a.low < b.low ? 1 : 0);
+    return result;
+}
+
+/** Round exact value to T with ties to max magnitude. */
+template<typename T>
+T round_exact(const ExactValue &value, uint32_t &fflags) {
+    constexpr int DIGITS = std::numeric_limits<T>::digits;
+    // Exponent of the lowest bit of subnormal numbers
+    constexpr int MIN_EXPONENT = std::numeric_limits<T>::min_exponent - DIGITS;
+    const int length = bit_length(value);
+    if (length == 0) {
+        return value.negative ? -T(0) : T(0);
+    }
+    const int exponent
+        = std::max(value.exponent + length - DIGITS, MIN_EXPONENT);
+    ExactValue rounded = value;
+    bool inexact = false;
+    bool away = false;
+    if (exponent > value.exponent) {
+        // Keep one bit below the result to decide the rounding.
+        inexact = shift_right(rounded, exponent - value.exponent - 1);
+        away = (rounded.low & 1) != 0;
+        inexact |= away;
+        rounded.low >>= 1;
+    }
+    const T magnitude = std::ldexp(
+        static_cast<T>(rounded.low + (away ? 1 : 0)),
+        std::max(exponent, value.exponent));
+    const T result = value.negative ? -magnitude : magnitude;
+    if (std::isinf(result)) {
+        fflags |= FPE_OF | FPE_NX;
+    } else if (inexact) {
+        fflags |= FPE_NX;
+        if (std::fabs(result) < std::numeric_limits<T>::min()) {
+            fflags |= FPE_UF;
+        }
+    }
+    return result;
+}
+
+/**
+ * RMM arithmetic computed in software. Finite results differ from RNE only
+ * in exact ties, so only inexact results are computed again. Square root
+ * never ties.
+ */
+template<typename T>
+T arithmetic_exact(FpuOp op, T a, T b, T c, uint32_t &fflags) {
+    T nearest;
+    uint32_t flags;
+    {
+        HostFpEnv env(FE_TONEAREST);
+        nearest = compute(op, a, b, c);
+        flags = HostFpEnv::flags();
+    }
+    if (!(flags & FPE_NX) || op == FpuOp::SQRT) {
+        fflags |= flags;
+        return nearest;
+    }
+    const ExactValue va = decompose(a);
+    ExactValue vb = decompose(b);
+    ExactValue vc = decompose(c);
+    ExactValue exact;
+    switch (op) {
+    case FpuOp::ADD: exact = add(va, vb); break;
+    case FpuOp::SUB:
+        vb.negative = !vb.negative;
+        exact = add(va, vb);
+        break;
+    case FpuOp::MUL: exact = multiply(va, vb); break;
+    case FpuOp::DIV: exact = divide(va, vb); break;
+    default:
+        exact = multiply(va, vb);
+        exact.negative ^= (op == FpuOp::NMSUB || op == FpuOp::NMADD);
+        vc.negative ^= (op == FpuOp::MSUB || op == FpuOp::NMADD);
+        exact = add(exact, vc);
+        break;
+    }
+    return round_exact<T>(exact, fflags);
+}
+
+template<typename T>
+T arithmetic(FpuOp op, FpRounding rm, T a, T b, T c, uint32_t &fflags) {
+    if (rm != FpRounding::RMM) {
+        HostFpEnv env(host_rounding(rm));
+        const T result = compute(op, a, b, c);
+        fflags |= HostFpEnv::flags();
+        return result;
+    }
+    // Host has no ties-to-max-magnitude mode, the result is computed by
+    // round-to-odd in a wider format and rounded in software.
+    using W = typename FpFormat<T>::Wide;
+    if (!is_wide_enough<T, W>()) {
+        return arithmetic_exact(op, a, b, c, fflags);
+    }
+    W wide;
+    {
+        HostFpEnv env(FE_TOWARDZERO);
+        wide = compute<W>(op, a, b, c);
+        const uint32_t flags = HostFpEnv::flags();
+        fflags |= flags & (FPE_NV | FPE_DZ);
+        if ((flags & FPE_NX) && std::isfinite(wide)) {
+            wide = make_odd(wide);
+        }
+    }
+    return round_rmm<T>(wide, fflags);
+}
+
+/** Conversion between single and double precision. */
+template<typename T, typename S>
+T convert_format(S value, FpRounding rm, uint32_t &fflags) {
+    if (std::isnan(value)) {
+        if (is_signaling(value)) {
+            fflags |= FPE_NV;
+        }
+        return canonical_nan<T>();
+    }
+    if (rm == FpRounding::RMM) {
+        return round_rmm<T>(value, fflags);
+    }
+    HostFpEnv env(host_rounding(rm));
+    volatile S v = value;
+    const T result = static_cast<T>(v);
+    fflags |= HostFpEnv::flags();
+    return result;
+}
+
+template<typename T, typename I>
+T from_integer(I value, FpRounding rm, uint32_t &fflags) {
+    if (rm == FpRounding::RMM) {
+        ExactValue exact;
+        exact.negative = std::numeric_limits<I>::is_signed && value < 0;
+        exact.low = static_cast<uint64_t>(value);
+        if (exact.negative) {
+            exact.low = 0 - exact.low;
+        }
+        return round_exact<T>(exact, fflags);
+    }
+    HostFpEnv env(host_rounding(rm));
+    volatile I v = value;
+    const T result = static_cast<T>(v);
+    fflags |= HostFpEnv::flags();
+    return result;
+}
+
+/**
+ * Conversion to integer saturates out of range values and NaN and raises
+ * invalid operation instead of inexact for them.
+ */
+template<typename I, typename T>
+I to_integer(T value, FpRounding rm, uint32_t &fflags) {
+    if (std::isnan(value)) {
+        fflags |= FPE_NV;
+        return std::numeric_limits<I>::max();
+    }
+    T rounded;
+    if (rm == FpRounding::RMM) {
+        rounded = std::round(value);
+    } else {
+        HostFpEnv env(host_rounding(rm));
+        volatile T v = value;
+        rounded = std::nearbyint(T(v));
+    }
+    const T limit = std::ldexp(T(1), std::numeric_limits<I>::digits);
+    const bool too_low = std::numeric_limits<I>::is_signed ? (rounded < -limit)
+                                                           : (rounded <= -1);
+    if (too_low) {
+        fflags |= FPE_NV;
+        return std::numeric_limits<I>::min();
+    }
+    if (rounded >= limit) {
+        fflags |= FPE_NV;
+        return std::numeric_limits<I>::max();
+    }
+    if (rounded != value) {
+        fflags |= FPE_NX;
+    }
+    return static_cast<I>(rounded);
+}
+
+/** MIN and MAX return the non-NaN operand and order -0.0 below +0.0. */
+template<typename T>
+T min_max(bool is_max, T a, T b, uint32_t &fflags) {
+    if (is_signaling(a) || is_signaling(b)) {
+        fflags |= FPE_NV;
+    }
+    if (std::isnan(a) && std::isnan(b)) {
+        return canonical_nan<T>();
+    }
+    if (std::isnan(a)) {
+        return b;
+    }
+    if (std::isnan(b)) {
+        return a;
+    }
+    if (a == b) {
+        return (std::signbit(a) != is_max) ? a : b;
+    }
+    return ((a < b) != is_max) ? a : b;
+}
+
+/** FEQ is a quiet comparison, FLT and FLE are signaling. */
+template<typename T>
+bool compare(FpuOp op, T a, T b, uint32_t &fflags) {
+    if (std::isnan(a) || std::isnan(b)) {
+        if (op != FpuOp::EQ || is_signaling(a) || is_signaling(b)) {
+            fflags |= FPE_NV;
+        }
+        return false;
+    }
+    switch (op) {
+    case FpuOp::EQ: return a == b;
+    case FpuOp::LT: return a < b;
+    default: return a <= b;
+    }
+}
+
+template<typename T>
+uint32_t classify(T value) {
+    const bool negative = std::signbit(value);
+    switch (std::fpclassify(value)) {
+    case FP_INFINITE: return negative ? 1u << 0 : 1u << 7;
+    case FP_NORMAL: return negative ? 1u << 1 : 1u << 6;
+    case FP_SUBNORMAL: return negative ? 1u << 2 : 1u << 5;
+    case FP_ZERO: return negative ? 1u << 3 : 1u << 4;
+    default: return is_signaling(value) ? 1u << 8 : 1u << 9;
+    }
+}
+
+template<typename T>
+T sign_inject(FpuOp op, T a, T b) {
+    using Bits = typename FpFormat<T>::Bits;
+    constexpr Bits SIGN = FpFormat<T>::SIGN_BIT;
+    const Bits sign_b = to_bits(b) & SIGN;
+    const Bits magnitude = to_bits(a) & ~SIGN;
+    switch (op) {
+    case FpuOp::SGNJ: return from_bits<T>(magnitude | sign_b);
+    case FpuOp::SGNJN: return from_bits<T>(magnitude | (sign_b ^ SIGN));
+    default: return from_bits<T>(to_bits(a) ^ sign_b);
+    }
+}
+
+/** Other format for conversions between single and double precision. */
+template<typename T>
+struct OtherFormat {
+    using Type = float;
+};
+
+template<>
+struct OtherFormat<float> {
+    using Type = double;
+};
+
+template<typename T>
+RegisterValue operate(
+    FpuOp op,
+    FpRounding rm,
+    RegisterValue ra,
+    RegisterValue rb,
+    RegisterValue rc,
+    uint32_t &fflags) {
+    // Operations with integer or raw operands.
+    switch (op) {
+    case FpuOp::MV_X: return FpFormat<T>::move_to_integer(ra);
+    case FpuOp::MV_F:
+        return FpFormat<T>::store_bits(
+            static_cast<typename FpFormat<T>::Bits>(ra.as_u64()));
+    case FpuOp::CVT_FROM_W:
+        return store(from_integer<T>(ra.as_i32(), rm, fflags));
+    case FpuOp::CVT_FROM_WU:
+        return store(from_integer<T>(ra.as_u32(), rm, fflags));
+    case FpuOp::CVT_FROM_L:
+        return store(from_integer<T>(ra.as_i64(), rm, fflags));
+    case FpuOp::CVT_FROM_LU:
+        return store(from_integer<T>(ra.as_u64(), rm, fflags));
+    case FpuOp::CVT_FMT: {
+        using S = typename OtherFormat<T>::Type;
+        return store(convert_format<T>(load<S>(ra), rm, fflags));
+    }
+    default: break;
+    }
+
+    const T a = load<T>(ra);
+    const T b = load<T>(rb);
+    const T c = load<T>(rc);
+    switch (op) {
+    case FpuOp::MADD:
+    case FpuOp::MSUB:
+    case FpuOp::NMSUB:
+    case FpuOp::NMADD:
+        // Invalid even when the addend is quiet NaN (host may not signal).
+        if ((std::isinf(a) && b == 0) || (a == 0 && std::isinf(b))) {
+            fflags |= FPE_NV;
+        }
+        FALLTROUGH
+    case FpuOp::ADD:
+    case FpuOp::SUB:
+    case FpuOp::MUL:
+    case FpuOp::DIV:
+    case FpuOp::SQRT:
+        return store(canonicalize(arithmetic(op, rm, a, b, c, fflags)));
+    case FpuOp::SGNJ:
+    case FpuOp::SGNJN:
+    case FpuOp::SGNJX: return store(sign_inject(op, a, b));
+    case FpuOp::MIN: return store(min_max(false, a, b, fflags));
+    case FpuOp::MAX: return store(min_max(true, a, b, fflags));
+    // 32-bit results are sign-extended in RV64 (also the unsigned ones).
+    case FpuOp::CVT_W: return to_integer<int32_t>(a, rm, fflags);
+    case FpuOp::CVT_WU:
+        return int32_t(to_integer<uint32_t>(a, rm, fflags));
+    case FpuOp::CVT_L: return to_integer<int64_t>(a, rm, fflags);
+    case FpuOp::CVT_LU: return to_integer<uint64_t>(a, rm, fflags);
+    case FpuOp::EQ:
+    case FpuOp::LT:
+    case FpuOp::LE: return uint32_t(compare(op, a, b, fflags));
+    case FpuOp::CLASS: return classify(a);
+    default:
+        qDebug("ERROR, unknown fpu operation: %hhx", uint8_t(op));
+        return 0;
+    }
+}
+
+} // namespace
+
+RegisterValue fpu_operate(
+    FpuOp op,
+    bool is_double,
+    FpRounding rm,
+    RegisterValue a,
+    RegisterValue b,
+    RegisterValue c,
+    uint32_t &fflags) {
+    return is_double ? operate<double>(op, rm, a, b, c, fflags)
+                     : operate<float>(op, rm, a, b, c, fflags);
+}
+
+} // namespace machine
@@ -0,0 +1,58 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include "execute/fpu_op.h"
+#include "register_value.h"
+
+#include <cstdint>
+
+namespace machine {
+
+/**
+ * RV32/64 "F" and "D" for OP-FP and fused multiply-add instructions
+ *
+ * Floating-point unit conforming to Standard Extensions for Single- and
+ * Double-Precision Floating-Point, Version 2.2.
+ *
+ * Arithmetic runs on the host FPU with host rounding mode set to the
+ * requested one, exception flags are taken from the host. Behavior the host
+ * does not provide is emulated: RMM rounding (computed with round-to-odd in
+ * a wider format and rounded in software), canonical NaN results, MIN/MAX,
+ * comparisons, classification and saturating conversions to integers.
+ *
+ * Single-precision values are NaN-boxed in 64-bit registers, improperly
+ * boxed operands are treated as canonical NaN.
+ *
+ * @param op          operation
+ * @param is_double   format of the operation (destination format for
+ *                    CVT_FMT)
+ * @param rm          rounding mode, already resolved (not DYN)
+ * @param a           operand 1 (integer register for CVT_FROM_* and MV_F)
+ * @param b           operand 2
+ * @param c           operand 3 (fused multiply-add only)
+ * @param fflags      accrued exception flags are or-ed here
+ * @return            result of the operation, NaN-boxed for single
+ *                    precision results in floating-point registers
+ */
+RegisterValue fpu_operate(
+    FpuOp op,
+    bool is_double,
+    FpRounding rm,
+    RegisterValue a,
+    RegisterValue b,
+    RegisterValue c,
+    uint32_t &fflags);
+
+/** Rounding mode is valid for execution (DYN has to be resolved). */
+constexpr bool fp_rounding_valid(FpRounding rm) {
+    return rm <= FpRounding::RMM;
+}
+
+/** NaN-box single-precision value for 64-bit floating-point register. */
+constexpr RegisterValue fp_box32(uint32_t bits) {
+    return RegisterValue(uint64_t(0xffffffff00000000ULL) | bits);
+}
+
+} // namespace machine
+
+#endif // FPU_H
@@ -0,0 +1,130 @@
+#include "fpu.h"
+
+#include "fpu.test.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace machine;
+
+static uint64_t single(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return fp_box32(bits).as_u64();
+}
+
+static uint64_t dbl(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void TestFpu::test_fpu_operate_data() {
+    QTest::addColumn<FpuOp>("op");
+    QTest::addColumn<bool>("is_double");
+    QTest::addColumn<int>("rm");
+    QTest::addColumn<uint64_t>("operand_a");
+    QTest::addColumn<uint64_t>("operand_b");
+    QTest::addColumn<uint64_t>("operand_c");
+    QTest::addColumn<uint64_t>("result");
+    QTest::addColumn<uint32_t>("fflags");
+
+    const int RNE = int(FpRounding::RNE);
+    const int RTZ = int(FpRounding::RTZ);
+    const int RUP = int(FpRounding::RUP);
+    const int RMM = int(FpRounding::RMM);
+    // Units in the last place of 1.0
+    const float ulp_s = std::ldexp(1.0f, -23);
+    const double ulp_d = std::ldexp(1.0, -52);
+
+    QTest::addRow("FDIV.S inexact")
+        << FpuOp::DIV << false << RNE << single(1) << single(3) << uint64_t(0)
+        << uint64_t(0xffffffff3eaaaaabULL) << FPE_NX;
+    QTest::addRow("FDIV.S by zero")
+        << FpuOp::DIV << false << RNE << single(1) << single(0) << uint64_t(0)
+        << single(INFINITY) << FPE_DZ;
+    QTest::addRow("FADD.S tie RNE")
+        << FpuOp::ADD << false << RNE << single(1) << single(ulp_s / 2)
+        << uint64_t(0) << single(1) << FPE_NX;
+    QTest::addRow("FADD.S tie RMM")
+        << FpuOp::ADD << false << RMM << single(1) << single(ulp_s / 2)
+        << uint64_t(0) << single(1 + ulp_s) << FPE_NX;
+    QTest::addRow("FADD.D tie RMM")
+        << FpuOp::ADD << true << RMM << dbl(1) << dbl(ulp_d / 2) << uint64_t(0)
+        << dbl(1 + ulp_d) << FPE_NX;
+    QTest::addRow("FMUL.D subnormal tie RMM")
+        << FpuOp::MUL << true << RMM << uint64_t(5) << dbl(0.5) << uint64_t(0)
+        << uint64_t(3) << (FPE_UF | FPE_NX);
+    QTest::addRow("FMUL.S overflow RUP")
+        << FpuOp::MUL << false << RUP << single(1e38f) << single(10)
+        << uint64_t(0) << single(INFINITY) << (FPE_OF | FPE_NX);
+    QTest::addRow("FSQRT.S negative")
+        << FpuOp::SQRT << false << RNE << single(-1) << uint64_t(0)
+        << uint64_t(0) << uint64_t(0xffffffff7fc00000ULL) << FPE_NV;
+    QTest::addRow("FMIN.S signed zeros")
+        << FpuOp::MIN << false << RNE << single(-0.0f) << single(0.0f)
+        << uint64_t(0) << single(-0.0f) << 0u;
+    QTest::addRow("FMADD.S")
+        << FpuOp::MADD << false << RNE << single(1e30f) << single(0)
+        << single(1) << single(1) << 0u;
+    QTest::addRow("FCVT.W.S RNE")
+        << FpuOp::CVT_W << false << RNE << single(2.5f) << uint64_t(0)
+        << uint64_t(0) << uint64_t(2) << FPE_NX;
+    QTest::addRow("FCVT.W.S RMM")
+        << FpuOp::CVT_W << false << RMM << single(2.5f) << uint64_t(0)
+        << uint64_t(0) << uint64_t(3) << FPE_NX;
+    QTest::addRow("FCVT.W.S saturate")
+        << FpuOp::CVT_W << false << RTZ << single(3e10f) << uint64_t(0)
+        << uint64_t(0) << uint64_t(0x7fffffff) << FPE_NV;
+    QTest::addRow("FCVT.WU.S negative")
+        << FpuOp::CVT_WU << false << RTZ << single(-3) << uint64_t(0)
+        << uint64_t(0) << uint64_t(0) << FPE_NV;
+    QTest::addRow("FCVT.S.D RMM")
+        << FpuOp::CVT_FMT << false << RMM << dbl(1 + double(ulp_s) / 2)
+        << uint64_t(0) << uint64_t(0) << single(1 + ulp_s) << FPE_NX;
+    QTest::addRow("FCVT.S.L RMM")
+        << FpuOp::CVT_FROM_L << false << RMM << uint64_t(0x1000001)
+        << uint64_t(0) << uint64_t(0) << single(0x1000002) << FPE_NX;
+    QTest::addRow("FCVT.D.L RMM")
+        << FpuOp::CVT_FROM_L << true << RMM << uint64_t(0x20000000000001)
+        << uint64_t(0) << uint64_t(0) << dbl(0x20000000000002) << FPE_NX;
+    QTest::addRow("FLT.S")
+        << FpuOp::LT << false << RNE << single(1) << single(2) << uint64_t(0)
+        << uint64_t(1) << 0u;
+    QTest::addRow("FCLASS.S not boxed")
+        << FpuOp::CLASS << false << RNE << uint64_t(0x12345) << uint64_t(0)
+        << uint64_t(0) << uint64_t(1 << 9) << 0u;
+}
+
+void TestFpu::test_fpu_operate() {
+    QFETCH(FpuOp, op);
+    QFETCH(bool, is_double);
+    QFETCH(int, rm);
+    QFETCH(uint64_t, operand_a);
+    QFETCH(uint64_t, operand_b);
+    QFETCH(uint64_t, operand_c);
+    QFETCH(uint64_t, result);
+    QFETCH(uint32_t, fflags);
+
+    uint32_t flags = 0;
+    QCOMPARE(
+        fpu_operate(
+            op, is_double, static_cast<FpRounding>(rm), operand_a, operand_b,
+            operand_c, flags)
+            .as_u64(),
+        result);
+    QCOMPARE(flags, fflags);
+}
+
+void TestFpu::test_fpu_canonical_nan() {
+    // Payload of NaN operands is not propagated.
+    uint32_t flags = 0;
+    const uint64_t nan = dbl(NAN) | 0x1234;
+    QCOMPARE(
+        fpu_operate(FpuOp::ADD, true, FpRounding::RNE, nan, dbl(1), 0, flags)
+            .as_u64(),
+        uint64_t(0x7ff8000000000000ULL));
+    QCOMPARE(flags, 0u);
+}
+
+QTEST_APPLESS_MAIN(TestFpu)
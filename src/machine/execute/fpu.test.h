@@ -0,0 +1,14 @@
+#ifndef FPU_TEST_H
+#define FPU_TEST_H
+
+#include <QtTest>
+
+class TestFpu : public QObject {
+    Q_OBJECT
+private slots:
+    static void test_fpu_operate_data();
+    static void test_fpu_operate();
+    static void test_fpu_canonical_nan();
+};
+
+#endif // FPU_TEST_H
@@ -0,0 +1,71 @@
+#ifndef FPU_OP_H
+#define FPU_OP_H
+
+#include <QMetaType>
+#include <cstdint>
+
+namespace machine {
+
+/**
+ * Operations of the floating-point unit (F and D extensions).
+ *
+ * Format of the operation (single or double) is passed separately.
+ */
+enum class FpuOp : uint8_t {
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    SQRT,
+    SGNJ,
+    SGNJN,
+    SGNJX,
+    MIN,
+    MAX,
+    CVT_FMT,     //> Conversion from the other format
+    CVT_W,       //> To signed 32-bit integer
+    CVT_WU,      //> To unsigned 32-bit integer
+    CVT_L,       //> To signed 64-bit integer
+    CVT_LU,      //> To unsigned 64-bit integer
+    CVT_FROM_W,  //> From signed 32-bit integer
+    CVT_FROM_WU, //> From unsigned 32-bit integer
+    CVT_FROM_L,  //> From signed 64-bit integer
+    CVT_FROM_LU, //> From unsigned 64-bit integer
+    MV_X,        //> Bits to integer register
+    MV_F,        //> Bits from integer register
+    EQ,
+    LT,
+    LE,
+    CLASS,
+    MADD,
+    MSUB,
+    NMSUB,
+    NMADD,
+};
+
+/**
+ * Rounding modes encoded in the rm instruction field and in fcsr.frm.
+ */
+enum class FpRounding : uint8_t {
+    RNE = 0b000, //> Round to nearest, ties to even
+    RTZ = 0b001, //> Round towards zero
+    RDN = 0b010, //> Round down
+    RUP = 0b011, //> Round up
+    RMM = 0b100, //> Round to nearest, ties to max magnitude
+    DYN = 0b111, //> Use fcsr.frm (instruction field only)
+};
+
+/*
+ * Accrued exception flags (fcsr.fflags).
+ */
+constexpr uint32_t FPE_NX = 1u << 0; // Inexact
+constexpr uint32_t FPE_UF = 1u << 1; // Underflow
+constexpr uint32_t FPE_OF = 1u << 2; // Overflow
+constexpr uint32_t FPE_DZ = 1u << 3; // Divide by zero
+constexpr uint32_t FPE_NV = 1u << 4; // Invalid operation
+
+} // namespace machine
+
+Q_DECLARE_METATYPE(machine::FpuOp)
+
+#endif // FPU_OP_H
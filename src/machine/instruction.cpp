@@ -1,17 +1,19 @@
 #include "instruction.h"
 
+#include "execute/fpu_op.h"
 #include "memory/backend/memory.h"
 #include "simulator_exception.h"
 #include "utils.h"
 
 #include <QChar>
-#include <QMultiMap>
 #include <QStringList>
+#include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <initializer_list>
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace machine;
 
@@ -68,12 +70,20 @@ static const ArgumentDesc argdeslist[] = {
     ArgumentDesc('s', 'g', 0,        0x1f,    {{{5, 15}}, 0}),
     ArgumentDesc('t', 'g', 0,        0x1f,    {{{5, 20}}, 0}),
     ArgumentDesc('j', 'n', -0x800,   0x7ff,   {{{12, 20}}, 0}),
-    ArgumentDesc('>', 'n', 0,        0x1f,    {{{5, 20}}, 0}),
+    ArgumentDesc('>', 'n', 0,        0x3f,    {{{6, 20}}, 0}),
+    ArgumentDesc('<', 'n', 0,        0x1f,    {{{5, 20}}, 0}),
     ArgumentDesc('a', 'a', -0x80000, 0x7ffff, {{{11, 21}, {1, 20}, {8, 12}, {1, 31}}, 1}),
-    ArgumentDesc('u', 'n', 0,        0xfffff, {{{20, 12}}, 12}),
+    ArgumentDesc('u', 'n', 0,        0xfffff, {{{20, 12}}, 0}),
     ArgumentDesc('p', 'p', -0x800,   0x7ff,   {{{4, 8}, {6, 25}, {1, 7}, {1, 31}}, 1}),
     ArgumentDesc('o', 'o', -0x800,   0x7ff,   {{{12, 20}}, 0}),
     ArgumentDesc('q', 'o', -0x800,   0x7ff,   {{{5, 7}, {7, 25}}, 0}),
+    ArgumentDesc('D', 'f', 0,        0x1f,    {{{5, 7}}, 0}),
+    ArgumentDesc('S', 'f', 0,        0x1f,    {{{5, 15}}, 0}),
+    ArgumentDesc('T', 'f', 0,        0x1f,    {{{5, 20}}, 0}),
+    ArgumentDesc('R', 'f', 0,        0x1f,    {{{5, 27}}, 0}),
+    ArgumentDesc('m', 'r', 0,        0x7,     {{{3, 12}}, 0}),
+    ArgumentDesc('E', 'c', 0,        0xfff,   {{{12, 20}}, 0}),
+    ArgumentDesc('Z', 'n', 0,        0x1f,    {{{5, 15}}, 0}),
 };
 
 static const ArgumentDesc *argdesbycode[(int)('z' + 1)];
@@ -116,6 +126,30 @@ const std::string Rv_regnames[32] = {
     "s6",   "s7", "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6",
 };
 
+const char *const Rv_fp_regnames[32] = {
+    "ft0", "ft1", "ft2",  "ft3",  "ft4", "ft5", "ft6",  "ft7",
+    "fs0", "fs1", "fa0",  "fa1",  "fa2", "fa3", "fa4",  "fa5",
+    "fa6", "fa7", "fs2",  "fs3",  "fs4", "fs5", "fs6",  "fs7",
+    "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11",
+};
+
+/** Names of rounding modes indexed by FpRounding, reserved ones are null. */
+static const char *const rounding_names[8] = {
+    "rne", "rtz", "rdn", "rup", "rmm", nullptr, nullptr, "dyn",
+};
+
+struct CsrDesc {
+    uint16_t number;
+    const char *name;
+};
+
+/** Only floating-point CSRs are implemented. */
+static const CsrDesc csr_names[] = {
+    { 0x001, "fflags" },
+    { 0x002, "frm" },
+    { 0x003, "fcsr" },
+};
+
 #define FLAGS_ALU_I_NO_RS (IMF_SUPPORTED | IMF_ALUSRC | IMF_REGWRITE)
 #define FLAGS_ALU_I (IMF_SUPPORTED | IMF_ALUSRC | IMF_REGWRITE | IMF_ALU_REQ_RS)
 #define FLAGS_ALU_I_ZE (FLAGS_ALU_I | IMF_ZERO_EXTEND)
@@ -127,6 +161,10 @@ const std::string Rv_regnames[32] = {
     (IMF_SUPPORTED | IMF_ALUSRC | IMF_MEMWRITE | IMF_MEM | IMF_ALU_REQ_RS      \
      | IMF_ALU_REQ_RT)
 
+// SC and AMO results come from the memory stage, as loads do.
+#define FLAGS_AMO_LOAD FLAGS_ALU_I_LOAD
+#define FLAGS_AMO_STORE (FLAGS_ALU_I_LOAD | IMF_MEMWRITE | IMF_ALU_REQ_RT)
+
 #define FLAGS_ALU_T_R_D (IMF_SUPPORTED | IMF_REGD | IMF_REGWRITE)
 #define FLAGS_ALU_T_R_STD (FLAGS_ALU_T_R_D | IMF_ALU_REQ_RS | IMF_ALU_REQ_RT)
 #define FLAGS_ALU_T_R_STD_SHV (FLAGS_ALU_T_R_STD | IMF_ALU_SHIFT)
@@ -141,9 +179,33 @@ const std::string Rv_regnames[32] = {
 
 #define FLAGS_J_B_PC_TO_R31 (IMF_SUPPORTED | IMF_PC_TO_R31 | IMF_REGWRITE)
 
+#define FLAGS_ALU_I_W (FLAGS_ALU_I | IMF_ALU_WORD | IMF_RV64)
+#define FLAGS_ALU_T_R_STD_W (FLAGS_ALU_T_R_STD | IMF_ALU_WORD | IMF_RV64)
+#define FLAGS_MUL (FLAGS_ALU_T_R_STD | IMF_MUL)
+#define FLAGS_MUL_W (FLAGS_MUL | IMF_ALU_WORD | IMF_RV64)
+
+#define FLAGS_FP (IMF_SUPPORTED | IMF_FPU | IMF_REGWRITE | IMF_ALU_REQ_RS)
+#define FLAGS_FP_SD (FLAGS_FP | IMF_FP_RS | IMF_FP_RD)
+#define FLAGS_FP_SD_RM (FLAGS_FP_SD | IMF_FP_RM)
+#define FLAGS_FP_STD (FLAGS_FP_SD | IMF_ALU_REQ_RT | IMF_FP_RT)
+#define FLAGS_FP_STD_RM (FLAGS_FP_STD | IMF_FP_RM)
+#define FLAGS_FP_FUSED (FLAGS_FP_STD_RM | IMF_FP_REQ_RS3)
+#define FLAGS_FP_CMP (FLAGS_FP | IMF_FP_RS | IMF_ALU_REQ_RT | IMF_FP_RT)
+#define FLAGS_FP_TO_X (FLAGS_FP | IMF_FP_RS)
+#define FLAGS_FP_FROM_X (FLAGS_FP | IMF_FP_RD)
+#define FLAGS_FP_LOAD (FLAGS_ALU_I_LOAD | IMF_FP_RD)
+#define FLAGS_FP_STORE (FLAGS_ALU_I_STORE | IMF_FP_RT)
+
+#define FLAGS_CSR_I (IMF_SUPPORTED | IMF_CSR | IMF_REGWRITE)
+#define FLAGS_CSR (FLAGS_CSR_I | IMF_ALU_REQ_RS)
+
 // #define NOALU .alu = ALU_OP_SLL
 #define NOALU .alu = AluOp::ADD
 #define NOMEM .mem_ctl = AC_NONE
+// Multiplier operation is stored in ALU field, IMF_MUL selects the unit.
+#define MULOP(op) static_cast<AluOp>(MulOp::op)
+// Floating-point operation is stored in ALU field, IMF_FPU selects the unit.
+#define FPUOP(op) static_cast<AluOp>(FpuOp::op)
 
 #define IM_UNKNOWN                                                             \
     { "UNKNOWN", Instruction::UNKNOWN, NOALU, NOMEM, nullptr, {}, 0, 0, 0 }
@@ -161,7 +223,7 @@ struct InstructionMap {
     uint32_t code;
     uint32_t mask;
     union {
-        unsigned int flags;
+        uint64_t flags;
         BitArg::Field subfield;
     };
 };
@@ -177,35 +239,56 @@ struct InstructionMap {
 // clang-format off
 
 static const struct InstructionMap LOAD_map[] = {
-    {"lb", IT_I, AluOp::ADD, AC_U8, nullptr, {"d", "o(s)"}, 0x00000003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LB
-    IM_UNKNOWN, // LH
-    {"lw", IT_I, AluOp::ADD, AC_U32, nullptr, {"d", "o(s)"}, 0x00002003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LW
-    IM_UNKNOWN, // LD
-    IM_UNKNOWN, // LBU
-    IM_UNKNOWN, // LHU
-    IM_UNKNOWN, // LWU
+    {"lb",  IT_I, AluOp::ADD, AC_I8,  nullptr, {"d", "o(s)"}, 0x00000003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LB
+    {"lh",  IT_I, AluOp::ADD, AC_I16, nullptr, {"d", "o(s)"}, 0x00001003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LH
+    {"lw",  IT_I, AluOp::ADD, AC_I32, nullptr, {"d", "o(s)"}, 0x00002003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LW
+    {"ld",  IT_I, AluOp::ADD, AC_I64, nullptr, {"d", "o(s)"}, 0x00003003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD | IMF_RV64 }}, // LD
+    {"lbu", IT_I, AluOp::ADD, AC_U8,  nullptr, {"d", "o(s)"}, 0x00004003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LBU
+    {"lhu", IT_I, AluOp::ADD, AC_U16, nullptr, {"d", "o(s)"}, 0x00005003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD }}, // LHU
+    {"lwu", IT_I, AluOp::ADD, AC_U32, nullptr, {"d", "o(s)"}, 0x00006003, 0x0000707f, { .flags = FLAGS_ALU_I_LOAD | IMF_RV64 }}, // LWU
     IM_UNKNOWN,
 };
 
+static const struct InstructionMap SRI_map[] = {
+    {"srli", IT_I, AluOp::SR, NOMEM, nullptr, {"d", "s", ">"}, 0x00005013, 0xfc00707f, { .flags = FLAGS_ALU_I }}, // SRLI
+    {"srai", IT_I, AluOp::SR, NOMEM, nullptr, {"d", "s", ">"}, 0x40005013, 0xfc00707f, { .flags = FLAGS_ALU_I | IMF_ALU_MOD }}, // SRAI
+};
+
 static const struct InstructionMap OP_IMM_map[] = {
     {"addi",  IT_I, AluOp::ADD,  NOMEM, nullptr, {"d", "s", "j"}, 0x00000013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // ADDI
-    {"slli",  IT_I, AluOp::SLL,  NOMEM, nullptr, {"d", "s", ">"}, 0x00001013, 0xfe00707f, { .flags = FLAGS_ALU_I }}, // SLLI
+    {"slli",  IT_I, AluOp::SLL,  NOMEM, nullptr, {"d", "s", ">"}, 0x00001013, 0xfc00707f, { .flags = FLAGS_ALU_I }}, // SLLI
     {"slti",  IT_I, AluOp::SLT,  NOMEM, nullptr, {"d", "s", "j"}, 0x00002013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // SLTI
     {"sltiu", IT_I, AluOp::SLTU, NOMEM, nullptr, {"d", "s", "j"}, 0x00003013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // SLTIU
     {"xori",  IT_I, AluOp::XOR,  NOMEM, nullptr, {"d", "s", "j"}, 0x00004013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // XORI
-    IM_UNKNOWN, // SRLI, SRAI
+    {"srli/srai", IT_I, NOALU, NOMEM, SRI_map, {}, 0x00005013, 0xbc00707f, { .subfield = {1, 30} }}, // SRLI, SRAI
     {"ori",   IT_I, AluOp::OR,   NOMEM, nullptr, {"d", "s", "j"}, 0x00006013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // ORI
     {"andi",  IT_I, AluOp::AND,  NOMEM, nullptr, {"d", "s", "j"}, 0x00007013, 0x0000707f, { .flags = FLAGS_ALU_I }}, // ANDI
 };
 
+static const struct InstructionMap SRIW_map[] = {
+    {"srliw", IT_I, AluOp::SR, NOMEM, nullptr, {"d", "s", "<"}, 0x0000501b, 0xfe00707f, { .flags = FLAGS_ALU_I_W }}, // SRLIW
+    {"sraiw", IT_I, AluOp::SR, NOMEM, nullptr, {"d", "s", "<"}, 0x4000501b, 0xfe00707f, { .flags = FLAGS_ALU_I_W | IMF_ALU_MOD }}, // SRAIW
+};
+
+static const struct InstructionMap OP_IMM_32_map[] = {
+    {"addiw", IT_I, AluOp::ADD, NOMEM, nullptr, {"d", "s", "j"}, 0x0000001b, 0x0000707f, { .flags = FLAGS_ALU_I_W }}, // ADDIW
+    {"slliw", IT_I, AluOp::SLL, NOMEM, nullptr, {"d", "s", "<"}, 0x0000101b, 0xfe00707f, { .flags = FLAGS_ALU_I_W }}, // SLLIW
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"srliw/sraiw", IT_I, NOALU, NOMEM, SRIW_map, {}, 0x0000501b, 0xbe00707f, { .subfield = {1, 30} }}, // SRLIW, SRAIW
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
 static const struct InstructionMap STORE_map[] = {
-    {"sb", IT_S, AluOp::ADD, AC_U8, nullptr, {"t", "q(s)"}, 0x00000023, 0x0000707f, { .flags = FLAGS_ALU_I_STORE }}, // SB
-    IM_UNKNOWN, // SH
+    {"sb", IT_S, AluOp::ADD, AC_U8,  nullptr, {"t", "q(s)"}, 0x00000023, 0x0000707f, { .flags = FLAGS_ALU_I_STORE }}, // SB
+    {"sh", IT_S, AluOp::ADD, AC_U16, nullptr, {"t", "q(s)"}, 0x00001023, 0x0000707f, { .flags = FLAGS_ALU_I_STORE }}, // SH
     {"sw", IT_S, AluOp::ADD, AC_U32, nullptr, {"t", "q(s)"}, 0x00002023, 0x0000707f, { .flags = FLAGS_ALU_I_STORE }}, // SW
-    IM_UNKNOWN, // LD
-    IM_UNKNOWN, // LBU
-    IM_UNKNOWN, // LHU
-    IM_UNKNOWN, // LWU
+    {"sd", IT_S, AluOp::ADD, AC_U64, nullptr, {"t", "q(s)"}, 0x00003023, 0x0000707f, { .flags = FLAGS_ALU_I_STORE | IMF_RV64 }}, // SD
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
     IM_UNKNOWN,
 };
 
@@ -214,60 +297,504 @@ static const struct InstructionMap ADD_map[] = {
     {"sub", IT_R, AluOp::ADD, NOMEM, nullptr, {"d", "s", "t"}, 0x40000033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD | IMF_ALU_MOD }},
 };
 
+static const struct InstructionMap SR_map[] = {
+    {"srl", IT_R, AluOp::SR, NOMEM, nullptr, {"d", "s", "t"}, 0x00005033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }},
+    {"sra", IT_R, AluOp::SR, NOMEM, nullptr, {"d", "s", "t"}, 0x40005033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD | IMF_ALU_MOD }},
+};
+
 // TODO: subtrees are ugly, maybe a union would help?
-static const struct InstructionMap OP_map[] = {
+static const struct InstructionMap OP_ALU_map[] = {
     {"add/sub", IT_R, NOALU,    NOMEM, ADD_map,              {}, 0x00000033, 0xbe00707f, { .subfield = {1, 30} }},
     {"sll",  IT_R, AluOp::SLL,  NOMEM, nullptr, {"d", "s", "t"}, 0x00001033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // SLL
     {"slt",  IT_R, AluOp::SLT,  NOMEM, nullptr, {"d", "s", "t"}, 0x00002033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // SLT
     {"sltu", IT_R, AluOp::SLTU, NOMEM, nullptr, {"d", "s", "t"}, 0x00003033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // SLTU
     {"xor",  IT_R, AluOp::XOR,  NOMEM, nullptr, {"d", "s", "t"}, 0x00004033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // XOR
-    IM_UNKNOWN, // SRL, SRA
+    {"srl/sra", IT_R, NOALU,    NOMEM, SR_map,               {}, 0x00005033, 0xbe00707f, { .subfield = {1, 30} }}, // SRL, SRA
     {"or",   IT_R, AluOp::OR,   NOMEM, nullptr, {"d", "s", "t"}, 0x00006033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // OR
     {"and",  IT_R, AluOp::AND,  NOMEM, nullptr, {"d", "s", "t"}, 0x00007033, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD }}, // AND
 };
 
-constexpr const int FLAGS_BRANCH = IMF_SUPPORTED | IMF_BRANCH | IMF_BJR_REQ_RS;
+static const struct InstructionMap MUL_map[] = {
+    {"mul",    IT_R, MULOP(MUL),    NOMEM, nullptr, {"d", "s", "t"}, 0x02000033, 0xfe00707f, { .flags = FLAGS_MUL }}, // MUL
+    {"mulh",   IT_R, MULOP(MULH),   NOMEM, nullptr, {"d", "s", "t"}, 0x02001033, 0xfe00707f, { .flags = FLAGS_MUL }}, // MULH
+    {"mulhsu", IT_R, MULOP(MULHSU), NOMEM, nullptr, {"d", "s", "t"}, 0x02002033, 0xfe00707f, { .flags = FLAGS_MUL }}, // MULHSU
+    {"mulhu",  IT_R, MULOP(MULHU),  NOMEM, nullptr, {"d", "s", "t"}, 0x02003033, 0xfe00707f, { .flags = FLAGS_MUL }}, // MULHU
+    {"div",    IT_R, MULOP(DIV),    NOMEM, nullptr, {"d", "s", "t"}, 0x02004033, 0xfe00707f, { .flags = FLAGS_MUL }}, // DIV
+    {"divu",   IT_R, MULOP(DIVU),   NOMEM, nullptr, {"d", "s", "t"}, 0x02005033, 0xfe00707f, { .flags = FLAGS_MUL }}, // DIVU
+    {"rem",    IT_R, MULOP(REM),    NOMEM, nullptr, {"d", "s", "t"}, 0x02006033, 0xfe00707f, { .flags = FLAGS_MUL }}, // REM
+    {"remu",   IT_R, MULOP(REMU),   NOMEM, nullptr, {"d", "s", "t"}, 0x02007033, 0xfe00707f, { .flags = FLAGS_MUL }}, // REMU
+};
+
+static const struct InstructionMap OP_map[] = {
+    {"op-alu", IT_R, NOALU, NOMEM, OP_ALU_map, {}, 0x00000033, 0x0000007f, { .subfield = {3, 12} }},
+    {"op-mul", IT_R, NOALU, NOMEM, MUL_map,    {}, 0x02000033, 0x0200007f, { .subfield = {3, 12} }},
+};
+
+static const struct InstructionMap ADDW_map[] = {
+    {"addw", IT_R, AluOp::ADD, NOMEM, nullptr, {"d", "s", "t"}, 0x0000003b, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD_W }},
+    {"subw", IT_R, AluOp::ADD, NOMEM, nullptr, {"d", "s", "t"}, 0x4000003b, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD_W | IMF_ALU_MOD }},
+};
+
+static const struct InstructionMap SRW_map[] = {
+    {"srlw", IT_R, AluOp::SR, NOMEM, nullptr, {"d", "s", "t"}, 0x0000503b, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD_W }},
+    {"sraw", IT_R, AluOp::SR, NOMEM, nullptr, {"d", "s", "t"}, 0x4000503b, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD_W | IMF_ALU_MOD }},
+};
+
+static const struct InstructionMap OP_32_ALU_map[] = {
+    {"addw/subw", IT_R, NOALU,  NOMEM, ADDW_map,             {}, 0x0000003b, 0xbe00707f, { .subfield = {1, 30} }},
+    {"sllw", IT_R, AluOp::SLL,  NOMEM, nullptr, {"d", "s", "t"}, 0x0000103b, 0xfe00707f, { .flags = FLAGS_ALU_T_R_STD_W }}, // SLLW
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"srlw/sraw", IT_R, NOALU,  NOMEM, SRW_map,              {}, 0x0000503b, 0xbe00707f, { .subfield = {1, 30} }}, // SRLW, SRAW
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap MULW_map[] = {
+    {"mulw",  IT_R, MULOP(MUL),  NOMEM, nullptr, {"d", "s", "t"}, 0x0200003b, 0xfe00707f, { .flags = FLAGS_MUL_W }}, // MULW
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"divw",  IT_R, MULOP(DIV),  NOMEM, nullptr, {"d", "s", "t"}, 0x0200403b, 0xfe00707f, { .flags = FLAGS_MUL_W }}, // DIVW
+    {"divuw", IT_R, MULOP(DIVU), NOMEM, nullptr, {"d", "s", "t"}, 0x0200503b, 0xfe00707f, { .flags = FLAGS_MUL_W }}, // DIVUW
+    {"remw",  IT_R, MULOP(REM),  NOMEM, nullptr, {"d", "s", "t"}, 0x0200603b, 0xfe00707f, { .flags = FLAGS_MUL_W }}, // REMW
+    {"remuw", IT_R, MULOP(REMU), NOMEM, nullptr, {"d", "s", "t"}, 0x0200703b, 0xfe00707f, { .flags = FLAGS_MUL_W }}, // REMUW
+};
+
+static const struct InstructionMap OP_32_map[] = {
+    {"op-32-alu", IT_R, NOALU, NOMEM, OP_32_ALU_map, {}, 0x0000003b, 0x0000007f, { .subfield = {3, 12} }},
+    {"op-32-mul", IT_R, NOALU, NOMEM, MULW_map,      {}, 0x0200003b, 0x0200007f, { .subfield = {3, 12} }},
+};
+
+static const struct InstructionMap LOAD_FP_map[] = {
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"flw", IT_I, AluOp::ADD, AC_U32, nullptr, {"D", "o(s)"}, 0x00002007, 0x0000707f, { .flags = FLAGS_FP_LOAD }}, // FLW
+    {"fld", IT_I, AluOp::ADD, AC_U64, nullptr, {"D", "o(s)"}, 0x00003007, 0x0000707f, { .flags = FLAGS_FP_LOAD | IMF_FP_DOUBLE }}, // FLD
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap STORE_FP_map[] = {
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"fsw", IT_S, AluOp::ADD, AC_U32, nullptr, {"T", "q(s)"}, 0x00002027, 0x0000707f, { .flags = FLAGS_FP_STORE }}, // FSW
+    {"fsd", IT_S, AluOp::ADD, AC_U64, nullptr, {"T", "q(s)"}, 0x00003027, 0x0000707f, { .flags = FLAGS_FP_STORE | IMF_FP_DOUBLE }}, // FSD
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+// Operations with rounding mode hold dynamic rounding mode in code, it is
+// the assembler default.
+static const struct InstructionMap FADD_map[] = {
+    {"fadd.s", IT_R, FPUOP(ADD), NOMEM, nullptr, {"D", "S", "T"}, 0x00007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM }},
+    {"fadd.d", IT_R, FPUOP(ADD), NOMEM, nullptr, {"D", "S", "T"}, 0x02007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FSUB_map[] = {
+    {"fsub.s", IT_R, FPUOP(SUB), NOMEM, nullptr, {"D", "S", "T"}, 0x08007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM }},
+    {"fsub.d", IT_R, FPUOP(SUB), NOMEM, nullptr, {"D", "S", "T"}, 0x0a007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMUL_map[] = {
+    {"fmul.s", IT_R, FPUOP(MUL), NOMEM, nullptr, {"D", "S", "T"}, 0x10007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM }},
+    {"fmul.d", IT_R, FPUOP(MUL), NOMEM, nullptr, {"D", "S", "T"}, 0x12007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FDIV_map[] = {
+    {"fdiv.s", IT_R, FPUOP(DIV), NOMEM, nullptr, {"D", "S", "T"}, 0x18007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM }},
+    {"fdiv.d", IT_R, FPUOP(DIV), NOMEM, nullptr, {"D", "S", "T"}, 0x1a007053, 0xfe00007f, { .flags = FLAGS_FP_STD_RM | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FSQRT_map[] = {
+    {"fsqrt.s", IT_R, FPUOP(SQRT), NOMEM, nullptr, {"D", "S"}, 0x58007053, 0xfff0007f, { .flags = FLAGS_FP_SD_RM }},
+    {"fsqrt.d", IT_R, FPUOP(SQRT), NOMEM, nullptr, {"D", "S"}, 0x5a007053, 0xfff0007f, { .flags = FLAGS_FP_SD_RM | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FSGNJ_S_map[] = {
+    {"fsgnj.s", IT_R, FPUOP(SGNJ), NOMEM, nullptr, {"D", "S", "T"}, 0x20000053, 0xfe00707f, { .flags = FLAGS_FP_STD }},
+    {"fsgnjn.s", IT_R, FPUOP(SGNJN), NOMEM, nullptr, {"D", "S", "T"}, 0x20001053, 0xfe00707f, { .flags = FLAGS_FP_STD }},
+    {"fsgnjx.s", IT_R, FPUOP(SGNJX), NOMEM, nullptr, {"D", "S", "T"}, 0x20002053, 0xfe00707f, { .flags = FLAGS_FP_STD }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FSGNJ_D_map[] = {
+    {"fsgnj.d", IT_R, FPUOP(SGNJ), NOMEM, nullptr, {"D", "S", "T"}, 0x22000053, 0xfe00707f, { .flags = FLAGS_FP_STD | IMF_FP_DOUBLE }},
+    {"fsgnjn.d", IT_R, FPUOP(SGNJN), NOMEM, nullptr, {"D", "S", "T"}, 0x22001053, 0xfe00707f, { .flags = FLAGS_FP_STD | IMF_FP_DOUBLE }},
+    {"fsgnjx.d", IT_R, FPUOP(SGNJX), NOMEM, nullptr, {"D", "S", "T"}, 0x22002053, 0xfe00707f, { .flags = FLAGS_FP_STD | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMINMAX_S_map[] = {
+    {"fmin.s", IT_R, FPUOP(MIN), NOMEM, nullptr, {"D", "S", "T"}, 0x28000053, 0xfe00707f, { .flags = FLAGS_FP_STD }},
+    {"fmax.s", IT_R, FPUOP(MAX), NOMEM, nullptr, {"D", "S", "T"}, 0x28001053, 0xfe00707f, { .flags = FLAGS_FP_STD }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMINMAX_D_map[] = {
+    {"fmin.d", IT_R, FPUOP(MIN), NOMEM, nullptr, {"D", "S", "T"}, 0x2a000053, 0xfe00707f, { .flags = FLAGS_FP_STD | IMF_FP_DOUBLE }},
+    {"fmax.d", IT_R, FPUOP(MAX), NOMEM, nullptr, {"D", "S", "T"}, 0x2a001053, 0xfe00707f, { .flags = FLAGS_FP_STD | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCMP_S_map[] = {
+    {"fle.s", IT_R, FPUOP(LE), NOMEM, nullptr, {"d", "S", "T"}, 0xa0000053, 0xfe00707f, { .flags = FLAGS_FP_CMP }},
+    {"flt.s", IT_R, FPUOP(LT), NOMEM, nullptr, {"d", "S", "T"}, 0xa0001053, 0xfe00707f, { .flags = FLAGS_FP_CMP }},
+    {"feq.s", IT_R, FPUOP(EQ), NOMEM, nullptr, {"d", "S", "T"}, 0xa0002053, 0xfe00707f, { .flags = FLAGS_FP_CMP }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCMP_D_map[] = {
+    {"fle.d", IT_R, FPUOP(LE), NOMEM, nullptr, {"d", "S", "T"}, 0xa2000053, 0xfe00707f, { .flags = FLAGS_FP_CMP | IMF_FP_DOUBLE }},
+    {"flt.d", IT_R, FPUOP(LT), NOMEM, nullptr, {"d", "S", "T"}, 0xa2001053, 0xfe00707f, { .flags = FLAGS_FP_CMP | IMF_FP_DOUBLE }},
+    {"feq.d", IT_R, FPUOP(EQ), NOMEM, nullptr, {"d", "S", "T"}, 0xa2002053, 0xfe00707f, { .flags = FLAGS_FP_CMP | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMV_X_S_map[] = {
+    {"fmv.x.w", IT_R, FPUOP(MV_X), NOMEM, nullptr, {"d", "S"}, 0xe0000053, 0xfff0707f, { .flags = FLAGS_FP_TO_X }},
+    {"fclass.s", IT_R, FPUOP(CLASS), NOMEM, nullptr, {"d", "S"}, 0xe0001053, 0xfff0707f, { .flags = FLAGS_FP_TO_X }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMV_X_D_map[] = {
+    {"fmv.x.d", IT_R, FPUOP(MV_X), NOMEM, nullptr, {"d", "S"}, 0xe2000053, 0xfff0707f, { .flags = FLAGS_FP_TO_X | IMF_FP_DOUBLE | IMF_RV64 }},
+    {"fclass.d", IT_R, FPUOP(CLASS), NOMEM, nullptr, {"d", "S"}, 0xe2001053, 0xfff0707f, { .flags = FLAGS_FP_TO_X | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FSGNJ_map[] = {
+    {"fsgnj.s", IT_R, NOALU, NOMEM, FSGNJ_S_map, {}, 0x20000053, 0xfe00007f, { .subfield = {3, 12} }},
+    {"fsgnj.d", IT_R, NOALU, NOMEM, FSGNJ_D_map, {}, 0x22000053, 0xfe00007f, { .subfield = {3, 12} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMINMAX_map[] = {
+    {"fminmax.s", IT_R, NOALU, NOMEM, FMINMAX_S_map, {}, 0x28000053, 0xfe00007f, { .subfield = {3, 12} }},
+    {"fminmax.d", IT_R, NOALU, NOMEM, FMINMAX_D_map, {}, 0x2a000053, 0xfe00007f, { .subfield = {3, 12} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCMP_map[] = {
+    {"fcmp.s", IT_R, NOALU, NOMEM, FCMP_S_map, {}, 0xa0000053, 0xfe00007f, { .subfield = {3, 12} }},
+    {"fcmp.d", IT_R, NOALU, NOMEM, FCMP_D_map, {}, 0xa2000053, 0xfe00007f, { .subfield = {3, 12} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMV_X_map[] = {
+    {"fmv.x.s", IT_R, NOALU, NOMEM, FMV_X_S_map, {}, 0xe0000053, 0xfff0007f, { .subfield = {3, 12} }},
+    {"fmv.x.d", IT_R, NOALU, NOMEM, FMV_X_D_map, {}, 0xe2000053, 0xfff0007f, { .subfield = {3, 12} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCVT_FMT_map[] = {
+    {"fcvt.s.d", IT_R, FPUOP(CVT_FMT), NOMEM, nullptr, {"D", "S"}, 0x40107053, 0xfff0007f, { .flags = FLAGS_FP_SD_RM }},
+    {"fcvt.d.s", IT_R, FPUOP(CVT_FMT), NOMEM, nullptr, {"D", "S"}, 0x42000053, 0xfff0007f, { .flags = FLAGS_FP_SD | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCVT_X_S_map[] = {
+    {"fcvt.w.s", IT_R, FPUOP(CVT_W), NOMEM, nullptr, {"d", "S"}, 0xc0007053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM }},
+    {"fcvt.wu.s", IT_R, FPUOP(CVT_WU), NOMEM, nullptr, {"d", "S"}, 0xc0107053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM }},
+    {"fcvt.l.s", IT_R, FPUOP(CVT_L), NOMEM, nullptr, {"d", "S"}, 0xc0207053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_RV64 }},
+    {"fcvt.lu.s", IT_R, FPUOP(CVT_LU), NOMEM, nullptr, {"d", "S"}, 0xc0307053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_RV64 }},
+};
+
+static const struct InstructionMap FCVT_X_D_map[] = {
+    {"fcvt.w.d", IT_R, FPUOP(CVT_W), NOMEM, nullptr, {"d", "S"}, 0xc2007053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_FP_DOUBLE }},
+    {"fcvt.wu.d", IT_R, FPUOP(CVT_WU), NOMEM, nullptr, {"d", "S"}, 0xc2107053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_FP_DOUBLE }},
+    {"fcvt.l.d", IT_R, FPUOP(CVT_L), NOMEM, nullptr, {"d", "S"}, 0xc2207053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_FP_DOUBLE | IMF_RV64 }},
+    {"fcvt.lu.d", IT_R, FPUOP(CVT_LU), NOMEM, nullptr, {"d", "S"}, 0xc2307053, 0xfff0007f, { .flags = FLAGS_FP_TO_X | IMF_FP_RM | IMF_FP_DOUBLE | IMF_RV64 }},
+};
+
+static const struct InstructionMap FCVT_F_S_map[] = {
+    {"fcvt.s.w", IT_R, FPUOP(CVT_FROM_W), NOMEM, nullptr, {"D", "s"}, 0xd0007053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM }},
+    {"fcvt.s.wu", IT_R, FPUOP(CVT_FROM_WU), NOMEM, nullptr, {"D", "s"}, 0xd0107053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM }},
+    {"fcvt.s.l", IT_R, FPUOP(CVT_FROM_L), NOMEM, nullptr, {"D", "s"}, 0xd0207053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM | IMF_RV64 }},
+    {"fcvt.s.lu", IT_R, FPUOP(CVT_FROM_LU), NOMEM, nullptr, {"D", "s"}, 0xd0307053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM | IMF_RV64 }},
+};
+
+static const struct InstructionMap FCVT_F_D_map[] = {
+    {"fcvt.d.w", IT_R, FPUOP(CVT_FROM_W), NOMEM, nullptr, {"D", "s"}, 0xd2000053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_DOUBLE }},
+    {"fcvt.d.wu", IT_R, FPUOP(CVT_FROM_WU), NOMEM, nullptr, {"D", "s"}, 0xd2100053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_DOUBLE }},
+    {"fcvt.d.l", IT_R, FPUOP(CVT_FROM_L), NOMEM, nullptr, {"D", "s"}, 0xd2207053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM | IMF_FP_DOUBLE | IMF_RV64 }},
+    {"fcvt.d.lu", IT_R, FPUOP(CVT_FROM_LU), NOMEM, nullptr, {"D", "s"}, 0xd2307053, 0xfff0007f, { .flags = FLAGS_FP_FROM_X | IMF_FP_RM | IMF_FP_DOUBLE | IMF_RV64 }},
+};
+
+static const struct InstructionMap FCVT_X_map[] = {
+    {"fcvt.x.s", IT_R, NOALU, NOMEM, FCVT_X_S_map, {}, 0xc0000053, 0xfe00007f, { .subfield = {2, 20} }},
+    {"fcvt.x.d", IT_R, NOALU, NOMEM, FCVT_X_D_map, {}, 0xc2000053, 0xfe00007f, { .subfield = {2, 20} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FCVT_F_map[] = {
+    {"fcvt.f.s", IT_R, NOALU, NOMEM, FCVT_F_S_map, {}, 0xd0000053, 0xfe00007f, { .subfield = {2, 20} }},
+    {"fcvt.f.d", IT_R, NOALU, NOMEM, FCVT_F_D_map, {}, 0xd2000053, 0xfe00007f, { .subfield = {2, 20} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMV_F_map[] = {
+    {"fmv.w.x", IT_R, FPUOP(MV_F), NOMEM, nullptr, {"D", "s"}, 0xf0000053, 0xfff0707f, { .flags = FLAGS_FP_FROM_X }},
+    {"fmv.d.x", IT_R, FPUOP(MV_F), NOMEM, nullptr, {"D", "s"}, 0xf2000053, 0xfff0707f, { .flags = FLAGS_FP_FROM_X | IMF_FP_DOUBLE | IMF_RV64 }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap OP_FP_map[] = {
+    {"fadd", IT_R, NOALU, NOMEM, FADD_map, {}, 0x00000053, 0xf800007f, { .subfield = {2, 25} }},
+    {"fsub", IT_R, NOALU, NOMEM, FSUB_map, {}, 0x08000053, 0xf800007f, { .subfield = {2, 25} }},
+    {"fmul", IT_R, NOALU, NOMEM, FMUL_map, {}, 0x10000053, 0xf800007f, { .subfield = {2, 25} }},
+    {"fdiv", IT_R, NOALU, NOMEM, FDIV_map, {}, 0x18000053, 0xf800007f, { .subfield = {2, 25} }},
+    {"fsgnj", IT_R, NOALU, NOMEM, FSGNJ_map, {}, 0x20000053, 0xf800007f, { .subfield = {2, 25} }},
+    {"fminmax", IT_R, NOALU, NOMEM, FMINMAX_map, {}, 0x28000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"fcvt-fmt", IT_R, NOALU, NOMEM, FCVT_FMT_map, {}, 0x40000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"fsqrt", IT_R, NOALU, NOMEM, FSQRT_map, {}, 0x58000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"fcmp", IT_R, NOALU, NOMEM, FCMP_map, {}, 0xa0000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"fcvt-x", IT_R, NOALU, NOMEM, FCVT_X_map, {}, 0xc0000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    {"fcvt-f", IT_R, NOALU, NOMEM, FCVT_F_map, {}, 0xd0000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    {"fmv-x", IT_R, NOALU, NOMEM, FMV_X_map, {}, 0xe0000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+    {"fmv-f", IT_R, NOALU, NOMEM, FMV_F_map, {}, 0xf0000053, 0xf800007f, { .subfield = {2, 25} }},
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMADD_map[] = {
+    {"fmadd.s", IT_R, FPUOP(MADD), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x00007043, 0x0600007f, { .flags = FLAGS_FP_FUSED }},
+    {"fmadd.d", IT_R, FPUOP(MADD), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x02007043, 0x0600007f, { .flags = FLAGS_FP_FUSED | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FMSUB_map[] = {
+    {"fmsub.s", IT_R, FPUOP(MSUB), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x00007047, 0x0600007f, { .flags = FLAGS_FP_FUSED }},
+    {"fmsub.d", IT_R, FPUOP(MSUB), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x02007047, 0x0600007f, { .flags = FLAGS_FP_FUSED | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FNMSUB_map[] = {
+    {"fnmsub.s", IT_R, FPUOP(NMSUB), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x0000704b, 0x0600007f, { .flags = FLAGS_FP_FUSED }},
+    {"fnmsub.d", IT_R, FPUOP(NMSUB), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x0200704b, 0x0600007f, { .flags = FLAGS_FP_FUSED | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap FNMADD_map[] = {
+    {"fnmadd.s", IT_R, FPUOP(NMADD), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x0000704f, 0x0600007f, { .flags = FLAGS_FP_FUSED }},
+    {"fnmadd.d", IT_R, FPUOP(NMADD), NOMEM, nullptr, {"D", "S", "T", "R"}, 0x0200704f, 0x0600007f, { .flags = FLAGS_FP_FUSED | IMF_FP_DOUBLE }},
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap SYSTEM_map[] = {
+    IM_UNKNOWN, // ECALL, EBREAK
+    {"csrrw",  IT_I, NOALU, NOMEM, nullptr, {"d", "E", "s"}, 0x00001073, 0x0000707f, { .flags = FLAGS_CSR }}, // CSRRW
+    {"csrrs",  IT_I, NOALU, NOMEM, nullptr, {"d", "E", "s"}, 0x00002073, 0x0000707f, { .flags = FLAGS_CSR }}, // CSRRS
+    {"csrrc",  IT_I, NOALU, NOMEM, nullptr, {"d", "E", "s"}, 0x00003073, 0x0000707f, { .flags = FLAGS_CSR }}, // CSRRC
+    IM_UNKNOWN,
+    {"csrrwi", IT_I, NOALU, NOMEM, nullptr, {"d", "E", "Z"}, 0x00005073, 0x0000707f, { .flags = FLAGS_CSR_I }}, // CSRRWI
+    {"csrrsi", IT_I, NOALU, NOMEM, nullptr, {"d", "E", "Z"}, 0x00006073, 0x0000707f, { .flags = FLAGS_CSR_I }}, // CSRRSI
+    {"csrrci", IT_I, NOALU, NOMEM, nullptr, {"d", "E", "Z"}, 0x00007073, 0x0000707f, { .flags = FLAGS_CSR_I }}, // CSRRCI
+};
+
+constexpr const int FLAGS_BRANCH = IMF_SUPPORTED | IMF_BRANCH | IMF_BJR_REQ_RS | IMF_BJR_REQ_RT;
 static const struct InstructionMap BRANCH_map[] = {
-    {"beq",  IT_B, AluOp::ADD, NOMEM, nullptr, {"s", "t", "p"}, 0x00000063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH | IMF_ALU_MOD }}, // BEQ
-    {"bne",  IT_B, AluOp::ADD, NOMEM, nullptr, {"s", "t", "p"}, 0x00001063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH | IMF_ALU_MOD | IMF_BJ_NOT }}, // BNE
+    {"beq",  IT_B, AluOp::ADD, NOMEM, nullptr, {"s", "t", "p"}, 0x00000063, 0x0000707f, { .flags = FLAGS_BRANCH | IMF_ALU_MOD }}, // BEQ
+    {"bne",  IT_B, AluOp::ADD, NOMEM, nullptr, {"s", "t", "p"}, 0x00001063, 0x0000707f, { .flags = FLAGS_BRANCH | IMF_ALU_MOD | IMF_BJ_NOT }}, // BNE
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"blt",  IT_B, AluOp::SLT, NOMEM, nullptr, {"s", "t", "p"}, 0x00004063, 0x0000707f, { .flags = FLAGS_BRANCH }}, // BLT
+    {"bge",  IT_B, AluOp::SLT, NOMEM, nullptr, {"s", "t", "p"}, 0x00005063, 0x0000707f, { .flags = FLAGS_BRANCH | IMF_BJ_NOT }}, // BGE
+    {"bltu", IT_B, AluOp::SLTU, NOMEM, nullptr, {"s", "t", "p"}, 0x00006063, 0x0000707f, { .flags = FLAGS_BRANCH }}, // BLTU
+    {"bgeu", IT_B, AluOp::SLTU, NOMEM, nullptr, {"s", "t", "p"}, 0x00007063, 0x0000707f, { .flags = FLAGS_BRANCH | IMF_BJ_NOT }}, // BGEU
+};
+
+static const struct InstructionMap AMO_W_map[] = {
+    {"amoadd.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x0000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOADD.W
+    {"amoswap.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x0800202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOSWAP.W
+    {"lr.w", IT_R, AluOp::ADD, AC_LOAD_LINKED, nullptr, {"d", "(s)"}, 0x1000202f, 0xf9f0707f, { .flags = FLAGS_AMO_LOAD }}, // LR.W
+    {"sc.w", IT_R, AluOp::ADD, AC_STORE_CONDITIONAL, nullptr, {"d", "t", "(s)"}, 0x1800202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // SC.W
+    {"amoxor.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x2000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOXOR.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amoor.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x4000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOOR.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amoand.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x6000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOAND.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomin.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x8000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOMIN.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomax.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xa000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOMAX.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amominu.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xc000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOMINU.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomaxu.w", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xe000202f, 0xf800707f, { .flags = FLAGS_AMO_STORE }}, // AMOMAXU.W
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap AMO_D_map[] = {
+    {"amoadd.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x0000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOADD.D
+    {"amoswap.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x0800302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOSWAP.D
+    {"lr.d", IT_R, AluOp::ADD, AC_LOAD_LINKED, nullptr, {"d", "(s)"}, 0x1000302f, 0xf9f0707f, { .flags = FLAGS_AMO_LOAD | IMF_RV64 }}, // LR.D
+    {"sc.d", IT_R, AluOp::ADD, AC_STORE_CONDITIONAL, nullptr, {"d", "t", "(s)"}, 0x1800302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // SC.D
+    {"amoxor.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x2000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOXOR.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amoor.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x4000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOOR.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amoand.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x6000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOAND.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomin.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0x8000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOMIN.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomax.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xa000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOMAX.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amominu.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xc000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOMINU.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amomaxu.d", IT_R, AluOp::ADD, AC_AMO, nullptr, {"d", "t", "(s)"}, 0xe000302f, 0xf800707f, { .flags = FLAGS_AMO_STORE | IMF_RV64 }}, // AMOMAXU.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+};
+
+static const struct InstructionMap AMO_map[] = {
+    IM_UNKNOWN,
+    IM_UNKNOWN,
+    {"amo.w", IT_R, NOALU, NOMEM, AMO_W_map, {}, 0x0000202f, 0x0000707f, { .subfield = {5, 27} }}, // AMO.W
+    {"amo.d", IT_R, NOALU, NOMEM, AMO_D_map, {}, 0x0000302f, 0x0000707f, { .subfield = {5, 27} }}, // AMO.D
+    IM_UNKNOWN,
+    IM_UNKNOWN,
     IM_UNKNOWN,
     IM_UNKNOWN,
-    {"blt",  IT_B, AluOp::SLT, NOMEM, nullptr, {"s", "t", "p"}, 0x00004063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH }}, // BLT
-    {"bge",  IT_B, AluOp::SLT, NOMEM, nullptr, {"s", "t", "p"}, 0x00005063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH | IMF_BJ_NOT }}, // BGE
-    {"bltu", IT_B, AluOp::SLTU, NOMEM, nullptr, {"s", "t", "p"}, 0x00006063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH }}, // BLTU
-    {"bgeu", IT_B, AluOp::SLTU, NOMEM, nullptr, {"s", "t", "p"}, 0x00007063, 0x0000707f, { .flags = IMF_SUPPORTED | IMF_BRANCH | IMF_BJ_NOT }}, // BGEU
 };
 
 static const struct InstructionMap I_inst_map[] = {
     {"load", IT_I, NOALU, NOMEM, LOAD_map, {}, 0x7f, 0x03, { .subfield = {3, 12} }}, // LOAD
-    IM_UNKNOWN, // LOAD-FP
+    {"load-fp", IT_I, NOALU, NOMEM, LOAD_FP_map, {}, 0x7f, 0x07, { .subfield = {3, 12} }}, // LOAD-FP
     IM_UNKNOWN, // custom-0
     IM_UNKNOWN, // MISC-MEM
     {"op-imm", IT_I, NOALU, NOMEM, OP_IMM_map, {}, 0x7f, 0x13, { .subfield = {3, 12} }}, // OP-IMM
-    IM_UNKNOWN, // AUIPC
-    IM_UNKNOWN, // OP-IMM-32
+    {"auipc", IT_U, AluOp::ADD, NOMEM, nullptr, {"d", "u"}, 0x00000017, 0x0000007f, { .flags = FLAGS_ALU_I_NO_RS | IMF_PC_TO_ALU }}, // AUIPC
+    {"op-imm-32", IT_I, NOALU, NOMEM, OP_IMM_32_map, {}, 0x7f, 0x1b, { .subfield = {3, 12} }}, // OP-IMM-32
     IM_UNKNOWN, // 48b
     {"store", IT_I, NOALU, NOMEM, STORE_map, {}, 0x7f, 0x23, { .subfield = {3, 12} }}, // STORE
-    IM_UNKNOWN, // STORE-FP
+    {"store-fp", IT_I, NOALU, NOMEM, STORE_FP_map, {}, 0x7f, 0x27, { .subfield = {3, 12} }}, // STORE-FP
     IM_UNKNOWN, // custom-1
-    IM_UNKNOWN, // AMO
-    {"op", IT_R, NOALU, NOMEM, OP_map, {}, 0x7f, 0x33, { .subfield = {3, 12} }}, // OP
-    IM_UNKNOWN, // LUI
-    IM_UNKNOWN, // OP-32
+    {"amo", IT_R, NOALU, NOMEM, AMO_map, {}, 0x7f, 0x2f, { .subfield = {3, 12} }}, // AMO
+    {"op", IT_R, NOALU, NOMEM, OP_map, {}, 0x7f, 0x33, { .subfield = {1, 25} }}, // OP
+    {"lui", IT_U, AluOp::ADD, NOMEM, nullptr, {"d", "u"}, 0x00000037, 0x0000007f, { .flags = FLAGS_ALU_I_NO_RS }}, // LUI
+    {"op-32", IT_R, NOALU, NOMEM, OP_32_map, {}, 0x7f, 0x3b, { .subfield = {1, 25} }}, // OP-32
     IM_UNKNOWN, // 64b
-    IM_UNKNOWN, // MADD
-    IM_UNKNOWN, // MSUB
-    IM_UNKNOWN, // NMSUB
-    IM_UNKNOWN, // NMADD
-    IM_UNKNOWN, // OP-FP
+    {"madd", IT_R, NOALU, NOMEM, FMADD_map, {}, 0x7f, 0x43, { .subfield = {2, 25} }}, // MADD
+    {"msub", IT_R, NOALU, NOMEM, FMSUB_map, {}, 0x7f, 0x47, { .subfield = {2, 25} }}, // MSUB
+    {"nmsub", IT_R, NOALU, NOMEM, FNMSUB_map, {}, 0x7f, 0x4b, { .subfield = {2, 25} }}, // NMSUB
+    {"nmadd", IT_R, NOALU, NOMEM, FNMADD_map, {}, 0x7f, 0x4f, { .subfield = {2, 25} }}, // NMADD
+    {"op-fp", IT_R, NOALU, NOMEM, OP_FP_map, {}, 0x7f, 0x53, { .subfield = {5, 27} }}, // OP-FP
     IM_UNKNOWN, // reserved
     IM_UNKNOWN, // custom-2/rv128
     IM_UNKNOWN, // 48b
     {"branch", IT_B, NOALU, NOMEM, BRANCH_map, {}, 0x7f, 0x63, { .subfield = {3, 12} }}, // BRANCH
-    IM_UNKNOWN, // JALR
+    {"jalr", IT_I, AluOp::ADD, NOMEM, nullptr, {"d", "o(s)"}, 0x00000067, 0x0000707f, { .flags = FLAGS_J_B_PC_TO_R31 | IMF_JUMP | IMF_BJR_REQ_RS }}, // JALR
     IM_UNKNOWN, // reserved
-    {"jal", IT_J, NOALU, NOMEM, nullptr, {"d", "s", "j"}, 0x0000006f, 0x0000007f, { .flags = FLAGS_J_B_PC_TO_R31 | IMF_JUMP }}, // JAL
-    IM_UNKNOWN, // SYSTEM
+    {"jal", IT_J, AluOp::ADD, NOMEM, nullptr, {"d", "a"}, 0x0000006f, 0x0000007f, { .flags = FLAGS_J_B_PC_TO_R31 | IMF_JUMP }}, // JAL
+    {"system", IT_I, NOALU, NOMEM, SYSTEM_map, {}, 0x7f, 0x73, { .subfield = {3, 12} }}, // SYSTEM
     IM_UNKNOWN, // reserved
     IM_UNKNOWN, // custom-3/rv128
     IM_UNKNOWN, // >= 80b
@@ -297,18 +824,284 @@ static inline const struct InstructionMap &InstructionMapFind(uint32_t code) {
 #undef IMF_SUB_GET_BITS
 #undef IMF_SUB_GET_SHIFT
 
+/*
+ * Expansion of compressed (RVC) instructions to their 32-bit equivalents,
+ * see The RISC-V Instruction Set Manual, chapter "C" Standard Extension.
+ */
+
+// Major opcodes of the expanded instructions
+enum : uint32_t {
+    OPC_LOAD = 0x03,
+    OPC_LOAD_FP = 0x07,
+    OPC_OP_IMM = 0x13,
+    OPC_OP_IMM_32 = 0x1b,
+    OPC_STORE = 0x23,
+    OPC_STORE_FP = 0x27,
+    OPC_OP = 0x33,
+    OPC_LUI = 0x37,
+    OPC_OP_32 = 0x3b,
+    OPC_BRANCH = 0x63,
+    OPC_JALR = 0x67,
+    OPC_JAL = 0x6f,
+    OPC_SYSTEM = 0x73,
+};
+
+static constexpr uint32_t enc_r(
+    uint32_t f7,
+    uint32_t rs2,
+    uint32_t rs1,
+    uint32_t f3,
+    uint32_t rd,
+    uint32_t op) {
+    return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static constexpr uint32_t
+enc_i(int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op) {
+    return (uint32_t(imm) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static constexpr uint32_t
+enc_s(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op) {
+    return ((uint32_t(imm) >> 5 & 0x7f) << 25) | (rs2 << 20) | (rs1 << 15)
+           | (f3 << 12) | ((uint32_t(imm) & 0x1f) << 7) | op;
+}
+
+static constexpr uint32_t
+enc_b(int32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op) {
+    return ((uint32_t(imm) >> 12 & 0x1) << 31)
+           | ((uint32_t(imm) >> 5 & 0x3f) << 25) | (rs2 << 20) | (rs1 << 15)
+           | (f3 << 12) | ((uint32_t(imm) >> 1 & 0xf) << 8)
+           | ((uint32_t(imm) >> 11 & 0x1) << 7) | op;
+}
+
+static constexpr uint32_t enc_j(int32_t imm, uint32_t rd, uint32_t op) {
+    return ((uint32_t(imm) >> 20 & 0x1) << 31)
+           | ((uint32_t(imm) >> 1 & 0x3ff) << 21)
+           | ((uint32_t(imm) >> 11 & 0x1) << 20)
+           | ((uint32_t(imm) >> 12 & 0xff) << 12) | (rd << 7) | op;
+}
+
+/** Sign extend the lowest `bits` bits of the value. */
+static constexpr int32_t sext(uint32_t value, unsigned bits) {
+    return int32_t(value << (32 - bits)) >> (32 - bits);
+}
+
+/**
+ * Expands compressed instruction to the 32-bit instruction performing the
+ * same operation. Reserved and illegal encodings expand to zero, which is
+ * not a valid instruction either.
+ */
+static uint32_t expand_compressed(uint16_t c, Xlen xlen) {
+    // Bits hi..lo of the compressed instruction
+    auto bits = [c](unsigned hi, unsigned lo) -> uint32_t {
+        return (c >> lo) & ((1u << (hi - lo + 1)) - 1);
+    };
+    const bool rv64 = xlen == Xlen::_64;
+    const uint32_t funct3 = bits(15, 13);
+    const uint32_t rd = bits(11, 7);       // Also rs1
+    const uint32_t rs2 = bits(6, 2);
+    const uint32_t rd_p = bits(4, 2) + 8;  // rd' and rs2'
+    const uint32_t rs1_p = bits(9, 7) + 8; // rs1' and rd'
+    // Immediates shared by several formats
+    const int32_t imm6 = sext(bits(12, 12) << 5 | bits(6, 2), 6);
+    const uint32_t uimm_w
+        = bits(5, 5) << 6 | bits(12, 10) << 3 | bits(6, 6) << 2;
+    const uint32_t uimm_d = bits(6, 5) << 6 | bits(12, 10) << 3;
+    const int32_t imm_j = sext(
+        bits(12, 12) << 11 | bits(8, 8) << 10 | bits(10, 9) << 8
+            | bits(6, 6) << 7 | bits(7, 7) << 6 | bits(2, 2) << 5
+            | bits(11, 11) << 4 | bits(5, 3) << 1,
+        12);
+    const int32_t imm_b = sext(
+        bits(12, 12) << 8 | bits(6, 5) << 6 | bits(2, 2) << 5
+            | bits(11, 10) << 3 | bits(4, 3) << 1,
+        9);
+
+    switch (c & 0x3) {
+    case 0x0:
+        switch (funct3) {
+        case 0: { // C.ADDI4SPN
+            const uint32_t nzuimm = bits(10, 7) << 6 | bits(12, 11) << 4
+                                    | bits(5, 5) << 3 | bits(6, 6) << 2;
+            if (nzuimm == 0) {
+                return 0;
+            }
+            return enc_i(nzuimm, 2, 0, rd_p, OPC_OP_IMM);
+        }
+        case 1: // C.FLD
+            return enc_i(uimm_d, rs1_p, 3, rd_p, OPC_LOAD_FP);
+        case 2: // C.LW
+            return enc_i(uimm_w, rs1_p, 2, rd_p, OPC_LOAD);
+        case 3: // C.LD (RV64) or C.FLW (RV32)
+            return rv64 ? enc_i(uimm_d, rs1_p, 3, rd_p, OPC_LOAD)
+                        : enc_i(uimm_w, rs1_p, 2, rd_p, OPC_LOAD_FP);
+        case 5: // C.FSD
+            return enc_s(uimm_d, rd_p, rs1_p, 3, OPC_STORE_FP);
+        case 6: // C.SW
+            return enc_s(uimm_w, rd_p, rs1_p, 2, OPC_STORE);
+        case 7: // C.SD (RV64) or C.FSW (RV32)
+            return rv64 ? enc_s(uimm_d, rd_p, rs1_p, 3, OPC_STORE)
+                        : enc_s(uimm_w, rd_p, rs1_p, 2, OPC_STORE_FP);
+        default: return 0;
+        }
+    case 0x1:
+        switch (funct3) {
+        case 0: // C.ADDI (C.NOP for rd = 0)
+            return enc_i(imm6, rd, 0, rd, OPC_OP_IMM);
+        case 1: // C.ADDIW (RV64) or C.JAL (RV32)
+            if (!rv64) {
+                return enc_j(imm_j, 1, OPC_JAL);
+            }
+            if (rd == 0) {
+                return 0;
+            }
+            return enc_i(imm6, rd, 0, rd, OPC_OP_IMM_32);
+        case 2: // C.LI
+            return enc_i(imm6, 0, 0, rd, OPC_OP_IMM);
+        case 3:
+            if (rd == 2) { // C.ADDI16SP
+                const int32_t nzimm = sext(
+                    bits(12, 12) << 9 | bits(4, 3) << 7 | bits(5, 5) << 6
+                        | bits(2, 2) << 5 | bits(6, 6) << 4,
+                    10);
+                if (nzimm == 0) {
+                    return 0;
+                }
+                return enc_i(nzimm, 2, 0, 2, OPC_OP_IMM);
+            }
+            // C.LUI
+            if (imm6 == 0) {
+                return 0;
+            }
+            return (uint32_t(imm6) << 12) | (rd << 7) | OPC_LUI;
+        case 4: {
+            const uint32_t shamt = bits(12, 12) << 5 | bits(6, 2);
+            switch (bits(11, 10)) {
+            case 0: // C.SRLI
+            case 1: // C.SRAI
+                if (!rv64 && (shamt & 0x20)) {
+                    return 0;
+                }
+                return enc_i(
+                    shamt | (bits(10, 10) << 10), rs1_p, 5, rs1_p, OPC_OP_IMM);
+            case 2: // C.ANDI
+                return enc_i(imm6, rs1_p, 7, rs1_p, OPC_OP_IMM);
+            default: break;
+            }
+            // Register-register operations on rd'/rs1' and rs2'
+            static const uint8_t funct3_op[4] = { 0, 4, 6, 7 };
+            const uint32_t op2 = bits(6, 5);
+            if (!bits(12, 12)) { // C.SUB, C.XOR, C.OR, C.AND
+                return enc_r(
+                    op2 == 0 ? 0x20 : 0, rd_p, rs1_p, funct3_op[op2], rs1_p,
+                    OPC_OP);
+            }
+            if (!rv64 || op2 > 1) {
+                return 0;
+            }
+            // C.SUBW, C.ADDW
+            return enc_r(op2 == 0 ? 0x20 : 0, rd_p, rs1_p, 0, rs1_p, OPC_OP_32);
+        }
+        case 5: // C.J
+            return enc_j(imm_j, 0, OPC_JAL);
+        case 6: // C.BEQZ
+            return enc_b(imm_b, 0, rs1_p, 0, OPC_BRANCH);
+        case 7: // C.BNEZ
+            return enc_b(imm_b, 0, rs1_p, 1, OPC_BRANCH);
+        }
+        break;
+    case 0x2: {
+        const uint32_t uimm_lwsp
+            = bits(3, 2) << 6 | bits(12, 12) << 5 | bits(6, 4) << 2;
+        const uint32_t uimm_ldsp
+            = bits(4, 2) << 6 | bits(12, 12) << 5 | bits(6, 5) << 3;
+        const uint32_t uimm_swsp = bits(8, 7) << 6 | bits(12, 9) << 2;
+        const uint32_t uimm_sdsp = bits(9, 7) << 6 | bits(12, 10) << 3;
+        switch (funct3) {
+        case 0: { // C.SLLI
+            const uint32_t shamt = bits(12, 12) << 5 | bits(6, 2);
+            if (!rv64 && (shamt & 0x20)) {
+                return 0;
+            }
+            return enc_i(shamt, rd, 1, rd, OPC_OP_IMM);
+        }
+        case 1: // C.FLDSP
+            return enc_i(uimm_ldsp, 2, 3, rd, OPC_LOAD_FP);
+        case 2: // C.LWSP
+            if (rd == 0) {
+                return 0;
+            }
+            return enc_i(uimm_lwsp, 2, 2, rd, OPC_LOAD);
+        case 3: // C.LDSP (RV64) or C.FLWSP (RV32)
+            if (!rv64) {
+                return enc_i(uimm_lwsp, 2, 2, rd, OPC_LOAD_FP);
+            }
+            if (rd == 0) {
+                return 0;
+            }
+            return enc_i(uimm_ldsp, 2, 3, rd, OPC_LOAD);
+        case 4:
+            if (!bits(12, 12)) {
+                if (rs2 != 0) { // C.MV
+                    return enc_r(0, rs2, 0, 0, rd, OPC_OP);
+                }
+                if (rd == 0) {
+                    return 0;
+                }
+                return enc_i(0, rd, 0, 0, OPC_JALR); // C.JR
+            }
+            if (rs2 != 0) { // C.ADD
+                return enc_r(0, rs2, rd, 0, rd, OPC_OP);
+            }
+            if (rd == 0) { // C.EBREAK
+                return enc_i(1, 0, 0, 0, OPC_SYSTEM);
+            }
+            return enc_i(0, rd, 0, 1, OPC_JALR); // C.JALR
+        case 5: // C.FSDSP
+            return enc_s(uimm_sdsp, rs2, 2, 3, OPC_STORE_FP);
+        case 6: // C.SWSP
+            return enc_s(uimm_swsp, rs2, 2, 2, OPC_STORE);
+        case 7: // C.SDSP (RV64) or C.FSWSP (RV32)
+            return rv64 ? enc_s(uimm_sdsp, rs2, 2, 3, OPC_STORE)
+                        : enc_s(uimm_swsp, rs2, 2, 2, OPC_STORE_FP);
+        }
+        break;
+    }
+    default: break;
+    }
+    return 0;
+}
+
 const Instruction Instruction::NOP = Instruction(0x00000013);
 
 Instruction::Instruction() {
     this->dt = 0;
+    this->cdt = 0;
 }
 
 Instruction::Instruction(uint32_t inst) {
     this->dt = inst;
+    this->cdt = 0;
 }
 
 Instruction::Instruction(const Instruction &i) {
     this->dt = i.data();
+    this->cdt = i.cdt;
+}
+
+uint8_t Instruction::size() const {
+    return (cdt != 0 || (dt & 0x3) != 0x3) ? 2 : 4;
+}
+
+Instruction Instruction::expanded(Xlen xlen) const {
+    if (cdt != 0 || (dt & 0x3) == 0x3) {
+        return *this;
+    }
+    Instruction inst(expand_compressed(dt, xlen));
+    // Original code determines size of the instruction.
+    inst.cdt = dt;
+    return inst;
 }
 
 #define MASK(LEN, OFF) ((this->dt >> (OFF)) & ((1 << (LEN)) - 1))
@@ -330,6 +1123,14 @@ uint8_t Instruction::rd() const {
     return (uint8_t)MASK(5, 7);
 }
 
+uint8_t Instruction::rs3() const {
+    return (uint8_t)MASK(5, 27);
+}
+
+uint8_t Instruction::rm() const {
+    return (uint8_t)MASK(3, 12);
+}
+
 uint8_t Instruction::shamt() const {
     return this->rt();
 }
@@ -354,7 +1155,7 @@ uint32_t Instruction::immediate() const {
                 | MASK(1, 31) << 12,
             12);
         break;
-    case U: ret = this->dt & ~((1 << 7) - 1); break;
+    case U: ret = this->dt & 0xfffff000; break;
     case J:
         ret = extend(
             MASK(10, 21) << 1 | MASK(1, 20) << 11 | MASK(8, 12) << 12
@@ -430,7 +1231,7 @@ bool Instruction::is_break() const {
 }
 
 bool Instruction::operator==(const Instruction &c) const {
-    return (this->data() == c.data());
+    return (this->data() == c.data()) && (this->cdt == c.cdt);
 }
 
 bool Instruction::operator!=(const Instruction &c) const {
@@ -440,11 +1241,21 @@ bool Instruction::operator!=(const Instruction &c) const {
 Instruction &Instruction::operator=(const Instruction &c) {
     if (this != &c) {
         this->dt = c.data();
+        this->cdt = c.cdt;
     }
     return *this;
 }
 
 QString Instruction::to_str(Address inst_addr) const {
+    if ((dt & 0x3) != 0x3) {
+        // Compressed instruction not yet expanded by decode, RV32
+        // interpretation is shown.
+        const uint32_t code = expand_compressed(dt, Xlen::_32);
+        if (code == 0) {
+            return QString("UNKNOWN");
+        }
+        return Instruction(code).to_str(inst_addr);
+    }
     const InstructionMap &im = InstructionMapFind(dt);
     // TODO there are exception where some fields are zero and such so we should
     // not print them in such case
@@ -456,7 +1267,12 @@ QString Instruction::to_str(Address inst_addr) const {
     }
 
     res += im.name;
-    foreach (const QString &arg, im.args) {
+    QStringList args = im.args;
+    // Rounding mode is shown only when it differs from the default.
+    if ((im.flags & IMF_FP_RM) && (rm() != (uint8_t)FpRounding::DYN)) {
+        args.append("m");
+    }
+    foreach (const QString &arg, args) {
         res += next_delim;
         next_delim = ", ";
         foreach (QChar ao, arg) {
@@ -478,6 +1294,31 @@ QString Instruction::to_str(Address inst_addr) const {
                     res += "x" + QString::number(field);
                 }
                 break;
+            case 'f':
+                if (symbolic_registers_fl) {
+                    res += Rv_fp_regnames[field];
+                } else {
+                    res += "f" + QString::number(field);
+                }
+                break;
+            case 'r':
+                if (rounding_names[field] != nullptr) {
+                    res += rounding_names[field];
+                } else {
+                    res += QString::number(field);
+                }
+                break;
+            case 'c': {
+                const CsrDesc *csr = std::find_if(
+                    std::begin(csr_names), std::end(csr_names),
+                    [field](const CsrDesc &d) { return d.number == field; });
+                if (csr != std::end(csr_names)) {
+                    res += csr->name;
+                } else {
+                    res += "0x" + QString::number(field, 16).toUpper();
+                }
+                break;
+            }
             case 'o':
             case 'n':
                 if (adesc->min < 0) {
@@ -487,335 +1328,417 @@ QString Instruction::to_str(Address inst_addr) const {
                 }
                 break;
             case 'p':
-                field += (inst_addr + 4).get_raw();
-                res += "0x" + QString::number((uint32_t)field, 16).toUpper();
-                break;
-            case 'a':
-                Address target
-                    = (inst_addr & 0xF0000000) | (address() << 2).get_raw();
-                res += " 0x" + QString::number(target.get_raw(), 16).toUpper();
+            case 'a': {
+                // Branch and jump targets are relative to the instruction.
+                Address target = inst_addr + (int64_t)(int32_t)immediate();
+                res += "0x" + QString::number(target.get_raw(), 16).toUpper();
                 break;
             }
+            }
         }
     }
     return res;
 }
 
-QMultiMap<QString, uint32_t> str_to_instruction_code_map;
+namespace {
 
-void instruction_from_string_build_base(
+/**
+ * Entry of the mnemonic table. Mnemonics with more encodings (different
+ * operand templates) have more adjacent entries.
+ */
+struct InstructionNameEntry {
+    const char *name;
+    uint32_t code;
+    /** `InstructionMap::args` converted to Latin1 once. */
+    std::vector<QByteArray> args;
+};
+
+using InstructionNameTable = std::vector<InstructionNameEntry>;
+
+/** Operand text, Latin1 characters terminated by NUL at `end`. */
+struct OperandSpan {
+    const char *begin;
+    const char *end;
+};
+
+} // namespace
+
+/**
+ * @param path_mask  bits of the code selected by subfields on the path,
+ *                   other bits of the code are taken from the map (they hold
+ *                   the default rounding mode)
+ */
+static void instruction_from_string_build_base(
+    InstructionNameTable &table,
     const InstructionMap *im,
     BitArg::Field field,
-    uint32_t base_code) {
+    uint32_t base_code,
+    uint32_t path_mask) {
     uint32_t code;
     uint8_t bits = field.count;
     uint8_t shift = field.offset;
 
+    path_mask |= field.encode(~0u);
     for (unsigned int i = 0; i < 1U << bits; i++, im++) {
         code = base_code | (i << shift);
         if (im->subclass) {
             instruction_from_string_build_base(
-                im->subclass, im->subfield, code);
+                table, im->subclass, im->subfield, code, path_mask);
             continue;
         }
         if (!(im->flags & IMF_SUPPORTED)) {
             continue;
         }
-        if (im->code != code) {
+        if ((im->code ^ code) & path_mask) {
 #if 0
             printf("code mitchmatch %s computed 0x%08x found 0x%08x\n", im->name, code, im->code);
 #endif
             continue;
         }
-        str_to_instruction_code_map.insert(im->name, code);
+        InstructionNameEntry entry { im->name, im->code, {} };
+        for (const QString &arg : im->args) {
+            entry.args.push_back(arg.toLatin1());
+        }
+        if (im->flags & IMF_FP_RM) {
+            // Variant with explicit rounding mode.
+            InstructionNameEntry with_rm = entry;
+            with_rm.args.push_back("m");
+            table.push_back(std::move(entry));
+            table.push_back(std::move(with_rm));
+            continue;
+        }
+        table.push_back(std::move(entry));
     }
-#if 0
-    for (auto i = str_to_instruction_code_map.begin();
-         i != str_to_instruction_code_map.end(); i++)
-        std::cout << i.key().toStdString() << ' ';
-#endif
 }
 
-void instruction_from_string_build_base() {
-    return instruction_from_string_build_base(
-        C_inst_map, instruction_map_opcode_field, 0);
+static bool name_less(const InstructionNameEntry &a, const char *b) {
+    return std::strcmp(a.name, b) < 0;
 }
 
-static int parse_reg_from_string(QString str, uint *chars_taken = nullptr) {
-    int res;
-    int i;
-    uint ctk;
-    if (str.count() < 2 || str.at(0) != 'x') {
+static bool name_less(const char *a, const InstructionNameEntry &b) {
+    return std::strcmp(a, b.name) < 0;
+}
+
+/**
+ * Mnemonic table sorted by name, built from instruction maps on first use.
+ */
+static const InstructionNameTable &instruction_name_table() {
+    static const InstructionNameTable table = []() {
+        InstructionNameTable t;
+        instruction_from_string_build_base(
+            t, C_inst_map, instruction_map_opcode_field, 0, 0);
+        // Stable sort keeps encodings of one mnemonic in map order.
+        std::stable_sort(
+            t.begin(), t.end(),
+            [](const InstructionNameEntry &a, const InstructionNameEntry &b) {
+                return std::strcmp(a.name, b.name) < 0;
+            });
+        return t;
+    }();
+    return table;
+}
+
+static const char *skip_space(const char *p, const char *end) {
+    while (p < end && std::isspace((unsigned char)*p)) {
+        p++;
+    }
+    return p;
+}
+
+static int
+parse_reg_from_string(const char *str, const char *end, uint *chars_taken) {
+    if (end - str < 2 || str[0] != 'x') {
         return -1;
     }
 
-    if (str.at(1).isLetter()) {
-        int k = 1;
-        while (k < str.count()) {
-            if (!str.at(k).isLetterOrNumber()) {
-                break;
-            }
+    if (std::isalpha((unsigned char)str[1])) {
+        const char *k = str + 1;
+        while (k < end && std::isalnum((unsigned char)*k)) {
             k++;
         }
-        str = str.mid(1, k - 1);
-        for (i = 0; i < REGISTER_CODES; i++) {
-            if (str == regbycode[i].name) {
-                if (chars_taken != nullptr) {
-                    *chars_taken = k;
-                }
+        size_t len = k - (str + 1);
+        for (int i = 0; i < REGISTER_CODES; i++) {
+            const char *name = regbycode[i].name;
+            if (std::strncmp(str + 1, name, len) == 0 && name[len] == 0) {
+                *chars_taken = k - str;
                 return regbycode[i].number;
             }
         }
         return -1;
     }
 
-    char cstr[str.count() + 1];
-    for (i = 0; i < str.count(); i++) {
-        cstr[i] = str.at(i).toLatin1();
-    }
-    cstr[i] = 0;
-    const char *p = cstr + 1;
+    const char *p = str + 1;
     char *r;
-    res = std::strtol(p, &r, 0);
-    ctk = r - p + 1;
+    long res = std::strtol(p, &r, 0);
     if (p == r) {
         return -1;
     }
-    if (res > 31) {
+    if (res < 0 || res > 31) {
+        return -1;
+    }
+    *chars_taken = r - str;
+    return (int)res;
+}
+
+/**
+ * Match identifier at the start of the string with a table of names.
+ *
+ * @return  index of the name or -1
+ */
+static int parse_name_from_string(
+    const char *str,
+    const char *end,
+    const char *const *names,
+    int count,
+    uint *chars_taken) {
+    const char *k = str;
+    while (k < end && std::isalnum((unsigned char)*k)) {
+        k++;
+    }
+    size_t len = k - str;
+    if (len == 0) {
         return -1;
     }
-    if (chars_taken != nullptr) {
-        *chars_taken = ctk;
+    for (int i = 0; i < count; i++) {
+        if (names[i] != nullptr && std::strncmp(str, names[i], len) == 0
+            && names[i][len] == 0) {
+            *chars_taken = len;
+            return i;
+        }
     }
-    return res;
+    return -1;
+}
+
+static int
+parse_fp_reg_from_string(const char *str, const char *end, uint *chars_taken) {
+    if (end - str < 2 || str[0] != 'f') {
+        return -1;
+    }
+    if (!std::isdigit((unsigned char)str[1])) {
+        return parse_name_from_string(
+            str, end, Rv_fp_regnames, REGISTER_CODES, chars_taken);
+    }
+    char *r;
+    long res = std::strtol(str + 1, &r, 10);
+    if (res < 0 || res > 31) {
+        return -1;
+    }
+    *chars_taken = r - str;
+    return (int)res;
+}
+
+static int
+parse_csr_from_string(const char *str, const char *end, uint *chars_taken) {
+    if (str < end && std::isdigit((unsigned char)*str)) {
+        char *r;
+        long res = std::strtol(str, &r, 0);
+        *chars_taken = r - str;
+        return (int)res;
+    }
+    for (const CsrDesc &csr : csr_names) {
+        uint taken = 0;
+        if (parse_name_from_string(str, end, &csr.name, 1, &taken) == 0) {
+            *chars_taken = taken;
+            return csr.number;
+        }
+    }
+    return -1;
 }
 
 static void reloc_append(
     RelocExpressionList *reloc,
-    const QString &fl,
+    const char *fl,
+    const char *end,
     Address inst_addr,
     int64_t offset,
     const ArgumentDesc *adesc,
-    uint *chars_taken = nullptr,
+    uint *chars_taken,
     const QString &filename = "",
     int line = 0,
     int options = 0) {
-    QString expression = "";
-    QString allowed_operators = "+-/*|&^~";
-    int i = 0;
-    for (; i < fl.size(); i++) {
-        QChar ch = fl.at(i);
-        if (ch.isSpace()) {
+    static const char allowed_operators[] = "+-/*|&^~";
+    QString expression;
+    const char *p = fl;
+    for (; p < end; p++) {
+        unsigned char ch = *p;
+        if (std::isspace(ch)) {
             continue;
         }
-        if (ch.isLetterOrNumber() || (ch == '_')) {
-            expression.append(ch);
-        } else if (allowed_operators.indexOf(ch) >= 0) {
-            expression.append(ch);
-        } else {
+        if (!std::isalnum(ch) && ch != '_'
+            && std::strchr(allowed_operators, ch) == nullptr) {
             break;
         }
+        expression.append(QLatin1Char(ch));
     }
 
     reloc->append(new RelocExpression(
         inst_addr, expression, offset, adesc->min, adesc->max, &adesc->arg,
         filename, line, options));
-    if (chars_taken != nullptr) {
-        *chars_taken = i;
+    *chars_taken = p - fl;
+}
+
+/**
+ * Parse number at the start of operand. Operand starting by other character
+ * or followed by an operator is left for relocation (when allowed).
+ *
+ * @return  false when the operand has to be relocated
+ */
+static bool parse_number(
+    const char *fl,
+    bool is_signed,
+    bool allow_reloc,
+    uint64_t &val,
+    uint &chars_taken) {
+    if (!std::isdigit((unsigned char)*fl) && allow_reloc) {
+        return false;
+    }
+    char *r;
+    uint64_t num_val
+        = is_signed ? std::strtoll(fl, &r, 0) : std::strtoull(fl, &r, 0);
+    chars_taken = r - fl;
+    while (*r && std::isspace((unsigned char)*r)) {
+        r++;
+    }
+    if (*r && std::strchr("+-/*|&^~", *r)) {
+        return !allow_reloc;
     }
+    val += num_val;
+    return true;
 }
 
 // #define CFS_OPTION_SILENT_MASK 0x100
 
-ssize_t Instruction::code_from_string(
+/**
+ * Encode instruction from mnemonic and operands already split into spans.
+ */
+static ssize_t code_from_operands(
     uint32_t *code,
     size_t buffsize,
-    const QString &inst_base,
-    QStringList &inst_fields,
+    const QStringRef &inst_base,
+    const std::vector<OperandSpan> &inst_fields,
     QString &error,
     Address inst_addr,
     RelocExpressionList *reloc,
     const QString &filename,
     int line,
-    bool pseudo_opt,
     bool silent) {
     const char *err = "unknown instruction";
-    if (str_to_instruction_code_map.isEmpty()) {
-        instruction_from_string_build_base();
+
+    // Mnemonics are plain lowercase ASCII, longer names cannot match.
+    char name[16];
+    if (inst_base.size() >= (int)sizeof(name)) {
+        error = err;
+        return -1;
     }
+    for (int k = 0; k < inst_base.size(); k++) {
+        name[k] = (char)std::tolower((unsigned char)inst_base.at(k).toLatin1());
+    }
+    name[inst_base.size()] = 0;
+
+    const InstructionNameTable &table = instruction_name_table();
+    auto range = std::equal_range(
+        table.begin(), table.end(), (const char *)name,
+        [](const auto &a, const auto &b) { return name_less(a, b); });
 
-    int field = 0;
     uint32_t inst_code = 0;
-    auto i = str_to_instruction_code_map.lowerBound(inst_base);
-    for (;; i++) {
-        if (i == str_to_instruction_code_map.end()) {
-            break;
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        inst_code = entry->code;
+        if (entry->args.size() > inst_fields.size()) {
+            err = "number of arguments does not match";
+            continue;
         }
-        if (i.key() != inst_base) {
-            break;
+        if (entry->args.size() != inst_fields.size()) {
+            continue;
         }
-        inst_code = i.value();
-        const InstructionMap &im = InstructionMapFind(inst_code);
 
-        field = 0;
-        foreach (const QString &arg, im.args) {
-            if (field >= inst_fields.count()) {
-                err = "number of arguments does not match";
-                field = -1;
-                break;
-            }
-            QString fl = inst_fields.at(field++);
-            foreach (QChar ao, arg) {
-                bool need_reloc = false;
-                const char *p;
-                char *r;
-                uint a = ao.toLatin1();
-                if (!a) {
-                    continue;
-                }
-                fl = fl.trimmed();
-                const ArgumentDesc *adesc = argdesbycode[a];
+        bool ok = true;
+        for (size_t field = 0; ok && field < entry->args.size(); field++) {
+            const char *fl = inst_fields[field].begin;
+            const char *end = inst_fields[field].end;
+            for (char a : entry->args[field]) {
+                fl = skip_space(fl, end);
+                const ArgumentDesc *adesc = argdesbycode[(uint)a];
                 if (adesc == nullptr) {
-                    if (!fl.count()) {
+                    if (fl == end) {
                         err = "empty argument encountered";
-                        field = -1;
+                        ok = false;
                         break;
                     }
-                    if (fl.at(0) != ao) {
+                    if (*fl != a) {
                         err = "argument does not match instruction template";
-                        field = -1;
+                        ok = false;
                         break;
                     }
-                    fl = fl.mid(1);
+                    fl++;
                     continue;
                 }
-                // uint bits = IMF_SUB_GET_BITS(adesc->loc);
-                // uint shift = IMF_SUB_GET_SHIFT(adesc->loc);
-                // int shift_right = adesc->shift;
                 uint64_t val = 0;
                 uint chars_taken = 0;
 
-                // if ((adesc->min < 0) && (field & (1 << bits - 1)))
-                //    field -= 1 << bits;
-                // field <<= adesc->shift;
-
                 switch (adesc->kind) {
-                case 'g': val += parse_reg_from_string(fl, &chars_taken); break;
-                case 'p':
-                    val -= (inst_addr + 4).get_raw();
-                    FALLTROUGH // TODO may need to have constant adjusted
-                        case 'o' : case 'n'
-                        : if (fl.at(0).isDigit() || (reloc == nullptr)) {
-                        uint64_t num_val;
-                        int i;
-                        // Qt functions are limited, toLongLong would be usable
-                        // but does not return information how many characters
-                        // are processed. Used solution has horrible overhead
-                        // but is usable for now
-                        char cstr[fl.count() + 1];
-                        for (i = 0; i < fl.count(); i++) {
-                            cstr[i] = fl.at(i).toLatin1();
-                        }
-                        cstr[i] = 0;
-                        p = cstr;
-                        if (adesc->min < 0) {
-                            num_val = std::strtoll(p, &r, 0);
-                        } else {
-                            num_val = std::strtoull(p, &r, 0);
-                        }
-                        while (*r && std::isspace(*r)) {
-                            r++;
-                        }
-                        if (*r && std::strchr("+-/*|&^~", *r)) {
-                            need_reloc = true;
-                        } else {
-                            val += num_val;
-                        }
-                        chars_taken = r - p;
-                    }
-                    else {
-                        need_reloc = true;
-                    }
-                    if (need_reloc && (reloc != nullptr)) {
-                        reloc_append(
-                            reloc, fl, inst_addr, val, adesc, &chars_taken,
-                            filename, line);
-                        val = 0;
-                    }
+                case 'g':
+                    val += parse_reg_from_string(fl, end, &chars_taken);
+                    break;
+                case 'f':
+                    val += parse_fp_reg_from_string(fl, end, &chars_taken);
+                    break;
+                case 'r':
+                    val += parse_name_from_string(
+                        fl, end, rounding_names, 8, &chars_taken);
                     break;
+                case 'c':
+                    val += parse_csr_from_string(fl, end, &chars_taken);
+                    break;
+                case 'p':
                 case 'a':
-                    val -= ((inst_addr + 4) & ~(int64_t)0x0fffffff).get_raw();
-                    if (fl.at(0).isDigit() || (reloc == nullptr)) {
-                        uint64_t num_val;
-                        int i;
-                        char cstr[fl.count() + 1];
-                        for (i = 0; i < fl.count(); i++) {
-                            cstr[i] = fl.at(i).toLatin1();
-                        }
-                        cstr[i] = 0;
-                        p = cstr;
-                        num_val = std::strtoull(p, &r, 0);
-                        while (*r && std::isspace(*r)) {
-                            r++;
-                        }
-                        if (*r && std::strchr("+-/*|&^~", *r)) {
-                            need_reloc = true;
-                        } else {
-                            val += num_val;
-                        }
-                        chars_taken = r - p;
-                    } else {
-                        need_reloc = true;
-                    }
-                    if (need_reloc && (reloc != nullptr)) {
+                    // Branch and jump targets are relative to the instruction.
+                    val -= inst_addr.get_raw();
+                    FALLTROUGH
+                case 'o':
+                case 'n':
+                    if (!parse_number(
+                            fl, adesc->min < 0, reloc != nullptr, val,
+                            chars_taken)) {
                         reloc_append(
-                            reloc, fl, inst_addr, val, adesc, &chars_taken,
-                            filename, line, silent);
+                            reloc, fl, end, inst_addr, val, adesc,
+                            &chars_taken, filename, line);
                         val = 0;
                     }
                     break;
                 }
                 if (chars_taken <= 0) {
                     err = "argument parse error";
-                    field = -1;
+                    ok = false;
                     break;
                 }
-                // if (adesc->min >= 0) {
-                //     val = (val >> shift_right);
-                // } else {
-                //     val = (uint64_t)((int64_t)val >> shift_right);
-                // }
                 if (!silent) {
                     if (adesc->min < 0) {
                         if (((int64_t)val < adesc->min)
                             || ((int64_t)val > adesc->max)) {
                             err = "argument range exceed";
-                            field = -1;
+                            ok = false;
                             break;
                         }
                     } else {
                         if ((val < (uint64_t)adesc->min)
                             || (val > (uint64_t)adesc->max)) {
                             err = "argument range exceed";
-                            field = -1;
+                            ok = false;
                             break;
                         }
                     }
                 }
-                // val = (val & ((1 << bits) - 1)) << shift;
+                // Field may hold default value (rounding mode).
+                inst_code &= ~adesc->arg.encode(~0u);
                 inst_code |= adesc->arg.encode(val);
-                fl = fl.mid(chars_taken);
-            }
-            if (field == -1) {
-                break;
+                fl += chars_taken;
             }
-            if (fl.trimmed() != "") {
+            if (ok && skip_space(fl, end) != end) {
                 err = "excessive characters in argument";
-                field = -1;
-                break;
+                ok = false;
             }
         }
-        if (field != inst_fields.count()) {
+        if (!ok) {
             continue;
         }
 
@@ -825,38 +1748,111 @@ ssize_t Instruction::code_from_string(
         return 4;
     }
 
-    ssize_t ret = -1;
-    inst_code = 0;
-    // if (pseudo_opt) {
-    //     if (((inst_base == "LA") || (inst_base == "LI"))
-    //         && (inst_fields.size() == 2)) {
-    //         if (code_from_string(
-    //                 code, buffsize, "LUI", inst_fields, error, inst_addr,
-    //                 reloc, filename, line, false, CFS_OPTION_SILENT_MASK +
-    //                 16)
-    //             < 0) {
-    //             error = QString("error in LUI element of " + inst_base);
-    //             return -1;
-    //         }
-    //         inst_fields.insert(1, inst_fields.at(0));
-    //         if (code_from_string(
-    //                 code + 1, buffsize - 4, "ORI", inst_fields, error,
-    //                 inst_addr + 4, reloc, filename, line, false,
-    //                 CFS_OPTION_SILENT_MASK + 0)
-    //             < 0) {
-    //             error = QString("error in ORI element of " + inst_base);
-    //             return -1;
-    //         }
-    //         return 8;
-    //     }
-    // }
     if (buffsize >= 4) {
-        *code = inst_code;
+        *code = 0;
     }
-    if (ret < 0) {
-        error = err;
+    error = err;
+    return -1;
+}
+
+/**
+ * Split operands separated by commas in place (commas are replaced by NUL),
+ * surrounding spaces are trimmed.
+ */
+static void
+split_operands(QByteArray &buffer, std::vector<OperandSpan> &fields) {
+    char *p = buffer.data();
+    char *end = p + buffer.size();
+    while (p <= end) {
+        char *sep = p;
+        while (sep < end && *sep != ',' && *sep != 0) {
+            sep++;
+        }
+        *sep = 0;
+        const char *b = skip_space(p, sep);
+        const char *e = sep;
+        while (e > b && std::isspace((unsigned char)e[-1])) {
+            e--;
+        }
+        fields.push_back({ b, e });
+        p = sep + 1;
+    }
+}
+
+/**
+ * Copy operands to one Latin1 buffer, each one terminated by NUL, and
+ * describe them by trimmed spans.
+ */
+template<typename Fields>
+static void fields_to_spans(
+    const Fields &inst_fields,
+    QByteArray &buffer,
+    std::vector<OperandSpan> &fields) {
+    int total = 0;
+    for (const auto &fl : inst_fields) {
+        total += fl.size() + 1;
+    }
+    buffer.reserve(total);
+    for (const auto &fl : inst_fields) {
+        for (QChar ch : fl) {
+            buffer.append(ch.toLatin1());
+        }
+        buffer.append('\0');
+    }
+    fields.reserve(inst_fields.size());
+    const char *p = buffer.constData();
+    for (const auto &fl : inst_fields) {
+        const char *end = p + fl.size();
+        const char *b = skip_space(p, end);
+        const char *e = end;
+        while (e > b && std::isspace((unsigned char)e[-1])) {
+            e--;
+        }
+        fields.push_back({ b, e });
+        p = end + 1;
     }
-    return ret;
+}
+
+ssize_t Instruction::code_from_string(
+    uint32_t *code,
+    size_t buffsize,
+    const QString &inst_base,
+    QStringList &inst_fields,
+    QString &error,
+    Address inst_addr,
+    RelocExpressionList *reloc,
+    const QString &filename,
+    int line,
+    bool pseudo_opt,
+    bool silent) {
+    UNUSED(pseudo_opt)
+    QByteArray buffer;
+    std::vector<OperandSpan> fields;
+    fields_to_spans(inst_fields, buffer, fields);
+    return code_from_operands(
+        code, buffsize, QStringRef(&inst_base), fields, error, inst_addr,
+        reloc, filename, line, silent);
+}
+
+ssize_t Instruction::code_from_string(
+    uint32_t *code,
+    size_t buffsize,
+    const QStringRef &inst_base,
+    const QVector<QStringRef> &inst_fields,
+    QString &error,
+    Address inst_addr,
+    RelocExpressionList *reloc,
+    const QString &filename,
+    int line,
+    bool pseudo_opt,
+    bool silent) {
+    UNUSED(pseudo_opt)
+    QByteArray buffer;
+    std::vector<OperandSpan> fields;
+    fields_to_spans(inst_fields, buffer, fields);
+    return code_from_operands(
+        code, buffsize, inst_base, fields, error, inst_addr, reloc, filename,
+        line, silent);
 }
 
 ssize_t Instruction::code_from_string(
@@ -870,6 +1866,7 @@ ssize_t Instruction::code_from_string(
     int line,
     bool pseudo_opt,
     bool silent) {
+    UNUSED(pseudo_opt)
     int k = 0, l;
     while (k < str.count()) {
         if (!str.at(k).isSpace()) {
@@ -884,21 +1881,20 @@ ssize_t Instruction::code_from_string(
         }
         l++;
     }
-    QString inst_base = str.mid(k, l - k).toLower();
-    str = str.mid(l + 1).trimmed();
-    QStringList inst_fields;
-    if (str.count()) {
-        inst_fields = str.split(",");
-    }
-
-    if (!inst_base.count()) {
+    if (l == k) {
         error = "empty instruction field";
         return -1;
     }
+    QStringRef inst_base = str.midRef(k, l - k);
+    QByteArray buffer = str.midRef(l + 1).trimmed().toLatin1();
+    std::vector<OperandSpan> fields;
+    if (!buffer.isEmpty()) {
+        split_operands(buffer, fields);
+    }
 
-    return code_from_string(
-        code, buffsize, inst_base, inst_fields, error, inst_addr, reloc,
-        filename, line, pseudo_opt, silent);
+    return code_from_operands(
+        code, buffsize, inst_base, fields, error, inst_addr, reloc, filename,
+        line, silent);
 }
 
 bool Instruction::update(int64_t val, RelocExpression *relocexp) {
@@ -928,12 +1924,13 @@ bool Instruction::update(int64_t val, RelocExpression *relocexp) {
 }
 
 void Instruction::append_recognized_instructions(QStringList &list) {
-    if (str_to_instruction_code_map.isEmpty()) {
-        instruction_from_string_build_base();
+    const char *previous = nullptr;
+    for (const InstructionNameEntry &entry : instruction_name_table()) {
+        if (previous == nullptr || std::strcmp(previous, entry.name) != 0) {
+            list.append(entry.name);
+        }
+        previous = entry.name;
     }
-
-    foreach (const QString &str, str_to_instruction_code_map.keys())
-        list.append(str);
 }
 
 void Instruction::set_symbolic_registers(bool enable) {
@@ -953,3 +1950,9 @@ void Instruction::append_recognized_registers(QStringList &list) {
         }
     }
 }
+
+void Instruction::append_recognized_fp_registers(QStringList &list) {
+    for (const char *name : Rv_fp_regnames) {
+        list.append(name);
+    }
+}
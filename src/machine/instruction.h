@@ -26,7 +26,7 @@ enum InstructionFlags {
                                to register file */
     IMF_ZERO_EXTEND = 1L << 6, /**< Immediate operand is zero extended, else
                                   sign */
-    IMF_PC_TO_R31 = 1L << 7,  /**< PC value will be stored to register R31/RA */
+    IMF_PC_TO_R31 = 1L << 7,  /**< Return address (PC + 4) is stored to RD */
     IMF_BJR_REQ_RS = 1L << 8, /**< Branch or jump operation reguires RS value */
     IMF_BJR_REQ_RT = 1L << 9, /**< Branch or jump operation requires RT value */
     IMF_ALU_SHIFT = 1L << 10, /**< Operation is shift of RT by RS or SHAMT */
@@ -51,6 +51,21 @@ enum InstructionFlags {
     IMF_STOP_IF = 1L << 23,    /**< Stop instruction fetch until instruction
                                   processed */
     IMF_ALU_MOD = 1L << 24, /**< ADD and right-shift modifier */
+    IMF_MUL = 1L << 25,     /**< Operation is executed by multiplier (M) */
+    IMF_ALU_WORD = 1L << 26, /**< 32-bit operation sign-extended in RV64 */
+    IMF_RV64 = 1L << 27,     /**< Instruction exists in RV64 only */
+    IMF_PC_TO_ALU = 1L << 28, /**< The first ALU source is instruction PC */
+    IMF_FPU = 1L << 29,       /**< Operation is executed by floating-point
+                                 unit (ALU operation holds FpuOp) */
+    IMF_FP_DOUBLE = 1L << 30, /**< Floating-point operation is double
+                                 precision, else single */
+    IMF_FP_RS = 1ULL << 31,   /**< RS is a floating-point register */
+    IMF_FP_RT = 1ULL << 32,   /**< RT is a floating-point register */
+    IMF_FP_RD = 1ULL << 33,   /**< RD is a floating-point register */
+    IMF_FP_REQ_RS3 = 1ULL << 34, /**< Fused operation requires floating-point
+                                    register RS3 */
+    IMF_FP_RM = 1ULL << 35, /**< Rounding mode is encoded in funct3 */
+    IMF_CSR = 1ULL << 36,   /**< Control and status register access */
 };
 
 struct BitArg {
@@ -77,7 +92,7 @@ struct BitArg {
         size_t offset = 0;
         for (Field field : *this) {
             ret |= field.decode(ins) << offset;
-            offset += field.offset;
+            offset += field.count;
         }
         return ret << shift;
     }
@@ -155,12 +170,21 @@ public:
     uint8_t rs() const;
     uint8_t rt() const;
     uint8_t rd() const;
+    uint8_t rs3() const; // Third source of fused floating-point operations
+    uint8_t rm() const;  // Rounding mode of floating-point operations
     uint8_t shamt() const;
     uint16_t funct() const;
     uint8_t cop0sel() const;
     uint32_t immediate() const;
     Address address() const;
     uint32_t data() const;
+    /** Length of the instruction encoding in bytes (2 for RVC). */
+    uint8_t size() const;
+    /**
+     * 32-bit equivalent of compressed (RVC) instruction, other instructions
+     * are returned unchanged. Reserved encodings expand to illegal zero.
+     */
+    Instruction expanded(Xlen xlen) const;
     bool imm_sign() const;
     enum Type type() const;
     enum InstructionFlags flags() const;
@@ -194,6 +218,22 @@ public:
         bool pseudo_opt = false,
         bool silent = false);
 
+    /**
+     * Variant for operands referenced directly in assembler source line.
+     */
+    static ssize_t code_from_string(
+        uint32_t *code,
+        size_t buffsize,
+        const QStringRef &inst_base,
+        const QVector<QStringRef> &inst_fields,
+        QString &error,
+        Address inst_addr = Address::null(),
+        RelocExpressionList *reloc = nullptr,
+        const QString &filename = "",
+        int line = 0,
+        bool pseudo_opt = false,
+        bool silent = false);
+
     static ssize_t code_from_string(
         uint32_t *code,
         size_t buffsize,
@@ -211,9 +251,12 @@ public:
     static void append_recognized_instructions(QStringList &list);
     static void set_symbolic_registers(bool enable);
     static void append_recognized_registers(QStringList &list);
+    /** ABI names of floating-point registers. */
+    static void append_recognized_fp_registers(QStringList &list);
 
 private:
     uint32_t dt;
+    uint16_t cdt; // Compressed code the instruction was expanded from
     static bool symbolic_registers_fl;
     inline uint32_t extend(uint32_t value, uint32_t used_bits) const;
 };
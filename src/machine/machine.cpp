@@ -2,11 +2,143 @@
 
 #include "programloader.h"
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QTime>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <utility>
 
 using namespace machine;
 
+namespace {
+
+/** How often background run publishes state for visualization. */
+constexpr qint64 SNAPSHOT_PERIOD_MS = 16;
+/** Steps between checks of the snapshot period (keeps clock reads cheap). */
+constexpr unsigned int SNAPSHOT_CHECK_STEPS = 1024;
+
+class BackgroundRunThread : public QThread {
+public:
+    explicit BackgroundRunThread(std::function<void()> body)
+        : body(std::move(body)) {}
+
+protected:
+    void run() override { body(); }
+
+private:
+    std::function<void()> body;
+};
+
+/**
+ * Runs handler shared by harts under the memory system lock, on the thread
+ * coordinating harts running in parallel.
+ */
+class SerializedExceptionHandler : public ExceptionHandler {
+public:
+    using Runner = std::function<void(const std::function<void()> &)>;
+
+    SerializedExceptionHandler(
+        ExceptionHandler *handler,
+        std::recursive_mutex &mutex,
+        Runner runner)
+        : handler(handler)
+        , mutex(mutex)
+        , runner(std::move(runner)) {}
+
+    bool handle_exception(
+        Core *core,
+        Registers *regs,
+        ExceptionCause excause,
+        Address inst_addr,
+        Address next_addr,
+        Address jump_branch_pc,
+        bool in_delay_slot,
+        Address mem_ref_addr) override {
+        bool result = false;
+        std::exception_ptr trap;
+        runner([&]() {
+            std::lock_guard<std::recursive_mutex> guard(mutex);
+            try {
+                result = handler->handle_exception(
+                    core, regs, excause, inst_addr, next_addr, jump_branch_pc,
+                    in_delay_slot, mem_ref_addr);
+            } catch (...) { trap = std::current_exception(); }
+        });
+        if (trap) {
+            std::rethrow_exception(trap);
+        }
+        return result;
+    }
+
+private:
+    ExceptionHandler *const handler;
+    std::recursive_mutex &mutex;
+    const Runner runner;
+};
+
+} // namespace
+
+namespace machine {
+
+/**
+ * Host thread stepping a hart in quantum mode. It waits for the next job
+ * between quanta, so no thread is created per quantum.
+ */
+class HartThread : public QThread {
+public:
+    ~HartThread() override {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            quit = true;
+        }
+        cond.notify_all();
+        wait();
+    }
+
+    /** Run the job on the thread, previous job has to be finished. */
+    void start_job(std::function<void()> new_job) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            job = std::move(new_job);
+        }
+        cond.notify_all();
+    }
+
+    /** Block until the last started job is finished. */
+    void wait_job() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this]() { return !job; });
+    }
+
+protected:
+    void run() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cond.wait(lock, [this]() { return job || quit; });
+            if (quit) {
+                return;
+            }
+            lock.unlock();
+            job();
+            lock.lock();
+            job = nullptr;
+            cond.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::function<void()> job;
+    bool quit = false;
+};
+
+} // namespace machine
+
 Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
     : machine_config(std::move(config))
     , stat(ST_READY) {
@@ -15,6 +147,8 @@ Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
     if (load_executable) {
         ProgramLoader program(machine_config.elf());
         this->machine_config.set_simulated_endian(program.get_endian());
+        this->machine_config.set_simulated_xlen(
+            program.get_architecture_type() == ARCH64 ? Xlen::_64 : Xlen::_32);
         mem_program_only = new Memory(machine_config.get_simulated_endian());
         program.to_memory(mem_program_only);
 
@@ -33,21 +167,17 @@ Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
     data_bus = new MemoryDataBus(machine_config.get_simulated_endian());
     data_bus->insert_device_to_range(
         mem, 0x00000000_addr, 0xefffffff_addr, false);
+    if (machine_config.get_simulated_xlen() == Xlen::_64) {
+        // Peripherals stay in the top of 32-bit space, RAM continues above.
+        data_bus->insert_device_to_range(
+            mem, 0x100000000_addr, 0xffffffffffffffff_addr, false,
+            0x100000000);
+    }
 
     setup_serial_port();
     setup_perip_spi_led();
     setup_lcd_display();
-
-    cch_program = new Cache(
-        data_bus, &machine_config.cache_program(),
-        machine_config.memory_access_time_read(),
-        machine_config.memory_access_time_write(),
-        machine_config.memory_access_time_burst());
-    cch_data = new Cache(
-        data_bus, &machine_config.cache_data(),
-        machine_config.memory_access_time_read(),
-        machine_config.memory_access_time_write(),
-        machine_config.memory_access_time_burst());
+    setup_dma();
 
     unsigned int min_cache_row_size = 16;
     if (machine_config.cache_data().enabled()) {
@@ -59,23 +189,88 @@ Machine::Machine(MachineConfig config, bool load_symtab, bool load_executable)
         min_cache_row_size = machine_config.cache_program().block_size() * 4;
     }
 
-    cop0st = new Cop0State();
-
-    if (machine_config.pipelined()) {
-        cr = new CorePipelined(
-            regs, cch_program, cch_data, machine_config.hazard_unit(),
-            min_cache_row_size, cop0st);
-    } else {
-        cr = new CoreSingle(regs, cch_program, cch_data, min_cache_row_size, cop0st);
+    if (machine_config.hart_count() > 1) {
+        coherence = new CoherenceBus();
     }
+    for (unsigned i = 0; i < machine_config.hart_count(); i++) {
+        Hart hart {};
+        // All harts start from the same (entry) state.
+        hart.regs = i == 0 ? regs : new Registers(*regs);
+        hart.cch_program = new Cache(
+            data_bus, &machine_config.cache_program(),
+            machine_config.memory_access_time_read(),
+            machine_config.memory_access_time_write(),
+            machine_config.memory_access_time_burst());
+        hart.cch_data = new Cache(
+            data_bus, &machine_config.cache_data(),
+            machine_config.memory_access_time_read(),
+            machine_config.memory_access_time_write(),
+            machine_config.memory_access_time_burst());
+        if (coherence != nullptr) {
+            hart.cch_program->set_coherence(coherence);
+            hart.cch_data->set_coherence(coherence);
+        }
+        hart.cop0st = new Cop0State();
+        if (machine_config.out_of_order().enabled()) {
+            auto *core = new CoreOutOfOrder(
+                hart.regs, hart.cch_program, hart.cch_data,
+                machine_config.out_of_order(), machine_config.issue_alu_ports(),
+                machine_config.issue_mul_ports(),
+                machine_config.issue_mem_ports(),
+                machine_config.branch_predictor(), min_cache_row_size,
+                hart.cop0st, machine_config.get_simulated_xlen());
+            core->set_program_end(program_end);
+            hart.cr = core;
+        } else if (machine_config.issue_width() > 1) {
+            auto *core = new CoreSuperscalar(
+                hart.regs, hart.cch_program, hart.cch_data,
+                machine_config.issue_width(), machine_config.issue_alu_ports(),
+                machine_config.issue_mul_ports(),
+                machine_config.issue_mem_ports(), min_cache_row_size,
+                hart.cop0st, machine_config.get_simulated_xlen());
+            core->set_program_end(program_end);
+            hart.cr = core;
+        } else if (machine_config.pipelined()) {
+            hart.cr = new CorePipelined(
+                hart.regs, hart.cch_program, hart.cch_data,
+                machine_config.hazard_unit(), min_cache_row_size, hart.cop0st,
+                machine_config.get_simulated_xlen(),
+                machine_config.branch_predictor());
+        } else {
+            hart.cr = new CoreSingle(
+                hart.regs, hart.cch_program, hart.cch_data, min_cache_row_size,
+                hart.cop0st, machine_config.get_simulated_xlen());
+        }
+        hart.cr->set_hart_id(i);
+        if (i != 0) {
+            // Stop of any hart is reported as stop of the machine.
+            connect(
+                hart.cr, &Core::stop_on_exception_reached, this,
+                [this]() { emit cr->stop_on_exception_reached(); },
+                Qt::DirectConnection);
+        }
+        harts.push_back(hart);
+    }
+    cch_program = harts[0].cch_program;
+    cch_data = harts[0].cch_data;
+    cop0st = harts[0].cop0st;
+    cr = harts[0].cr;
+    // Direct connection, interrupts are raised from the simulation thread
+    // during background run (and from hart threads in quantum mode).
     connect(
-        this, &Machine::set_interrupt_signal, cop0st,
-        &Cop0State::set_interrupt_signal);
+        this, &Machine::set_interrupt_signal, this,
+        &Machine::deliver_interrupt, Qt::DirectConnection);
 
     run_t = new QTimer(this);
     set_speed(0); // In default run as fast as possible
     connect(run_t, &QTimer::timeout, this, &Machine::step_timer);
 
+    snapshot_t = new QTimer(this);
+    snapshot_t->setInterval(SNAPSHOT_PERIOD_MS);
+    connect(snapshot_t, &QTimer::timeout, this, &Machine::snapshot_timer);
+    // Peripherals signal the GUI from simulation thread during background run.
+    qRegisterMetaType<size_t>("size_t");
+
     for (int i = 0; i < EXCAUSE_COUNT; i++) {
         if (i != EXCAUSE_INT && i != EXCAUSE_BREAK && i != EXCAUSE_HWBREAK) {
             set_stop_on_exception(
@@ -93,35 +288,63 @@ void Machine::setup_lcd_display() {
     memory_bus_insert_range(
         perip_lcd_display, 0xffe00000_addr, 0xffe4afff_addr, true);
 }
+void Machine::setup_dma() {
+    perip_dma = new DmaController(
+        machine_config.get_simulated_endian(), data_bus, &events,
+        machine_config.memory_access_time_read(),
+        machine_config.memory_access_time_write(),
+        machine_config.memory_access_time_burst());
+    memory_bus_insert_range(perip_dma, 0xffffc200_addr, 0xffffc21f_addr, true);
+    connect(
+        perip_dma, &DmaController::signal_interrupt, this,
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
+}
 void Machine::setup_perip_spi_led() {
     perip_spi_led = new PeripSpiLed(machine_config.get_simulated_endian());
     memory_bus_insert_range(
         perip_spi_led, 0xffffc100_addr, 0xffffc1ff_addr, true);
 }
 void Machine::setup_serial_port() {
-    ser_port = new SerialPort(machine_config.get_simulated_endian());
+    ser_port = new SerialPort(
+        machine_config.get_simulated_endian(),
+        machine_config.serial_tx_fifo_size(),
+        machine_config.serial_rx_fifo_size());
+    ser_port->set_char_timing(&events, machine_config.serial_cycles_per_char());
     memory_bus_insert_range(ser_port, 0xffffc000_addr, 0xffffc03f_addr, true);
     memory_bus_insert_range(ser_port, 0xffff0000_addr, 0xffff003f_addr, false);
     connect(
         ser_port, &SerialPort::signal_interrupt, this,
-        &Machine::set_interrupt_signal);
+        &Machine::set_interrupt_signal, Qt::DirectConnection);
 }
 
 Machine::~Machine() {
+    if (sim_thread != nullptr) {
+        join_background_run();
+    }
+    hart_threads.clear();
+    delete snapshot_t;
+    snapshot_t = nullptr;
     delete run_t;
     run_t = nullptr;
-    delete cr;
+    for (Hart &hart : harts) {
+        delete hart.cr;
+        delete hart.cop0st;
+        delete hart.regs;
+    }
     cr = nullptr;
-    delete cop0st;
     cop0st = nullptr;
-    delete regs;
     regs = nullptr;
     delete mem;
     mem = nullptr;
-    delete cch_program;
+    for (Hart &hart : harts) {
+        delete hart.cch_program;
+        delete hart.cch_data;
+    }
+    harts.clear();
     cch_program = nullptr;
-    delete cch_data;
     cch_data = nullptr;
+    delete coherence;
+    coherence = nullptr;
     delete data_bus;
     data_bus = nullptr;
     delete mem_program_only;
@@ -139,6 +362,34 @@ void Machine::set_speed(unsigned int ips, unsigned int time_chunk) {
     run_t->setInterval(ips);
 }
 
+void Machine::set_background_run(bool enable) {
+    if (enable == background_run_enabled) {
+        return;
+    }
+    background_run_enabled = enable;
+    if (stat != ST_RUNNING) {
+        return;
+    }
+    // Switch running machine between the two modes.
+    if (enable) {
+        run_t->stop();
+        start_background_run();
+    } else if (suspend_background_run()) {
+        run_t->start();
+    }
+}
+
+bool Machine::background_running() const {
+    return sim_thread != nullptr;
+}
+
+void Machine::set_snapshot_window(
+    enum SnapshotWindowId id,
+    const SnapshotWindowRequest &request) {
+    std::lock_guard<std::mutex> guard(window_mutex);
+    window_requests.at(id) = request;
+}
+
 const Registers *Machine::registers() {
     return regs;
 }
@@ -168,11 +419,9 @@ Cache *Machine::cache_data_rw() {
 }
 
 void Machine::cache_sync() {
-    if (cch_program != nullptr) {
-        cch_program->sync();
-    }
-    if (cch_data != nullptr) {
-        cch_data->sync();
+    for (Hart &hart : harts) {
+        hart.cch_program->sync();
+        hart.cch_data->sync();
     }
 }
 
@@ -196,6 +445,14 @@ LcdDisplay *Machine::peripheral_lcd_display() {
     return perip_lcd_display;
 }
 
+DmaController *Machine::peripheral_dma() {
+    return perip_dma;
+}
+
+EventQueue *Machine::event_queue() {
+    return &events;
+}
+
 SymbolTable *Machine::symbol_table_rw(bool create) {
     if (create && (symtab == nullptr)) {
         symtab = new SymbolTable;
@@ -224,11 +481,43 @@ const Core *Machine::core() {
 }
 
 const CoreSingle *Machine::core_singe() {
-    return machine_config.pipelined() ? nullptr : (const CoreSingle *)cr;
+    return dynamic_cast<const CoreSingle *>(cr);
 }
 
 const CorePipelined *Machine::core_pipelined() {
-    return machine_config.pipelined() ? (const CorePipelined *)cr : nullptr;
+    return dynamic_cast<const CorePipelined *>(cr);
+}
+
+const CoreSuperscalar *Machine::core_superscalar() {
+    return dynamic_cast<const CoreSuperscalar *>(cr);
+}
+
+const CoreOutOfOrder *Machine::core_out_of_order() {
+    return dynamic_cast<const CoreOutOfOrder *>(cr);
+}
+
+unsigned Machine::hart_count() const {
+    return harts.size();
+}
+
+const Registers *Machine::hart_registers(unsigned hart) {
+    return harts.at(hart).regs;
+}
+
+const Core *Machine::hart_core(unsigned hart) {
+    return harts.at(hart).cr;
+}
+
+const Cache *Machine::hart_cache_program(unsigned hart) {
+    return harts.at(hart).cch_program;
+}
+
+const Cache *Machine::hart_cache_data(unsigned hart) {
+    return harts.at(hart).cch_data;
+}
+
+const CoherenceBus *Machine::coherence_bus() {
+    return coherence;
 }
 
 bool Machine::executable_loaded() const {
@@ -253,48 +542,214 @@ bool Machine::exited() {
 
 void Machine::play() {
     CTL_GUARD;
+    if (sim_thread != nullptr) {
+        return;
+    }
     set_status(ST_RUNNING);
+    if (background_run_enabled) {
+        start_background_run();
+        return;
+    }
     run_t->start();
     step_internal(true);
 }
 
 void Machine::pause() {
+    if (sim_thread != nullptr) {
+        join_background_run();
+        conclude_background_run();
+        return;
+    }
     if (stat != ST_BUSY) {
         CTL_GUARD;
     }
     set_status(ST_READY);
     run_t->stop();
+    ser_port->flush_tx(true);
 }
 
 void Machine::step_internal(bool skip_break) {
     CTL_GUARD;
+    if (sim_thread != nullptr) {
+        return;
+    }
     enum Status stat_prev = stat;
     set_status(ST_BUSY);
     emit tick();
     try {
         QTime start_time = QTime::currentTime();
         do {
-            cr->step(skip_break);
+            step_harts(skip_break);
         } while (time_chunk != 0 && stat == ST_BUSY && !skip_break
                  && start_time.msecsTo(QTime::currentTime()) < (int)time_chunk);
     } catch (SimulatorException &e) {
         run_t->stop();
         set_status(ST_TRAPPED);
+        flush_memory_changes(true);
         emit program_trap(e);
         return;
     }
-    if (regs->read_pc() >= program_end) {
+    if (program_exited()) {
         run_t->stop();
         set_status(ST_EXIT);
+        flush_memory_changes(true);
         emit program_exit();
     } else {
         if (stat == ST_BUSY) {
             set_status(stat_prev);
         }
+        // Output may be batched only while running continuously.
+        flush_memory_changes(stat != ST_RUNNING);
     }
     emit post_tick();
 }
 
+void Machine::step_harts(bool skip_break) {
+    if (harts.size() > 1 && machine_config.hart_quantum() != 0) {
+        step_harts_quantum(skip_break);
+        return;
+    }
+    events.tick();
+    for (Hart &hart : harts) {
+        if (hart_running(hart)) {
+            hart.cr->step(skip_break);
+        }
+    }
+}
+
+void Machine::step_harts_quantum(bool skip_break) {
+    const unsigned quantum = machine_config.hart_quantum();
+    // Visualization is not thread safe, state is refreshed after the quantum.
+    const bool block_signals = !cr->signalsBlocked();
+    if (block_signals) {
+        block_simulation_signals(true);
+    }
+    std::vector<std::exception_ptr> traps(harts.size());
+    while (hart_threads.size() < harts.size()) {
+        hart_threads.emplace_back(new HartThread());
+        hart_threads.back()->start();
+    }
+    // Host input is pulled here, harts must not call the GUI.
+    ser_port->hold_rx(true);
+    {
+        std::lock_guard<std::mutex> guard(interrupt_mutex);
+        harts_parallel = true;
+    }
+    {
+        std::lock_guard<std::mutex> guard(coordinator_mutex);
+        for (Hart &hart : harts) {
+            hart.cr->state.exception_stop_pending = false;
+            if (hart_running(hart)) {
+                harts_running++;
+            }
+        }
+    }
+    for (size_t i = 0; i < harts.size(); i++) {
+        Hart &hart = harts[i];
+        std::exception_ptr &trap = traps[i];
+        if (!hart_running(hart)) {
+            continue;
+        }
+        hart_threads[i]->start_job([&, this]() {
+            try {
+                bool skip = skip_break;
+                for (unsigned n = 0; n < quantum; n++) {
+                    hart.cr->step(skip);
+                    skip = false;
+                    if (!hart_running(hart)
+                        || hart.cr->state.exception_stop_pending) {
+                        break;
+                    }
+                }
+            } catch (...) { trap = std::current_exception(); }
+            std::lock_guard<std::mutex> guard(coordinator_mutex);
+            harts_running--;
+            coordinator_cond.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(coordinator_mutex);
+        while (true) {
+            coordinator_cond.wait(lock, [this]() {
+                return harts_running == 0 || coordinator_call != nullptr;
+            });
+            if (coordinator_call == nullptr) {
+                break;
+            }
+            lock.unlock();
+            (*coordinator_call)();
+            lock.lock();
+            coordinator_call = nullptr;
+            coordinator_cond.notify_all();
+        }
+    }
+    for (auto &thread : hart_threads) {
+        thread->wait_job();
+    }
+    ser_port->hold_rx(false);
+    std::vector<std::pair<uint, bool>> interrupts;
+    {
+        std::lock_guard<std::mutex> guard(interrupt_mutex);
+        harts_parallel = false;
+        interrupts.swap(pending_interrupts);
+    }
+    for (const auto &irq : interrupts) {
+        cop0st->set_interrupt_signal(irq.first, irq.second);
+    }
+    if (block_signals) {
+        block_simulation_signals(false);
+        if (exception_stop_pending()) {
+            emit cr->stop_on_exception_reached();
+        }
+    }
+    for (unsigned n = 0; n < quantum; n++) {
+        events.tick();
+    }
+    for (auto &trap : traps) {
+        if (trap) {
+            std::rethrow_exception(trap);
+        }
+    }
+}
+
+void Machine::run_on_coordinator(const std::function<void()> &call) {
+    std::unique_lock<std::mutex> lock(coordinator_mutex);
+    if (harts_running == 0) {
+        // Not in parallel quantum, caller is the coordinating thread.
+        lock.unlock();
+        call();
+        return;
+    }
+    coordinator_cond.wait(
+        lock, [this]() { return coordinator_call == nullptr; });
+    coordinator_call = &call;
+    coordinator_cond.notify_all();
+    coordinator_cond.wait(
+        lock, [this, &call]() { return coordinator_call != &call; });
+}
+
+bool Machine::hart_running(const Hart &hart) const {
+    return hart.regs->read_pc() < program_end || hart.cr->busy();
+}
+
+bool Machine::program_exited() const {
+    for (const Hart &hart : harts) {
+        if (hart_running(hart)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Machine::exception_stop_pending() const {
+    for (const Hart &hart : harts) {
+        if (hart.cr->state.exception_stop_pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void Machine::step() {
     step_internal(true);
 }
@@ -305,14 +760,304 @@ void Machine::step_timer() {
 
 void Machine::restart() {
     pause();
-    regs->reset();
+    for (Hart &hart : harts) {
+        hart.regs->reset();
+    }
     if (mem_program_only != nullptr) {
         mem->reset(*mem_program_only);
     }
-    cch_program->reset();
-    cch_data->reset();
-    cr->reset();
+    for (Hart &hart : harts) {
+        hart.cch_program->reset();
+        hart.cch_data->reset();
+    }
+    if (coherence != nullptr) {
+        coherence->reset_stats();
+    }
+    data_bus->clear_reservations();
+    perip_dma->reset();
+    ser_port->reset();
+    // Drop events scheduled by previous run (DMA transfers, serial TX).
+    events.reset();
+    for (Hart &hart : harts) {
+        hart.cr->reset();
+    }
     set_status(ST_READY);
+    flush_memory_changes(true);
+}
+
+void Machine::flush_memory_changes(bool final) {
+    data_bus->flush_changed_range();
+    for (Hart &hart : harts) {
+        hart.cch_program->flush_changed_range();
+        hart.cch_data->flush_changed_range();
+    }
+    perip_lcd_display->flush_dirty_region(true);
+    ser_port->flush_tx(final);
+}
+
+void Machine::start_background_run() {
+    bg_stop_request = false;
+    bg_end = BG_STOPPED;
+    bg_trap.reset();
+    for (Hart &hart : harts) {
+        hart.cr->state.exception_stop_pending = false;
+    }
+    for (auto &range : bg_carry) {
+        range = {};
+    }
+    bg_lcd_carry = {};
+    snapshots.reset();
+    flush_memory_changes();
+    emit tick();
+
+    block_simulation_signals(true);
+    sim_thread = new BackgroundRunThread([this]() { background_run(); });
+    connect(
+        sim_thread, &QThread::finished, this,
+        &Machine::background_run_finished);
+    // Serial port input is checked from GUI (terminal) thread. Let the
+    // simulation thread process those requests between steps instead.
+    ser_port->moveToThread(sim_thread);
+    sim_thread->start();
+    snapshot_t->start();
+}
+
+void Machine::join_background_run() {
+    bg_joining = true;
+    bg_stop_request = true;
+    // Simulation thread can wait for GUI thread (e.g., terminal input),
+    // keep the events flowing.
+    while (!sim_thread->wait(10)) {
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+    snapshot_t->stop();
+    delete sim_thread;
+    sim_thread = nullptr;
+    bg_joining = false;
+
+    block_simulation_signals(false);
+    if (snapshots.update()) {
+        apply_snapshot(snapshots.read_buffer());
+    }
+    cch_program->refresh_statistics();
+    cch_data->refresh_statistics();
+}
+
+void Machine::conclude_background_run() {
+    switch (bg_end) {
+    case BG_TRAPPED:
+        set_status(ST_TRAPPED);
+        emit program_trap(*bg_trap);
+        break;
+    case BG_EXITED:
+        set_status(ST_EXIT);
+        emit program_exit();
+        break;
+    case BG_STOPPED:
+    case BG_EXCEPTION_STOP: set_status(ST_READY); break;
+    }
+}
+
+bool Machine::suspend_background_run() {
+    if (sim_thread == nullptr) {
+        return false;
+    }
+    join_background_run();
+    if (bg_end != BG_STOPPED) {
+        conclude_background_run();
+        return false;
+    }
+    return true;
+}
+
+void Machine::resume_background_run() {
+    start_background_run();
+}
+
+void Machine::background_run() {
+    QElapsedTimer since_snapshot;
+    since_snapshot.start();
+    unsigned int steps = 0;
+    bool skip_break = true;
+    try {
+        while (!bg_stop_request.load(std::memory_order_relaxed)) {
+            step_harts(skip_break);
+            skip_break = false;
+            if (program_exited()) {
+                bg_end = BG_EXITED;
+                break;
+            }
+            if (exception_stop_pending()) {
+                bg_end = BG_EXCEPTION_STOP;
+                break;
+            }
+            if (++steps % SNAPSHOT_CHECK_STEPS == 0
+                && since_snapshot.elapsed() >= SNAPSHOT_PERIOD_MS) {
+                QCoreApplication::sendPostedEvents();
+                publish_snapshot();
+                since_snapshot.restart();
+            }
+        }
+    } catch (SimulatorException &e) {
+        bg_trap.reset(new SimulatorException(e));
+        bg_end = BG_TRAPPED;
+    }
+    QCoreApplication::sendPostedEvents();
+    ser_port->moveToThread(thread());
+    publish_snapshot();
+}
+
+void Machine::publish_snapshot() {
+    MachineSnapshot &snapshot = snapshots.write_buffer();
+    snapshot.pc = regs->read_pc();
+    for (size_t i = 1; i < REGISTER_COUNT; i++) {
+        snapshot.gp[i] = regs->peek_gp(i);
+    }
+    for (size_t i = 0; i < REGISTER_COUNT; i++) {
+        snapshot.fp[i] = regs->peek_fp(i);
+    }
+    snapshot.fcsr = regs->read_fcsr();
+    snapshot.hi = regs->read_hi_lo(true);
+    snapshot.lo = regs->read_hi_lo(false);
+    snapshot.cycle_count = cr->get_cycle_count();
+    snapshot.stall_count = cr->get_stall_count();
+    for (int i = 1; i < Cop0State::COP0REGS_CNT; i++) {
+        snapshot.cop0[i] = cop0st->peek_cop0reg((Cop0State::Cop0Registers)i);
+    }
+    const Pipeline &pipeline = cr->state.pipeline;
+    snapshot.fetch_addr = pipeline.fetch.result.inst_addr;
+    snapshot.decode_addr = pipeline.decode.result.inst_addr;
+    snapshot.execute_addr = pipeline.execute.result.inst_addr;
+    snapshot.memory_addr = pipeline.memory.result.inst_addr;
+    snapshot.writeback_addr = pipeline.writeback.internal.inst_addr;
+
+    ChangedRange *ranges[3] = { &snapshot.data_bus_range,
+                                &snapshot.cache_program_range,
+                                &snapshot.cache_data_range };
+    const FrontendMemory *memories[3] = { data_bus, cch_program, cch_data };
+    // Previous snapshot is dropped by publish if it was not consumed yet,
+    // its ranges must not get lost.
+    bool resend = !snapshots.consumed();
+    for (size_t i = 0; i < 3; i++) {
+        ChangedRange &range = *ranges[i];
+        range = {};
+        range.valid = memories[i]->take_changed_range(range.start, range.last);
+        if (resend) {
+            range.merge(bg_carry[i]);
+        }
+        bg_carry[i] = range;
+    }
+    for (int i = 0; i < SW_COUNT; i++) {
+        read_snapshot_window((SnapshotWindowId)i, snapshot.windows[i]);
+    }
+    // Pixels are copied from the current framebuffer, region of the dropped
+    // snapshot is just merged.
+    LcdRegion &lcd = snapshot.lcd_region;
+    lcd.valid = perip_lcd_display->take_dirty_region(
+        lcd.x, lcd.y, lcd.width, lcd.height);
+    if (resend) {
+        lcd.merge(bg_lcd_carry);
+    }
+    bg_lcd_carry = {};
+    bg_lcd_carry.merge(lcd);
+    lcd.pixels.resize(lcd.valid ? 2 * lcd.width * lcd.height : 0);
+    if (lcd.valid) {
+        const byte *fb_data = perip_lcd_display->get_fb_data();
+        const size_t line_size = perip_lcd_display->get_fb_line_size();
+        for (size_t row = 0; row < lcd.height; row++) {
+            memcpy(
+                &lcd.pixels[2 * lcd.width * row],
+                fb_data + (lcd.y + row) * line_size + 2 * lcd.x,
+                2 * lcd.width);
+        }
+    }
+    snapshots.publish();
+    ser_port->flush_tx(true);
+}
+
+void Machine::read_snapshot_window(
+    enum SnapshotWindowId id,
+    SnapshotWindow &window) {
+    {
+        std::lock_guard<std::mutex> guard(window_mutex);
+        window.request = window_requests.at(id);
+    }
+    const SnapshotWindowRequest &request = window.request;
+    const FrontendMemory *mem = data_bus;
+    if (request.through_cache) {
+        mem = cch_data;
+    }
+    const Cache *status_cache = (id == SW_PROGRAM) ? cch_program : cch_data;
+    window.data.resize(request.cells);
+    window.loc_stat.resize(request.cells);
+    Address address = request.start;
+    for (unsigned i = 0; i < request.cells; i++) {
+        switch (request.cell_bytes) {
+        case 1: window.data[i] = mem->read_u8(address, ae::INTERNAL); break;
+        case 2: window.data[i] = mem->read_u16(address, ae::INTERNAL); break;
+        default: window.data[i] = mem->read_u32(address, ae::INTERNAL); break;
+        }
+        window.loc_stat[i] = status_cache->location_status(address);
+        address += request.cell_bytes;
+    }
+}
+
+void Machine::apply_snapshot(const MachineSnapshot &snapshot) {
+    emit tick();
+    if (snapshot.data_bus_range.valid) {
+        data_bus->notify_changed_range(
+            snapshot.data_bus_range.start, snapshot.data_bus_range.last);
+    }
+    if (snapshot.cache_program_range.valid) {
+        cch_program->notify_changed_range(
+            snapshot.cache_program_range.start,
+            snapshot.cache_program_range.last);
+    }
+    if (snapshot.cache_data_range.valid) {
+        cch_data->notify_changed_range(
+            snapshot.cache_data_range.start, snapshot.cache_data_range.last);
+    }
+    emit snapshot_update(snapshot);
+    emit post_tick();
+}
+
+void Machine::snapshot_timer() {
+    if (sim_thread != nullptr && snapshots.update()) {
+        apply_snapshot(snapshots.read_buffer());
+    }
+}
+
+void Machine::background_run_finished() {
+    // The thread may already be joined (and possibly replaced by a resumed
+    // run) when this queued notification arrives.
+    if (sim_thread == nullptr || bg_joining || !sim_thread->isFinished()) {
+        return;
+    }
+    join_background_run();
+    conclude_background_run();
+}
+
+void Machine::deliver_interrupt(uint irq_num, bool active) {
+    {
+        std::lock_guard<std::mutex> guard(interrupt_mutex);
+        if (harts_parallel) {
+            pending_interrupts.emplace_back(irq_num, active);
+            return;
+        }
+    }
+    cop0st->set_interrupt_signal(irq_num, active);
+}
+
+void Machine::block_simulation_signals(bool block) {
+    for (Hart &hart : harts) {
+        hart.regs->blockSignals(block);
+        hart.cr->blockSignals(block);
+        hart.cop0st->blockSignals(block);
+        hart.cch_program->blockSignals(block);
+        hart.cch_data->blockSignals(block);
+    }
+    data_bus->blockSignals(block);
+    perip_lcd_display->blockSignals(block);
 }
 
 void Machine::set_status(enum Status st) {
@@ -326,8 +1071,18 @@ void Machine::set_status(enum Status st) {
 void Machine::register_exception_handler(
     ExceptionCause excause,
     ExceptionHandler *exhandler) {
-    if (cr != nullptr) {
-        cr->register_exception_handler(excause, exhandler);
+    if (harts.size() > 1 && machine_config.hart_quantum() != 0
+        && exhandler != nullptr) {
+        // Handler is shared by harts running on separate threads.
+        hart_handlers.emplace_back(new SerializedExceptionHandler(
+            exhandler, coherence->lock(),
+            [this](const std::function<void()> &call) {
+                run_on_coordinator(call);
+            }));
+        exhandler = hart_handlers.back().get();
+    }
+    for (Hart &hart : harts) {
+        hart.cr->register_exception_handler(excause, exhandler);
     }
 }
 
@@ -344,14 +1099,22 @@ bool Machine::memory_bus_insert_range(
 }
 
 void Machine::insert_hwbreak(Address address) {
-    if (cr != nullptr) {
-        cr->insert_hwbreak(address);
+    bool resume = suspend_background_run();
+    for (Hart &hart : harts) {
+        hart.cr->insert_hwbreak(address);
+    }
+    if (resume) {
+        start_background_run();
     }
 }
 
 void Machine::remove_hwbreak(Address address) {
-    if (cr != nullptr) {
-        cr->remove_hwbreak(address);
+    bool resume = suspend_background_run();
+    for (Hart &hart : harts) {
+        hart.cr->remove_hwbreak(address);
+    }
+    if (resume) {
+        start_background_run();
     }
 }
 
@@ -363,8 +1126,8 @@ bool Machine::is_hwbreak(Address address) {
 }
 
 void Machine::set_stop_on_exception(enum ExceptionCause excause, bool value) {
-    if (cr != nullptr) {
-        cr->set_stop_on_exception(excause, value);
+    for (Hart &hart : harts) {
+        hart.cr->set_stop_on_exception(excause, value);
     }
 }
 
@@ -376,8 +1139,8 @@ bool Machine::get_stop_on_exception(enum ExceptionCause excause) const {
 }
 
 void Machine::set_step_over_exception(enum ExceptionCause excause, bool value) {
-    if (cr != nullptr) {
-        cr->set_step_over_exception(excause, value);
+    for (Hart &hart : harts) {
+        hart.cr->set_step_over_exception(excause, value);
     }
 }
 
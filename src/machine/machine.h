@@ -1,24 +1,38 @@
 #ifndef MACHINE_H
 #define MACHINE_H
 
+#include "common/triple_buffer.h"
 #include "core.h"
+#include "event_queue.h"
+#include "machine_snapshot.h"
 #include "machineconfig.h"
 #include "memory/backend/lcddisplay.h"
+#include "memory/backend/dmacontroller.h"
 #include "memory/backend/peripheral.h"
 #include "memory/backend/peripspiled.h"
 #include "memory/backend/serialport.h"
 #include "memory/cache/cache.h"
+#include "memory/cache/coherence.h"
 #include "memory/memory_bus.h"
 #include "registers.h"
 #include "simulator_exception.h"
 #include "symboltable.h"
 
 #include <QObject>
+#include <QThread>
 #include <QTimer>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace machine {
 
+class HartThread;
+
 class Machine : public QObject {
     Q_OBJECT
 public:
@@ -30,6 +44,30 @@ public:
 
     const MachineConfig &config();
     void set_speed(unsigned int ips, unsigned int time_chunk = 0);
+    /**
+     * Run the simulation in a separate thread (intended for unlimited speed).
+     *
+     * Signals of registers, core, caches and memory bus are blocked during
+     * such run and visualization is refreshed from periodic `MachineSnapshot`
+     * (`snapshot_update` followed by `post_tick`) instead.
+     */
+    void set_background_run(bool enable);
+    bool background_running() const;
+    /**
+     * Temporarily stop background run to modify core state or memory from
+     * GUI thread.
+     *
+     * @return  true when run should be continued by `resume_background_run`
+     */
+    bool suspend_background_run();
+    void resume_background_run();
+    /**
+     * Cells copied into every snapshot of background run, so views never
+     * read memory owned by the simulation thread. Can be called any time.
+     */
+    void set_snapshot_window(
+        enum SnapshotWindowId id,
+        const SnapshotWindowRequest &request);
 
     const Registers *registers();
     const Cop0State *cop0state();
@@ -44,6 +82,9 @@ public:
     SerialPort *serial_port();
     PeripSpiLed *peripheral_spi_led();
     LcdDisplay *peripheral_lcd_display();
+    DmaController *peripheral_dma();
+    /** Simulated time of peripherals, advanced once per core cycle. */
+    EventQueue *event_queue();
     const SymbolTable *symbol_table(bool create = false);
     SymbolTable *symbol_table_rw(bool create = false);
     void set_symbol(
@@ -55,6 +96,19 @@ public:
     const Core *core();
     const CoreSingle *core_singe();
     const CorePipelined *core_pipelined();
+    const CoreSuperscalar *core_superscalar();
+    const CoreOutOfOrder *core_out_of_order();
+    /**
+     * Harts share memory bus, each of them has own registers, core and
+     * private caches. Accessors above return hart 0.
+     */
+    unsigned hart_count() const;
+    const Registers *hart_registers(unsigned hart);
+    const Core *hart_core(unsigned hart);
+    const Cache *hart_cache_program(unsigned hart);
+    const Cache *hart_cache_data(unsigned hart);
+    /** Snooping bus of private caches, nullptr for single hart machine. */
+    const CoherenceBus *coherence_bus();
     bool executable_loaded() const;
 
     enum Status {
@@ -98,12 +152,58 @@ signals:
     void tick();      // Time tick
     void post_tick(); // Emitted after tick to allow updates
     void set_interrupt_signal(uint irq_num, bool active);
+    void snapshot_update(const machine::MachineSnapshot &snapshot);
 
 private slots:
     void step_timer();
+    void snapshot_timer();
+    void background_run_finished();
+    /**
+     * Deliver peripheral interrupt to hart 0. While harts run on separate
+     * threads, it is postponed to the end of the quantum.
+     */
+    void deliver_interrupt(uint irq_num, bool active);
 
 private:
     void step_internal(bool skip_break = false);
+    /**
+     * Advance all running harts. Harts step one after other in lockstep,
+     * or by `hart_quantum` steps on separate host threads when configured.
+     */
+    void step_harts(bool skip_break);
+    void step_harts_quantum(bool skip_break);
+    /**
+     * Run call of a hart thread on the thread coordinating the quantum and
+     * wait for it. Exception handlers may call the GUI, which is blocked
+     * until all harts finish their quantum.
+     */
+    void run_on_coordinator(const std::function<void()> &call);
+    bool program_exited() const;
+    bool exception_stop_pending() const;
+    /**
+     * Publish memory ranges modified during last step(s) to visualization.
+     * Pending serial port output is passed too, at most once per its flush
+     * interval unless `final` is set.
+     */
+    void flush_memory_changes(bool final = false);
+
+    enum BackgroundRunEnd {
+        BG_STOPPED,        // Stop requested by GUI thread
+        BG_EXITED,         // Program reached its end
+        BG_EXCEPTION_STOP, // Exception configured to stop the machine
+        BG_TRAPPED         // Simulator exception thrown
+    };
+    void start_background_run();
+    /** Stop the simulation thread and deliver its last snapshot. */
+    void join_background_run();
+    /** Update status according to the reason the background run ended. */
+    void conclude_background_run();
+    void background_run(); // Runs in simulation thread
+    void publish_snapshot();
+    void read_snapshot_window(enum SnapshotWindowId id, SnapshotWindow &window);
+    void apply_snapshot(const MachineSnapshot &snapshot);
+    void block_simulation_signals(bool block);
+
     MachineConfig machine_config;
 
     Registers *regs = nullptr;
@@ -118,14 +218,54 @@ private:
     SerialPort *ser_port = nullptr;
     PeripSpiLed *perip_spi_led = nullptr;
     LcdDisplay *perip_lcd_display = nullptr;
+    DmaController *perip_dma = nullptr;
     Cache *cch_program = nullptr;
     Cache *cch_data = nullptr;
     Cop0State *cop0st = nullptr;
     Core *cr = nullptr;
+    EventQueue events;
+
+    struct Hart {
+        Registers *regs;
+        Cop0State *cop0st;
+        Cache *cch_program;
+        Cache *cch_data;
+        Core *cr;
+    };
+    /** Hart did not reach the end of program or still has work in flight. */
+    bool hart_running(const Hart &hart) const;
+    /** All harts, members of hart 0 are aliased by the fields above. */
+    std::vector<Hart> harts;
+    CoherenceBus *coherence = nullptr;
+    /** Exception handlers serialized for harts running in parallel. */
+    std::vector<std::unique_ptr<ExceptionHandler>> hart_handlers;
+    /** Host threads of harts in quantum mode, reused by all quanta. */
+    std::vector<std::unique_ptr<HartThread>> hart_threads;
+    std::mutex interrupt_mutex; // Guards the two fields below
+    bool harts_parallel = false;
+    std::vector<std::pair<uint, bool>> pending_interrupts;
+    std::condition_variable coordinator_cond;
+    std::mutex coordinator_mutex; // Guards the two fields below
+    unsigned harts_running = 0; // Harts not finished with the quantum
+    const std::function<void()> *coordinator_call = nullptr;
 
     QTimer *run_t = nullptr;
     unsigned int time_chunk = { 0 };
 
+    bool background_run_enabled = false;
+    QThread *sim_thread = nullptr;
+    QTimer *snapshot_t = nullptr;
+    std::atomic<bool> bg_stop_request { false };
+    bool bg_joining = false;
+    BackgroundRunEnd bg_end = BG_STOPPED;
+    std::unique_ptr<SimulatorException> bg_trap;
+    TripleBuffer<MachineSnapshot> snapshots;
+    /** Ranges of the last published snapshot, resent until it is consumed. */
+    ChangedRange bg_carry[3];
+    LcdRegion bg_lcd_carry;
+    std::mutex window_mutex; // Guards window_requests
+    std::array<SnapshotWindowRequest, SW_COUNT> window_requests;
+
     SymbolTable *symtab = nullptr;
     Address program_end = 0xffff0000_addr;
     enum Status stat = ST_READY;
@@ -133,6 +273,7 @@ private:
     void setup_serial_port();
     void setup_perip_spi_led();
     void setup_lcd_display();
+    void setup_dma();
 };
 
 } // namespace machine
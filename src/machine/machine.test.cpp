@@ -0,0 +1,599 @@
+#include "machine.h"
+
+#include "machine.test.h"
+#include "memory/backend/dmacontroller.h"
+#include "memory/backend/memory.h"
+#include "memory/backend/serialport.h"
+#include "memory/cache/cache.h"
+#include "memory/cache/coherence.h"
+#include "memory/memory_bus.h"
+
+#include <map>
+
+using namespace machine;
+
+/** Store code to memory of the machine at the initial program counter. */
+static void load_code(Machine &machine, const QVector<uint32_t> &code) {
+    Address addr = machine.registers()->read_pc();
+    for (uint32_t word : code) {
+        memory_write_u32(machine.memory_rw(), addr.get_raw(), word);
+        addr += 4;
+    }
+}
+
+/** Step all harts until each of them reaches the end of program. */
+static void run_to_exit(Machine &machine) {
+    for (int k = 100000; k > 0 && !machine.exited(); k--) {
+        machine.step();
+    }
+    QCOMPARE(machine.status(), Machine::ST_EXIT);
+}
+
+/** Two harts with coherent write-back data caches (4 words per block). */
+static MachineConfig dual_hart_config(unsigned quantum) {
+    MachineConfig config;
+    config.set_hart_count(2);
+    config.set_hart_quantum(quantum);
+    config.access_cache_data()->set_enabled(true);
+    config.access_cache_data()->set_write_policy(CacheConfig::WP_BACK);
+    config.access_cache_data()->set_block_size(4);
+    return config;
+}
+
+/** Each hart stores its index + 10 to word 0x2000 + 4 * index and loads it. */
+static const QVector<uint32_t> hart_store_code {
+    0xf14022f3, // csrr  t0, mhartid
+    0x00229313, // slli  t1, t0, 2
+    0x00002537, // lui   a0, 0x2
+    0x00650533, // add   a0, a0, t1
+    0x00a28393, // addi  t2, t0, 10
+    0x00752023, // sw    t2, 0(a0)
+    0x00052e03, // lw    t3, 0(a0)
+    0xffff0f37, // lui   t5, 0xffff0 (end of program)
+    0x000f0067, // jr    t5
+};
+
+void TestMachine::test_cache_coherence() {
+    CacheConfig cache_c;
+    cache_c.set_enabled(true);
+    cache_c.set_write_policy(CacheConfig::WP_BACK);
+    cache_c.set_set_count(4);
+    cache_c.set_block_size(2);
+    cache_c.set_associativity(1);
+
+    Memory m(BIG);
+    TrivialBus m_frontend(&m);
+    CoherenceBus coherence;
+    Cache cache_a(&m_frontend, &cache_c);
+    Cache cache_b(&m_frontend, &cache_c);
+    cache_a.set_coherence(&coherence);
+    cache_b.set_coherence(&coherence);
+
+    // Modified in A, read by B
+    cache_a.write_u32(0x100_addr, 0x11);
+    QCOMPARE(cache_b.read_u32(0x100_addr), (uint32_t)0x11);
+    QCOMPARE(memory_read_u32(&m, 0x100), (uint32_t)0x11);
+    // Shared, write by B invalidates A
+    cache_b.write_u32(0x100_addr, 0x22);
+    QCOMPARE(cache_a.location_status(0x100_addr) & LOCSTAT_CACHED, 0);
+    QCOMPARE(cache_a.read_u32(0x100_addr), (uint32_t)0x22);
+
+    const CoherenceStats &stats = coherence.get_stats();
+    QCOMPARE(stats.bus_reads, (uint32_t)2);
+    QCOMPARE(stats.bus_read_exclusives, (uint32_t)1);
+    QCOMPARE(stats.upgrades, (uint32_t)1);
+    QCOMPARE(stats.invalidations, (uint32_t)1);
+    QCOMPARE(stats.interventions, (uint32_t)2);
+}
+
+void TestMachine::test_hart_stepping_data() {
+    QTest::addColumn<unsigned>("quantum");
+
+    QTest::newRow("lockstep") << 0u;
+    QTest::newRow("quantum") << 3u;
+}
+
+void TestMachine::test_hart_stepping() {
+    QFETCH(unsigned, quantum);
+
+    Machine machine(dual_hart_config(quantum), false, false);
+    load_code(machine, hart_store_code);
+    run_to_exit(machine);
+
+    QCOMPARE(machine.hart_count(), 2u);
+    for (unsigned i = 0; i < 2; i++) {
+        QCOMPARE(machine.hart_registers(i)->read_gp(5).as_u32(), i);
+        QCOMPARE(machine.hart_registers(i)->read_gp(28).as_u32(), 10 + i);
+        QCOMPARE(machine.hart_core(i)->get_instruction_count(), 9u);
+    }
+    machine.cache_sync();
+    QCOMPARE(memory_read_u32(machine.memory(), 0x2000), 10u);
+    QCOMPARE(memory_read_u32(machine.memory(), 0x2004), 11u);
+}
+
+void TestMachine::test_hart_statistics() {
+    Machine machine(dual_hart_config(0), false, false);
+    load_code(machine, hart_store_code);
+    run_to_exit(machine);
+
+    // Words of both harts share a block. In lockstep, hart 0 stores first,
+    // the store of hart 1 takes the modified block over and hart 0 misses
+    // again on the load.
+    const Cache *cache_0 = machine.hart_cache_data(0);
+    const Cache *cache_1 = machine.hart_cache_data(1);
+    QCOMPARE(cache_0->get_hit_count(), 0u);
+    QCOMPARE(cache_0->get_miss_count(), 2u);
+    QCOMPARE(cache_1->get_hit_count(), 1u);
+    QCOMPARE(cache_1->get_miss_count(), 1u);
+    for (unsigned i = 0; i < 2; i++) {
+        QCOMPARE(machine.hart_core(i)->get_cycle_count(), 9u);
+    }
+
+    const CoherenceStats &stats = machine.coherence_bus()->get_stats();
+    QCOMPARE(stats.bus_reads, 1u);
+    QCOMPARE(stats.bus_read_exclusives, 2u);
+    QCOMPARE(stats.upgrades, 0u);
+    QCOMPARE(stats.invalidations, 1u);
+    QCOMPARE(stats.interventions, 2u);
+}
+
+void TestMachine::test_atomic_contention_data() {
+    QTest::addColumn<unsigned>("quantum");
+
+    QTest::newRow("lockstep") << 0u;
+    QTest::newRow("quantum") << 1000u;
+}
+
+void TestMachine::test_atomic_contention() {
+    QFETCH(unsigned, quantum);
+
+    Machine machine(dual_hart_config(quantum), false, false);
+    // Both harts increment two shared counters, by AMO and by LR/SC loop.
+    load_code(
+        machine,
+        {
+            0x00001537, // lui   a0, 0x1
+            0x00850593, // addi  a1, a0, 8
+            0x1f400313, // addi  t1, zero, 500
+            0x00100393, // addi  t2, zero, 1
+            0x0075202f, // loop: amoadd.w zero, t2, (a0)
+            0x1005ae2f, // retry: lr.w t3, (a1)
+            0x001e0e13, // addi  t3, t3, 1
+            0x19c5aeaf, // sc.w  t4, t3, (a1)
+            0xfe0e9ae3, // bnez  t4, retry
+            0xfff30313, // addi  t1, t1, -1
+            0xfe0314e3, // bnez  t1, loop
+            0xffff0f37, // lui   t5, 0xffff0 (end of program)
+            0x000f0067, // jr    t5
+        });
+    run_to_exit(machine);
+
+    machine.cache_sync();
+    QCOMPARE(memory_read_u32(machine.memory(), 0x1000), 1000u);
+    QCOMPARE(memory_read_u32(machine.memory(), 0x1008), 1000u);
+}
+
+/** Counts handled exceptions and the ones handled off its own thread. */
+class CountingHandler : public ExceptionHandler {
+public:
+    bool handle_exception(
+        Core *,
+        Registers *,
+        ExceptionCause,
+        Address,
+        Address,
+        Address,
+        bool,
+        Address) override {
+        calls++;
+        if (QThread::currentThread() != thread()) {
+            foreign_calls++;
+        }
+        return true;
+    }
+
+    unsigned calls = 0;
+    unsigned foreign_calls = 0;
+};
+
+void TestMachine::test_atomic_misaligned_data() {
+    QTest::addColumn<bool>("pipelined");
+
+    QTest::newRow("single cycle") << false;
+    QTest::newRow("pipelined") << true;
+}
+
+void TestMachine::test_atomic_misaligned() {
+    QFETCH(bool, pipelined);
+
+    CountingHandler handler;
+    MachineConfig config;
+    config.set_pipelined(pipelined);
+    Machine machine(config, false, false);
+    machine.register_exception_handler(EXCAUSE_ADDRS, &handler);
+    machine.set_stop_on_exception(EXCAUSE_ADDRS, false);
+    machine.set_step_over_exception(EXCAUSE_ADDRS, true);
+    load_code(
+        machine,
+        {
+            0x00001537, // lui   a0, 0x1
+            0x00250593, // addi  a1, a0, 2
+            0x00100393, // addi  t2, zero, 1
+            0x00700e13, // addi  t3, zero, 7
+            0x0075ae2f, // amoadd.w t3, t2, (a1)
+            0x00752eaf, // amoadd.w t4, t2, (a0)
+            0xffff0f37, // lui   t5, 0xffff0 (end of program)
+            0x000f0067, // jr    t5
+        });
+    run_to_exit(machine);
+
+    // Misaligned access raises exception and changes neither memory nor
+    // the destination register.
+    QCOMPARE(handler.calls, 1u);
+    QCOMPARE(machine.registers()->read_gp(28).as_u32(), 7u);
+    QCOMPARE(machine.registers()->read_gp(29).as_u32(), 0u);
+    QCOMPARE(memory_read_u32(machine.memory(), 0x1000), 1u);
+}
+
+void TestMachine::test_out_of_order_drain() {
+    MachineConfig config;
+    config.access_out_of_order()->set_enabled(true);
+    Machine machine(config, false, false);
+    // Multiplications are still in flight when the fetch reaches the end.
+    load_code(
+        machine,
+        {
+            0x00300513, // addi  a0, zero, 3
+            0x02a505b3, // mul   a1, a0, a0
+            0x02a585b3, // mul   a1, a1, a0
+            0x02a585b3, // mul   a1, a1, a0
+            0xffff0f37, // lui   t5, 0xffff0 (end of program)
+            0x000f0067, // jr    t5
+        });
+    unsigned steps = 0;
+    while (!machine.exited() && steps < 100) {
+        machine.step();
+        steps++;
+    }
+    QCOMPARE(machine.status(), Machine::ST_EXIT);
+    QVERIFY(!machine.core()->busy());
+    QCOMPARE(machine.core()->get_cycle_count(), steps);
+    QCOMPARE(machine.registers()->read_gp(11).as_u32(), 81u);
+}
+
+void TestMachine::test_quantum_interrupt() {
+    Machine machine(dual_hart_config(100), false, false);
+    // Hart 1 enables serial port TX interrupt, it is delivered to hart 0.
+    load_code(
+        machine,
+        {
+            0xf14022f3, // csrr  t0, mhartid
+            0x00028863, // beqz  t0, end
+            0xffffc337, // lui   t1, 0xffffc (serial port)
+            0x00200393, // addi  t2, zero, 2
+            0x00732423, // sw    t2, 8(t1) (TX interrupt enable)
+            0xffff0f37, // end: lui t5, 0xffff0 (end of program)
+            0x000f0067, // jr    t5
+        });
+    run_to_exit(machine);
+
+    const uint32_t tx_irq = Cop0State::Status_Int0 << 2;
+    QCOMPARE(
+        machine.cop0state()->peek_cop0reg(Cop0State::Cause) & tx_irq, tx_irq);
+}
+
+/** Serial port registers (see serialport.cpp). */
+enum SerialReg : Offset {
+    SERP_RX_ST = 0x00,
+    SERP_RX_DATA = 0x04,
+    SERP_TX_ST = 0x08,
+    SERP_TX_DATA = 0x0c,
+    SERP_RX_FIFO = 0x10,
+    SERP_TX_FIFO = 0x14,
+};
+
+/**
+ * Connect host side of the serial port: characters are received from `input`
+ * and sent to `output`, the last state of each interrupt is kept in `irq`.
+ */
+static void connect_serial_host(
+    SerialPort &port,
+    QByteArray &input,
+    QByteArray &output,
+    std::map<uint, bool> &irq) {
+    QObject::connect(
+        &port, &SerialPort::rx_byte_pool,
+        [&input](int, unsigned int &data, bool &available) {
+            available = !input.isEmpty();
+            if (available) {
+                data = (uint8_t)input.at(0);
+                input.remove(0, 1);
+            }
+        });
+    QObject::connect(
+        &port, &SerialPort::tx_bytes,
+        [&output](const QByteArray &data) { output.append(data); });
+    QObject::connect(
+        &port, &SerialPort::signal_interrupt,
+        [&irq](uint irq_level, bool active) { irq[irq_level] = active; });
+}
+
+void TestMachine::test_serial_fifo() {
+    SerialPort port(LITTLE, 4, 4);
+    QByteArray input = "abcdef", output;
+    std::map<uint, bool> irq;
+    connect_serial_host(port, input, output, irq);
+
+    // RX FIFO is filled from host up to its size, the rest waits there.
+    QCOMPARE(memory_read_u32(&port, SERP_RX_ST) & 1, (uint32_t)1);
+    QCOMPARE(memory_read_u32(&port, SERP_RX_FIFO) & 0xffff, (uint32_t)4);
+    QCOMPARE(input, QByteArray("ef"));
+    QByteArray received;
+    for (int i = 0; i < 6; i++) {
+        received.append((char)memory_read_u32(&port, SERP_RX_DATA));
+    }
+    QCOMPARE(received, QByteArray("abcdef"));
+    QCOMPARE(memory_read_u32(&port, SERP_RX_ST) & 1, (uint32_t)0);
+
+    // Without character timing, full TX FIFO is passed to host at once.
+    for (char c : QByteArray("012345")) {
+        memory_write_u32(&port, SERP_TX_DATA, (uint8_t)c);
+    }
+    QCOMPARE(output, QByteArray("0123"));
+    QCOMPARE(memory_read_u32(&port, SERP_TX_FIFO) & 0xffff, (uint32_t)2);
+    port.flush_tx(true);
+    QCOMPARE(output, QByteArray("012345"));
+
+    // With character timing, characters written to full FIFO are dropped.
+    EventQueue events;
+    port.set_char_timing(&events, 10);
+    output.clear();
+    for (char c : QByteArray("abcdef")) {
+        memory_write_u32(&port, SERP_TX_DATA, (uint8_t)c);
+    }
+    QCOMPARE(memory_read_u32(&port, SERP_TX_FIFO) & 0xffff, (uint32_t)4);
+    QCOMPARE(memory_read_u32(&port, SERP_TX_ST) & 1, (uint32_t)0);
+    for (int i = 0; i < 40; i++) {
+        events.tick();
+    }
+    port.flush_tx(true);
+    QCOMPARE(output, QByteArray("abcd"));
+    QVERIFY(irq.empty());
+}
+
+void TestMachine::test_serial_interrupt() {
+    SerialPort port(LITTLE, 8, 8);
+    QByteArray input = "ab", output;
+    std::map<uint, bool> irq;
+    connect_serial_host(port, input, output, irq);
+    const uint tx_irq = 2, rx_irq = 3;
+
+    // RX interrupt is requested while at least threshold characters wait.
+    memory_write_u32(&port, SERP_RX_FIFO, 3 << 16);
+    memory_write_u32(&port, SERP_RX_ST, 2);
+    QCOMPARE(memory_read_u32(&port, SERP_RX_FIFO), (uint32_t)(3 << 16 | 2));
+    QVERIFY(!irq[rx_irq]);
+    input.append("c");
+    port.rx_queue_check();
+    QVERIFY(irq[rx_irq]);
+    QCOMPARE(memory_read_u32(&port, SERP_RX_DATA), (uint32_t)'a');
+    QVERIFY(!irq[rx_irq]);
+
+    // TX interrupt is requested while at most threshold characters wait.
+    EventQueue events;
+    port.set_char_timing(&events, 10);
+    memory_write_u32(&port, SERP_TX_FIFO, 1 << 16);
+    memory_write_u32(&port, SERP_TX_ST, 2);
+    QVERIFY(irq[tx_irq]);
+    for (char c : QByteArray("xyz")) {
+        memory_write_u32(&port, SERP_TX_DATA, (uint8_t)c);
+    }
+    QVERIFY(!irq[tx_irq]);
+    // One character per 10 cycles, the last but one leaves at cycle 20.
+    for (int i = 0; i < 19; i++) {
+        events.tick();
+    }
+    QCOMPARE(memory_read_u32(&port, SERP_TX_FIFO) & 0xffff, (uint32_t)2);
+    QVERIFY(!irq[tx_irq]);
+    events.tick();
+    QCOMPARE(memory_read_u32(&port, SERP_TX_FIFO) & 0xffff, (uint32_t)1);
+    QVERIFY(irq[tx_irq]);
+    for (int i = 0; i < 10; i++) {
+        events.tick();
+    }
+    QCOMPARE(memory_read_u32(&port, SERP_TX_FIFO) & 0xffff, (uint32_t)0);
+    port.flush_tx(true);
+    QCOMPARE(output, QByteArray("xyz"));
+
+    // Disabled interrupt is deasserted.
+    memory_write_u32(&port, SERP_TX_ST, 0);
+    QVERIFY(!irq[tx_irq]);
+}
+
+void TestMachine::test_quantum_serial_rx() {
+    CountingHandler handler;
+    Machine machine(dual_hart_config(100), false, false);
+    machine.register_exception_handler(EXCAUSE_ADDRS, &handler);
+    machine.set_stop_on_exception(EXCAUSE_ADDRS, false);
+    machine.set_step_over_exception(EXCAUSE_ADDRS, true);
+    // Each hart waits for a character from the serial port, stores it to
+    // word 0x2000 + 4 * index and raises exception handled by the host
+    // (misaligned AMO stands for a system call).
+    load_code(
+        machine,
+        {
+            0xf14022f3, // csrr  t0, mhartid
+            0x00229313, // slli  t1, t0, 2
+            0x00002537, // lui   a0, 0x2
+            0x00650533, // add   a0, a0, t1
+            0xffffc3b7, // lui   t2, 0xffffc (serial port)
+            0x0003ae03, // wait: lw t3, 0(t2)
+            0x001e7e13, // andi  t3, t3, 1
+            0xfe0e0ce3, // beqz  t3, wait
+            0x0043ae83, // lw    t4, 4(t2)
+            0x01d52023, // sw    t4, 0(a0)
+            0x00250593, // addi  a1, a0, 2
+            0x0005a02f, // amoadd.w zero, zero, (a1)
+            0xffff0f37, // lui   t5, 0xffff0 (end of program)
+            0x000f0067, // jr    t5
+        });
+    // Host is called only from this thread, like the GUI, which is blocked
+    // while harts run their quantum.
+    const QThread *host = QThread::currentThread();
+    QByteArray input, output;
+    std::map<uint, bool> irq;
+    unsigned foreign_polls = 0;
+    connect_serial_host(*machine.serial_port(), input, output, irq);
+    QObject::connect(
+        machine.serial_port(), &SerialPort::rx_byte_pool,
+        [host, &foreign_polls](int, unsigned int &, bool &) {
+            if (QThread::currentThread() != host) {
+                foreign_polls++;
+            }
+        });
+
+    // Input arrives while harts are polling.
+    for (int k = 0; k < 3; k++) {
+        machine.step();
+    }
+    input = "xy";
+    run_to_exit(machine);
+
+    machine.cache_sync();
+    const uint32_t first = memory_read_u32(machine.memory(), 0x2000);
+    const uint32_t second = memory_read_u32(machine.memory(), 0x2004);
+    QVERIFY(first == 'x' || first == 'y');
+    QCOMPARE(first + second, (uint32_t)('x' + 'y'));
+    QVERIFY(input.isEmpty());
+    QCOMPARE(foreign_polls, 0u);
+    QCOMPARE(handler.calls, 2u);
+    QCOMPARE(handler.foreign_calls, 0u);
+}
+
+/** DMA controller registers and bits (see dmacontroller.cpp). */
+enum DmaReg : Offset {
+    DMA_CTRL = 0x00,
+    DMA_STATUS = 0x04,
+    DMA_DESC = 0x08,
+    DMA_BYTES = 0x0c,
+};
+constexpr uint32_t DMA_START = 0x1, DMA_IE = 0x2, DMA_BURST_2 = 0x100;
+constexpr uint32_t DMA_BUSY = 0x1, DMA_DONE = 0x2, DMA_ERROR = 0x4;
+constexpr uint DMA_IRQ = 4;
+
+/** Store DMA descriptor to memory. */
+static void write_descriptor(
+    Memory &mem,
+    uint32_t address,
+    uint32_t src,
+    uint32_t dst,
+    uint32_t size,
+    uint32_t next) {
+    memory_write_u32(&mem, address, src);
+    memory_write_u32(&mem, address + 4, dst);
+    memory_write_u32(&mem, address + 8, size);
+    memory_write_u32(&mem, address + 12, next);
+}
+
+/**
+ * Start the chain of descriptors and advance time until the transfer ends.
+ *
+ * @return  cycles taken by the transfer
+ */
+static uint64_t run_dma(DmaController &dma, EventQueue &events, uint32_t desc) {
+    memory_write_u32(&dma, DMA_DESC, desc);
+    memory_write_u32(&dma, DMA_CTRL, DMA_START | DMA_IE | DMA_BURST_2);
+    const uint64_t start = events.now();
+    for (int k = 10000; k > 0 && (memory_read_u32(&dma, DMA_STATUS) & DMA_BUSY);
+         k--) {
+        events.tick();
+    }
+    QCOMPARE(memory_read_u32(&dma, DMA_STATUS) & DMA_BUSY, (uint32_t)0);
+    return events.now() - start;
+}
+
+void TestMachine::test_dma_transfer() {
+    Memory mem(LITTLE);
+    MemoryDataBus bus(LITTLE);
+    bus.insert_device_to_range(&mem, 0x0_addr, 0xffff_addr, false);
+    EventQueue events;
+    // Read and write take 10 cycles, following words of the burst 2.
+    DmaController dma(LITTLE, &bus, &events, 10, 10, 2);
+    std::map<uint, bool> irq;
+    QObject::connect(
+        &dma, &DmaController::signal_interrupt,
+        [&irq](uint irq_level, bool active) { irq[irq_level] = active; });
+
+    for (uint32_t i = 0; i < 10; i++) {
+        memory_write_u32(&mem, 0x1000 + 4 * i, 0x11111111 * i);
+    }
+    // Six words in three bursts, then four words in two bursts.
+    write_descriptor(mem, 0x100, 0x1000, 0x2000, 24, 0x110);
+    write_descriptor(mem, 0x110, 0x1018, 0x3000, 16, 0);
+
+    // Descriptor read takes 10 + 3 * 2 cycles, burst of two words
+    // 2 * 10 + 2 * 2 cycles.
+    QCOMPARE(run_dma(dma, events, 0x100), (uint64_t)(2 * 16 + 5 * 24));
+    QCOMPARE(memory_read_u32(&dma, DMA_STATUS), DMA_DONE);
+    QCOMPARE(memory_read_u32(&dma, DMA_BYTES), (uint32_t)40);
+    for (uint32_t i = 0; i < 6; i++) {
+        QCOMPARE(memory_read_u32(&mem, 0x2000 + 4 * i), 0x11111111 * i);
+    }
+    for (uint32_t i = 6; i < 10; i++) {
+        QCOMPARE(
+            memory_read_u32(&mem, 0x3000 + 4 * (i - 6)), 0x11111111 * i);
+    }
+    QCOMPARE(memory_read_u32(&mem, 0x2018), (uint32_t)0);
+    QCOMPARE(memory_read_u32(&mem, 0x3010), (uint32_t)0);
+
+    // Completion interrupt is held until DONE is cleared.
+    QVERIFY(irq[DMA_IRQ]);
+    memory_write_u32(&dma, DMA_STATUS, DMA_DONE);
+    QVERIFY(!irq[DMA_IRQ]);
+}
+
+void TestMachine::test_dma_error_data() {
+    QTest::addColumn<uint32_t>("desc");
+    QTest::addColumn<uint32_t>("src");
+    QTest::addColumn<uint32_t>("dst");
+
+    QTest::newRow("valid") << 0x100u << 0x1000u << 0x2000u;
+    QTest::newRow("unmapped descriptor") << 0x20000u << 0x1000u << 0x2000u;
+    QTest::newRow("unmapped source") << 0x100u << 0x20000u << 0x2000u;
+    QTest::newRow("unmapped destination") << 0x100u << 0x1000u << 0x20000u;
+    QTest::newRow("destination crosses end of memory")
+        << 0x100u << 0x1000u << 0xfffcu;
+    // Memory is mapped at both ends of the address space.
+    QTest::newRow("source wraps around") << 0x100u << 0xfffffffcu << 0x2000u;
+    QTest::newRow("destination wraps around")
+        << 0x100u << 0x1000u << 0xfffffffcu;
+}
+
+void TestMachine::test_dma_error() {
+    QFETCH(uint32_t, desc);
+    QFETCH(uint32_t, src);
+    QFETCH(uint32_t, dst);
+
+    Memory mem(LITTLE);
+    MemoryDataBus bus(LITTLE);
+    bus.insert_device_to_range(&mem, 0x0_addr, 0xffff_addr, false);
+    bus.insert_device_to_range(&mem, 0xffff0000_addr, 0xffffffff_addr, false);
+    EventQueue events;
+    DmaController dma(LITTLE, &bus, &events, 1, 1, 0);
+    std::map<uint, bool> irq;
+    QObject::connect(
+        &dma, &DmaController::signal_interrupt,
+        [&irq](uint irq_level, bool active) { irq[irq_level] = active; });
+    write_descriptor(mem, 0x100, src, dst, 8, 0);
+
+    run_dma(dma, events, desc);
+    const bool valid = desc == 0x100 && src == 0x1000 && dst == 0x2000;
+    QCOMPARE(
+        memory_read_u32(&dma, DMA_STATUS),
+        valid ? DMA_DONE : DMA_DONE | DMA_ERROR);
+    // Burst is checked as a whole before any data are moved.
+    QCOMPARE(memory_read_u32(&dma, DMA_BYTES), valid ? 8u : 0u);
+    QVERIFY(irq[DMA_IRQ]);
+}
+
+QTEST_APPLESS_MAIN(TestMachine)
@@ -0,0 +1,27 @@
+#ifndef MACHINE_TEST_H
+#define MACHINE_TEST_H
+
+#include <QtTest>
+
+class TestMachine : public QObject {
+    Q_OBJECT
+private slots:
+    static void test_cache_coherence();
+    static void test_hart_stepping_data();
+    static void test_hart_stepping();
+    static void test_hart_statistics();
+    static void test_atomic_contention_data();
+    static void test_atomic_contention();
+    static void test_atomic_misaligned_data();
+    static void test_atomic_misaligned();
+    static void test_out_of_order_drain();
+    static void test_quantum_interrupt();
+    static void test_serial_fifo();
+    static void test_serial_interrupt();
+    static void test_quantum_serial_rx();
+    static void test_dma_transfer();
+    static void test_dma_error_data();
+    static void test_dma_error();
+};
+
+#endif // MACHINE_TEST_H
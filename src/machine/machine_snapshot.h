@@ -0,0 +1,160 @@
+/**
+ * Copy of machine state handed from simulation thread to visualization.
+ *
+ * When machine runs in background (see `Machine::set_background_run`), the
+ * visualization must not look into live simulator structures nor receive a
+ * signal per simulated event. Instead simulation periodically fills this
+ * structure and publishes it through a `TripleBuffer`. Only values needed for
+ * the always visible docks are present, together with memory cells shown by
+ * memory and program views (see `Machine::set_snapshot_window`). Everything
+ * else is refreshed once the run ends.
+ *
+ * @file
+ */
+#ifndef QTRVSIM_MACHINE_SNAPSHOT_H
+#define QTRVSIM_MACHINE_SNAPSHOT_H
+
+#include "cop0state.h"
+#include "machinedefs.h"
+#include "memory/address.h"
+#include "register_value.h"
+#include "registers.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/**
+ * Inclusive address range, possibly empty.
+ */
+struct ChangedRange {
+    bool valid = false;
+    Address start {};
+    Address last {};
+
+    void merge(const ChangedRange &other) {
+        if (!other.valid) {
+            return;
+        }
+        if (!valid) {
+            *this = other;
+            return;
+        }
+        if (other.start < start) {
+            start = other.start;
+        }
+        if (other.last > last) {
+            last = other.last;
+        }
+    }
+};
+
+/**
+ * Framebuffer pixels of LCD display modified since previous snapshot.
+ */
+struct LcdRegion {
+    bool valid = false;
+    size_t x = 0, y = 0, width = 0, height = 0;
+    std::vector<uint8_t> pixels {}; // Rows of the region, RGB565 big endian
+
+    /** Extend to the bounding box of both regions, pixels are not merged. */
+    void merge(const LcdRegion &other) {
+        if (!other.valid) {
+            return;
+        }
+        if (!valid) {
+            valid = true;
+            x = other.x;
+            y = other.y;
+            width = other.width;
+            height = other.height;
+            return;
+        }
+        const size_t x2 = std::max(x + width, other.x + other.width);
+        const size_t y2 = std::max(y + height, other.y + other.height);
+        x = std::min(x, other.x);
+        y = std::min(y, other.y);
+        width = x2 - x;
+        height = y2 - y;
+    }
+};
+
+/** Views reading memory through snapshot windows. */
+enum SnapshotWindowId {
+    SW_DATA,    // Memory view, cache status of data cache
+    SW_PROGRAM, // Program view, cache status of program cache
+    SW_COUNT
+};
+
+/** Memory cells copied into every snapshot. */
+struct SnapshotWindowRequest {
+    Address start {};
+    unsigned cell_bytes = 4; // 1, 2 or 4
+    unsigned cells = 0;
+    bool through_cache = false; // Read through data cache instead of the bus
+
+    bool operator==(const SnapshotWindowRequest &other) const {
+        return start == other.start && cell_bytes == other.cell_bytes
+               && cells == other.cells && through_cache == other.through_cache;
+    }
+    bool operator!=(const SnapshotWindowRequest &other) const {
+        return !(*this == other);
+    }
+};
+
+struct SnapshotWindow {
+    SnapshotWindowRequest request {};
+    std::vector<uint32_t> data {};
+    std::vector<LocationStatus> loc_stat {};
+
+    /** @return false when the cell is not covered by the window */
+    bool cell(Address address, uint32_t &value, LocationStatus &status) const {
+        if (address < request.start) {
+            return false;
+        }
+        const uint64_t offset = address - request.start;
+        if (offset % request.cell_bytes != 0
+            || offset / request.cell_bytes >= data.size()) {
+            return false;
+        }
+        value = data[offset / request.cell_bytes];
+        status = loc_stat[offset / request.cell_bytes];
+        return true;
+    }
+};
+
+struct MachineSnapshot {
+    Address pc {};
+    std::array<RegisterValue, REGISTER_COUNT> gp {};
+    std::array<RegisterValue, REGISTER_COUNT> fp {};
+    uint32_t fcsr = 0;
+    RegisterValue hi {}, lo {};
+
+    uint32_t cycle_count = 0;
+    uint32_t stall_count = 0;
+
+    std::array<uint32_t, Cop0State::COP0REGS_CNT> cop0 {};
+
+    // Address of instruction last processed by each pipeline stage.
+    Address fetch_addr {};
+    Address decode_addr {};
+    Address execute_addr {};
+    Address memory_addr {};
+    Address writeback_addr {};
+
+    // Modified since previous snapshot (not necessarily the consumed one).
+    ChangedRange data_bus_range {};
+    ChangedRange cache_program_range {};
+    ChangedRange cache_data_range {};
+
+    std::array<SnapshotWindow, SW_COUNT> windows {};
+    LcdRegion lcd_region {};
+};
+
+} // namespace machine
+
+#endif // QTRVSIM_MACHINE_SNAPSHOT_H
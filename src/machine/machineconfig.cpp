@@ -18,6 +18,14 @@ using namespace machine;
 #define DF_MEM_ACC_WRITE 10
 #define DF_MEM_ACC_BURST 0
 #define DF_ELF QString("")
+#define DF_ISSUE_WIDTH 1
+#define DF_ISSUE_ALU_PORTS 0
+#define DF_ISSUE_MUL_PORTS 1
+#define DF_ISSUE_MEM_PORTS 1
+#define DF_SERIAL_TX_FIFO 4096
+#define DF_SERIAL_RX_FIFO 64
+#define DF_HART_COUNT 1
+#define DF_HART_QUANTUM 0
 //////////////////////////////////////////////////////////////////////////////
 /// Default config of CacheConfig
 #define DFC_EN false
@@ -27,6 +35,24 @@ using namespace machine;
 #define DFC_REPLAC RP_RAND
 #define DFC_WRITE WP_THROUGH_NOALLOC
 //////////////////////////////////////////////////////////////////////////////
+/// Default config of BranchPredictorConfig
+#define DFB_PREDICTOR BP_NOT_TAKEN
+#define DFB_TABLE_BITS 8
+#define DFB_BTB_ENTRIES 0
+#define DFB_RAS_ENTRIES 0
+//////////////////////////////////////////////////////////////////////////////
+/// Default config of OutOfOrderConfig
+#define DFO_EN false
+#define DFO_WIDTH 2
+#define DFO_ROB 32
+#define DFO_IQ 16
+#define DFO_LSQ 8
+#define DFO_LAT_ALU 1
+#define DFO_LAT_MUL 3
+#define DFO_LAT_FPU 4
+#define DFO_LAT_LOAD 2
+#define DFO_PENALTY 2
+//////////////////////////////////////////////////////////////////////////////
 
 CacheConfig::CacheConfig() {
     en = DFC_EN;
@@ -146,15 +172,271 @@ bool CacheConfig::operator!=(const CacheConfig &c) const {
     return !operator==(c);
 }
 
+BranchPredictorConfig::BranchPredictorConfig() {
+    pred = DFB_PREDICTOR;
+    n_table_bits = DFB_TABLE_BITS;
+    n_btb = DFB_BTB_ENTRIES;
+    n_ras = DFB_RAS_ENTRIES;
+}
+
+#define N(STR) (prefix + QString(STR))
+
+BranchPredictorConfig::BranchPredictorConfig(
+    const QSettings *sts,
+    const QString &prefix) {
+    pred = (enum Predictor)sts->value(N("Predictor"), DFB_PREDICTOR).toUInt();
+    n_table_bits = sts->value(N("TableBits"), DFB_TABLE_BITS).toUInt();
+    n_btb = sts->value(N("BtbEntries"), DFB_BTB_ENTRIES).toUInt();
+    n_ras = sts->value(N("RasEntries"), DFB_RAS_ENTRIES).toUInt();
+}
+
+void BranchPredictorConfig::store(QSettings *sts, const QString &prefix) const {
+    sts->setValue(N("Predictor"), (unsigned)predictor());
+    sts->setValue(N("TableBits"), table_bits());
+    sts->setValue(N("BtbEntries"), btb_entries());
+    sts->setValue(N("RasEntries"), ras_entries());
+}
+
+#undef N
+
+void BranchPredictorConfig::set_predictor(enum Predictor v) {
+    pred = v;
+}
+
+bool BranchPredictorConfig::set_predictor(const QString &kind) {
+    static QMap<QString, enum Predictor> kind_map = {
+        { "none", BP_NOT_TAKEN },
+        { "not-taken", BP_NOT_TAKEN },
+        { "btfn", BP_BTFN },
+        { "1bit", BP_BIMODAL1 },
+        { "2bit", BP_BIMODAL2 },
+        { "bimodal", BP_BIMODAL2 },
+        { "gshare", BP_GSHARE },
+    };
+    if (!kind_map.contains(kind)) {
+        return false;
+    }
+    set_predictor(kind_map.value(kind));
+    return true;
+}
+
+void BranchPredictorConfig::set_table_bits(unsigned v) {
+    // Index is taken from address bits above the 2-byte granule.
+    n_table_bits = v < 24 ? v : 24;
+}
+
+void BranchPredictorConfig::set_btb_entries(unsigned v) {
+    n_btb = v;
+}
+
+void BranchPredictorConfig::set_ras_entries(unsigned v) {
+    n_ras = v;
+}
+
+enum BranchPredictorConfig::Predictor BranchPredictorConfig::predictor() const {
+    return pred;
+}
+
+unsigned BranchPredictorConfig::table_bits() const {
+    return n_table_bits;
+}
+
+unsigned BranchPredictorConfig::btb_entries() const {
+    return n_btb;
+}
+
+unsigned BranchPredictorConfig::ras_entries() const {
+    return n_ras;
+}
+
+bool BranchPredictorConfig::operator==(const BranchPredictorConfig &c) const {
+#define CMP(GETTER) (GETTER)() == (c.GETTER)()
+    return CMP(predictor) && CMP(table_bits) && CMP(btb_entries)
+           && CMP(ras_entries);
+#undef CMP
+}
+
+bool BranchPredictorConfig::operator!=(const BranchPredictorConfig &c) const {
+    return !operator==(c);
+}
+
+OutOfOrderConfig::OutOfOrderConfig() {
+    en = DFO_EN;
+    w_dispatch = w_issue = w_commit = DFO_WIDTH;
+    n_rob = DFO_ROB;
+    n_iq = DFO_IQ;
+    n_lsq = DFO_LSQ;
+    lat_alu = DFO_LAT_ALU;
+    lat_mul = DFO_LAT_MUL;
+    lat_fpu = DFO_LAT_FPU;
+    lat_load = DFO_LAT_LOAD;
+    penalty = DFO_PENALTY;
+}
+
+#define N(STR) (prefix + QString(STR))
+
+OutOfOrderConfig::OutOfOrderConfig(
+    const QSettings *sts,
+    const QString &prefix) {
+    en = sts->value(N("Enabled"), DFO_EN).toBool();
+    w_dispatch = sts->value(N("DispatchWidth"), DFO_WIDTH).toUInt();
+    w_issue = sts->value(N("IssueWidth"), DFO_WIDTH).toUInt();
+    w_commit = sts->value(N("CommitWidth"), DFO_WIDTH).toUInt();
+    n_rob = sts->value(N("RobSize"), DFO_ROB).toUInt();
+    n_iq = sts->value(N("IqSize"), DFO_IQ).toUInt();
+    n_lsq = sts->value(N("LsqSize"), DFO_LSQ).toUInt();
+    lat_alu = sts->value(N("AluLatency"), DFO_LAT_ALU).toUInt();
+    lat_mul = sts->value(N("MulLatency"), DFO_LAT_MUL).toUInt();
+    lat_fpu = sts->value(N("FpuLatency"), DFO_LAT_FPU).toUInt();
+    lat_load = sts->value(N("LoadLatency"), DFO_LAT_LOAD).toUInt();
+    penalty = sts->value(N("MispredictPenalty"), DFO_PENALTY).toUInt();
+}
+
+void OutOfOrderConfig::store(QSettings *sts, const QString &prefix) const {
+    sts->setValue(N("Enabled"), enabled());
+    sts->setValue(N("DispatchWidth"), dispatch_width());
+    sts->setValue(N("IssueWidth"), issue_width());
+    sts->setValue(N("CommitWidth"), commit_width());
+    sts->setValue(N("RobSize"), rob_size());
+    sts->setValue(N("IqSize"), iq_size());
+    sts->setValue(N("LsqSize"), lsq_size());
+    sts->setValue(N("AluLatency"), alu_latency());
+    sts->setValue(N("MulLatency"), mul_latency());
+    sts->setValue(N("FpuLatency"), fpu_latency());
+    sts->setValue(N("LoadLatency"), load_latency());
+    sts->setValue(N("MispredictPenalty"), mispredict_penalty());
+}
+
+#undef N
+
+void OutOfOrderConfig::set_enabled(bool v) {
+    en = v;
+}
+
+void OutOfOrderConfig::set_dispatch_width(unsigned v) {
+    w_dispatch = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_issue_width(unsigned v) {
+    w_issue = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_commit_width(unsigned v) {
+    w_commit = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_rob_size(unsigned v) {
+    n_rob = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_iq_size(unsigned v) {
+    n_iq = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_lsq_size(unsigned v) {
+    n_lsq = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_alu_latency(unsigned v) {
+    lat_alu = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_mul_latency(unsigned v) {
+    lat_mul = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_fpu_latency(unsigned v) {
+    lat_fpu = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_load_latency(unsigned v) {
+    lat_load = v > 0 ? v : 1;
+}
+
+void OutOfOrderConfig::set_mispredict_penalty(unsigned v) {
+    penalty = v;
+}
+
+bool OutOfOrderConfig::enabled() const {
+    return en;
+}
+
+unsigned OutOfOrderConfig::dispatch_width() const {
+    return w_dispatch;
+}
+
+unsigned OutOfOrderConfig::issue_width() const {
+    return w_issue;
+}
+
+unsigned OutOfOrderConfig::commit_width() const {
+    return w_commit;
+}
+
+unsigned OutOfOrderConfig::rob_size() const {
+    return n_rob;
+}
+
+unsigned OutOfOrderConfig::iq_size() const {
+    return n_iq;
+}
+
+unsigned OutOfOrderConfig::lsq_size() const {
+    return n_lsq;
+}
+
+unsigned OutOfOrderConfig::alu_latency() const {
+    return lat_alu;
+}
+
+unsigned OutOfOrderConfig::mul_latency() const {
+    return lat_mul;
+}
+
+unsigned OutOfOrderConfig::fpu_latency() const {
+    return lat_fpu;
+}
+
+unsigned OutOfOrderConfig::load_latency() const {
+    return lat_load;
+}
+
+unsigned OutOfOrderConfig::mispredict_penalty() const {
+    return penalty;
+}
+
+bool OutOfOrderConfig::operator==(const OutOfOrderConfig &c) const {
+#define CMP(GETTER) (GETTER)() == (c.GETTER)()
+    return CMP(enabled) && CMP(dispatch_width) && CMP(issue_width)
+           && CMP(commit_width) && CMP(rob_size) && CMP(iq_size)
+           && CMP(lsq_size) && CMP(alu_latency) && CMP(mul_latency)
+           && CMP(fpu_latency) && CMP(load_latency)
+           && CMP(mispredict_penalty);
+#undef CMP
+}
+
+bool OutOfOrderConfig::operator!=(const OutOfOrderConfig &c) const {
+    return !operator==(c);
+}
+
 MachineConfig::MachineConfig() {
     pipeline = DF_PIPELINE;
     delayslot = DF_DELAYSLOT;
     hunit = DF_HUNIT;
+    iss_width = DF_ISSUE_WIDTH;
+    iss_alu_ports = DF_ISSUE_ALU_PORTS;
+    iss_mul_ports = DF_ISSUE_MUL_PORTS;
+    iss_mem_ports = DF_ISSUE_MEM_PORTS;
     exec_protect = DF_EXEC_PROTEC;
     write_protect = DF_WRITE_PROTEC;
     mem_acc_read = DF_MEM_ACC_READ;
     mem_acc_write = DF_MEM_ACC_WRITE;
     mem_acc_burst = DF_MEM_ACC_BURST;
+    ser_cycles_per_char = 0;
+    ser_tx_fifo = DF_SERIAL_TX_FIFO;
+    ser_rx_fifo = DF_SERIAL_RX_FIFO;
+    n_harts = DF_HART_COUNT;
+    hart_quant = DF_HART_QUANTUM;
     osem_enable = true;
     osem_known_syscall_stop = true;
     osem_unknown_syscall_stop = true;
@@ -165,17 +447,28 @@ MachineConfig::MachineConfig() {
     elf_path = DF_ELF;
     cch_program = CacheConfig();
     cch_data = CacheConfig();
+    bpred = BranchPredictorConfig();
+    ooo = OutOfOrderConfig();
 }
 
 MachineConfig::MachineConfig(const MachineConfig *config) {
     pipeline = config->pipelined();
     delayslot = config->delay_slot();
     hunit = config->hazard_unit();
+    iss_width = config->issue_width();
+    iss_alu_ports = config->issue_alu_ports();
+    iss_mul_ports = config->issue_mul_ports();
+    iss_mem_ports = config->issue_mem_ports();
     exec_protect = config->memory_execute_protection();
     write_protect = config->memory_write_protection();
     mem_acc_read = config->memory_access_time_read();
     mem_acc_write = config->memory_access_time_write();
     mem_acc_burst = config->memory_access_time_burst();
+    ser_cycles_per_char = config->serial_cycles_per_char();
+    ser_tx_fifo = config->serial_tx_fifo_size();
+    ser_rx_fifo = config->serial_rx_fifo_size();
+    n_harts = config->hart_count();
+    hart_quant = config->hart_quantum();
     osem_enable = config->osemu_enable();
     osem_known_syscall_stop = config->osemu_known_syscall_stop();
     osem_unknown_syscall_stop = config->osemu_unknown_syscall_stop();
@@ -186,6 +479,10 @@ MachineConfig::MachineConfig(const MachineConfig *config) {
     elf_path = config->elf();
     cch_program = config->cache_program();
     cch_data = config->cache_data();
+    bpred = config->branch_predictor();
+    ooo = config->out_of_order();
+    simulated_endian = config->get_simulated_endian();
+    simulated_xlen = config->get_simulated_xlen();
 }
 
 #define N(STR) (prefix + QString(STR))
@@ -194,6 +491,10 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     pipeline = sts->value(N("Pipelined"), DF_PIPELINE).toBool();
     delayslot = sts->value(N("DelaySlot"), DF_DELAYSLOT).toBool();
     hunit = (enum HazardUnit)sts->value(N("HazardUnit"), DF_HUNIT).toUInt();
+    iss_width = sts->value(N("IssueWidth"), DF_ISSUE_WIDTH).toUInt();
+    iss_alu_ports = sts->value(N("IssueAluPorts"), DF_ISSUE_ALU_PORTS).toUInt();
+    iss_mul_ports = sts->value(N("IssueMulPorts"), DF_ISSUE_MUL_PORTS).toUInt();
+    iss_mem_ports = sts->value(N("IssueMemPorts"), DF_ISSUE_MEM_PORTS).toUInt();
     exec_protect
         = sts->value(N("MemoryExecuteProtection"), DF_EXEC_PROTEC).toBool();
     write_protect
@@ -201,6 +502,13 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     mem_acc_read = sts->value(N("MemoryRead"), DF_MEM_ACC_READ).toUInt();
     mem_acc_write = sts->value(N("MemoryWrite"), DF_MEM_ACC_WRITE).toUInt();
     mem_acc_burst = sts->value(N("MemoryBurts"), DF_MEM_ACC_BURST).toUInt();
+    ser_cycles_per_char = sts->value(N("SerialCyclesPerChar"), 0).toUInt();
+    ser_tx_fifo
+        = sts->value(N("SerialTxFifoSize"), DF_SERIAL_TX_FIFO).toUInt();
+    ser_rx_fifo
+        = sts->value(N("SerialRxFifoSize"), DF_SERIAL_RX_FIFO).toUInt();
+    n_harts = sts->value(N("HartCount"), DF_HART_COUNT).toUInt();
+    hart_quant = sts->value(N("HartQuantum"), DF_HART_QUANTUM).toUInt();
     osem_enable = sts->value(N("OsemuEnable"), true).toBool();
     osem_known_syscall_stop
         = sts->value(N("OsemuKnownSyscallStop"), true).toBool();
@@ -213,15 +521,26 @@ MachineConfig::MachineConfig(const QSettings *sts, const QString &prefix) {
     elf_path = sts->value(N("Elf"), DF_ELF).toString();
     cch_program = CacheConfig(sts, N("ProgramCache_"));
     cch_data = CacheConfig(sts, N("DataCache_"));
+    bpred = BranchPredictorConfig(sts, N("BranchPredictor_"));
+    ooo = OutOfOrderConfig(sts, N("OutOfOrder_"));
 }
 
 void MachineConfig::store(QSettings *sts, const QString &prefix) {
     sts->setValue(N("Pipelined"), pipelined());
     sts->setValue(N("DelaySlot"), delay_slot());
     sts->setValue(N("HazardUnit"), (unsigned)hazard_unit());
+    sts->setValue(N("IssueWidth"), issue_width());
+    sts->setValue(N("IssueAluPorts"), issue_alu_ports());
+    sts->setValue(N("IssueMulPorts"), issue_mul_ports());
+    sts->setValue(N("IssueMemPorts"), issue_mem_ports());
     sts->setValue(N("MemoryRead"), memory_access_time_read());
     sts->setValue(N("MemoryWrite"), memory_access_time_write());
     sts->setValue(N("MemoryBurts"), memory_access_time_burst());
+    sts->setValue(N("SerialCyclesPerChar"), serial_cycles_per_char());
+    sts->setValue(N("SerialTxFifoSize"), serial_tx_fifo_size());
+    sts->setValue(N("SerialRxFifoSize"), serial_rx_fifo_size());
+    sts->setValue(N("HartCount"), hart_count());
+    sts->setValue(N("HartQuantum"), hart_quantum());
     sts->setValue(N("OsemuEnable"), osemu_enable());
     sts->setValue(N("OsemuKnownSyscallStop"), osemu_known_syscall_stop());
     sts->setValue(N("OsemuUnknownSyscallStop"), osemu_unknown_syscall_stop());
@@ -232,6 +551,8 @@ void MachineConfig::store(QSettings *sts, const QString &prefix) {
     sts->setValue(N("Elf"), elf_path);
     cch_program.store(sts, N("ProgramCache_"));
     cch_data.store(sts, N("DataCache_"));
+    bpred.store(sts, N("BranchPredictor_"));
+    ooo.store(sts, N("OutOfOrder_"));
 }
 
 #undef N
@@ -291,6 +612,22 @@ bool MachineConfig::set_hazard_unit(const QString &hukind) {
     return true;
 }
 
+void MachineConfig::set_issue_width(unsigned v) {
+    iss_width = v > 0 ? v : 1;
+}
+
+void MachineConfig::set_issue_alu_ports(unsigned v) {
+    iss_alu_ports = v;
+}
+
+void MachineConfig::set_issue_mul_ports(unsigned v) {
+    iss_mul_ports = v > 0 ? v : 1;
+}
+
+void MachineConfig::set_issue_mem_ports(unsigned v) {
+    iss_mem_ports = v > 0 ? v : 1;
+}
+
 void MachineConfig::set_memory_execute_protection(bool v) {
     exec_protect = v;
 }
@@ -311,6 +648,26 @@ void MachineConfig::set_memory_access_time_burst(unsigned v) {
     mem_acc_burst = v;
 }
 
+void MachineConfig::set_serial_cycles_per_char(unsigned v) {
+    ser_cycles_per_char = v;
+}
+
+void MachineConfig::set_serial_tx_fifo_size(unsigned v) {
+    ser_tx_fifo = v > 0 ? v : 1;
+}
+
+void MachineConfig::set_serial_rx_fifo_size(unsigned v) {
+    ser_rx_fifo = v > 0 ? v : 1;
+}
+
+void MachineConfig::set_hart_count(unsigned v) {
+    n_harts = v;
+}
+
+void MachineConfig::set_hart_quantum(unsigned v) {
+    hart_quant = v;
+}
+
 void MachineConfig::set_osemu_enable(bool v) {
     osem_enable = v;
 }
@@ -351,10 +708,22 @@ void MachineConfig::set_cache_data(const CacheConfig &c) {
     cch_data = c;
 }
 
+void MachineConfig::set_branch_predictor(const BranchPredictorConfig &c) {
+    bpred = c;
+}
+
+void MachineConfig::set_out_of_order(const OutOfOrderConfig &c) {
+    ooo = c;
+}
+
 void MachineConfig::set_simulated_endian(Endian endian) {
     MachineConfig::simulated_endian = endian;
 }
 
+void MachineConfig::set_simulated_xlen(Xlen xlen) {
+    MachineConfig::simulated_xlen = xlen;
+}
+
 bool MachineConfig::pipelined() const {
     return pipeline;
 }
@@ -369,6 +738,22 @@ enum MachineConfig::HazardUnit MachineConfig::hazard_unit() const {
     return pipeline ? hunit : machine::MachineConfig::HU_NONE;
 }
 
+unsigned MachineConfig::issue_width() const {
+    return iss_width;
+}
+
+unsigned MachineConfig::issue_alu_ports() const {
+    return iss_alu_ports;
+}
+
+unsigned MachineConfig::issue_mul_ports() const {
+    return iss_mul_ports;
+}
+
+unsigned MachineConfig::issue_mem_ports() const {
+    return iss_mem_ports;
+}
+
 bool MachineConfig::memory_execute_protection() const {
     return exec_protect;
 }
@@ -389,6 +774,26 @@ unsigned MachineConfig::memory_access_time_burst() const {
     return mem_acc_burst;
 }
 
+unsigned MachineConfig::serial_cycles_per_char() const {
+    return ser_cycles_per_char;
+}
+
+unsigned MachineConfig::serial_tx_fifo_size() const {
+    return ser_tx_fifo;
+}
+
+unsigned MachineConfig::serial_rx_fifo_size() const {
+    return ser_rx_fifo;
+}
+
+unsigned MachineConfig::hart_count() const {
+    return n_harts > 1 ? n_harts : 1;
+}
+
+unsigned MachineConfig::hart_quantum() const {
+    return hart_quant;
+}
+
 bool MachineConfig::osemu_enable() const {
     return osem_enable;
 }
@@ -433,17 +838,42 @@ CacheConfig *MachineConfig::access_cache_data() {
     return &cch_data;
 }
 
+const BranchPredictorConfig &MachineConfig::branch_predictor() const {
+    return bpred;
+}
+
+BranchPredictorConfig *MachineConfig::access_branch_predictor() {
+    return &bpred;
+}
+
+const OutOfOrderConfig &MachineConfig::out_of_order() const {
+    return ooo;
+}
+
+OutOfOrderConfig *MachineConfig::access_out_of_order() {
+    return &ooo;
+}
+
 Endian MachineConfig::get_simulated_endian() const {
     return simulated_endian;
 }
 
+Xlen MachineConfig::get_simulated_xlen() const {
+    return simulated_xlen;
+}
+
 bool MachineConfig::operator==(const MachineConfig &c) const {
 #define CMP(GETTER) (GETTER)() == (c.GETTER)()
     return CMP(pipelined) && CMP(delay_slot) && CMP(hazard_unit)
+           && CMP(issue_width) && CMP(issue_alu_ports)
+           && CMP(issue_mul_ports) && CMP(issue_mem_ports)
            && CMP(memory_execute_protection) && CMP(memory_write_protection)
            && CMP(memory_access_time_read) && CMP(memory_access_time_write)
-           && CMP(memory_access_time_burst) && CMP(elf) && CMP(cache_program)
-           && CMP(cache_data);
+           && CMP(memory_access_time_burst) && CMP(serial_cycles_per_char)
+           && CMP(serial_tx_fifo_size) && CMP(serial_rx_fifo_size)
+           && CMP(hart_count) && CMP(hart_quantum)
+           && CMP(elf) && CMP(cache_program) && CMP(cache_data)
+           && CMP(branch_predictor) && CMP(out_of_order);
 #undef CMP
 }
 
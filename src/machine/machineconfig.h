@@ -2,6 +2,7 @@
 #define MACHINECONFIG_H
 
 #include "common/endian.h"
+#include "machinedefs.h"
 
 #include <QSettings>
 #include <QString>
@@ -63,6 +64,96 @@ private:
     enum WritePolicy write_pol;
 };
 
+class BranchPredictorConfig {
+public:
+    BranchPredictorConfig();
+    explicit BranchPredictorConfig(
+        const QSettings *,
+        const QString &prefix = "");
+
+    void store(QSettings *, const QString &prefix = "") const;
+
+    enum Predictor {
+        BP_NOT_TAKEN, // Static, conditional branches are never taken
+        BP_BTFN,      // Static, backward taken, forward not taken
+        BP_BIMODAL1,  // Table of last outcomes indexed by address
+        BP_BIMODAL2,  // Table of 2-bit saturating counters
+        BP_GSHARE     // 2-bit counters indexed by address xor global history
+    };
+
+    void set_predictor(enum Predictor);
+    bool set_predictor(const QString &kind);
+    // Table of dynamic predictors has 2^bits entries, gshare keeps the same
+    // number of global history bits.
+    void set_table_bits(unsigned);
+    // Number of branch target buffer entries, zero disables the buffer. Only
+    // transfers found in the buffer can be predicted taken. Out-of-order core
+    // predicts only targets of indirect jumps by it.
+    void set_btb_entries(unsigned);
+    // Depth of return address stack, zero disables it.
+    void set_ras_entries(unsigned);
+
+    enum Predictor predictor() const;
+    unsigned table_bits() const;
+    unsigned btb_entries() const;
+    unsigned ras_entries() const;
+
+    bool operator==(const BranchPredictorConfig &c) const;
+    bool operator!=(const BranchPredictorConfig &c) const;
+
+private:
+    enum Predictor pred;
+    unsigned n_table_bits, n_btb, n_ras;
+};
+
+class OutOfOrderConfig {
+public:
+    OutOfOrderConfig();
+    explicit OutOfOrderConfig(const QSettings *, const QString &prefix = "");
+
+    void store(QSettings *, const QString &prefix = "") const;
+
+    // Timing model of out-of-order core replaces other cores when enabled.
+    void set_enabled(bool);
+    // Instructions renamed, issued and committed per cycle
+    void set_dispatch_width(unsigned);
+    void set_issue_width(unsigned);
+    void set_commit_width(unsigned);
+    // Entries of reorder buffer, issue queue and load/store queue
+    void set_rob_size(unsigned);
+    void set_iq_size(unsigned);
+    void set_lsq_size(unsigned);
+    // Execution latencies in cycles
+    void set_alu_latency(unsigned);
+    void set_mul_latency(unsigned); // Multiplication and division
+    void set_fpu_latency(unsigned);
+    void set_load_latency(unsigned);
+    // Cycles from resolution of mispredicted branch to dispatch of target
+    void set_mispredict_penalty(unsigned);
+
+    bool enabled() const;
+    unsigned dispatch_width() const;
+    unsigned issue_width() const;
+    unsigned commit_width() const;
+    unsigned rob_size() const;
+    unsigned iq_size() const;
+    unsigned lsq_size() const;
+    unsigned alu_latency() const;
+    unsigned mul_latency() const;
+    unsigned fpu_latency() const;
+    unsigned load_latency() const;
+    unsigned mispredict_penalty() const;
+
+    bool operator==(const OutOfOrderConfig &c) const;
+    bool operator!=(const OutOfOrderConfig &c) const;
+
+private:
+    bool en;
+    unsigned w_dispatch, w_issue, w_commit;
+    unsigned n_rob, n_iq, n_lsq;
+    unsigned lat_alu, lat_mul, lat_fpu, lat_load, penalty;
+};
+
 class MachineConfig {
 public:
     MachineConfig();
@@ -85,6 +176,14 @@ public:
     // Hazard unit
     void set_hazard_unit(enum HazardUnit);
     bool set_hazard_unit(const QString &hukind);
+    // Instructions issued per cycle. Width above one selects in-order
+    // multi-issue core (pipeline setting is ignored then).
+    void set_issue_width(unsigned);
+    // Execution ports shared by issue slots of multi-issue and out-of-order
+    // core. Zero ALU ports means one per issue slot.
+    void set_issue_alu_ports(unsigned);
+    void set_issue_mul_ports(unsigned);
+    void set_issue_mem_ports(unsigned);
     // Protect data memory from execution. Only program sections can be
     // executed.
     void set_memory_execute_protection(bool);
@@ -94,6 +193,18 @@ public:
     void set_memory_access_time_read(unsigned);
     void set_memory_access_time_write(unsigned);
     void set_memory_access_time_burst(unsigned);
+    // Serial port transmit time of one character in cycles (0 = immediate).
+    void set_serial_cycles_per_char(unsigned);
+    // Serial port FIFO sizes. TX FIFO is passed to host when full, RX FIFO
+    // is filled from host in advance.
+    void set_serial_tx_fifo_size(unsigned);
+    void set_serial_rx_fifo_size(unsigned);
+    // Number of harts sharing the memory, each has its own core and private
+    // L1 caches kept coherent by snooping.
+    void set_hart_count(unsigned);
+    // Steps each hart runs on its own host thread before harts synchronize.
+    // Zero (default) simulates harts in deterministic lockstep instead.
+    void set_hart_quantum(unsigned);
     // Operating system and exceptions setup
     void set_osemu_enable(bool);
     void set_osemu_known_syscall_stop(bool);
@@ -109,16 +220,29 @@ public:
     // Configure cache
     void set_cache_program(const CacheConfig &);
     void set_cache_data(const CacheConfig &);
+    // Branch prediction of pipelined and out-of-order core
+    void set_branch_predictor(const BranchPredictorConfig &);
+    void set_out_of_order(const OutOfOrderConfig &);
     void set_simulated_endian(Endian endian);
+    void set_simulated_xlen(Xlen xlen);
 
     bool pipelined() const;
     bool delay_slot() const;
     enum HazardUnit hazard_unit() const;
+    unsigned issue_width() const;
+    unsigned issue_alu_ports() const;
+    unsigned issue_mul_ports() const;
+    unsigned issue_mem_ports() const;
     bool memory_execute_protection() const;
     bool memory_write_protection() const;
     unsigned memory_access_time_read() const;
     unsigned memory_access_time_write() const;
     unsigned memory_access_time_burst() const;
+    unsigned serial_cycles_per_char() const;
+    unsigned serial_tx_fifo_size() const;
+    unsigned serial_rx_fifo_size() const;
+    unsigned hart_count() const;
+    unsigned hart_quantum() const;
     bool osemu_enable() const;
     bool osemu_known_syscall_stop() const;
     bool osemu_unknown_syscall_stop() const;
@@ -129,10 +253,15 @@ public:
     QString elf() const;
     const CacheConfig &cache_program() const;
     const CacheConfig &cache_data() const;
+    const BranchPredictorConfig &branch_predictor() const;
+    const OutOfOrderConfig &out_of_order() const;
     Endian get_simulated_endian() const;
+    Xlen get_simulated_xlen() const;
 
     CacheConfig *access_cache_program();
     CacheConfig *access_cache_data();
+    BranchPredictorConfig *access_branch_predictor();
+    OutOfOrderConfig *access_out_of_order();
 
     bool operator==(const MachineConfig &c) const;
     bool operator!=(const MachineConfig &c) const;
@@ -140,15 +269,21 @@ public:
 private:
     bool pipeline, delayslot;
     enum HazardUnit hunit;
+    unsigned iss_width, iss_alu_ports, iss_mul_ports, iss_mem_ports;
     bool exec_protect, write_protect;
     unsigned mem_acc_read, mem_acc_write, mem_acc_burst;
+    unsigned ser_cycles_per_char, ser_tx_fifo, ser_rx_fifo;
+    unsigned n_harts, hart_quant;
     bool osem_enable, osem_known_syscall_stop, osem_unknown_syscall_stop;
     bool osem_interrupt_stop, osem_exception_stop;
     bool res_at_compile;
     QString osem_fs_root;
     QString elf_path;
     CacheConfig cch_program, cch_data;
+    BranchPredictorConfig bpred;
+    OutOfOrderConfig ooo;
     Endian simulated_endian = BIG;
+    Xlen simulated_xlen = Xlen::_32;
 };
 
 } // namespace machine
@@ -18,8 +18,9 @@ enum AccessControl {
     AC_U32,
     AC_I64,
     AC_U64,
-    AC_LOAD_LINKED,
-    AC_STORE_CONDITIONAL,
+    AC_LOAD_LINKED,       // LR, width is given by the instruction
+    AC_STORE_CONDITIONAL, // SC
+    AC_AMO,               // AMO read-modify-write, operation in funct5
     AC_WORD_RIGHT,
     AC_WORD_LEFT,
     AC_CACHE_OP,
@@ -40,6 +41,12 @@ constexpr bool is_special_access(AccessControl type) {
 static_assert(is_special_access(AC_CACHE_OP), "");
 static_assert(is_special_access((AccessControl)13), "");
 
+/** Width of integer registers and addresses (RV32 or RV64). */
+enum class Xlen {
+    _32 = 32,
+    _64 = 64,
+};
+
 enum ExceptionCause {
     EXCAUSE_NONE = 0, // Use zero as default value when no exception is
     // pending.
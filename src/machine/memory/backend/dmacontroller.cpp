@@ -0,0 +1,290 @@
+#include "memory/backend/dmacontroller.h"
+
+#include "common/endian.h"
+
+#include <algorithm>
+
+using namespace machine;
+
+constexpr Offset DMA_CTRL_REG_o = 0x00u;
+constexpr uint32_t DMA_CTRL_START_m = 0x1u;
+constexpr uint32_t DMA_CTRL_IE_m = 0x2u;
+constexpr uint32_t DMA_CTRL_ABORT_m = 0x4u;
+// Burst length is 2^BURST words, BURST is limited to 8 (256 words).
+constexpr uint32_t DMA_CTRL_BURST_m = 0xf00u;
+constexpr unsigned DMA_CTRL_BURST_sh = 8;
+constexpr uint32_t DMA_CTRL_BURST_MAX = 8;
+
+constexpr Offset DMA_STATUS_REG_o = 0x04u;
+constexpr uint32_t DMA_STATUS_BUSY_m = 0x1u;
+constexpr uint32_t DMA_STATUS_DONE_m = 0x2u;
+constexpr uint32_t DMA_STATUS_ERROR_m = 0x4u;
+
+constexpr Offset DMA_DESC_REG_o = 0x08u;
+constexpr Offset DMA_BYTES_REG_o = 0x0cu;
+constexpr Offset DMA_STALL_REG_o = 0x10u;
+
+DmaController::DmaController(
+    Endian simulated_machine_endian,
+    MemoryDataBus *bus,
+    EventQueue *events,
+    unsigned access_read,
+    unsigned access_write,
+    unsigned access_burst)
+    : BackendMemory(simulated_machine_endian)
+    , irq_level(4) // HW interrupt 2
+    , bus(bus)
+    , events(events)
+    , access_read(std::max(access_read, 1u))
+    , access_write(std::max(access_write, 1u))
+    , access_burst(access_burst) {}
+
+DmaController::~DmaController() {
+    abort();
+}
+
+void DmaController::reset() {
+    abort();
+    ctrl_reg = 0;
+    status_reg = 0;
+    desc_reg = 0;
+    bytes_reg = 0;
+    stall_reg = 0;
+    update_irq();
+    notify_regs();
+}
+
+WriteResult DmaController::write(
+    Offset destination,
+    const void *source,
+    size_t size,
+    WriteOptions options) {
+    UNUSED(options)
+    return write_by_u32(
+        destination, source, size,
+        [&](Offset src) {
+            return byteswap_if(
+                read_reg(src), internal_endian != simulated_machine_endian);
+        },
+        [&](Offset src, uint32_t value) {
+            return write_reg(
+                src, byteswap_if(
+                         value, internal_endian != simulated_machine_endian));
+        });
+}
+
+ReadResult DmaController::read(
+    void *destination,
+    Offset source,
+    size_t size,
+    ReadOptions options) const {
+    UNUSED(options)
+    return read_by_u32(destination, source, size, [&](Offset src) {
+        return byteswap_if(
+            read_reg(src), internal_endian != simulated_machine_endian);
+    });
+}
+
+uint32_t DmaController::read_reg(Offset source) const {
+    Q_ASSERT((source & 3U) == 0); // uint32_t aligned
+    switch (source) {
+    case DMA_CTRL_REG_o: return ctrl_reg;
+    case DMA_STATUS_REG_o: return status_reg;
+    case DMA_DESC_REG_o: return desc_reg;
+    case DMA_BYTES_REG_o: return bytes_reg;
+    case DMA_STALL_REG_o: return stall_reg;
+    default: return 0;
+    }
+}
+
+bool DmaController::write_reg(Offset destination, uint32_t value) {
+    Q_ASSERT((destination & 3U) == 0); // uint32_t aligned
+    switch (destination) {
+    case DMA_CTRL_REG_o:
+        ctrl_reg = value & (DMA_CTRL_IE_m | DMA_CTRL_BURST_m);
+        if (value & DMA_CTRL_ABORT_m) {
+            abort();
+        } else if (value & DMA_CTRL_START_m) {
+            start();
+        }
+        update_irq();
+        break;
+    case DMA_STATUS_REG_o:
+        // DONE and ERROR are cleared by writing one.
+        status_reg &= ~(value & (DMA_STATUS_DONE_m | DMA_STATUS_ERROR_m));
+        update_irq();
+        break;
+    case DMA_DESC_REG_o: desc_reg = value; break;
+    default:
+        // Todo show this to user as this is failure of supplied program
+        printf("[WARNING] DmaController: write to non-writable location.\n");
+        return false;
+    }
+    return true;
+}
+
+void DmaController::start() {
+    if (status_reg & DMA_STATUS_BUSY_m) {
+        return;
+    }
+    status_reg = DMA_STATUS_BUSY_m;
+    bytes_reg = 0;
+    stall_reg = 0;
+    desc_addr = desc_reg;
+    fetch_descriptor();
+}
+
+void DmaController::abort() {
+    if (pending != 0) {
+        events->cancel(pending);
+        pending = 0;
+    }
+    status_reg &= ~DMA_STATUS_BUSY_m;
+}
+
+void DmaController::fetch_descriptor() {
+    if (desc_addr == 0) {
+        finish(false);
+        return;
+    }
+    if ((desc_addr & 3U) != 0 || !range_accessible(desc_addr, 16, false)) {
+        finish(true);
+        return;
+    }
+    uint32_t desc[4];
+    bus->read(desc, Address(desc_addr), sizeof(desc), { .type = ae::REGULAR });
+    for (uint32_t &word : desc) {
+        word = byteswap_if(word, NATIVE_ENDIAN != simulated_machine_endian);
+    }
+    src = desc[0];
+    dst = desc[1];
+    remaining = desc[2];
+    next_desc = desc[3];
+    bus_accesses = bus->get_access_counter();
+    // Descriptor is read as a single burst of four words.
+    schedule_burst(
+        access_read + 3 * (access_burst != 0 ? access_burst : access_read));
+}
+
+bool DmaController::range_accessible(
+    uint32_t address,
+    uint32_t size,
+    bool write) const {
+    const uint64_t end = (uint64_t)address + size;
+    if (end > (uint64_t)UINT32_MAX + 1) {
+        return false;
+    }
+    const int denied = LOCSTAT_ILLEGAL | (write ? LOCSTAT_READ_ONLY : 0);
+    // Devices are mapped by whole words, each word is checked once.
+    for (uint64_t addr = address; addr < end;
+         addr = (addr & ~(uint64_t)3) + 4) {
+        if (bus->location_status(Address(addr)) & denied) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t DmaController::burst_cycles(size_t words) const {
+    if (words == 0) {
+        return 0;
+    }
+    uint64_t next_read = access_burst != 0 ? access_burst : access_read;
+    uint64_t next_write = access_burst != 0 ? access_burst : access_write;
+    return access_read + access_write + (words - 1) * (next_read + next_write);
+}
+
+uint32_t DmaController::burst_size() const {
+    return 4U << std::min(
+               (ctrl_reg & DMA_CTRL_BURST_m) >> DMA_CTRL_BURST_sh,
+               DMA_CTRL_BURST_MAX);
+}
+
+void DmaController::schedule_burst(uint64_t delay) {
+    uint32_t n = std::min(remaining, burst_size());
+    delay += burst_cycles((n + 3) / 4);
+    stalled = false;
+    pending = events->schedule_in(
+        std::max<uint64_t>(delay, 1), [this]() { burst_window_end(); });
+}
+
+void DmaController::burst_window_end() {
+    pending = 0;
+    uint64_t core_accesses = bus->get_access_counter() - bus_accesses;
+    // Core has priority, its accesses extend the window. Each window is
+    // extended only once, so the core cannot starve the engine.
+    if (!stalled && core_accesses != 0) {
+        uint64_t stall = core_accesses * access_read;
+        stall_reg += stall;
+        stalled = true;
+        pending = events->schedule_in(stall, [this]() { burst_window_end(); });
+        notify_regs();
+        return;
+    }
+
+    uint32_t n = std::min(remaining, burst_size());
+    // Unmapped memory would not accept the data, the transfer fails instead.
+    if (!range_accessible(src, n, false) || !range_accessible(dst, n, true)) {
+        finish(true);
+        return;
+    }
+    if (n != 0) {
+        // Whole burst is moved at once on host.
+        buffer.resize(n);
+        bus->read(buffer.data(), Address(src), n, { .type = ae::REGULAR });
+        bus->write(Address(dst), buffer.data(), n, { .type = ae::REGULAR });
+        src += n;
+        dst += n;
+        remaining -= n;
+        bytes_reg += n;
+    }
+    bus_accesses = bus->get_access_counter();
+    notify_regs();
+    if (remaining != 0) {
+        schedule_burst(0);
+    } else {
+        desc_addr = next_desc;
+        fetch_descriptor();
+    }
+}
+
+void DmaController::finish(bool error) {
+    status_reg &= ~DMA_STATUS_BUSY_m;
+    status_reg |= DMA_STATUS_DONE_m;
+    if (error) {
+        status_reg |= DMA_STATUS_ERROR_m;
+    }
+    update_irq();
+    notify_regs();
+}
+
+void DmaController::update_irq() {
+    bool active = (ctrl_reg & DMA_CTRL_IE_m)
+                  && (status_reg & (DMA_STATUS_DONE_m | DMA_STATUS_ERROR_m));
+    if (active != irq_active) {
+        irq_active = active;
+        emit signal_interrupt(irq_level, active);
+    }
+}
+
+void DmaController::notify_regs() {
+    emit external_backend_change_notify(
+        this, DMA_CTRL_REG_o, DMA_STALL_REG_o + 3, ae::INTERNAL);
+}
+
+LocationStatus DmaController::location_status(Offset offset) const {
+    switch (offset & ~3U) {
+    case DMA_CTRL_REG_o: FALLTROUGH
+    case DMA_STATUS_REG_o: FALLTROUGH
+    case DMA_DESC_REG_o: {
+        return LOCSTAT_NONE;
+    }
+    case DMA_BYTES_REG_o: FALLTROUGH
+    case DMA_STALL_REG_o: {
+        return LOCSTAT_READ_ONLY;
+    }
+    default: {
+        return LOCSTAT_ILLEGAL;
+    }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef DMACONTROLLER_H
+#define DMACONTROLLER_H
+
+#include "common/endian.h"
+#include "event_queue.h"
+#include "memory/backend/backend_memory.h"
+#include "memory/memory_bus.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace machine {
+
+/**
+ * DMA engine copying memory blocks described by a chain of descriptors.
+ *
+ * Descriptor is four words in simulated memory: source address, destination
+ * address, length in bytes and address of the next descriptor (0 ends the
+ * chain). Data are moved through the memory data bus in bursts (programmable
+ * number of words), each burst is copied at once on host and takes simulated
+ * time given by memory access times. Accesses of the core to the bus during
+ * a burst delay the next one (core has priority), the delay is accumulated in
+ * the stall register. Descriptor or burst touching unmapped (or, for
+ * destination, read-only) memory stops the transfer with error.
+ *
+ * The engine works below caches, it is not coherent with them (like usual
+ * hardware). Program has to write back dirty lines before transfer or use
+ * uncached memory.
+ */
+class DmaController final : public BackendMemory {
+    Q_OBJECT
+public:
+    /**
+     * @param bus           bus used for descriptor fetch and data transfer
+     * @param events        simulated time source
+     * @param access_read   cycles of a single memory read
+     * @param access_write  cycles of a single memory write
+     * @param access_burst  cycles of each following word in burst (0 means
+     *                      no burst support, regular access time is used)
+     */
+    DmaController(
+        Endian simulated_machine_endian,
+        MemoryDataBus *bus,
+        EventQueue *events,
+        unsigned access_read,
+        unsigned access_write,
+        unsigned access_burst);
+    ~DmaController() override;
+
+    /** Abort running transfer and clear all registers. */
+    void reset();
+
+signals:
+    void signal_interrupt(uint irq_level, bool active) const;
+
+public:
+    WriteResult write(
+        Offset destination,
+        const void *source,
+        size_t size,
+        WriteOptions options) override;
+
+    ReadResult read(
+        void *destination,
+        Offset source,
+        size_t size,
+        ReadOptions options) const override;
+
+    LocationStatus location_status(Offset offset) const override;
+
+private:
+    uint32_t read_reg(Offset source) const;
+    bool write_reg(Offset destination, uint32_t value);
+    void start();
+    void abort();
+    /** Load descriptor at `desc_addr`, finish the chain when it is zero. */
+    void fetch_descriptor();
+    /**
+     * Whole range is mapped to devices accepting the access and does not wrap
+     * around the end of address space.
+     */
+    bool range_accessible(uint32_t address, uint32_t size, bool write) const;
+    /** Bytes moved by a single burst. */
+    uint32_t burst_size() const;
+    /** Start transfer window of the next burst after `delay` cycles. */
+    void schedule_burst(uint64_t delay);
+    /** Move data of the burst, when the bus was not taken by core. */
+    void burst_window_end();
+    void finish(bool error);
+    void update_irq();
+    /** Simulated cycles needed to move given number of words. */
+    uint64_t burst_cycles(size_t words) const;
+    void notify_regs();
+
+    /** endian of internal registers of the periphery use. */
+    static constexpr Endian internal_endian = NATIVE_ENDIAN;
+    const uint8_t irq_level;
+    MemoryDataBus *const bus;
+    EventQueue *const events;
+    const unsigned access_read;
+    const unsigned access_write;
+    const unsigned access_burst;
+
+    uint32_t ctrl_reg = 0;
+    uint32_t status_reg = 0;
+    uint32_t desc_reg = 0;
+    uint32_t bytes_reg = 0;
+    uint32_t stall_reg = 0;
+
+    // Current descriptor.
+    uint32_t desc_addr = 0;
+    uint32_t src = 0;
+    uint32_t dst = 0;
+    uint32_t remaining = 0;
+    uint32_t next_desc = 0;
+
+    EventQueue::EventId pending = 0;
+    /** Bus accesses observed after the last burst (own accesses included). */
+    uint64_t bus_accesses = 0;
+    /** Current window was already extended by core accesses. */
+    bool stalled = false;
+    std::vector<uint8_t> buffer;
+    bool irq_active = false;
+};
+
+} // namespace machine
+
+#endif // DMACONTROLLER_H
@@ -16,7 +16,9 @@ LcdDisplay::LcdDisplay(Endian simulated_machine_endian)
     , fb_width(480)
     , fb_height(320)
     , fb_bits_per_pixel(16)
-    , fb_data(get_fb_size_bytes(), 0) {}
+    , fb_data(get_fb_size_bytes(), 0) {
+    since_flush.start();
+}
 
 LcdDisplay::~LcdDisplay() = default;
 
@@ -93,35 +95,64 @@ bool LcdDisplay::write_reg(Offset destination, uint32_t value) {
 
     memcpy(&fb_data[destination], &value, sizeof(value));
 
-    size_t x, y;
-    std::tie(x, y) = get_pixel_from_address(destination);
-
-    const uint32_t last_addr = destination + 3;
-    uint32_t pixel_addr;
-    uint32_t pixek_data;
-    uint r, g, b;
-
-    while ((pixel_addr = get_address_from_pixel(x, y)) <= last_addr) {
-        pixek_data = fb_data[pixel_addr] << 8u;
-        pixek_data |= fb_data[pixel_addr + 1];
+    size_t x1, y1, x2, y2;
+    std::tie(x1, y1) = get_pixel_from_address(destination);
+    std::tie(x2, y2) = get_pixel_from_address(destination + 3);
+    if (y1 != y2) {
+        // Word crosses line boundary, whole lines are updated.
+        x1 = 0;
+        x2 = fb_width - 1;
+    }
+    if (!dirty) {
+        dirty = true;
+        dirty_x1 = x1;
+        dirty_y1 = y1;
+        dirty_x2 = x2;
+        dirty_y2 = y2;
+    } else {
+        dirty_x1 = std::min(dirty_x1, x1);
+        dirty_y1 = std::min(dirty_y1, y1);
+        dirty_x2 = std::max(dirty_x2, x2);
+        dirty_y2 = std::max(dirty_y2, y2);
+    }
+    flush_dirty_region();
 
-        r = ((pixek_data >> 11u) & 0x1fu) << 3u;
-        g = ((pixek_data >> 5u) & 0x3fu) << 2u;
-        b = ((pixek_data >> 0u) & 0x1fu) << 3u;
+    emit write_notification(destination, value);
 
-        emit pixel_update(x, y, r, g, b);
+    return true;
+}
 
-        if (++x >= fb_width) {
-            x = 0;
-            y++;
-        }
+void LcdDisplay::flush_dirty_region(bool force) {
+    if (!dirty || signalsBlocked()
+        || (!force && since_flush.elapsed() < FRAME_INTERVAL_MS)) {
+        return;
     }
+    size_t x, y, width, height;
+    take_dirty_region(x, y, width, height);
+    since_flush.restart();
+    emit region_update(x, y, width, height);
+}
 
-    emit write_notification(destination, value);
-
+bool LcdDisplay::take_dirty_region(
+    size_t &x,
+    size_t &y,
+    size_t &width,
+    size_t &height) {
+    if (!dirty) {
+        return false;
+    }
+    dirty = false;
+    x = dirty_x1;
+    y = dirty_y1;
+    width = dirty_x2 - dirty_x1 + 1;
+    height = dirty_y2 - dirty_y1 + 1;
     return true;
 }
 
+const byte *LcdDisplay::get_fb_data() const {
+    return fb_data.data();
+}
+
 size_t LcdDisplay::get_address_from_pixel(size_t x, size_t y) const {
     size_t address = y * get_fb_line_size();
     if (fb_bits_per_pixel > 12) {
@@ -6,6 +6,7 @@
 #include "memory/backend/backend_memory.h"
 #include "simulator_exception.h"
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QObject>
 #include <cstdint>
@@ -21,7 +22,13 @@ public:
 signals:
     void write_notification(Offset offset, uint32_t value) const;
     void read_notification(Offset offset, uint32_t value) const;
-    void pixel_update(size_t x, size_t y, uint r, uint g, uint b);
+    /**
+     * Framebuffer area modified since previous notification.
+     *
+     * Emitted at most once per frame (see `flush_dirty_region`), pixels are
+     * to be read from `get_fb_data`.
+     */
+    void region_update(size_t x, size_t y, size_t width, size_t height) const;
 
 public:
     WriteResult write(
@@ -52,6 +59,36 @@ public:
         return fb_height;
     }
 
+    /**
+     * Raw framebuffer content (RGB565, big endian).
+     */
+    const byte *get_fb_data() const;
+    size_t get_fb_line_size() const;
+
+    /**
+     * Emit `region_update` for pixels modified since the last flush.
+     *
+     * Writes flush by themselves, but only once per `FRAME_INTERVAL_MS`.
+     * Simulation loop forces flush at the end of each update tick so the
+     * last written pixels are not left behind.
+     *
+     * @param force     ignore frame rate limit
+     */
+    void flush_dirty_region(bool force = false);
+
+    /**
+     * Take pixels modified since the last flush without emitting
+     * `region_update`. Background run copies them into machine snapshot
+     * while signals of the display are blocked (and flush does nothing).
+     *
+     * @return  false when no pixel was modified
+     */
+    bool take_dirty_region(
+        size_t &x,
+        size_t &y,
+        size_t &width,
+        size_t &height);
+
 private:
     /** Endian internal registers of the periphery (framebuffer) use. */
     static constexpr Endian internal_endian = BIG;
@@ -62,7 +99,6 @@ private:
     /** Write HW register - allows only 32bit aligned access */
     bool write_reg(Offset destination, uint32_t value);
 
-    size_t get_fb_line_size() const;
     size_t get_fb_size_bytes() const;
     size_t get_address_from_pixel(size_t x, size_t y) const;
     std::tuple<size_t, size_t> get_pixel_from_address(size_t address) const;
@@ -71,6 +107,12 @@ private:
     const size_t fb_height; //> Height in pixels
     const size_t fb_bits_per_pixel;
     std::vector<byte> fb_data;
+
+    static constexpr qint64 FRAME_INTERVAL_MS = 16;
+    /** Bounding box of pixels changed since last flush (inclusive). */
+    bool dirty = false;
+    size_t dirty_x1 = 0, dirty_y1 = 0, dirty_x2 = 0, dirty_y2 = 0;
+    QElapsedTimer since_flush;
 };
 
 } // namespace machine
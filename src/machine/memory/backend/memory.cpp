@@ -120,7 +120,7 @@ constexpr size_t tree_row_bit_offset(size_t i) {
 /*
  * Select branch index from memory tree.
  */
-constexpr size_t get_tree_row(size_t offset, size_t i) {
+constexpr size_t get_tree_row(Offset offset, size_t i) {
     return (offset & generate_mask(MEMORY_TREE_BITS, tree_row_bit_offset(i)))
            >> tree_row_bit_offset(i);
 }
@@ -138,27 +138,68 @@ Memory::Memory(Endian simulated_machine_endian)
 Memory::Memory(const Memory &other)
     : BackendMemory(other.simulated_machine_endian) {
     this->mt_root = copy_section_tree(other.get_memory_tree_root(), 0);
+    copy_high_roots(other);
 }
 
 Memory::~Memory() {
     free_section_tree(this->mt_root, 0);
     delete[] this->mt_root;
+    free_high_roots();
 }
 
 void Memory::reset() {
     free_section_tree(this->mt_root, 0);
     delete[] this->mt_root;
     this->mt_root = allocate_section_tree();
+    free_high_roots();
 }
 
 void Memory::reset(const Memory &m) {
     free_section_tree(this->mt_root, 0);
+    delete[] this->mt_root;
     this->mt_root = copy_section_tree(m.get_memory_tree_root(), 0);
+    free_high_roots();
+    copy_high_roots(m);
+}
+
+union MemoryTree *Memory::get_tree_root(Offset offset, bool create) const {
+    const uint64_t block = offset >> 32;
+    if (block == 0) {
+        return this->mt_root;
+    }
+    auto it = mt_high_roots.find(block);
+    if (it != mt_high_roots.end()) {
+        return it->second;
+    }
+    if (!create) {
+        return nullptr;
+    }
+    union MemoryTree *root = allocate_section_tree();
+    mt_high_roots.emplace(block, root);
+    return root;
+}
+
+void Memory::free_high_roots() {
+    for (auto &block : mt_high_roots) {
+        free_section_tree(block.second, 0);
+        delete[] block.second;
+    }
+    mt_high_roots.clear();
 }
 
-MemorySection *Memory::get_section(size_t offset, bool create) const {
-    union MemoryTree *w = this->mt_root;
+void Memory::copy_high_roots(const Memory &other) {
+    for (const auto &block : other.mt_high_roots) {
+        mt_high_roots.emplace(
+            block.first, copy_section_tree(block.second, 0));
+    }
+}
+
+MemorySection *Memory::get_section(Offset offset, bool create) const {
+    union MemoryTree *w = get_tree_root(offset, create);
     size_t row_num;
+    if (w == nullptr) {
+        return nullptr;
+    }
     // Walk memory tree branch from root to leaf and create new nodes when
     // needed and requested (`create` flag).
     for (size_t i = 0; i < (MEMORY_TREE_DEPTH - 1); i++) {
@@ -184,7 +225,7 @@ MemorySection *Memory::get_section(size_t offset, bool create) const {
     return w[row_num].sec;
 }
 
-size_t get_section_offset_mask(size_t addr) {
+size_t get_section_offset_mask(Offset addr) {
     return addr & generate_mask(MEMORY_SECTION_BITS, 0);
 }
 
@@ -232,7 +273,18 @@ uint32_t Memory::get_change_counter() const {
 }
 
 bool Memory::operator==(const Memory &m) const {
-    return compare_section_tree(this->mt_root, m.get_memory_tree_root(), 0);
+    if (!compare_section_tree(this->mt_root, m.get_memory_tree_root(), 0)
+        || mt_high_roots.size() != m.mt_high_roots.size()) {
+        return false;
+    }
+    for (const auto &block : mt_high_roots) {
+        auto it = m.mt_high_roots.find(block.first);
+        if (it == m.mt_high_roots.end()
+            || !compare_section_tree(block.second, it->second, 0)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool Memory::operator!=(const Memory &m) const {
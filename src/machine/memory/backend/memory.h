@@ -11,6 +11,7 @@
 
 #include <QObject>
 #include <cstdint>
+#include <map>
 
 namespace machine {
 
@@ -71,6 +72,9 @@ union MemoryTree {
 /**
  * NOTE: Internal endian of memory must be the same as endian of the whole
  * simulated machine. Therefore it does not have internal_endian field.
+ *
+ * The lookup tree covers 32-bit address space. Addresses above it (RV64) are
+ * split to 4 GiB blocks, each with its own tree allocated on the first write.
  */
 class Memory final : public BackendMemory {
     Q_OBJECT
@@ -85,7 +89,7 @@ public:
     void reset(const Memory &);
 
     // returns section containing given address
-    MemorySection *get_section(size_t offset, bool create) const;
+    MemorySection *get_section(Offset offset, bool create) const;
 
     WriteResult write(
         Offset destination,
@@ -108,7 +112,12 @@ public:
 
 private:
     union MemoryTree *mt_root;
+    // Trees of 4 GiB blocks above 32-bit address space indexed by block.
+    mutable std::map<uint64_t, union MemoryTree *> mt_high_roots;
     uint32_t change_counter = 0;
+    union MemoryTree *get_tree_root(Offset offset, bool create) const;
+    void free_high_roots();
+    void copy_high_roots(const Memory &);
     static union MemoryTree *allocate_section_tree();
     static void free_section_tree(union MemoryTree *, size_t depth);
     static bool compare_section_tree(
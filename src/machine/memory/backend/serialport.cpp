@@ -19,27 +19,140 @@ constexpr Offset SERP_TX_ST_REG_IE_m = 0x2u;
 
 constexpr Offset SERP_TX_DATA_REG_o = 0xcu;
 
-SerialPort::SerialPort(Endian simulated_machine_endian)
+// FIFO registers: bits 15..0 current level (read only), bits 31..16 interrupt
+// threshold.
+constexpr Offset SERP_RX_FIFO_REG_o = 0x10u;
+constexpr Offset SERP_TX_FIFO_REG_o = 0x14u;
+constexpr uint32_t SERP_FIFO_LEVEL_m = 0xffffu;
+constexpr unsigned SERP_FIFO_THRESHOLD_sh = 16;
+
+SerialPort::SerialPort(
+    Endian simulated_machine_endian,
+    size_t tx_fifo_size,
+    size_t rx_fifo_size)
     : BackendMemory(simulated_machine_endian)
     , tx_irq_level(2)
     , rx_irq_level(3) // HW interrupt 1
-{}
+    , tx_fifo_size(std::max<size_t>(tx_fifo_size, 1))
+    , rx_fifo_size(std::max<size_t>(rx_fifo_size, 1))
+    , tx_threshold(this->tx_fifo_size - 1) {
+    tx_fifo.reserve(this->tx_fifo_size);
+    since_tx_flush.start();
+}
 
-SerialPort::~SerialPort() = default;
+SerialPort::~SerialPort() {
+    flush_tx(true);
+}
 
-void SerialPort::pool_rx_byte() const {
-    unsigned int byte = 0;
-    bool available = false;
-    if (!(rx_st_reg & SERP_RX_ST_REG_READY_m)) {
-        rx_st_reg |= SERP_RX_ST_REG_READY_m;
+void SerialPort::pool_rx_bytes(bool only_when_empty) const {
+    if (only_when_empty && !rx_fifo.empty()) {
+        return;
+    }
+    while (!rx_held && rx_fifo.size() < rx_fifo_size) {
+        unsigned int byte = 0;
+        bool available = false;
         emit rx_byte_pool(0, byte, available);
-        if (available) {
-            change_counter++;
-            rx_data_reg = byte;
-        } else {
-            rx_st_reg &= ~SERP_RX_ST_REG_READY_m;
+        if (!available) {
+            break;
+        }
+        change_counter++;
+        rx_fifo.push_back(byte);
+    }
+    if (rx_fifo.empty()) {
+        rx_st_reg &= ~SERP_RX_ST_REG_READY_m;
+    } else {
+        rx_st_reg |= SERP_RX_ST_REG_READY_m;
+    }
+}
+
+void SerialPort::set_char_timing(EventQueue *events, uint32_t cycles_per_char) {
+    this->events = events;
+    this->cycles_per_char = events != nullptr ? cycles_per_char : 0;
+}
+
+size_t SerialPort::tx_level() const {
+    return tx_fifo.size() - tx_sent;
+}
+
+void SerialPort::tx_push(uint8_t data) {
+    if (cycles_per_char == 0) {
+        tx_fifo.append((char)data);
+        if ((size_t)tx_fifo.size() >= tx_fifo_size) {
+            flush_tx(true);
         }
+        return;
+    }
+    if (tx_level() >= tx_fifo_size) {
+        return; // Not ready, character is lost.
+    }
+    tx_fifo.append((char)data);
+    tx_start();
+}
+
+void SerialPort::tx_start() {
+    if (tx_busy || tx_level() == 0) {
+        return;
+    }
+    tx_busy = true;
+    events->schedule_in(cycles_per_char, [this]() { tx_char_sent(); });
+}
+
+void SerialPort::tx_char_sent() {
+    tx_busy = false;
+    tx_sent++;
+    if ((size_t)tx_sent >= tx_fifo_size) {
+        flush_tx(true);
     }
+    update_tx_irq();
+    emit external_backend_change_notify(
+        this, SERP_TX_ST_REG_o, SERP_TX_FIFO_REG_o + 3, ae::INTERNAL);
+    tx_start();
+}
+
+void SerialPort::flush_tx(bool force) {
+    if (tx_fifo.isEmpty()
+        || (!force && since_tx_flush.elapsed() < TX_FLUSH_INTERVAL_MS)) {
+        return;
+    }
+    if (cycles_per_char == 0) {
+        emit tx_bytes(tx_fifo);
+        tx_fifo.clear();
+    } else {
+        if (tx_sent == 0) {
+            return;
+        }
+        emit tx_bytes(tx_fifo.left(tx_sent));
+        tx_fifo.remove(0, tx_sent);
+        tx_sent = 0;
+    }
+    since_tx_flush.restart();
+    update_tx_irq();
+}
+
+void SerialPort::reset() {
+    flush_tx(true);
+    tx_fifo.clear();
+    tx_sent = 0;
+    tx_busy = false;
+    tx_st_reg = 0;
+    rx_st_reg &= ~SERP_RX_ST_REG_IE_m;
+    tx_threshold = tx_fifo_size - 1;
+    rx_threshold = 1;
+    update_tx_irq();
+    update_rx_irq();
+    emit external_backend_change_notify(
+        this, SERP_RX_ST_REG_o, SERP_TX_FIFO_REG_o + 3, ae::INTERNAL);
+}
+
+void SerialPort::hold_rx(bool hold) {
+    if (hold && !rx_held) {
+        // Input arriving during the hold waits for the next one.
+        pool_rx_bytes(false);
+        update_rx_irq();
+        emit external_backend_change_notify(
+            this, SERP_RX_ST_REG_o, SERP_RX_FIFO_REG_o + 3, ae::INTERNAL);
+    }
+    rx_held = hold;
 }
 
 WriteResult SerialPort::write(
@@ -75,7 +188,7 @@ ReadResult SerialPort::read(
 
 void SerialPort::update_rx_irq() const {
     bool active = (rx_st_reg & SERP_RX_ST_REG_IE_m) != 0;
-    active &= (rx_st_reg & SERP_RX_ST_REG_READY_m) != 0;
+    active &= rx_fifo.size() >= rx_threshold;
     if (active != rx_irq_active) {
         rx_irq_active = active;
         emit signal_interrupt(rx_irq_level, active);
@@ -84,20 +197,25 @@ void SerialPort::update_rx_irq() const {
 
 void SerialPort::rx_queue_check_internal() const {
     if (rx_st_reg & SERP_RX_ST_REG_IE_m) {
-        pool_rx_byte();
+        pool_rx_bytes(true);
     }
     update_rx_irq();
 }
 
 void SerialPort::rx_queue_check() const {
-    rx_queue_check_internal();
+    // Host signals new input, fill the FIFO even if it is not empty (to reach
+    // interrupt threshold).
+    if (rx_st_reg & SERP_RX_ST_REG_IE_m) {
+        pool_rx_bytes(false);
+    }
+    update_rx_irq();
     emit external_backend_change_notify(
-        this, SERP_RX_ST_REG_o, SERP_RX_DATA_REG_o + 3, ae::INTERNAL);
+        this, SERP_RX_ST_REG_o, SERP_RX_FIFO_REG_o + 3, ae::INTERNAL);
 }
 
 void SerialPort::update_tx_irq() const {
     bool active = (tx_st_reg & SERP_TX_ST_REG_IE_m) != 0;
-    active &= (tx_st_reg & SERP_TX_ST_REG_READY_m) != 0;
+    active &= tx_level() <= tx_threshold;
     if (active != tx_irq_active) {
         tx_irq_active = active;
         emit signal_interrupt(tx_irq_level, active);
@@ -111,18 +229,21 @@ uint32_t SerialPort::read_reg(Offset source, AccessEffects type) const {
 
     switch (source) {
     case SERP_RX_ST_REG_o:
-        pool_rx_byte();
+        pool_rx_bytes(true);
         value = rx_st_reg;
         break;
     case SERP_RX_DATA_REG_o:
-        pool_rx_byte();
-        if (rx_st_reg & SERP_RX_ST_REG_READY_m) {
-            value = rx_data_reg;
+        pool_rx_bytes(true);
+        if (!rx_fifo.empty()) {
+            value = rx_fifo.front();
             if (type == ae::REGULAR) {
-                rx_st_reg &= ~SERP_RX_ST_REG_READY_m;
+                rx_fifo.pop_front();
+                if (rx_fifo.empty()) {
+                    rx_st_reg &= ~SERP_RX_ST_REG_READY_m;
+                }
                 update_rx_irq();
                 emit external_backend_change_notify(
-                    this, SERP_RX_ST_REG_o, SERP_RX_DATA_REG_o + 3,
+                    this, SERP_RX_ST_REG_o, SERP_RX_FIFO_REG_o + 3,
                     ae::INTERNAL);
             }
         } else {
@@ -130,7 +251,20 @@ uint32_t SerialPort::read_reg(Offset source, AccessEffects type) const {
         }
         rx_queue_check_internal();
         break;
-    case SERP_TX_ST_REG_o: value = tx_st_reg | SERP_TX_ST_REG_READY_m; break;
+    case SERP_TX_ST_REG_o:
+        value = tx_st_reg;
+        if (tx_level() < tx_fifo_size) {
+            value |= SERP_TX_ST_REG_READY_m;
+        }
+        break;
+    case SERP_RX_FIFO_REG_o:
+        value = (rx_fifo.size() & SERP_FIFO_LEVEL_m)
+                | (rx_threshold << SERP_FIFO_THRESHOLD_sh);
+        break;
+    case SERP_TX_FIFO_REG_o:
+        value = (tx_level() & SERP_FIFO_LEVEL_m)
+                | (tx_threshold << SERP_FIFO_THRESHOLD_sh);
+        break;
     default:
         printf(
             "WARNING: Serial port - read out of range (at 0x%ld).\n", source);
@@ -159,7 +293,18 @@ bool SerialPort::write_reg(Offset destination, uint32_t value) {
             update_tx_irq();
             return true;
         case SERP_TX_DATA_REG_o:
-            emit tx_byte(value & 0xffu);
+            tx_push(value & 0xffu);
+            update_tx_irq();
+            return true;
+        case SERP_RX_FIFO_REG_o:
+            rx_threshold = std::min<uint32_t>(
+                std::max<uint32_t>(value >> SERP_FIFO_THRESHOLD_sh, 1),
+                rx_fifo_size);
+            rx_queue_check_internal();
+            return true;
+        case SERP_TX_FIFO_REG_o:
+            tx_threshold = std::min<uint32_t>(
+                value >> SERP_FIFO_THRESHOLD_sh, tx_fifo_size - 1);
             update_tx_irq();
             return true;
         default:
@@ -178,6 +323,8 @@ LocationStatus SerialPort::location_status(Offset offset) const {
     switch (offset & ~3U) {
     case SERP_RX_ST_REG_o: FALLTROUGH
     case SERP_TX_ST_REG_o: FALLTROUGH
+    case SERP_RX_FIFO_REG_o: FALLTROUGH
+    case SERP_TX_FIFO_REG_o: FALLTROUGH
     case SERP_TX_DATA_REG_o: // This is actually write only, but there is no
                              // enum for that.
     {
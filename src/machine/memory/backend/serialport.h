@@ -2,22 +2,80 @@
 #define SERIALPORT_H
 
 #include "common/endian.h"
+#include "event_queue.h"
 #include "memory/backend/backend_memory.h"
 #include "memory/backend/peripheral.h"
 #include "simulator_exception.h"
 
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <cstdint>
+#include <deque>
 
 namespace machine {
 
+/**
+ * UART with receive and transmit FIFO.
+ *
+ * Transmitted characters are collected in the TX FIFO and passed to the host
+ * in chunks (`tx_bytes`), when the FIFO fills up or by `flush_tx`, which is
+ * limited to one chunk per `TX_FLUSH_INTERVAL_MS`. Received
+ * characters are pulled from the host (`rx_byte_pool`) into the RX FIFO.
+ *
+ * Both FIFOs have programmable interrupt threshold. RX interrupt is requested
+ * when at least threshold characters are waiting, TX interrupt when at most
+ * threshold characters are pending. Defaults (RX 1, TX size - 1) behave as
+ * a plain single character UART.
+ *
+ * Optionally, transmission takes simulated time (see `set_char_timing`).
+ */
 class SerialPort : public BackendMemory {
     Q_OBJECT
 public:
-    explicit SerialPort(Endian simulated_machine_endian);
+    /**
+     * @param tx_fifo_size  characters collected before forced flush to host
+     * @param rx_fifo_size  characters pulled from host in advance
+     */
+    explicit SerialPort(
+        Endian simulated_machine_endian,
+        size_t tx_fifo_size = 4096,
+        size_t rx_fifo_size = 64);
     ~SerialPort() override;
 
+    /**
+     * Pass pending transmitted characters to host.
+     *
+     * Called by simulation loop after each update tick.
+     *
+     * @param force     ignore `TX_FLUSH_INTERVAL_MS` since previous flush
+     */
+    void flush_tx(bool force = false);
+
+    /**
+     * Each transmitted character occupies the line for `cycles_per_char`
+     * machine cycles. TX FIFO level, ready bit and interrupt then follow
+     * characters not sent yet. Zero (default) sends characters immediately.
+     */
+    void set_char_timing(EventQueue *events, uint32_t cycles_per_char);
+
+    /**
+     * Return registers and TX FIFO to power-on state. Characters already
+     * sent are passed to host, the rest is dropped. RX FIFO holds host input
+     * and is kept. Pending transmission event has to be dropped by resetting
+     * the event queue.
+     */
+    void reset();
+
+    /**
+     * While held, reads are served from the RX FIFO only and the host is not
+     * asked for more input. The FIFO is filled when the hold starts. Harts
+     * running on separate threads must not call the host, which may be
+     * blocked waiting for them.
+     */
+    void hold_rx(bool hold);
+
 signals:
-    void tx_byte(unsigned int data);
+    void tx_bytes(const QByteArray &data);
     void rx_byte_pool(int fd, unsigned int &data, bool &available) const;
     void write_notification(Offset address, uint32_t value);
     void read_notification(Offset address, uint32_t value) const;
@@ -45,21 +103,44 @@ private:
     uint32_t read_reg(Offset source, AccessEffects type) const;
     bool write_reg(Offset destination, uint32_t value);
     void rx_queue_check_internal() const;
-    void pool_rx_byte() const;
+    /**
+     * Pull characters from host until RX FIFO is full or host has no more.
+     *
+     * @param only_when_empty   do not ask host while there are unread chars
+     */
+    void pool_rx_bytes(bool only_when_empty) const;
+    void tx_push(uint8_t data);
+    /** Characters in TX FIFO, which were not sent yet. */
+    size_t tx_level() const;
+    void tx_start();
+    void tx_char_sent();
     void update_rx_irq() const;
     void update_tx_irq() const;
     uint32_t get_change_counter() const;
 
     /** endian of internal registers of the periphery use. */
     static constexpr Endian internal_endian = NATIVE_ENDIAN;
+    static constexpr qint64 TX_FLUSH_INTERVAL_MS = 16;
     const uint8_t tx_irq_level;
     const uint8_t rx_irq_level;
+    const size_t tx_fifo_size;
+    const size_t rx_fifo_size;
     mutable uint32_t change_counter = { 0 };
     mutable uint32_t tx_st_reg = { 0 };
     mutable uint32_t rx_st_reg = { 0 };
-    mutable uint32_t rx_data_reg = { 0 };
+    uint32_t tx_threshold;
+    uint32_t rx_threshold = 1;
+    QByteArray tx_fifo;
+    EventQueue *events = nullptr;
+    uint32_t cycles_per_char = 0;
+    // Leading part of `tx_fifo` already sent, waiting for flush to host.
+    int tx_sent = 0;
+    bool tx_busy = false;
+    QElapsedTimer since_tx_flush;
+    mutable std::deque<uint8_t> rx_fifo;
     mutable bool tx_irq_active = false;
     mutable bool rx_irq_active = false;
+    bool rx_held = false;
 };
 
 } // namespace machine
@@ -33,6 +33,7 @@ Cache::Cache(
             config->set_count(),
             { .valid = false,
               .dirty = false,
+              .exclusive = false,
               .tag = 0,
               .data = std::vector<uint32_t>(config->block_size()) }));
 }
@@ -44,8 +45,13 @@ WriteResult Cache::write(
     const void *source,
     size_t size,
     WriteOptions options) {
+    const auto guard = coherence_guard();
     if (!cache_config.enabled() || is_in_uncached_area(destination)
         || is_in_uncached_area(destination + size)) {
+        if (coherence != nullptr && !is_in_uncached_area(destination)) {
+            coherence->transaction(
+                this, BUS_WRITE, destination, destination + (size - 1));
+        }
         mem_writes++;
         emit memory_writes_update(mem_writes);
         update_all_statistics();
@@ -65,14 +71,37 @@ WriteResult Cache::write(
         return mem->write(destination, source, size, options);
     }
 
+    // Write is held in the cache, reservations are kept by the bus.
+    mem->invalidate_reservations(destination, destination + (size - 1));
     return { .n_bytes = size, .changed = changed };
 }
 
+void Cache::reserve(unsigned hart, Address address) {
+    const auto guard = coherence_guard();
+    mem->reserve(hart, address);
+}
+
+bool Cache::take_reservation(unsigned hart, Address address) {
+    const auto guard = coherence_guard();
+    return mem->take_reservation(hart, address);
+}
+
+void Cache::invalidate_reservations(Address start_addr, Address last_addr) {
+    const auto guard = coherence_guard();
+    mem->invalidate_reservations(start_addr, last_addr);
+}
+
+void Cache::atomic_access(const std::function<void()> &sequence) {
+    const auto guard = coherence_guard();
+    mem->atomic_access(sequence);
+}
+
 ReadResult Cache::read(
     void *destination,
     Address source,
     size_t size,
     ReadOptions options) const {
+    const auto guard = coherence_guard();
     if (!cache_config.enabled() || is_in_uncached_area(source)
         || is_in_uncached_area(source + size)) {
         mem_reads++;
@@ -98,6 +127,47 @@ bool Cache::is_in_uncached_area(Address source) const {
     return (source >= uncached_start && source <= uncached_last);
 }
 
+void Cache::set_coherence(CoherenceBus *bus) {
+    coherence = bus;
+    bus->attach(this);
+}
+
+SnoopResult
+Cache::snoop(Address start_addr, Address last_addr, bool invalidate) {
+    SnoopResult result;
+    if (!cache_config.enabled()) {
+        return result;
+    }
+    const uint64_t block_bytes = cache_config.block_size() * BLOCK_ITEM_SIZE;
+    uint64_t block = start_addr.get_raw() - start_addr.get_raw() % block_bytes;
+    for (; block <= last_addr.get_raw(); block += block_bytes) {
+        const CacheLocation loc = compute_location(Address(block));
+        const size_t way = find_block_index(loc);
+        if (way >= cache_config.associativity()) {
+            continue;
+        }
+        struct CacheLine &cd = dt[way][loc.row];
+        result.held = true;
+        result.written_back |= write_back(way, loc.row);
+        if (invalidate) {
+            kick(way, loc.row);
+            emit cache_update(way, loc.row, 0, false, false, 0, nullptr, false);
+            continue;
+        }
+        cd.exclusive = false;
+        record_block_change(cd.tag, loc.row);
+        for (size_t col = 0; col < cache_config.block_size(); col++) {
+            emit cache_update(
+                way, loc.row, col, cd.valid, cd.dirty, cd.tag, cd.data.data(),
+                false);
+        }
+    }
+    if (result.written_back) {
+        update_all_statistics();
+    }
+    return result;
+}
+
 void Cache::flush() {
     if (!cache_config.enabled()) {
         return;
@@ -115,6 +185,7 @@ void Cache::flush() {
         }
     }
     change_counter++;
+    record_changed_range(0x0_addr, 0xffffffff_addr);
     update_all_statistics();
 }
 
@@ -143,11 +214,10 @@ void Cache::reset() {
     burst_reads = 0;
     burst_writes = 0;
 
-    emit hit_update(get_hit_count());
-    emit miss_update(get_miss_count());
-    emit memory_reads_update(get_read_count());
-    emit memory_writes_update(get_write_count());
-    update_all_statistics();
+    // Content is gone as a whole, there is no point in being more precise.
+    record_changed_range(0x0_addr, 0xffffffff_addr);
+
+    refresh_statistics();
 
     if (cache_config.enabled()) {
         for (size_t assoc_index = 0; assoc_index < cache_config.associativity();
@@ -161,6 +231,14 @@ void Cache::reset() {
     }
 }
 
+void Cache::refresh_statistics() const {
+    emit hit_update(get_hit_count());
+    emit miss_update(get_miss_count());
+    emit memory_reads_update(get_read_count());
+    emit memory_writes_update(get_write_count());
+    update_all_statistics();
+}
+
 void Cache::internal_read(Address source, void *destination, size_t size) const {
     CacheLocation loc = compute_location(source);
     for (size_t assoc_index = 0; assoc_index < cache_config.associativity();
@@ -197,8 +275,13 @@ bool Cache::access(
 
             const size_t size_overflow
                 = calculate_overflow_to_next_blocks(size, loc);
+            const size_t size_within_block = size - size_overflow;
+            if (coherence != nullptr) {
+                coherence->transaction(
+                    this, BUS_WRITE, address,
+                    address + (size_within_block - 1));
+            }
             if (size_overflow > 0) {
-                const size_t size_within_block = size - size_overflow;
                 return access(
                     address + size_within_block,
                     (byte *)buffer + size_within_block, size_overflow,
@@ -222,6 +305,14 @@ bool Cache::access(
     if (cd.valid) {
         if (access_type == WRITE) {
             hit_write++;
+            if (coherence != nullptr && !cd.exclusive) {
+                // Shared copies of peers have to be invalidated first.
+                coherence->transaction(
+                    this, BUS_UPGRADE, calc_base_address(cd.tag, loc.row),
+                    calc_base_address(cd.tag, loc.row)
+                        + (cache_config.block_size() * BLOCK_ITEM_SIZE - 1));
+                cd.exclusive = true;
+            }
         } else {
             hit_read++;
         }
@@ -235,16 +326,29 @@ bool Cache::access(
         }
         emit miss_update(get_miss_count());
 
+        const Address block_start = calc_base_address(loc.tag, loc.row);
+        bool shared = false;
+        if (coherence != nullptr) {
+            // Peers flush modified copy before the block is filled.
+            shared = coherence->transaction(
+                this, access_type == WRITE ? BUS_READ_EXCLUSIVE : BUS_READ,
+                block_start,
+                block_start
+                    + (cache_config.block_size() * BLOCK_ITEM_SIZE - 1));
+        }
+
         mem->read(
-            cd.data.data(), calc_base_address(loc.tag, loc.row),
+            cd.data.data(), block_start,
             cache_config.block_size() * BLOCK_ITEM_SIZE,
             { .type = ae::REGULAR });
 
         cd.valid = true;
         cd.dirty = false;
+        cd.exclusive = access_type == WRITE || !shared;
         cd.tag = loc.tag;
 
         change_counter += cache_config.block_size();
+        record_block_change(loc.tag, loc.row);
         mem_reads += cache_config.block_size();
         burst_reads += cache_config.block_size() - 1;
         emit memory_reads_update(mem_reads);
@@ -271,6 +375,7 @@ bool Cache::access(
                 ((byte *)&cd.data[loc.col]) + loc.byte, buffer,
                 size_within_block);
             change_counter++;
+            record_changed_range(address, address + (size_within_block - 1));
         }
     }
     const auto last_affected_col
@@ -311,13 +416,9 @@ size_t Cache::find_block_index(const CacheLocation &loc) const {
 
 void Cache::kick(size_t way, size_t row) const {
     struct CacheLine &cd = dt[way][row];
-    if (cd.dirty && cache_config.write_policy() == CacheConfig::WP_BACK) {
-        mem->write(
-            calc_base_address(cd.tag, row), cd.data.data(),
-            cache_config.block_size() * BLOCK_ITEM_SIZE, {});
-        mem_writes += cache_config.block_size();
-        burst_writes += cache_config.block_size() - 1;
-        emit memory_writes_update(mem_writes);
+    write_back(way, row);
+    if (cd.valid) {
+        record_block_change(cd.tag, row);
     }
     cd.valid = false;
     cd.dirty = false;
@@ -327,11 +428,40 @@ void Cache::kick(size_t way, size_t row) const {
     replacement_policy->update_stats(way, row, false);
 }
 
+bool Cache::write_back(size_t way, size_t row) const {
+    struct CacheLine &cd = dt[way][row];
+    if (!cd.dirty || cache_config.write_policy() != CacheConfig::WP_BACK) {
+        return false;
+    }
+    mem->write(
+        calc_base_address(cd.tag, row), cd.data.data(),
+        cache_config.block_size() * BLOCK_ITEM_SIZE, {});
+    mem_writes += cache_config.block_size();
+    burst_writes += cache_config.block_size() - 1;
+    emit memory_writes_update(mem_writes);
+    cd.dirty = false;
+    return true;
+}
+
+std::unique_lock<std::recursive_mutex> Cache::coherence_guard() const {
+    if (coherence == nullptr) {
+        return {};
+    }
+    return std::unique_lock<std::recursive_mutex>(coherence->lock());
+}
+
 void Cache::update_all_statistics() const {
     emit statistics_update(
         get_stall_count(), get_speed_improvement(), get_hit_rate());
 }
 
+void Cache::record_block_change(size_t tag, size_t row) const {
+    const Address block_start = calc_base_address(tag, row);
+    record_changed_range(
+        block_start,
+        block_start + (cache_config.block_size() * BLOCK_ITEM_SIZE - 1));
+}
+
 Address Cache::calc_base_address(size_t tag, size_t row) const {
     return Address(
         (tag * cache_config.set_count() + row) * cache_config.block_size()
@@ -383,6 +513,7 @@ const CacheConfig &Cache::get_config() const {
 }
 
 uint32_t Cache::get_change_counter() const {
+    const auto guard = coherence_guard();
     return change_counter;
 }
 
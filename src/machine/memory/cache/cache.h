@@ -3,11 +3,13 @@
 
 #include "machineconfig.h"
 #include "memory/cache/cache_policy.h"
+#include "memory/cache/coherence.h"
 #include "memory/cache/cache_types.h"
 #include "memory/frontend_memory.h"
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 
 namespace machine {
 
@@ -71,6 +73,25 @@ public:
 
     uint32_t get_change_counter() const override;
 
+    void reserve(unsigned hart, Address address) override;
+    bool take_reservation(unsigned hart, Address address) override;
+    void
+    invalidate_reservations(Address start_addr, Address last_addr) override;
+    /** Sequence runs under the coherence bus lock. */
+    void atomic_access(const std::function<void()> &sequence) override;
+
+    /**
+     * Keep the cache coherent with the other caches attached to the bus.
+     * The cache is attached to it by this call.
+     */
+    void set_coherence(CoherenceBus *bus);
+    /**
+     * Snoop transaction of a peer cache on the coherence bus. Modified
+     * blocks in the range are written back, then they are either invalidated
+     * or kept as shared.
+     */
+    SnoopResult snoop(Address start_addr, Address last_addr, bool invalidate);
+
     void flush();         // flush cache
     void sync() override; // Same as flush
 
@@ -85,6 +106,7 @@ public:
     double get_hit_rate() const;          // Usage efficiency in percents
 
     void reset(); // Reset whole state of cache
+    void refresh_statistics() const; // Emit all statistics signals again
 
     const CacheConfig &get_config() const;
 
@@ -116,6 +138,7 @@ private:
     const Address uncached_last;
     const uint32_t access_pen_r, access_pen_w, access_pen_b;
     const std::unique_ptr<CachePolicy> replacement_policy;
+    CoherenceBus *coherence = nullptr;
 
     mutable std::vector<std::vector<CacheLine>> dt;
 
@@ -133,8 +156,20 @@ private:
 
     void kick(size_t way, size_t row) const;
 
+    /** Write modified block back to memory, returns true if it was dirty. */
+    bool write_back(size_t way, size_t row) const;
+
+    /** Serializes accesses of coherent caches used from several threads. */
+    std::unique_lock<std::recursive_mutex> coherence_guard() const;
+
     Address calc_base_address(size_t tag, size_t row) const;
 
+    /**
+     * Report whole block as changed (fill and eviction alter both content
+     * and location status of all its addresses).
+     */
+    void record_block_change(size_t tag, size_t row) const;
+
     void update_all_statistics() const;
 
     CacheLocation compute_location(Address address) const;
@@ -18,9 +18,13 @@ struct CacheLocation {
 
 /**
  * Single cache line. Appropriate cache block is stored in `data`.
+ *
+ * `exclusive` is set when no other coherent cache holds the block (MESI
+ * exclusive or modified state), it is meaningful only for caches attached
+ * to `CoherenceBus`.
  */
 struct CacheLine {
-    bool valid, dirty;
+    bool valid, dirty, exclusive;
     uint64_t tag;
     std::vector<uint32_t> data;
 };
@@ -0,0 +1,53 @@
+#include "memory/cache/coherence.h"
+
+#include "memory/cache/cache.h"
+
+using namespace machine;
+
+void CoherenceBus::attach(Cache *cache) {
+    caches.push_back(cache);
+}
+
+bool CoherenceBus::transaction(
+    const Cache *requester,
+    BusTransaction type,
+    Address start_addr,
+    Address last_addr) {
+    const bool invalidate = type != BUS_READ;
+    switch (type) {
+    case BUS_READ: stats.bus_reads++; break;
+    case BUS_READ_EXCLUSIVE: stats.bus_read_exclusives++; break;
+    case BUS_UPGRADE: stats.upgrades++; break;
+    case BUS_WRITE: stats.bus_writes++; break;
+    }
+    bool shared = false;
+    for (Cache *cache : caches) {
+        if (cache == requester) {
+            continue;
+        }
+        const SnoopResult result
+            = cache->snoop(start_addr, last_addr, invalidate);
+        if (result.written_back) {
+            stats.interventions++;
+        }
+        if (result.held) {
+            shared = true;
+            if (invalidate) {
+                stats.invalidations++;
+            }
+        }
+    }
+    return shared;
+}
+
+const CoherenceStats &CoherenceBus::get_stats() const {
+    return stats;
+}
+
+void CoherenceBus::reset_stats() {
+    stats = {};
+}
+
+std::recursive_mutex &CoherenceBus::lock() const {
+    return mutex;
+}
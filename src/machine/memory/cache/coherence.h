@@ -0,0 +1,84 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include "memory/address.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace machine {
+
+class Cache;
+
+/**
+ * Transactions broadcast by a cache on the shared bus.
+ */
+enum BusTransaction {
+    BUS_READ,           // BusRd - read miss, peers keep shared copies
+    BUS_READ_EXCLUSIVE, // BusRdX - write miss, peers invalidate
+    BUS_UPGRADE,        // BusUpgr - write hit to shared line, peers invalidate
+    BUS_WRITE           // Write not allocated in cache, peers invalidate
+};
+
+/**
+ * Outcome of a snoop in a single cache.
+ */
+struct SnoopResult {
+    bool held = false;         // Cache kept a copy of some snooped block
+    bool written_back = false; // Modified data were flushed to memory
+};
+
+/**
+ * Coherence traffic counters.
+ */
+struct CoherenceStats {
+    uint32_t bus_reads = 0;
+    uint32_t bus_read_exclusives = 0;
+    uint32_t upgrades = 0;
+    uint32_t bus_writes = 0;
+    uint32_t invalidations = 0; // Peer lines dropped by snoops
+    uint32_t interventions = 0; // Peer modified lines flushed for requester
+};
+
+/**
+ * Snooping bus connecting private caches of harts (MESI protocol).
+ *
+ * Line states are kept by caches: modified is valid and dirty line of
+ * a write-back cache, exclusive and shared are distinguished by
+ * `CacheLine::exclusive`. Every transaction is snooped by all other attached
+ * caches before the requester accesses memory, so flushed modified data are
+ * seen by the following fill.
+ *
+ * The bus also provides lock serializing accesses of all attached caches, it
+ * is used when harts run on separate host threads.
+ */
+class CoherenceBus {
+public:
+    void attach(Cache *cache);
+
+    /**
+     * Broadcast transaction of the requester for (inclusive) address range.
+     *
+     * @return  true when some peer cache keeps a copy (BUS_READ fills shared)
+     */
+    bool transaction(
+        const Cache *requester,
+        BusTransaction type,
+        Address start_addr,
+        Address last_addr);
+
+    const CoherenceStats &get_stats() const;
+    void reset_stats();
+
+    std::recursive_mutex &lock() const;
+
+private:
+    std::vector<Cache *> caches;
+    CoherenceStats stats;
+    mutable std::recursive_mutex mutex;
+};
+
+} // namespace machine
+
+#endif // COHERENCE_H
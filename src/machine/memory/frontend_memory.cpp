@@ -106,6 +106,71 @@ FrontendMemory::read_ctl(enum AccessControl ctl, Address address) const {
 
 void FrontendMemory::sync() {}
 
+void FrontendMemory::reserve(unsigned hart, Address address) {
+    UNUSED(hart)
+    UNUSED(address)
+}
+
+bool FrontendMemory::take_reservation(unsigned hart, Address address) {
+    UNUSED(hart)
+    UNUSED(address)
+    return false;
+}
+
+void FrontendMemory::invalidate_reservations(
+    Address start_addr,
+    Address last_addr) {
+    UNUSED(start_addr)
+    UNUSED(last_addr)
+}
+
+void FrontendMemory::atomic_access(const std::function<void()> &sequence) {
+    sequence();
+}
+
+void FrontendMemory::flush_changed_range() const {
+    if (!changed_pending) {
+        return;
+    }
+    changed_pending = false;
+    emit changed_range_notify(this, changed_start, changed_last);
+}
+
+bool FrontendMemory::take_changed_range(
+    Address &start_addr,
+    Address &last_addr) const {
+    if (!changed_pending) {
+        return false;
+    }
+    changed_pending = false;
+    start_addr = changed_start;
+    last_addr = changed_last;
+    return true;
+}
+
+void FrontendMemory::notify_changed_range(
+    Address start_addr,
+    Address last_addr) const {
+    emit changed_range_notify(this, start_addr, last_addr);
+}
+
+void FrontendMemory::record_changed_range(
+    Address start_addr,
+    Address last_addr) const {
+    if (!changed_pending) {
+        changed_start = start_addr;
+        changed_last = last_addr;
+        changed_pending = true;
+        return;
+    }
+    if (start_addr < changed_start) {
+        changed_start = start_addr;
+    }
+    if (last_addr > changed_last) {
+        changed_last = last_addr;
+    }
+}
+
 LocationStatus FrontendMemory::location_status(Address address) const {
     (void)address;
     return LOCSTAT_NONE;
@@ -10,6 +10,7 @@
 
 #include <QObject>
 #include <cstdint>
+#include <functional>
 
 // Shortcut for enum class values, type is obvious from context.
 using ae = machine::AccessEffects;
@@ -90,6 +91,65 @@ public:
     virtual LocationStatus location_status(Address address) const;
     virtual uint32_t get_change_counter() const = 0;
 
+    /**
+     * Register LR reservation of the hart for the set containing address.
+     *
+     * Reservations are tracked by the bus terminating the chain (see
+     * `Reservations`), other components forward the request. Default
+     * implementation does not track anything.
+     */
+    virtual void reserve(unsigned hart, Address address);
+
+    /**
+     * Consume reservation of the hart for SC.
+     *
+     * @return  true when the hart held reservation for the address
+     */
+    virtual bool take_reservation(unsigned hart, Address address);
+
+    /**
+     * Drop reservations of all harts overlapping the (inclusive) range.
+     *
+     * Used by components, which absorb writes before they reach the bus
+     * (write-back cache).
+     */
+    virtual void invalidate_reservations(Address start_addr, Address last_addr);
+
+    /**
+     * Perform accesses of an atomic instruction (LR, SC or AMO) as one
+     * indivisible operation.
+     *
+     * Components shared by harts running on separate threads keep their lock
+     * for the whole sequence. Other components forward the request, default
+     * implementation just runs the sequence.
+     */
+    virtual void atomic_access(const std::function<void()> &sequence);
+
+    /**
+     * Publish range of addresses modified since the last call.
+     *
+     * Modifications only extend a pending range (cheap min/max), the
+     * `changed_range_notify` signal is emitted here. The owner of the
+     * simulation loop (`Machine`) calls this once per update tick, so
+     * visualization is notified per tick instead of per access.
+     */
+    void flush_changed_range() const;
+
+    /**
+     * Move pending changed range out without emitting any signal.
+     *
+     * Used when simulation runs in a thread other than the visualization.
+     * The range is later passed to `notify_changed_range` in the GUI thread.
+     *
+     * @return  false when nothing has changed since last flush/take
+     */
+    bool take_changed_range(Address &start_addr, Address &last_addr) const;
+
+    /**
+     * Emit `changed_range_notify` for range obtained by `take_changed_range`.
+     */
+    void notify_changed_range(Address start_addr, Address last_addr) const;
+
     /**
      * Write byte sequence to memory
      *
@@ -139,7 +199,27 @@ signals:
         Address last_addr,
         AccessEffects type) const;
 
+    /**
+     * Range of addresses modified since the last flush.
+     *
+     * @see FrontendMemory::flush_changed_range
+     */
+    void changed_range_notify(
+        const FrontendMemory *issuing_memory,
+        Address start_addr,
+        Address last_addr) const;
+
+protected:
+    /**
+     * Extend the pending changed range by given (inclusive) range.
+     */
+    void record_changed_range(Address start_addr, Address last_addr) const;
+
 private:
+    mutable Address changed_start {};
+    mutable Address changed_last {};
+    mutable bool changed_pending = false;
+
     /**
      * Read any type from memory
      *
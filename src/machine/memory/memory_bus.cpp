@@ -26,6 +26,9 @@ WriteResult MemoryDataBus::write(
     const void *source,
     size_t size,
     WriteOptions options) {
+    if (options.type == ae::REGULAR) {
+        access_counter++;
+    }
     return repeat_access_until_completed<WriteResult>(
         destination, source, size, options,
         [this](Address dst, const void *src, size_t s, WriteOptions opt)
@@ -45,10 +48,15 @@ WriteResult MemoryDataBus::write_single(
         return (WriteResult) { .n_bytes = 0, .changed = false };
     }
     WriteResult result = range->device->write(
-        destination - range->start_addr, source, size, options);
+        range->device_offset(destination), source, size, options);
+    if (result.n_bytes > 0) {
+        reservations.invalidate(
+            destination, destination + (result.n_bytes - 1));
+    }
 
     if (result.changed) {
         change_counter++;
+        record_changed_range(destination, destination + (result.n_bytes - 1));
     }
 
     return result;
@@ -59,6 +67,9 @@ ReadResult MemoryDataBus::read(
     Address source,
     size_t size,
     ReadOptions options) const {
+    if (options.type == ae::REGULAR) {
+        access_counter++;
+    }
     return repeat_access_until_completed<ReadResult>(
         destination, source, size, options,
         [this](void *dst, Address src, size_t s, ReadOptions opt)
@@ -80,19 +91,37 @@ ReadResult MemoryDataBus::read_single(
     }
 
     return p_range->device->read(
-        destination, source - p_range->start_addr, size, options);
+        destination, p_range->device_offset(source), size, options);
 }
 
 uint32_t MemoryDataBus::get_change_counter() const {
     return change_counter;
 }
 
+void MemoryDataBus::reserve(unsigned hart, Address address) {
+    reservations.reserve(hart, address);
+}
+
+bool MemoryDataBus::take_reservation(unsigned hart, Address address) {
+    return reservations.take(hart, address);
+}
+
+void MemoryDataBus::invalidate_reservations(
+    Address start_addr,
+    Address last_addr) {
+    reservations.invalidate(start_addr, last_addr);
+}
+
+void MemoryDataBus::clear_reservations() {
+    reservations.clear();
+}
+
 enum LocationStatus MemoryDataBus::location_status(Address address) const {
     const RangeDesc *range = find_range(address);
     if (range == nullptr) {
         return LOCSTAT_ILLEGAL;
     }
-    return range->device->location_status(address - range->start_addr);
+    return range->device->location_status(range->device_offset(address));
 }
 
 const MemoryDataBus::RangeDesc *
@@ -117,14 +146,16 @@ bool MemoryDataBus::insert_device_to_range(
     BackendMemory *device,
     Address start_addr,
     Address last_addr,
-    bool move_ownership) {
+    bool move_ownership,
+    Offset start_offset) {
     auto iter = ranges_by_addr.lowerBound(start_addr);
     if (iter != ranges_by_addr.end()
         && iter.value()->overlaps(start_addr, last_addr)) {
         // Some part of requested range in already taken.
         return false;
     }
-    auto *range = new RangeDesc(device, start_addr, last_addr, move_ownership);
+    auto *range = new RangeDesc(
+        device, start_addr, last_addr, move_ownership, start_offset);
 
     // Why are we using last address as key?
     //
@@ -137,9 +168,11 @@ bool MemoryDataBus::insert_device_to_range(
     // searched address for case that range is not present.
     ranges_by_addr.insert(last_addr, range);
     ranges_by_device.insert(device, range);
+    // Direct connection, device may live in the simulation thread during
+    // background run.
     connect(
         device, &BackendMemory::external_backend_change_notify, this,
-        &MemoryDataBus::range_backend_external_change);
+        &MemoryDataBus::range_backend_external_change, Qt::DirectConnection);
     return true;
 }
 
@@ -181,11 +214,24 @@ void MemoryDataBus::range_backend_external_change(
     // We only use device here for lookup, so const_cast is safe as find takes
     // it by const reference .
     for (auto i = ranges_by_device.find(const_cast<BackendMemory *>(device));
-         i != ranges_by_device.end(); i++) {
+         i != ranges_by_device.end() && i.key() == device; i++) {
         const RangeDesc *range = i.value();
-        emit external_change_notify(
-            this, range->start_addr + start_offset,
-            std::max(range->start_addr + last_offset, range->last_addr), type);
+        if (last_offset < range->start_offset) {
+            continue; // Change is below this range.
+        }
+        const Address start_addr
+            = range->start_addr
+              + (std::max(start_offset, range->start_offset)
+                 - range->start_offset);
+        const Address last_addr = std::min(
+            range->start_addr + (last_offset - range->start_offset),
+            range->last_addr);
+        if (start_addr > last_addr) {
+            continue; // Change is above this range.
+        }
+        reservations.invalidate(start_addr, last_addr);
+        record_changed_range(start_addr, last_addr);
+        emit external_change_notify(this, start_addr, last_addr, type);
     }
 }
 
@@ -193,11 +239,13 @@ MemoryDataBus::RangeDesc::RangeDesc(
     BackendMemory *device,
     Address start_addr,
     Address last_addr,
-    bool owns_device)
+    bool owns_device,
+    Offset start_offset)
     : device(device)
     , start_addr(start_addr)
     , last_addr(last_addr)
-    , owns_device(owns_device) {}
+    , owns_device(owns_device)
+    , start_offset(start_offset) {}
 
 bool MemoryDataBus::RangeDesc::contains(Address address) const {
     return start_addr <= address && address <= last_addr;
@@ -207,6 +255,10 @@ bool MemoryDataBus::RangeDesc::overlaps(Address start, Address last) const {
     return contains(start) || contains(last);
 }
 
+Offset MemoryDataBus::RangeDesc::device_offset(Address address) const {
+    return start_offset + (address - start_addr);
+}
+
 TrivialBus::TrivialBus(BackendMemory *backend_memory)
     : FrontendMemory(backend_memory->simulated_machine_endian)
     , device(backend_memory) {}
@@ -217,7 +269,16 @@ WriteResult TrivialBus::write(
     size_t size,
     WriteOptions options) {
     change_counter += 1; // Counter is mandatory by the frontend interface.
-    return device->write(destination.get_raw(), source, size, options);
+    WriteResult result
+        = device->write(destination.get_raw(), source, size, options);
+    if (result.n_bytes > 0) {
+        reservations.invalidate(
+            destination, destination + (result.n_bytes - 1));
+    }
+    if (result.changed) {
+        record_changed_range(destination, destination + (result.n_bytes - 1));
+    }
+    return result;
 }
 
 ReadResult TrivialBus::read(
@@ -231,3 +292,17 @@ ReadResult TrivialBus::read(
 uint32_t TrivialBus::get_change_counter() const {
     return change_counter;
 }
+
+void TrivialBus::reserve(unsigned hart, Address address) {
+    reservations.reserve(hart, address);
+}
+
+bool TrivialBus::take_reservation(unsigned hart, Address address) {
+    return reservations.take(hart, address);
+}
+
+void TrivialBus::invalidate_reservations(
+    Address start_addr,
+    Address last_addr) {
+    reservations.invalidate(start_addr, last_addr);
+}
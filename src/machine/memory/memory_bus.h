@@ -5,6 +5,7 @@
 #include "machinedefs.h"
 #include "memory/backend/backend_memory.h"
 #include "memory/frontend_memory.h"
+#include "memory/reservations.h"
 #include "simulator_exception.h"
 #include "utils.h"
 
@@ -70,6 +71,20 @@ public:
      */
     uint32_t get_change_counter() const override;
 
+    void reserve(unsigned hart, Address address) override;
+    bool take_reservation(unsigned hart, Address address) override;
+    void
+    invalidate_reservations(Address start_addr, Address last_addr) override;
+
+    /** Drop reservations of all harts (machine restart). */
+    void clear_reservations();
+
+    /**
+     * Number of regular (not internal) read and write requests. Used by bus
+     * masters other than the core to account for bus contention.
+     */
+    uint64_t get_access_counter() const { return access_counter; }
+
     /**
      * Connect a backend device to the bus for given address range.
      *
@@ -80,6 +95,8 @@ public:
      * @param move_ownership    if true, bus will be responsible for for
      *                          device destruction
      *                          TODO: consider replace with a smartpointer
+     * @param start_offset      offset within the device seen at start_addr,
+     *                          allows to map one device by multiple ranges
      * @return                  result of connection, it will fail if range is
      *                          already occupied
      */
@@ -87,7 +104,8 @@ public:
         BackendMemory *device,
         Address start_addr,
         Address last_addr,
-        bool move_ownership);
+        bool move_ownership,
+        Offset start_offset = 0);
 
     /**
      * Disconnect a device by a pointer to it.
@@ -130,6 +148,8 @@ private:
      */
     QMap<Address, const RangeDesc *> ranges_by_addr;
     mutable uint32_t change_counter = 0;
+    mutable uint64_t access_counter = 0;
+    Reservations reservations;
 
     /**
      * Helper to write into single range. Used by `write`.
@@ -173,7 +193,8 @@ public:
         BackendMemory *device,
         Address start_addr,
         Address last_addr,
-        bool owns_device);
+        bool owns_device,
+        Offset start_offset);
 
     /**
      * Tells, whether given address belongs to this range.
@@ -186,10 +207,16 @@ public:
      */
     bool overlaps(Address start, Address last) const;
 
+    /**
+     * Offset within the device for given address from this range.
+     */
+    Offset device_offset(Address address) const;
+
     BackendMemory *const device; // TODO consider a shared pointer
     const Address start_addr;
     const Address last_addr;
     const bool owns_device;
+    const Offset start_offset;
 };
 
 /**
@@ -218,9 +245,15 @@ public:
 
     uint32_t get_change_counter() const override;
 
+    void reserve(unsigned hart, Address address) override;
+    bool take_reservation(unsigned hart, Address address) override;
+    void
+    invalidate_reservations(Address start_addr, Address last_addr) override;
+
 private:
     BackendMemory *const device;
     mutable uint32_t change_counter = 0;
+    Reservations reservations;
 };
 
 } // namespace machine
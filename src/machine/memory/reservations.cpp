@@ -0,0 +1,35 @@
+#include "memory/reservations.h"
+
+using namespace machine;
+
+void Reservations::reserve(unsigned hart, Address address) {
+    by_hart.insert(hart, address & ~(GRANULE - 1));
+}
+
+bool Reservations::take(unsigned hart, Address address) {
+    auto i = by_hart.find(hart);
+    if (i == by_hart.end()) {
+        return false;
+    }
+    const bool held = i.value() == (address & ~(GRANULE - 1));
+    by_hart.erase(i);
+    return held;
+}
+
+void Reservations::invalidate(Address start_addr, Address last_addr) {
+    if (by_hart.isEmpty()) {
+        return;
+    }
+    const Address first_granule = start_addr & ~(GRANULE - 1);
+    for (auto i = by_hart.begin(); i != by_hart.end();) {
+        if (i.value() >= first_granule && i.value() <= last_addr) {
+            i = by_hart.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Reservations::clear() {
+    by_hart.clear();
+}
@@ -0,0 +1,46 @@
+#ifndef RESERVATIONS_H
+#define RESERVATIONS_H
+
+#include "memory/address.h"
+
+#include <QMap>
+#include <cstdint>
+
+namespace machine {
+
+/**
+ * Reservations of load-reserved/store-conditional (RISC-V "A") instructions.
+ *
+ * Each hart holds at most one reservation. Reservation set is the naturally
+ * aligned granule containing the reserved address. Any write to the granule,
+ * by a hart or another bus master (DMA), invalidates reservations of all
+ * harts for it. Reservations are kept by the last level of frontend memory
+ * (the bus), so every writer in the system is seen.
+ */
+class Reservations {
+public:
+    /** Size of reservation set in bytes, LR.D fits in. */
+    static constexpr uint64_t GRANULE = 8;
+
+    /** Register reservation of the hart, previous one is dropped. */
+    void reserve(unsigned hart, Address address);
+
+    /**
+     * Consume reservation of the hart (as store-conditional does).
+     *
+     * @return  true when the hart held reservation for the address
+     */
+    bool take(unsigned hart, Address address);
+
+    /** Drop reservations overlapping written (inclusive) range. */
+    void invalidate(Address start_addr, Address last_addr);
+
+    void clear();
+
+private:
+    QMap<unsigned, Address> by_hart; // Reserved granule of the hart
+};
+
+} // namespace machine
+
+#endif // RESERVATIONS_H
@@ -15,6 +15,7 @@
 #ifndef STAGES_H
 #define STAGES_H
 
+#include "execute/fpu_op.h"
 #include "instruction.h"
 #include "memory/address.h"
 
@@ -23,6 +24,12 @@
 
 namespace machine {
 
+/**
+ * Floating-point registers are numbered after general-purpose ones in
+ * num_rs1, num_rs2, num_rs3 and num_rd, so one hazard unit covers both files.
+ */
+constexpr uint8_t FP_REG_BASE = 32;
+
 enum ForwardFrom {
     FORWARD_NONE = 0b00,
     FORWARD_FROM_W = 0b01,
@@ -83,6 +90,16 @@ struct DecodeInterstage {
     bool stop_if = false;
     bool is_valid = false;
     bool alu_mod = false; // alternative versions of ADD and right-shift
+    bool alu_mul = false; // operation of multiplier (aluop holds MulOp)
+    bool alu_word = false; // RV64 32-bit word operation
+    AluFunction alu_fn = nullptr; // ALU operation selected by decode
+    bool fpu = false;       // operation of FPU (aluop holds FpuOp)
+    bool fp_double = false; // double-precision floating-point operation
+    bool fp_req_rs3 = false; // requires rs3 for fused multiply-add
+    bool csr = false;        // control and status register access
+    FpRounding fp_rm = FpRounding::RNE; // Rounding mode from instruction
+    uint8_t num_rs3 = 0;                // Number of the register s3
+    RegisterValue val_rs3 = 0;          // Value from register rs3
 };
 struct DecodeInternalState {
     /**
@@ -108,6 +125,7 @@ struct ExecuteInterstage {
     bool in_delay_slot = false;
     bool stop_if = false;
     bool is_valid = false;
+    bool fp_box = false; // NaN-box loaded single-precision value
 };
 struct ExecuteInternalState {
     bool alu_src = false;
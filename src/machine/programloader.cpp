@@ -92,7 +92,6 @@ ProgramLoader::ProgramLoader(const QString &file) : elf_file(file) {
     } else if (elf_class == ELFCLASS64) {
         LOG("Loaded executable: 64bit");
         architecture_type = ARCH64;
-        WARN("64bit simulation is not fully supported.");
         // Get program sections headers
         if (!(sections_headers.arch64 = elf64_getphdr(elf))) {
             throw SIMULATOR_EXCEPTION(
@@ -142,7 +141,7 @@ void ProgramLoader::to_memory(Memory *mem) {
         }
     } else if (architecture_type == ARCH64) {
         for (size_t phdrs_i : this->indexes_of_load_sections) {
-            uint32_t base_address
+            uint64_t base_address
                 = this->sections_headers.arch64[phdrs_i].p_vaddr;
             char *f = elf_rawfile(this->elf, nullptr);
             for (unsigned y = 0;
@@ -156,7 +155,7 @@ void ProgramLoader::to_memory(Memory *mem) {
 }
 
 Address ProgramLoader::end() {
-    uint32_t last = 0;
+    uint64_t last = 0;
     // Go trough all sections and found out last one
     if (architecture_type == ARCH32) {
         for (size_t i : this->indexes_of_load_sections) {
@@ -21,37 +21,39 @@ Registers::Registers(const Registers &orig) : QObject() {
     this->lo = orig.read_hi_lo(false);
     this->hi = orig.read_hi_lo(true);
     this->gp = orig.gp;
+    this->fp = orig.fp;
+    this->fcsr = orig.fcsr;
 }
 
 Address Registers::read_pc() const {
     return this->pc;
 }
 
-Address Registers::pc_inc() {
-    this->pc += 4;
-    emit pc_update(this->pc);
+Address Registers::pc_inc(unsigned size) {
+    this->pc += size;
+    pc_changed = true;
     return this->pc;
 }
 
 Address Registers::pc_jmp(int32_t offset) {
-    if (offset % 4) {
+    if (offset % 2) {
         throw SIMULATOR_EXCEPTION(
             UnalignedJump, "Trying to jump by unaligned offset",
             QString::number(offset, 16));
     }
     this->pc += offset;
-    emit pc_update(this->pc);
+    pc_changed = true;
     return this->pc;
 }
 
 void Registers::pc_abs_jmp(machine::Address address) {
-    if (address.get_raw() % 4) {
+    if (address.get_raw() % 2) {
         throw SIMULATOR_EXCEPTION(
             UnalignedJump, "Trying to jump to unaligned address",
             QString::number(address.get_raw(), 16));
     }
     this->pc = address;
-    emit pc_update(this->pc);
+    pc_changed = true;
 }
 
 void Registers::pc_abs_jmp_28(Address address) {
@@ -63,9 +65,8 @@ RegisterValue Registers::read_gp(RegisterId reg) const {
         return { 0 }; // $0 always reads as 0
     }
 
-    RegisterValue value = this->gp.at(reg.data);
-    emit gp_read(reg, value.as_u32());
-    return value;
+    journal.record_read(reg);
+    return this->gp[reg.data];
 }
 
 void Registers::write_gp(RegisterId reg, RegisterValue value) {
@@ -73,8 +74,31 @@ void Registers::write_gp(RegisterId reg, RegisterValue value) {
         return; // Skip write to $0
     }
 
-    this->gp.at(reg.data) = value;
-    emit gp_update(reg, value.as_u32());
+    journal.record_write(reg, this->gp[reg.data], value);
+    this->gp[reg.data] = value;
+}
+
+RegisterValue Registers::read_fp(RegisterId reg) const {
+    journal.record_fp_read(reg);
+    return this->fp[reg.data];
+}
+
+void Registers::write_fp(RegisterId reg, RegisterValue value) {
+    journal.record_fp_write(reg, this->fp[reg.data], value);
+    this->fp[reg.data] = value;
+}
+
+void Registers::write_fcsr(uint32_t value) {
+    value &= FCSR_MASK;
+    journal.record_fcsr_write(fcsr, value);
+    fcsr = value;
+}
+
+void Registers::accrue_fflags(uint32_t flags) {
+    flags &= FCSR_FFLAGS_MASK;
+    if ((fcsr | flags) != fcsr) {
+        write_fcsr(fcsr | flags);
+    }
 }
 
 RegisterValue Registers::read_hi_lo(bool is_hi) const {
@@ -99,6 +123,9 @@ bool Registers::operator==(const Registers &c) const {
     if (this->gp != c.gp) {
         return false;
     }
+    if (this->fp != c.fp || this->fcsr != c.fcsr) {
+        return false;
+    }
     if (read_hi_lo(false).as_u32() != c.read_hi_lo(false).as_u32()) {
         return false;
     }
@@ -119,6 +146,22 @@ void Registers::reset() {
     }
     write_gp(29_reg, SP_INIT.get_raw()); // initialize to safe RAM area -
                                          // corresponds to Linux
+    for (int i = 0; i < 32; i++) {
+        write_fp(i, 0);
+    }
+    write_fcsr(0);
     write_hi_lo(false, 0);
     write_hi_lo(true, 0);
+    flush_changes();
+}
+
+void Registers::flush_changes() {
+    if (!journal.empty()) {
+        emit step_changes(journal);
+        journal.clear();
+    }
+    if (pc_changed) {
+        pc_changed = false;
+        emit pc_update(this->pc);
+    }
 }
@@ -6,6 +6,7 @@
 #include "simulator_exception.h"
 
 #include <QObject>
+#include <QVarLengthArray>
 #include <array>
 #include <cstdint>
 
@@ -44,6 +45,78 @@ inline RegisterId operator"" _reg(unsigned long long value) {
     return { static_cast<uint8_t>(value) };
 }
 
+/**
+ * Register write recorded in the journal (general-purpose or
+ * floating-point, they are kept in separate lists).
+ */
+struct RegisterChange {
+    RegisterId reg;
+    RegisterValue old_value;
+    RegisterValue new_value;
+};
+
+/**
+ * Accesses of general-purpose registers during one step.
+ *
+ * Observers (register view, tracer) get whole journal once per step instead
+ * of a signal for each access. Old values allow to undo the step.
+ */
+class RegisterJournal {
+public:
+    void record_write(
+        RegisterId reg,
+        RegisterValue old_value,
+        RegisterValue new_value) {
+        writes.append({ reg, old_value, new_value });
+    }
+    void record_read(RegisterId reg) { read_mask |= 1u << reg.data; }
+    void record_fp_write(
+        RegisterId reg,
+        RegisterValue old_value,
+        RegisterValue new_value) {
+        fp_writes.append({ reg, old_value, new_value });
+    }
+    void record_fp_read(RegisterId reg) { fp_read_mask |= 1u << reg.data; }
+    void record_fcsr_write(uint32_t old_value, uint32_t new_value) {
+        if (!fcsr_written) {
+            old_fcsr = old_value;
+            fcsr_written = true;
+        }
+        new_fcsr = new_value;
+    }
+    void clear() {
+        writes.clear();
+        read_mask = 0;
+        fp_writes.clear();
+        fp_read_mask = 0;
+        fcsr_written = false;
+    }
+    bool empty() const {
+        return writes.isEmpty() && read_mask == 0 && fp_writes.isEmpty()
+               && fp_read_mask == 0 && !fcsr_written;
+    }
+
+    /** Writes in program order. */
+    QVarLengthArray<RegisterChange, 4> writes;
+    /** Bit for each register read. */
+    uint32_t read_mask = 0;
+    /** Floating-point register writes in program order. */
+    QVarLengthArray<RegisterChange, 2> fp_writes;
+    uint32_t fp_read_mask = 0;
+    /** Value of fcsr before the first and after the last write. */
+    bool fcsr_written = false;
+    uint32_t old_fcsr = 0;
+    uint32_t new_fcsr = 0;
+};
+
+/*
+ * Fields of floating-point control and status register (fcsr).
+ */
+constexpr uint32_t FCSR_FFLAGS_MASK = 0x1f; // Accrued exceptions
+constexpr unsigned FCSR_FRM_SHIFT = 5;      // Dynamic rounding mode
+constexpr uint32_t FCSR_FRM_MASK = 0x7 << FCSR_FRM_SHIFT;
+constexpr uint32_t FCSR_MASK = FCSR_FFLAGS_MASK | FCSR_FRM_MASK;
+
 /**
  * Register file
  */
@@ -54,7 +127,8 @@ public:
     Registers(const Registers &);
 
     Address read_pc() const;          // Return current value of program counter
-    Address pc_inc();                 // Increment program counter by four bytes
+    Address pc_inc(unsigned size = 4); // Increment program counter by size of
+                                       // the instruction
     Address pc_jmp(int32_t offset);   // Relative jump from current
                                       // location in
                                       // program counter
@@ -67,6 +141,19 @@ public:
                                                         // register
     void write_gp(RegisterId reg, RegisterValue value); // Write general-purpose
                                                         // register
+    /** Read register without recording the access (for observers). */
+    RegisterValue peek_gp(RegisterId reg) const { return gp[reg.data]; }
+    /**
+     * Floating-point registers hold 64 bits (D extension), single-precision
+     * values are NaN-boxed.
+     */
+    RegisterValue read_fp(RegisterId reg) const;
+    void write_fp(RegisterId reg, RegisterValue value);
+    RegisterValue peek_fp(RegisterId reg) const { return fp[reg.data]; }
+    uint32_t read_fcsr() const { return fcsr; }
+    void write_fcsr(uint32_t value);
+    /** Or exception flags to fcsr.fflags. */
+    void accrue_fflags(uint32_t flags);
     RegisterValue read_hi_lo(bool hi) const; // true - read HI / false - read LO
     void write_hi_lo(bool hi, RegisterValue value);
 
@@ -75,11 +162,16 @@ public:
 
     void reset(); // Reset all values to zero (except pc)
 
+    /**
+     * Publish accesses since the last call (`step_changes` and `pc_update`)
+     * and start a new journal. Called once per step.
+     */
+    void flush_changes();
+
 signals:
     void pc_update(Address val);
-    void gp_update(RegisterId reg, RegisterValue val);
+    void step_changes(const machine::RegisterJournal &changes);
     void hi_lo_update(bool hi, RegisterValue val);
-    void gp_read(RegisterId reg, RegisterValue val) const;
     void hi_lo_read(bool hi, RegisterValue val) const;
 
 private:
@@ -90,8 +182,15 @@ private:
      * Getters and setters will never try to read or write zero register.
      */
     std::array<RegisterValue, REGISTER_COUNT> gp {};
+    /** Floating-point registers, f0 is a regular register. */
+    std::array<RegisterValue, REGISTER_COUNT> fp {};
+    uint32_t fcsr = 0;
     RegisterValue hi {}, lo {};
     Address pc {}; // program counter
+
+    // Reads are recorded from const getter.
+    mutable RegisterJournal journal;
+    bool pc_changed = false;
 };
 
 } // namespace machine